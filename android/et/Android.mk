@@ -28,6 +28,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-android/nativeactivity.android.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/debug.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/plist.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/tools.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/core/assetpack.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/objectscache.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/core/transformable.cpp
 
@@ -39,6 +40,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scene3d.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/serialization.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/storage.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/supportmesh.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/scene3d/scenequery.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/primitives/primitives.cpp
 
@@ -55,6 +57,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/carousel.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/element2d.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/element3d.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/font.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/charactergenerator.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/gui.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/guibase.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/gui/guirenderer.cpp
@@ -78,6 +81,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pngloader.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/imaging/pvrloader.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/taskpool.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/tasks/jobsystem.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/notifytimer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/timers/sequence.cpp
@@ -106,6 +110,7 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/vertexbuffer/vertexdeclaration.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/renderer.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/rendering.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/renderstate.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/uploadqueue.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/rendering/rendercontext.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/opengl/opengl.common.cpp
@@ -118,10 +123,15 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/app/invocation.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/app/runloop.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/aabb.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/broadphase.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/collision.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/collision/trianglebvh.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/criticalsection.unix.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/mappedfile.unix.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/filewatcher.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/mutex.unix.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/condition.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/atomiccounter.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/thread.unix.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/platform-unix/threading.unix.cpp
@@ -131,7 +141,9 @@ LOCAL_SRC_FILES += $(SOURCE_PATH)/geometry/geometry.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/geometry/rectplacer.cpp
 
 LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/formats.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/oggvorbis.cpp
 LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/sound.openal.cpp
+LOCAL_SRC_FILES += $(SOURCE_PATH)/sound/voicemanager.cpp
 
 LOCAL_STATIC_LIBRARIES := android_native_app_glue libpng libjpeg libzip libxml libcurl openal
 
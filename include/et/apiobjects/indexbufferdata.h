@@ -42,6 +42,12 @@ namespace et
 			{ return _sourceTag; }
 
 		void setData(const IndexArray::Pointer& i);
+		void setDataWithOffset(const void* data, size_t offset, size_t dataSize);
+		
+		/*
+		 * Takes properties from index array and allocates storage without uploading data
+		 */
+		void allocateData(const IndexArray::Pointer& i);
 
 	private:
 		void setProperties(const IndexArray::Pointer& i);
@@ -33,7 +33,23 @@ namespace et
 
 		vec2 getTexCoord(const vec2& ivec, TextureOrigin origin = TextureOrigin_TopLeft) const;
 
+		/*
+		 * Data of the description is released once it is uploaded, both here and
+		 * in the end of staged update, description keeps only properties of the texture.
+		 */
 		void updateData(RenderContext* rc, TextureDescription::Pointer desc);
+		
+		/*
+		 * Staged update (see UploadQueue): properties are set first, then levels or ranges of rows
+		 * are uploaded one by one. Uploading rows from the first one allocates the whole level.
+		 * Returns false if description could not be uploaded by levels.
+		 */
+		bool beginStagedUpdate(RenderContext* rc, TextureDescription::Pointer desc);
+		void updateLevel(RenderContext* rc, size_t level, size_t layer);
+		void updateLevelRows(RenderContext* rc, size_t level, size_t layer, int firstRow, int rowsCount);
+		void endStagedUpdate();
+		
+		size_t layersCount() const;
 		void updateDataDirectly(RenderContext* rc, const vec2i& size, char* data, size_t dataSize);
 
 		void updatePartialDataDirectly(RenderContext* rc, const vec2i& offset, const vec2i& size,
@@ -72,6 +88,8 @@ namespace et
 		const TextureDescription::Pointer description() const
 			{ return _desc; }
 
+		uint64_t memoryUsage() const;
+
 	private:
 		friend class TextureFactory;
 
@@ -83,7 +101,10 @@ namespace et
 
 		void generateTexture(RenderContext* rc);
 		void build(RenderContext* rc);
+		bool buildProperties(RenderContext* rc);
         void buildData(const char* ptr, size_t dataSize);
+		void buildLevelData(size_t level, size_t layer, const char* ptr, size_t dataSize);
+		void releaseData();
 
 	private:
 		uint32_t _glID;
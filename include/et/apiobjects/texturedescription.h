@@ -32,17 +32,17 @@ namespace et
 		typedef std::vector<TextureDescription::Pointer> List;
 
 	public:
-		vec2i sizeForMipLevel(size_t level)
+		vec2i sizeForMipLevel(size_t level) const
 			{ return size / intPower(2, level); }
 
-		size_t dataSizeForMipLevel(size_t level)
+		size_t dataSizeForMipLevel(size_t level) const
 		{
 			size_t actualSize = static_cast<size_t>(sizeForMipLevel(level).square()) * bitsPerPixel / 8;
 			size_t minimumSize = static_cast<size_t>(minimalSizeForCompressedFormat.square()) * bitsPerPixel / 8;
 			return compressed ? etMax(minimalDataSize, etMax(minimumSize, actualSize)) : actualSize;
 		}
 
-		size_t dataSizeForAllMipLevels()
+		size_t dataSizeForAllMipLevels() const
 		{
 			size_t result = 0;
 			for (size_t i = 0; i < mipMapCount; ++i)
@@ -20,7 +20,14 @@ namespace et
 		~TextureFactory();
 		
 		Texture loadTexture(const std::string& file, ObjectsCache& cache, bool async = false,
-			TextureLoaderDelegate* delegate = nullptr);
+			TextureLoaderDelegate* delegate = nullptr,
+			TextureLoadingPriority priority = TextureLoadingPriority_Default);
+
+		/*
+		 * Asynchronous loading control, texture is identified by the origin
+		 */
+		bool setTextureLoadingPriority(const Texture& texture, TextureLoadingPriority priority);
+		bool cancelTextureLoading(const Texture& texture);
 
 		Texture loadTexturesToCubemap(const std::string& posx, const std::string& negx,
 			const std::string& posy, const std::string& negy, const std::string& posz,
@@ -52,9 +59,10 @@ namespace et
 			{ return *this; }
 		
 		void reloadObject(LoadableObject::Pointer, ObjectsCache&);
+		void textureDidUpload(TextureLoadingRequest* request);
 		
 	private:
-		AutoPtr<TextureLoadingThread> _loadingThread;
+		AutoPtr<TextureLoadingPool> _loadingPool;
 		CriticalSection _csTextureLoading;
 		ObjectLoader::Pointer _loader;
 	};
@@ -8,16 +8,32 @@
 #pragma once
 
 #include <list>
-#include <queue>
+#include <deque>
+#include <map>
+#include <set>
 #include <et/threading/thread.h>
+#include <et/threading/atomiccounter.h>
 #include <et/threading/criticalsection.h>
 #include <et/apiobjects/texture.h>
 
 namespace et
 {
+	enum TextureLoadingPriority
+	{
+		TextureLoadingPriority_Prefetch,
+		TextureLoadingPriority_Default,
+		TextureLoadingPriority_Visible,
+		TextureLoadingPriority_max
+	};
+
+	class TextureLoadingPool;
 	struct TextureLoadingRequest;
 	typedef std::list<TextureLoadingRequest*> TextureLoadingRequestList;
 
+	/*
+	 * Destroying delegate cancels requests, which are not needed by anyone else.
+	 * Delegates should be destroyed in the main thread.
+	 */
 	class TextureLoaderDelegate
 	{
 	public:
@@ -42,20 +58,34 @@ namespace et
 
 	struct TextureLoadingRequest
 	{
+		enum State
+		{
+			State_Queued,
+			State_Decoding,
+			State_Decoded
+		};
+
 		std::string fileName;
 		TextureDescription::Pointer textureDescription;
 		Texture texture;
-		TextureLoaderDelegate* delegate;
+		TextureLoadingPool* pool;
+		std::vector<TextureLoaderDelegate*> delegates;
+		TextureLoadingPriority priority;
+		State state;
+		bool requestedWithoutDelegate;
+		bool cancelled;
+
+		TextureLoadingRequest(const std::string& name, const Texture& tex, TextureLoadingPool* p,
+			TextureLoadingPriority pr);
 
-		TextureLoadingRequest(const std::string& name, const Texture& tex, TextureLoaderDelegate* d);
 		~TextureLoadingRequest();
-		
-		void discardDelegate();
+
+		void addDelegate(TextureLoaderDelegate* d);
+		void discardDelegate(TextureLoaderDelegate* d);
 	};
-	
-	typedef std::queue<TextureLoadingRequest*> TextureLoadingRequestQueue;
 
-	class TextureLoadingThread;
+	typedef std::deque<TextureLoadingRequest*> TextureLoadingRequestQueue;
+
 	class TextureLoadingThreadDelegate
 	{
 	public:
@@ -66,20 +96,91 @@ namespace et
 	class TextureLoadingThread : public Thread
 	{
 	public:
-		TextureLoadingThread(TextureLoadingThreadDelegate* delegate);
-		~TextureLoadingThread();
-
-		void addRequest(const std::string& fileName, Texture texture, TextureLoaderDelegate* delegate);
+		TextureLoadingThread(TextureLoadingPool* pool);
 
 	private:
 		ThreadResult main();
+
+	private:
+		TextureLoadingPool* _pool;
+	};
+
+	/*
+	 * Decodes textures on several threads. Requests with higher priority are taken first,
+	 * requests for the same file are merged into one.
+	 * Loaded textures are delivered to the delegate in the main run loop.
+	 */
+	class TextureLoadingPool
+	{
+	public:
+		TextureLoadingPool(TextureLoadingThreadDelegate* delegate, size_t threadsCount);
+		~TextureLoadingPool();
+
+		size_t threadsCount() const
+			{ return _threads.size(); }
+
+		void addRequest(const std::string& fileName, Texture texture, TextureLoaderDelegate* delegate,
+			TextureLoadingPriority priority = TextureLoadingPriority_Default);
+
+		/*
+		 * Attaches delegate to the request for the same file, which is still in progress
+		 * or restarts cancelled one. Returns false if there is nothing to wait for.
+		 */
+		bool joinRequest(Texture texture, TextureLoaderDelegate* delegate,
+			TextureLoadingPriority priority = TextureLoadingPriority_Default);
+
+		bool setPriority(const std::string& fileName, TextureLoadingPriority priority);
+
+		/*
+		 * Removes request from the queue or discards result of decoding if it's already started.
+		 * Texture stays without data until it's requested again, delegates are not notified.
+		 */
+		bool cancelRequest(const std::string& fileName);
+
+		/*
+		 * Should be called by delegate before request is deleted.
+		 * Returns delegates of the request, no more delegates could join it after this call.
+		 */
+		void finishRequest(TextureLoadingRequest* request, std::vector<TextureLoaderDelegate*>& delegates);
+
+	private:
+		friend class TextureLoadingThread;
+		friend class TextureLoaderDelegate;
+
+		void startThreads();
+		void wakeThread();
+
 		TextureLoadingRequest* dequeRequest();
+		void processRequest(TextureLoadingRequest* request);
+
+		void discardDelegate(TextureLoadingRequest* request, TextureLoaderDelegate* delegate);
+
+		void enqueue(TextureLoadingRequest* request);
+		bool removeFromQueue(TextureLoadingRequest* request);
+		void changePriority(TextureLoadingRequest* request, TextureLoadingPriority priority);
+		bool cancel(TextureLoadingRequest* request);
+
+	private:
+		TextureLoadingPool(const TextureLoadingPool&)
+			{ }
+
+		TextureLoadingPool& operator = (const TextureLoadingPool&)
+			{ return *this; }
 
 	private:
 		TextureLoadingThreadDelegate* _delegate;
-		TextureLoadingRequestQueue _requests;
-		CriticalSection _requestsCriticalSection;
-		
-		volatile bool _running;
+		std::vector<TextureLoadingThread*> _threads;
+		AtomicCounter _nextThread;
+
+		CriticalSection _csRequests;
+		TextureLoadingRequestQueue _queues[TextureLoadingPriority_max];
+		std::map<std::string, TextureLoadingRequest*> _activeRequests;
+
+		/*
+		 * Names of files, which loading was cancelled. Textures are not retained here,
+		 * they are passed again to joinRequest by the factory.
+		 */
+		std::set<std::string> _cancelledTextures;
+		bool _threadsStarted;
 	};
-}
\ No newline at end of file
+}
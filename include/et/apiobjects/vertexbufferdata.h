@@ -32,6 +32,7 @@ namespace et
 			{ return _decl; }
 
 		void setData(const void* data, size_t dataSize);
+		void setDataWithOffset(const void* data, size_t offset, size_t dataSize);
 
 		void serialize(std::ostream& stream);
 		void deserialize(std::istream& stream);
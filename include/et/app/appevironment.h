@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/core/et.h>
+#include <et/threading/criticalsection.h>
 
 namespace et
 {
@@ -30,20 +31,46 @@ namespace et
 		void addSearchPath(const std::string& path);
 		void addRelativeSearchPath(const std::string& path);
 		
+		/*
+		 * Results of lookups are cached, including names which were not found.
+		 * Cache is cleared when search path changes, call invalidateResolvedPaths
+		 * when files are added or removed (or asset pack is mounted) at runtime.
+		 */
 		std::string findFile(const std::string& name) const;
 		std::string findFolder(const std::string& name) const;
 		std::string resolveScalableFileName(const std::string& name, size_t scale) const;
 
+		/*
+		 * Same as findFile, returns false (and name itself) if file was not found
+		 */
+		bool resolveFile(const std::string& name, std::string& result) const;
+
 		bool expandFileName(std::string& name) const;
+
+		void invalidateResolvedPaths();
 		
 		const std::string& applicationDocumentsFolder() const;
 		void updateDocumentsFolder(const ApplicationIdentifier& i);
 
+	private:
+		typedef std::map<std::string, std::string> ResolvedPaths;
+
+		void clearResolvedPaths();
+
 	private:
 		std::string _appPath;
 		std::string _appPackagePath;
 		std::string _dataFolder;
 		std::string _documentsFolder;
 		StringList _searchPath;
+
+		/*
+		 * Guards search path as well as cached lookups
+		 */
+		mutable CriticalSection _resolvedPathsLock;
+		mutable ResolvedPaths _resolvedFiles;
+		mutable ResolvedPaths _resolvedFolders;
+		mutable ResolvedPaths _expandedFiles;
+		mutable ResolvedPaths _scalableFiles;
 	};
 }
\ No newline at end of file
@@ -41,6 +41,9 @@ namespace et
 		RunLoop& backgroundRunLoop()
 			{ return _backgroundThread.runLoop(); }
 		
+		JobSystem& jobSystem()
+			{ return _backgroundThread.jobSystem(); }
+		
 		size_t renderingContextHandle() const
 			{ return _renderingContextHandle; }
 
@@ -152,6 +155,9 @@ namespace et
 	inline RunLoop& backgroundRunLoop()
 		{ return Application::instance().backgroundRunLoop(); }
 	
+	inline JobSystem& jobSystem()
+		{ return Application::instance().jobSystem(); }
+	
 	inline TimerPool::Pointer mainTimerPool()
 		{ return Application::instance().mainRunLoop().mainTimerPool(); }
 }
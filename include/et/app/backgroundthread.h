@@ -8,6 +8,7 @@
 #pragma once
 
 #include <et/threading/thread.h>
+#include <et/tasks/jobsystem.h>
 #include <et/app/runloop.h>
 
 namespace et
@@ -20,13 +21,17 @@ namespace et
 		BackgroundRunLoop();
 		
 		void setOwner(BackgroundThread* owner);
-		void addTask(Task* t, float);
+		TaskHandle addTask(Task* t, float);
 		
 	private:
 		friend class BackgroundThread;
 		BackgroundThread* _owner;
 	};
 	
+	/*
+	 * Background thread only keeps track of delayed tasks,
+	 * actual execution is performed by the workers of the job system.
+	 */
 	class BackgroundThread : public Thread
 	{
 	public:
@@ -35,10 +40,14 @@ namespace et
 		RunLoop& runLoop()
 			{ return _runLoop; }
 		
+		JobSystem& jobSystem()
+			{ return _jobSystem; }
+		
 	private:
 		ThreadResult main();
 		
 	private:
+		JobSystem _jobSystem;
 		BackgroundRunLoop _runLoop;
 	};
-}
\ No newline at end of file
+}
@@ -163,15 +163,15 @@ namespace et
 
 		void invokeInMainRunLoop(ArgType arg, float delay)
 		{
-			Invocation1 i;
-			i.setTarget<ReceiverType, ArgType>(_receiver, _receiverMethod, arg);
+			Invocation i;
+			i.setTarget(_receiver, _receiverMethod, arg);
 			i.invokeInMainRunLoop(delay);
 		}
 		
 		void invokeInBackground(ArgType arg, float delay)
 		{
-			Invocation1 i;
-			i.setTarget<ReceiverType, ArgType>(_receiver, _receiverMethod, arg);
+			Invocation i;
+			i.setTarget(_receiver, _receiverMethod, arg);
 			i.invokeInBackground(delay);
 		}
 
@@ -236,15 +236,15 @@ namespace et
 		
 		void invokeInMainRunLoop(Arg1Type a1, Arg2Type a2, float delay)
 		{
-			Invocation2 i;
-			i.setTarget<ReceiverType, Arg1Type, Arg2Type>(_receiver, _receiverMethod, a1, a2);
+			Invocation i;
+			i.setTarget(_receiver, _receiverMethod, a1, a2);
 			i.invokeInMainRunLoop(delay);
 		}
 		
 		void invokeInBackground(Arg1Type a1, Arg2Type a2, float delay)
 		{
-			Invocation2 i;
-			i.setTarget<ReceiverType, Arg1Type, Arg2Type>(_receiver, _receiverMethod, a1, a2);
+			Invocation i;
+			i.setTarget(_receiver, _receiverMethod, a1, a2);
 			i.invokeInBackground(delay);
 		}
 
@@ -7,7 +7,9 @@
 
 #pragma once
 
-#include <et/core/autoptr.h>
+#include <new>
+#include <tuple>
+#include <type_traits>
 #include <et/app/runloop.h>
 #include <et/tasks/tasks.h>
 
@@ -20,159 +22,315 @@ namespace et
 		virtual ~PureInvocationTarget() { };
 
 		virtual void invoke() = 0;
-		virtual PureInvocationTarget* copy() = 0;
+
+		/*
+		 * Constructs copy of the target in the buffer if it fits there,
+		 * otherwise allocates it on heap.
+		 */
+		virtual PureInvocationTarget* copyTo(void* buffer, size_t capacity, size_t alignment) const = 0;
+		virtual PureInvocationTarget* moveTo(void* buffer, size_t capacity, size_t alignment) = 0;
 	};
 
-	class PureInvocation
+	template <typename Target>
+	class InvocationTargetBase : public PureInvocationTarget
 	{
 	public:
-		PureInvocation() : _target(0) { };
-		virtual ~PureInvocation() { };
+		PureInvocationTarget* copyTo(void* buffer, size_t capacity, size_t alignment) const
+		{
+			const Target& self = static_cast<const Target&>(*this);
+			return fits(capacity, alignment) ? new (buffer) Target(self) : new Target(self);
+		}
 
-		virtual void invoke() = 0;
-		virtual void invokeInMainRunLoop(float delay) = 0;
+		PureInvocationTarget* moveTo(void* buffer, size_t capacity, size_t alignment)
+		{
+			Target& self = static_cast<Target&>(*this);
+			return fits(capacity, alignment) ? new (buffer) Target(std::move(self)) : new Target(std::move(self));
+		}
 
-	protected:
-		AutoPtr<PureInvocationTarget> _target;
+	private:
+		static bool fits(size_t capacity, size_t alignment)
+			{ return (sizeof(Target) <= capacity) && (std::alignment_of<Target>::value <= alignment); }
 	};
-	
-	class InvocationTask : public Task
+
+	/*
+	 * Inline storage for invocation targets: pointer to object, method and
+	 * copies of all arguments are kept inside, no allocations are made
+	 * unless target is larger than InvocationStorage::Capacity bytes.
+	 */
+	class InvocationStorage
 	{
 	public:
-		InvocationTask(PureInvocationTarget* invocation);
-		~InvocationTask();
-		void execute();
+		enum
+		{
+			Capacity = 96
+		};
+
+	public:
+		InvocationStorage() :
+			_target(nullptr) { }
+
+		InvocationStorage(const InvocationStorage& r) : _target(r._target ?
+			r._target->copyTo(_buffer.data, Capacity, alignment()) : nullptr) { }
+
+		/*
+		 * Target allocated on heap changes owner, inline target is moved into the buffer
+		 */
+		InvocationStorage(InvocationStorage&& r) :
+			_target(nullptr)
+		{
+			if (r._target == nullptr) return;
+
+			if (r.storedInline())
+			{
+				_target = r._target->moveTo(_buffer.data, Capacity, alignment());
+				r.reset();
+			}
+			else
+			{
+				_target = r._target;
+				r._target = nullptr;
+			}
+		}
+
+		~InvocationStorage()
+			{ reset(); }
+
+		InvocationStorage& operator = (const InvocationStorage& r)
+		{
+			if (&r != this)
+			{
+				reset();
+				_target = r._target ? r._target->copyTo(_buffer.data, Capacity, alignment()) : nullptr;
+			}
+			return *this;
+		}
+
+		template <typename Target>
+		void set(Target&& t)
+		{
+			reset();
+			_target = t.moveTo(_buffer.data, Capacity, alignment());
+		}
+
+		void reset()
+		{
+			if (_target == nullptr) return;
+
+			if (storedInline())
+				_target->~PureInvocationTarget();
+			else
+				delete _target;
+
+			_target = nullptr;
+		}
+
+		bool valid() const
+			{ return _target != nullptr; }
+
+		bool storedInline() const
+			{ return reinterpret_cast<const void*>(_target) == reinterpret_cast<const void*>(_buffer.data); }
+
+		void invoke()
+			{ assert(_target); _target->invoke(); }
+
+	private:
+		static size_t alignment()
+			{ return std::alignment_of<AlignedBuffer>::value; }
 
 	private:
-		PureInvocationTarget* _invocation;
+		union AlignedBuffer
+		{
+			char data[Capacity];
+			double alignDouble;
+			uint64_t alignInteger;
+			void* alignPointer;
+		};
+
+	private:
+		PureInvocationTarget* _target;
+		AlignedBuffer _buffer;
 	};
 
-	template <typename T>
-	class InvocationTarget : public PureInvocationTarget
+	/*
+	 * Instances are allocated from the pool of fixed-size blocks,
+	 * so posting invocations to run loops does not touch the heap.
+	 */
+	class InvocationTask : public Task
 	{
 	public:
-		InvocationTarget(T* o, void(T::*m)()) : _object(o), _method(m) { }
+		InvocationTask(const InvocationStorage& storage) :
+			_storage(storage) { }
 
-		void invoke()
-			{ (_object->*_method)(); }
+		InvocationTask(InvocationStorage&& storage) :
+			_storage(std::move(storage)) { }
+
+		void execute()
+			{ _storage.invoke(); }
 
-		PureInvocationTarget* copy()
-			{ return new InvocationTarget(_object, _method); }
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
 
 	private:
-		T* _object;
-		void(T::*_method)();
+		InvocationStorage _storage;
 	};
 
-	template <typename T, typename A1>
-	class Invocation1Target : public PureInvocationTarget
+	template <typename F>
+	class FunctionInvocationTarget : public InvocationTargetBase<FunctionInvocationTarget<F>>
 	{
 	public:
-		Invocation1Target(T* o, void(T::*m)(A1), A1 p1) : _object(o), _method(m), _param(p1) { }
+		FunctionInvocationTarget(const F& f) :
+			_function(f) { }
+
+		FunctionInvocationTarget(F&& f) :
+			_function(std::move(f)) { }
 
 		void invoke()
-			{ (_object->*_method)(_param); }
+			{ _function(); }
+
+	private:
+		F _function;
+	};
+
+#if (ET_SUPPORT_VARIADIC_TEMPLATES)
+
+	template <size_t...>
+	struct InvocationIndices { };
 
-		void setParameter(A1 p1)
-			{ _param = p1; }
+	template <size_t N, size_t... I>
+	struct InvocationIndicesBuilder : InvocationIndicesBuilder<N - 1, N - 1, I...> { };
 
-		PureInvocationTarget* copy() 
-			{ return new Invocation1Target(_object, _method, _param); }
+	template <size_t... I>
+	struct InvocationIndicesBuilder<0, I...>
+		{ typedef InvocationIndices<I...> Type; };
+
+	template <typename T, typename... A>
+	class InvocationTarget : public InvocationTargetBase<InvocationTarget<T, A...>>
+	{
+	public:
+		typedef void(T::*Method)(A...);
+
+	public:
+		template <typename... P>
+		InvocationTarget(T* o, Method m, P&&... p) :
+			_object(o), _method(m), _arguments(std::forward<P>(p)...) { }
+
+		void invoke()
+			{ invoke(typename InvocationIndicesBuilder<sizeof...(A)>::Type()); }
 
 	private:
-		Invocation1Target operator = (const Invocation1Target&) 
-			{ return *this; }
+		template <size_t... I>
+		void invoke(InvocationIndices<I...>)
+			{ (_object->*_method)(std::get<I>(_arguments)...); }
 
 	private:
 		T* _object;
-		void(T::*_method)(A1);
-		A1 _param;
+		Method _method;
+		std::tuple<typename std::decay<A>::type...> _arguments;
 	};
 
-	template <typename T, typename A1, typename A2>
-	class Invocation2Target : public PureInvocationTarget
+#else
+
+	template <typename T>
+	class InvocationTarget0 : public InvocationTargetBase<InvocationTarget0<T>>
 	{
 	public:
-		Invocation2Target(T* o, void(T::*m)(A1, A2), A1 p1, A2 p2) : 
-			_object(o), _method(m), _p1(p1), _p2(p2) { }
+		InvocationTarget0(T* o, void(T::*m)()) :
+			_object(o), _method(m) { }
 
 		void invoke()
-			{ (_object->*_method)(_p1, _p2); }
-
-		void setParameters(A1 p1, A2 p2)
-		{ 
-			_p1 = p1; 
-			_p2 = p2;
-		}
-
-		PureInvocationTarget* copy() 
-			{ return new Invocation2Target(_object, _method, _p1, _p2); }
-
-	private:
-		Invocation2Target operator = (const Invocation2Target&) 
-			{ return *this; }
+			{ (_object->*_method)(); }
 
 	private:
 		T* _object;
-		void(T::*_method)(A1, A2);
-		A1 _p1;
-		A2 _p2;
+		void(T::*_method)();
 	};
 
-	class Invocation : public PureInvocation
+	template <typename T, typename A1>
+	class InvocationTarget1 : public InvocationTargetBase<InvocationTarget1<T, A1>>
 	{
 	public:
-		void invoke();
-		void invokeInMainRunLoop(float delay = 0.0f);
-		void invokeInBackground(float delay = 0.0f);
-		void invokeInRunLoop(RunLoop& rl, float delay = 0.0f);
+		template <typename P1>
+		InvocationTarget1(T* o, void(T::*m)(A1), P1&& p1) :
+			_object(o), _method(m), _p1(std::forward<P1>(p1)) { }
 
-		template <typename T>
-		void setTarget(T* o, void(T::*m)())
-			{ assert(o); _target = new InvocationTarget<T>(o, m); }
+		void invoke()
+			{ (_object->*_method)(_p1); }
 
 	private:
-		AutoPtr<PureInvocationTarget> _target;
+		T* _object;
+		void(T::*_method)(A1);
+		typename std::decay<A1>::type _p1;
 	};
 
-	class Invocation1 : public PureInvocation
+	template <typename T, typename A1, typename A2>
+	class InvocationTarget2 : public InvocationTargetBase<InvocationTarget2<T, A1, A2>>
 	{
 	public:
-		void invoke();
-		void invokeInMainRunLoop(float delay = 0.0f);
-		void invokeInBackground(float delay = 0.0f);
-		void invokeInRunLoop(RunLoop& rl, float delay = 0.0f);
+		template <typename P1, typename P2>
+		InvocationTarget2(T* o, void(T::*m)(A1, A2), P1&& p1, P2&& p2) :
+			_object(o), _method(m), _p1(std::forward<P1>(p1)), _p2(std::forward<P2>(p2)) { }
 
-		template <typename T, typename A1>
-		void setTarget(T* o, void(T::*m)(A1), A1 param)
-			{ assert(o); _target = new Invocation1Target<T, A1>(o, m, param); }
+		void invoke()
+			{ (_object->*_method)(_p1, _p2); }
 
-		template <typename T, typename A1>
-		void setParameter(A1 p)
-			{ (static_cast<Invocation1Target<T, A1>*>(_target.ptr()))->setParameter(p); }
+	private:
+		T* _object;
+		void(T::*_method)(A1, A2);
+		typename std::decay<A1>::type _p1;
+		typename std::decay<A2>::type _p2;
 	};
 
-	class Invocation2 : public PureInvocation
+#endif
+
+	class Invocation
 	{
 	public:
 		void invoke();
+
+		/*
+		 * Target is moved into the posted task, so invocation becomes invalid
+		 * and should be set again before the next use
+		 */
 		void invokeInMainRunLoop(float delay = 0.0f);
 		void invokeInBackground(float delay = 0.0f);
 		void invokeInRunLoop(RunLoop& rl, float delay = 0.0f);
+		
+		bool valid() const
+			{ return _storage.valid(); }
+
+#if (ET_SUPPORT_VARIADIC_TEMPLATES)
+
+		template <typename T, typename... A, typename... P>
+		void setTarget(T* o, void(T::*m)(A...), P&&... p)
+			{ assert(o); _storage.set(InvocationTarget<T, A...>(o, m, std::forward<P>(p)...)); }
 
-		template <typename T, typename A1, typename A2>
-		void setTarget(T* o, void(T::*m)(A1, A2), A1 p1, A2 p2)
-			{ assert(o); _target = new Invocation2Target<T, A1, A2>(o, m, p1, p2); }
+#else
+
+		template <typename T>
+		void setTarget(T* o, void(T::*m)())
+			{ assert(o); _storage.set(InvocationTarget0<T>(o, m)); }
 
-		template <typename T, typename A1, typename A2>
-		void setParameters(A1 p1, A2 p2)
-			{ (static_cast<Invocation2Target<T, A1, A2>*>(_target.ptr()))->setParameters(p1, p2); }
+		template <typename T, typename A1, typename P1>
+		void setTarget(T* o, void(T::*m)(A1), P1&& p1)
+			{ assert(o); _storage.set(InvocationTarget1<T, A1>(o, m, std::forward<P1>(p1))); }
+
+		template <typename T, typename A1, typename A2, typename P1, typename P2>
+		void setTarget(T* o, void(T::*m)(A1, A2), P1&& p1, P2&& p2)
+			{ assert(o); _storage.set(InvocationTarget2<T, A1, A2>(o, m, std::forward<P1>(p1), std::forward<P2>(p2))); }
+
+#endif
+
+		/*
+		 * Any callable object without arguments, e.g. lambda
+		 */
+		template <typename F>
+		void setFunction(F&& f)
+			{ _storage.set(FunctionInvocationTarget<typename std::decay<F>::type>(std::forward<F>(f))); }
+
+	private:
+		InvocationStorage _storage;
 	};
 
-/*
- * 0
- */
-	
 #define ET_INVOKE_THIS_CLASS_METHOD(CLASS, METHOD)	\
 		{ Invocation _aInvocation;\
 		_aInvocation.setTarget(this, &CLASS::METHOD);\
@@ -187,37 +345,29 @@ namespace et
 		{ Invocation _aInvocation;\
 		_aInvocation.setTarget(this, &CLASS::METHOD);\
 		_aInvocation.invokeInBackground(); }
-	
+
 #define ET_INVOKE_THIS_CLASS_METHOD_IN_BACKGROUND_DELAYED(CLASS, METHOD, DELAY)	\
 		{ Invocation _aInvocation;\
 		_aInvocation.setTarget(this, &CLASS::METHOD);\
 		_aInvocation.invokeInBackground(DELAY); }
-	
-/*
- * 1
- */
-	
+
 #define ET_INVOKE_THIS_CLASS_METHOD1(CLASS, METHOD, P1)	\
-		{ Invocation1 _aInvocation1;\
-		_aInvocation1.setTarget(this, &CLASS::METHOD, P1);\
-		_aInvocation1.invokeInMainRunLoop(); }
+		{ Invocation _aInvocation;\
+		_aInvocation.setTarget(this, &CLASS::METHOD, P1);\
+		_aInvocation.invokeInMainRunLoop(); }
 
 #define ET_INVOKE_THIS_CLASS_METHOD1_DELAYED(CLASS, METHOD, P1, DELAY) \
-		{ Invocation1 _aInvocation1; \
-		_aInvocation1.setTarget(this, &CLASS::METHOD, P1); \
-		_aInvocation1.invokeInMainRunLoop(DELAY); }
-
-/*
- * 2
- */
+		{ Invocation _aInvocation; \
+		_aInvocation.setTarget(this, &CLASS::METHOD, P1); \
+		_aInvocation.invokeInMainRunLoop(DELAY); }
 
 #define ET_INVOKE_THIS_CLASS_METHOD2(CLASS, METHOD, P1, P2)	\
-		{ Invocation2 _aInvocation2; \
-		_aInvocation2.setTarget(this, &CLASS::METHOD, P1, P2); \
-		_aInvocation2.invokeInMainRunLoop(); }
+		{ Invocation _aInvocation; \
+		_aInvocation.setTarget(this, &CLASS::METHOD, P1, P2); \
+		_aInvocation.invokeInMainRunLoop(); }
 
 #define ET_INVOKE_THIS_CLASS_METHOD2_DELAYED(CLASS, METHOD, P1, P2, DELAY) \
-		{ Invocation2 _aInvocation2; \
-		_aInvocation2.setTarget(this, &CLASS::METHOD, P1, P2); \
-		_aInvocation2.invokeInMainRunLoop(DELAY); }
+		{ Invocation _aInvocation; \
+		_aInvocation.setTarget(this, &CLASS::METHOD, P1, P2); \
+		_aInvocation.invokeInMainRunLoop(DELAY); }
 }
@@ -38,10 +38,20 @@ namespace et
 		void detachTimerPool(TimerPool::Pointer pool);
 		void detachAllTimerPools();
 
-		virtual void addTask(Task*, float);
+		virtual TaskHandle addTask(Task*, float);
+		
+		bool cancelTask(TaskHandle handle)
+			{ return _taskPool.cancelTask(handle); }
 		
 		bool hasTasks()
 			{ return _taskPool.hasTasks(); }
+		
+		bool nextTaskTime(float& t)
+			{ return _taskPool.nextTaskTime(t); }
+
+	protected:
+		TaskPool& taskPool()
+			{ return _taskPool; }
 
 	private:
 		void updateTime(uint64_t t);
@@ -25,16 +25,92 @@ namespace et
 
 	typedef StaticDataStorage<vec4, FrustumPlane_max> FrustumData;
 
+	/*
+	 * Bit i of word (i / 32) is set if object i is visible
+	 */
+	typedef std::vector<uint32_t> VisibilityMask;
+
+	inline bool isVisible(const VisibilityMask& mask, size_t index)
+		{ return (mask[index / 32] & (1u << (index % 32))) != 0; }
+
+	/*
+	 * Boxes in structure-of-arrays form for the batch culling.
+	 * Arrays are padded with empty boxes to the multiple of four elements.
+	 */
+	struct AABBArray
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> dimensionX;
+		std::vector<float> dimensionY;
+		std::vector<float> dimensionZ;
+
+		AABBArray() :
+			_size(0) { }
+
+		size_t size() const
+			{ return _size; }
+
+		void reserve(size_t count);
+		void push_back(const AABB& aabb);
+		void clear();
+
+	private:
+		size_t _size;
+	};
+
+	/*
+	 * Spheres in structure-of-arrays form, padded the same way as AABBArray
+	 */
+	struct SphereArray
+	{
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> radius;
+
+		SphereArray() :
+			_size(0) { }
+
+		size_t size() const
+			{ return _size; }
+
+		void reserve(size_t count);
+		void push_back(const Sphere& sphere);
+		void clear();
+
+	private:
+		size_t _size;
+	};
+
 	class Frustum
 	{
 	public:
 		Frustum();
 		Frustum(const mat4& mvpMatrix);
 
+		const vec4& plane(FrustumPlane p) const
+			{ return _data[p]; }
+
 		bool containSphere(const Sphere& sphere) const;
 		bool containAABB(const AABB& aabb) const;
 		bool containOBB(const OBB& obb) const;
 
+		/*
+		 * Batch culling. Mask is resized to fit all objects, returns amount of visible objects.
+		 */
+		size_t cullAABBs(const AABBArray& boxes, VisibilityMask& mask) const;
+		size_t cullSpheres(const SphereArray& spheres, VisibilityMask& mask) const;
+
+		/*
+		 * Culls objects in range [begin, end) and writes only words of the mask covering this range,
+		 * so different ranges could be culled in parallel. Begin should be a multiple of 32
+		 * and mask should be already resized to fit all objects.
+		 */
+		size_t cullAABBs(const AABBArray& boxes, VisibilityMask& mask, size_t begin, size_t end) const;
+		size_t cullSpheres(const SphereArray& spheres, VisibilityMask& mask, size_t begin, size_t end) const;
+
 	private:
 		FrustumData _data;
 	};
@@ -0,0 +1,173 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/collision/collision.h>
+
+namespace et
+{
+	typedef uint32_t BroadphaseProxy;
+	static const BroadphaseProxy InvalidBroadphaseProxy = static_cast<BroadphaseProxy>(-1);
+
+	struct BroadphasePair
+	{
+		BroadphaseProxy first;
+		BroadphaseProxy second;
+
+		BroadphasePair() :
+			first(InvalidBroadphaseProxy), second(InvalidBroadphaseProxy) { }
+
+		BroadphasePair(BroadphaseProxy a, BroadphaseProxy b) :
+			first(etMin(a, b)), second(etMax(a, b)) { }
+
+		bool operator == (const BroadphasePair& p) const
+			{ return (first == p.first) && (second == p.second); }
+
+		bool operator < (const BroadphasePair& p) const
+			{ return (first < p.first) || ((first == p.first) && (second < p.second)); }
+	};
+	typedef std::vector<BroadphasePair> BroadphasePairList;
+
+	/*
+	 * Finds pairs of proxies with overlapping bounds, which should be passed to the narrowphase.
+	 * Spheres and oriented boxes are represented by their axis aligned bounds.
+	 * Proxy handles stay valid until removed and could be reused afterwards.
+	 */
+	class Broadphase
+	{
+	public:
+		Broadphase();
+		virtual ~Broadphase() { }
+
+		BroadphaseProxy addProxy(const AABB& aabb, void* userData = nullptr);
+		BroadphaseProxy addProxy(const Sphere& sphere, void* userData = nullptr);
+		BroadphaseProxy addProxy(const OBB& obb, void* userData = nullptr);
+
+		void moveProxy(BroadphaseProxy proxy, const AABB& aabb);
+		void moveProxy(BroadphaseProxy proxy, const Sphere& sphere);
+		void moveProxy(BroadphaseProxy proxy, const OBB& obb);
+
+		void removeProxy(BroadphaseProxy proxy);
+		void clear();
+
+		void* userData(BroadphaseProxy proxy) const
+			{ return _proxies.at(proxy).userData; }
+
+		size_t proxiesCount() const
+			{ return _proxiesCount; }
+
+		/*
+		 * Pairs are appended to the list, each pair is reported once
+		 */
+		virtual void findOverlappingPairs(BroadphasePairList& pairs) = 0;
+
+	protected:
+		struct Proxy
+		{
+			vec3 minVertex;
+			vec3 maxVertex;
+			void* userData;
+			bool active;
+
+			Proxy() :
+				userData(nullptr), active(false) { }
+		};
+		typedef std::vector<Proxy> ProxyList;
+
+		const ProxyList& proxies() const
+			{ return _proxies; }
+
+		static bool overlaps(const Proxy& a, const Proxy& b)
+		{
+			return (a.minVertex.x <= b.maxVertex.x) && (a.maxVertex.x >= b.minVertex.x) &&
+				(a.minVertex.y <= b.maxVertex.y) && (a.maxVertex.y >= b.minVertex.y) &&
+				(a.minVertex.z <= b.maxVertex.z) && (a.maxVertex.z >= b.minVertex.z);
+		}
+
+		virtual void proxyAdded(BroadphaseProxy) { }
+		virtual void proxyRemoved(BroadphaseProxy) { }
+
+	private:
+		ET_DENY_COPY(Broadphase)
+
+		BroadphaseProxy addProxy(const vec3& center, const vec3& extent, void* userData);
+		void moveProxy(BroadphaseProxy proxy, const vec3& center, const vec3& extent);
+
+	private:
+		ProxyList _proxies;
+		std::vector<BroadphaseProxy> _freeProxies;
+		size_t _proxiesCount;
+	};
+
+	/*
+	 * Proxies are kept sorted by lower bound along one axis. Sorting is incremental (insertion sort),
+	 * so it is close to linear when proxies move coherently. Axis with the largest spread of centers
+	 * is selected on each update, all proxies are resorted when it changes.
+	 */
+	class SweepAndPrune : public Broadphase
+	{
+	public:
+		SweepAndPrune();
+
+		void findOverlappingPairs(BroadphasePairList& pairs);
+
+	private:
+		struct Entry
+		{
+			vec3 minVertex;
+			vec3 maxVertex;
+			BroadphaseProxy proxy;
+		};
+
+		void proxyAdded(BroadphaseProxy proxy);
+		void proxyRemoved(BroadphaseProxy proxy);
+
+		void updateEntries();
+		int selectAxis() const;
+
+	private:
+		std::vector<Entry> _entries;
+		std::vector<uint32_t> _entryOfProxy;
+		int _axis;
+	};
+
+	/*
+	 * Proxies are inserted into cells of the infinite grid, cells are hashed into table,
+	 * which is rebuilt on each update. Pair is reported only from the first cell shared by both proxies.
+	 * Proxies, which cover too many cells, are tested against all others.
+	 */
+	class UniformGrid : public Broadphase
+	{
+	public:
+		UniformGrid(float cellSize);
+
+		float cellSize() const
+			{ return _cellSize; }
+
+		void setCellSize(float value)
+			{ _cellSize = value; }
+
+		void findOverlappingPairs(BroadphasePairList& pairs);
+
+	private:
+		struct CellEntry
+		{
+			vec3i cell;
+			BroadphaseProxy proxy;
+		};
+
+		vec3i cellForPoint(const vec3& p) const;
+
+	private:
+		std::vector<CellEntry> _entries;
+		std::vector<CellEntry> _sortedEntries;
+		std::vector<uint32_t> _buckets;
+		std::vector<BroadphaseProxy> _largeProxies;
+		float _cellSize;
+	};
+}
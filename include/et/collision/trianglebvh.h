@@ -0,0 +1,121 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/collision/collision.h>
+
+namespace et
+{
+	/*
+	 * Bounding volume hierarchy over triangles, built with surface area heuristic.
+	 * Nodes are stored in depth-first order: the first child of the interior node
+	 * immediately follows it, index of the second child is stored in the node.
+	 * Hierarchy does not own triangles, the same array should be provided to queries.
+	 */
+	class TriangleBVH
+	{
+	public:
+		enum
+		{
+			MaxTrianglesInLeaf = 4,
+			MaxDepth = 64
+		};
+
+		struct Node
+		{
+			vec3 minVertex;
+			uint32_t offset;
+			vec3 maxVertex;
+			uint32_t count;
+
+			bool isLeaf() const
+				{ return count > 0; }
+
+			/*
+			 * Slab test, distance to the entry point is measured in lengths of direction
+			 */
+			bool intersectsRay(const vec3& origin, const vec3& invDirection, float maxDistance, float& distance) const
+			{
+				vec3 t0 = (minVertex - origin) * invDirection;
+				vec3 t1 = (maxVertex - origin) * invDirection;
+				vec3 tNear = minv(t0, t1);
+				vec3 tFar = maxv(t0, t1);
+
+				distance = etMax(0.0f, etMax(tNear.x, etMax(tNear.y, tNear.z)));
+				return distance <= etMin(maxDistance, etMin(tFar.x, etMin(tFar.y, tFar.z)));
+			}
+		};
+
+		typedef std::vector<Node> NodeList;
+		typedef std::vector<uint32_t> IndexList;
+
+		struct RayHit
+		{
+			vec3 point;
+			float distance;
+			uint32_t triangle;
+
+			RayHit() :
+				distance(0.0f), triangle(0) { }
+		};
+
+		/*
+		 * Inverse of direction for slab tests, zero components are replaced with large values
+		 */
+		static vec3 inverseDirection(const vec3& direction);
+
+	public:
+		void build(const triangle* triangles, size_t triangleCount);
+		void clear();
+
+		bool empty() const
+			{ return _nodes.empty(); }
+
+		const NodeList& nodes() const
+			{ return _nodes; }
+
+		const IndexList& indices() const
+			{ return _indices; }
+
+		/*
+		 * Returns contact with the deepest penetration
+		 */
+		bool sphereTriangles(const triangle* triangles, const Sphere& s,
+			vec3& point, vec3& normal, float& penetration) const;
+
+		/*
+		 * Sphere moves by velocity during unit of time, returns the earliest contact
+		 */
+		bool sphereTriangles(const triangle* triangles, const Sphere& s, const vec3& velocity,
+			vec3& point, vec3& normal, float& penetration, float& intersectionTime) const;
+
+		/*
+		 * Returns the closest intersection
+		 */
+		bool rayTriangles(const triangle* triangles, const ray3d& r, vec3* intersection_pt) const;
+		bool segmentTriangles(const triangle* triangles, const segment3d& s, vec3* intersection_pt) const;
+
+		/*
+		 * Distance of the hit is measured in lengths of direction and should not exceed maxDistance
+		 */
+		bool closestHit(const triangle* triangles, const vec3& origin, const vec3& direction,
+			float maxDistance, RayHit& hit) const;
+
+		void serialize(std::ostream& stream) const;
+		void deserialize(std::istream& stream);
+
+	private:
+		struct BuildItem;
+
+		uint32_t buildNode(std::vector<BuildItem>& items, size_t begin, size_t end, size_t depth);
+
+	private:
+		NodeList _nodes;
+		IndexList _indices;
+	};
+}
@@ -0,0 +1,131 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/core/containers.h>
+#include <et/core/mappedfile.h>
+#include <et/core/stream.h>
+
+namespace et
+{
+	/*
+	 * Read-only archive of files, accessed through the memory mapping.
+	 * Table of contents is sorted by hashes of names, data of each entry starts
+	 * at the alignment boundary, so entries are used in place without copying.
+	 */
+	class AssetPack : public Shared
+	{
+	public:
+		ET_DECLARE_POINTER(AssetPack)
+
+		enum
+		{
+			DefaultAlignment = 16
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entriesCount;
+			uint32_t alignment;
+			uint64_t namesOffset;
+			uint64_t namesSize;
+		};
+
+		/*
+		 * Entries follow the header, names are stored without terminating zeros
+		 */
+		struct Entry
+		{
+			uint64_t nameHash;
+			uint64_t offset;
+			uint64_t size;
+			uint32_t nameOffset;
+			uint32_t nameLength;
+		};
+
+		/*
+		 * Writes files into the pack, names are stored relative to the root folder.
+		 * Alignment should be power of two, page size allows to map entries independently.
+		 */
+		static bool build(const std::string& outputFile, const std::string& rootFolder,
+			const StringList& files, size_t alignment = DefaultAlignment);
+
+		/*
+		 * Mounted packs are searched by InputStream and fileExists before the file system,
+		 * most recently mounted first. File names starting with the root folder
+		 * are looked up by the remaining part.
+		 */
+		static void mount(AssetPack::Pointer pack, const std::string& rootFolder = std::string());
+		static void unmount(AssetPack::Pointer pack);
+
+		static bool mountedFileExists(const std::string& fileName);
+
+		/*
+		 * Returns stream over the mapped entry or nullptr, caller takes ownership
+		 */
+		static std::istream* openMountedFile(const std::string& fileName);
+
+	public:
+		AssetPack();
+		AssetPack(const std::string& fileName);
+
+		bool open(const std::string& fileName);
+		void close();
+
+		bool valid() const
+			{ return _header != nullptr; }
+
+		size_t entriesCount() const
+			{ return valid() ? _header->entriesCount : 0; }
+
+		const Entry& entry(size_t index) const
+			{ assert(index < entriesCount()); return _entries[index]; }
+
+		std::string entryName(size_t index) const;
+
+		const char* entryData(const Entry& e) const
+			{ return _file.data() + e.offset; }
+
+		/*
+		 * Returns nullptr if pack does not contain the file
+		 */
+		const Entry* find(const std::string& name) const;
+
+		bool contains(const std::string& name) const
+			{ return find(name) != nullptr; }
+
+		/*
+		 * Result points into the mapping and stays valid while the pack is open
+		 */
+		bool data(const std::string& name, BinaryDataStorage& result) const;
+
+		/*
+		 * Stream reads directly from the mapping and keeps the pack alive
+		 */
+		InputStream::Pointer stream(const std::string& name);
+
+		void prefetch(const Entry& e)
+			{ _file.prefetch(static_cast<size_t>(e.offset), static_cast<size_t>(e.size)); }
+
+		void discard(const Entry& e)
+			{ _file.discard(static_cast<size_t>(e.offset), static_cast<size_t>(e.size)); }
+
+	private:
+		ET_DENY_COPY(AssetPack)
+
+		std::istream* createStream(const Entry& e);
+
+	private:
+		MappedFile _file;
+		const Header* _header;
+		const Entry* _entries;
+		const char* _names;
+	};
+}
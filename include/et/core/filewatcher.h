@@ -0,0 +1,42 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+namespace et
+{
+	/*
+	 * Reports changes of the watched files without polling the file system.
+	 * Folders of the files are watched, so files replaced by editors (saved
+	 * into temporary file and renamed) are reported as well.
+	 * Uses inotify where it is available, on other platforms available() returns false
+	 * and files should be checked by modification date instead.
+	 */
+	class FileWatcherPrivate;
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		bool available() const;
+
+		void watch(const std::string& fileName);
+		void unwatch(const std::string& fileName);
+
+		/*
+		 * Does not block, appends files changed since the previous call
+		 */
+		void poll(StringList& changedFiles);
+
+	private:
+		ET_DENY_COPY(FileWatcher)
+
+	private:
+		FileWatcherPrivate* _private;
+	};
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+namespace et
+{
+	/*
+	 * Read-only file mapped into the address space.
+	 * Pages are loaded by the system on access and could be released with discard.
+	 */
+	class MappedFilePrivate;
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		MappedFile(const std::string& fileName);
+		~MappedFile();
+
+		bool open(const std::string& fileName);
+		void close();
+
+		bool valid() const
+			{ return _data != nullptr; }
+
+		const char* data() const
+			{ return _data; }
+
+		size_t size() const
+			{ return _size; }
+
+		/*
+		 * Hints the system to load pages of the range in advance
+		 */
+		void prefetch(size_t offset, size_t length);
+
+		/*
+		 * Releases physical memory of the pages, which are completely inside the range.
+		 * Data remains accessible and will be loaded again on access.
+		 */
+		void discard(size_t offset, size_t length);
+
+	private:
+		ET_DENY_COPY(MappedFile)
+
+	private:
+		MappedFilePrivate* _private;
+		const char* _data;
+		size_t _size;
+	};
+}
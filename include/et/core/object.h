@@ -62,6 +62,13 @@ namespace et
 
 		bool canBeReloaded() const
 			{ return !(_origin.empty() && _distributedOrigins.empty()); }
+
+		/*
+		 * Approximate amount of memory (including video memory) held by the object,
+		 * used for the memory budget of ObjectsCache
+		 */
+		virtual uint64_t memoryUsage() const
+			{ return 0; }
 	
 	private:
 		std::string _origin;
@@ -7,14 +7,47 @@
 
 #pragma once
 
+#include <list>
+#include <unordered_map>
 #include <et/core/object.h>
+#include <et/core/filewatcher.h>
 #include <et/threading/criticalsection.h>
 #include <et/timers/timedobject.h>
 
 namespace et
 {
+	struct ObjectsCacheStatistics
+	{
+		size_t objects;
+		uint64_t memoryUsage;
+		uint64_t memoryBudget;
+
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t evictions;
+
+		ObjectsCacheStatistics() : objects(0), memoryUsage(0), memoryBudget(0),
+			hits(0), misses(0), evictions(0) { }
+	};
+
+	/*
+	 * While monitoring, objects are reloaded when their files change. Changes are reported by
+	 * FileWatcher where it is available and reloaded once files are not modified for a short
+	 * interval, otherwise modification dates are checked periodically.
+	 * Loaders are called from the thread which updates the cache, without the lock taken.
+	 *
+	 * With the memory budget set, least recently used objects, which are referenced
+	 * only by the cache, are evicted when memory usage of managed objects exceeds the budget.
+	 * Evicted objects are destroyed on the main thread, from update, flush or setMemoryBudget.
+	 */
 	class ObjectsCache : public TimedObject
 	{
+	public:
+		enum
+		{
+			UnlimitedMemory = 0
+		};
+
 	public:
 		ObjectsCache();
 		~ObjectsCache();
@@ -35,10 +68,18 @@ namespace et
 		int64_t getFileProperty(const std::string& p);
 		uint64_t getObjectProperty(LoadableObject::Pointer);
 
+		/*
+		 * Budget is compared with the sum of LoadableObject::memoryUsage of managed objects
+		 */
+		void setMemoryBudget(uint64_t bytes);
+
+		ObjectsCacheStatistics statistics();
+
 	private:
 		ET_DENY_COPY(ObjectsCache)
 
 		void performUpdate();
+		void processFileChanges(float t);
 		void update(float t);
 
 	private:
@@ -54,10 +95,44 @@ namespace et
 				object(o), loader(l) { }
 		};
 		typedef std::vector<ObjectProperty> ObjectPropertyList;
-		typedef std::map<const std::string, ObjectPropertyList> ObjectMap;
+		typedef std::unordered_map<std::string, ObjectPropertyList> ObjectMap;
+		typedef std::list<const LoadableObject*> UsageList;
+
+		/*
+		 * Origin points to the key of the objects map, so object is found
+		 * even if its origin was changed after it was added to the cache
+		 */
+		struct ObjectEntry
+		{
+			const std::string* origin;
+			UsageList::iterator usage;
+			uint64_t memoryUsage;
+		};
+		typedef std::unordered_map<const LoadableObject*, ObjectEntry> ObjectEntryMap;
 
+		void reloadObjects(ObjectPropertyList& objects);
+
+		void touch(const ObjectPropertyList& objects);
+		void remove(const LoadableObject* object);
+		void evictUnusedObjects();
+		void releaseEvictedObjects();
+
+		/*
+		 * File is watched while there are objects loaded from it
+		 */
+		void retainFile(const std::string& fileName);
+		void releaseFile(const std::string& fileName);
+
+	private:
 		CriticalSection _lock;
 		ObjectMap _objects;
+		ObjectEntryMap _entries;
+		UsageList _usage;
+		FileWatcher _watcher;
+		std::map<std::string, size_t> _watchedFiles;
+		std::map<std::string, float> _pendingChanges;
+		std::vector<LoadableObject::Pointer> _evictedObjects;
+		ObjectsCacheStatistics _statistics;
 		float _updateTime;
 	};
 }
@@ -25,6 +25,11 @@ namespace et
 		InputStream();
 		InputStream(const std::string& file, StreamMode mode);
 
+		/*
+		 * Takes ownership of the stream
+		 */
+		InputStream(std::istream* stream);
+
 		~InputStream();
 
 		bool valid();
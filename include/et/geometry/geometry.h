@@ -239,6 +239,16 @@ namespace et
 		return (l > 0) ? v / std::sqrt(l) : vector4<T>(0);
 	}
 
+#if (ET_SIMD)
+	template <>
+	inline vector4<float> normalize(const vector4<float>& v)
+	{
+		vector4<float> result;
+		simd::normalize(v.data(), result.data());
+		return result;
+	}
+#endif
+
 	template <typename T>
 	inline Quaternion<T> normalize(const Quaternion<T>& q) 
 	{ 
@@ -269,6 +279,12 @@ namespace et
 	inline T dot(const vector4<T>& v1, const vector4<T>& v2)
 		{ return v1.x*v2.x + v1.y*v2.y + v1.z*v2.z + v1.w*v2.w; }
 
+#if (ET_SIMD)
+	template <>
+	inline float dot(const vector4<float>& v1, const vector4<float>& v2)
+		{ return simd::dot(v1.data(), v2.data()); }
+#endif
+
 	template <typename T>
 	inline T outerProduct(const vector2<T>& v1, const vector2<T>& v2)
 		{ return v1.x * v2.y - v1.y * v2.x; }
@@ -353,5 +353,38 @@ namespace et
 			return matrix4(r1, r2, r3, mat[3]);
 		}
 	};
+
+#if (ET_SIMD)
+	template <>
+	inline matrix4<float> matrix4<float>::operator * (const matrix4<float>& m) const
+	{
+		matrix4<float> result;
+		simd::multiplyMatrix(data(), m.data(), result.data());
+		return result;
+	}
+
+	template <>
+	inline matrix4<float>& matrix4<float>::operator *= (const matrix4<float>& m)
+	{
+		simd::multiplyMatrix(data(), m.data(), data());
+		return *this;
+	}
+
+	template <>
+	inline vector4<float> matrix4<float>::operator * (const vector4<float>& v) const
+	{
+		vector4<float> result;
+		simd::transformVector(data(), v.data(), result.data());
+		return result;
+	}
+
+	template <>
+	inline matrix4<float> matrix4<float>::inverse() const
+	{
+		matrix4<float> result(0.0f);
+		simd::inverseMatrix(data(), result.data());
+		return result;
+	}
+#endif
 }
 
@@ -141,4 +141,21 @@ namespace et
 	template <typename T>
 	inline Quaternion<T> operator * (T value, const Quaternion<T>& q)
 		{ return q * value; }
+
+#if (ET_SIMD)
+	template <>
+	inline Quaternion<float> Quaternion<float>::operator * (const Quaternion<float>& q) const
+	{
+		Quaternion<float> result;
+		simd::multiplyQuaternion(&scalar, &q.scalar, &result.scalar);
+		return result;
+	}
+
+	template <>
+	inline Quaternion<float>& Quaternion<float>::operator *= (const Quaternion<float>& q)
+	{
+		simd::multiplyQuaternion(&scalar, &q.scalar, &scalar);
+		return *this;
+	}
+#endif
 }
\ No newline at end of file
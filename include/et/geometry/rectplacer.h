@@ -12,21 +12,87 @@
 
 namespace et
 {
+	/*
+	 * Skyline bottom-left packer. Space wasted below the skyline and space
+	 * released by removed rects is kept in the list of free rects and reused first.
+	 * Free rects smaller than any rect placed so far are dropped.
+	 */
 	class RectPlacer
 	{
 	public:
 		typedef std::vector<rect> RectList;
+		typedef std::vector<vec2i> SizeList;
+
+		enum SortMode
+		{
+			SortMode_None,
+			SortMode_Height,
+			SortMode_Area,
+			SortMode_LongestSide,
+			SortMode_max
+		};
 
 	public:
 		RectPlacer(const vec2i& contextSize, bool addSpace);
+
 		bool place(const vec2i& size, rect& placedPosition);
 
-		const RectList& placedItems() const 
+		/*
+		 * Places rects in order defined by sort mode, positions are returned in the original order.
+		 * Positions of rects which does not fit are empty. Returns number of placed rects.
+		 */
+		size_t place(const SizeList& sizes, RectList& placedPositions, SortMode sortMode = SortMode_Height);
+
+		/*
+		 * Position should be the one returned by place()
+		 */
+		bool remove(const rect& placedPosition);
+
+		void clear();
+
+		const vec2i& contextSize() const
+			{ return _contextSize; }
+
+		/*
+		 * Order of placed items is not preserved on removal
+		 */
+		const RectList& placedItems() const
 			{ return _placedItems; }
 
+		/*
+		 * Ratio of area covered by placed rects to the area of context
+		 */
+		float occupancy() const;
+
+	private:
+		struct SkylineNode
+		{
+			int x;
+			int y;
+			int width;
+
+			SkylineNode(int ax, int ay, int w) :
+				x(ax), y(ay), width(w) { }
+		};
+
+		typedef std::vector<SkylineNode> SkylineNodeList;
+
+	private:
+		bool placeToFreeRect(const vec2i& size, recti& result);
+		bool placeToSkyline(const vec2i& size, recti& result);
+
+		int skylineFit(size_t index, const vec2i& size, int maxBottom);
+		void addSkylineLevel(size_t index, const recti& r);
+
+		void addFreeRect(const recti& r);
+
 	private:
 		vec2i _contextSize;
 		RectList _placedItems;
+		SkylineNodeList _skyline;
+		std::vector<recti> _freeRects;
+		vec2i _minSize;
+		int64_t _usedArea;
 		bool _addSpace;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,354 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/core/et.h>
+
+#if (ET_SIMD_SSE2)
+#	include <emmintrin.h>
+#elif (ET_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
+#if (ET_SIMD)
+
+namespace et
+{
+	/*
+	 * Operations on four floats, used by specializations of vector4, matrix4 and quaternion.
+	 * Data is loaded and stored unaligned, since vectors are packed into vertices and other structures.
+	 */
+	namespace simd
+	{
+#	if (ET_SIMD_SSE2)
+
+		typedef __m128 float4;
+
+		inline float4 load(const float* p)
+			{ return _mm_loadu_ps(p); }
+
+		inline void store(float* p, float4 v)
+			{ _mm_storeu_ps(p, v); }
+
+		inline float4 splat(float v)
+			{ return _mm_set1_ps(v); }
+
+		inline float4 set(float x, float y, float z, float w)
+			{ return _mm_setr_ps(x, y, z, w); }
+
+		inline float first(float4 v)
+			{ return _mm_cvtss_f32(v); }
+
+		inline float4 add(float4 a, float4 b)
+			{ return _mm_add_ps(a, b); }
+
+		inline float4 sub(float4 a, float4 b)
+			{ return _mm_sub_ps(a, b); }
+
+		inline float4 mul(float4 a, float4 b)
+			{ return _mm_mul_ps(a, b); }
+
+		inline float4 div(float4 a, float4 b)
+			{ return _mm_div_ps(a, b); }
+
+		inline float4 abs(float4 v)
+			{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+		/*
+		 * Bit i of the result is set if component i is greater than zero
+		 */
+		inline int positiveMask(float4 v)
+			{ return _mm_movemask_ps(_mm_cmpgt_ps(v, _mm_setzero_ps())); }
+
+		inline float4 min(float4 a, float4 b)
+			{ return _mm_min_ps(a, b); }
+
+		inline float4 max(float4 a, float4 b)
+			{ return _mm_max_ps(a, b); }
+
+		inline float4 inverseSqrt(float4 v)
+			{ return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(v)); }
+
+		/*
+		 * Components are truncated towards zero
+		 */
+		inline float4 truncate(float4 v)
+			{ return _mm_cvtepi32_ps(_mm_cvttps_epi32(v)); }
+
+		inline void truncate(float4 v, int* result)
+			{ _mm_storeu_si128(reinterpret_cast<__m128i*>(result), _mm_cvttps_epi32(v)); }
+
+		/*
+		 * Returns components of x, where a is greater than b, and components of y otherwise
+		 */
+		inline float4 selectGreater(float4 a, float4 b, float4 x, float4 y)
+		{
+			float4 mask = _mm_cmpgt_ps(a, b);
+			return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+		}
+
+		/*
+		 * Returns (a[x], a[y], b[z], b[w])
+		 */
+		template <int x, int y, int z, int w>
+		inline float4 shuffle(float4 a, float4 b)
+			{ return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+
+#	elif (ET_SIMD_NEON)
+
+		typedef float32x4_t float4;
+
+		inline float4 load(const float* p)
+			{ return vld1q_f32(p); }
+
+		inline void store(float* p, float4 v)
+			{ vst1q_f32(p, v); }
+
+		inline float4 splat(float v)
+			{ return vdupq_n_f32(v); }
+
+		inline float4 set(float x, float y, float z, float w)
+			{ float values[4] = { x, y, z, w }; return vld1q_f32(values); }
+
+		inline float first(float4 v)
+			{ return vgetq_lane_f32(v, 0); }
+
+		inline float4 add(float4 a, float4 b)
+			{ return vaddq_f32(a, b); }
+
+		inline float4 sub(float4 a, float4 b)
+			{ return vsubq_f32(a, b); }
+
+		inline float4 mul(float4 a, float4 b)
+			{ return vmulq_f32(a, b); }
+
+		/*
+		 * NEON has no division, reciprocal estimate is refined with two Newton-Raphson steps
+		 */
+		inline float4 div(float4 a, float4 b)
+		{
+			float4 r = vrecpeq_f32(b);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			return vmulq_f32(a, r);
+		}
+
+		inline float4 abs(float4 v)
+			{ return vabsq_f32(v); }
+
+		/*
+		 * Bit i of the result is set if component i is greater than zero
+		 */
+		inline int positiveMask(float4 v)
+		{
+			static const uint32_t bits[4] = { 1, 2, 4, 8 };
+			uint32x4_t m = vandq_u32(vcgtq_f32(v, vdupq_n_f32(0.0f)), vld1q_u32(bits));
+			uint32x2_t s = vadd_u32(vget_low_u32(m), vget_high_u32(m));
+			return static_cast<int>(vget_lane_u32(vpadd_u32(s, s), 0));
+		}
+
+		inline float4 min(float4 a, float4 b)
+			{ return vminq_f32(a, b); }
+
+		inline float4 max(float4 a, float4 b)
+			{ return vmaxq_f32(a, b); }
+
+		/*
+		 * Estimate is refined with two Newton-Raphson steps
+		 */
+		inline float4 inverseSqrt(float4 v)
+		{
+			float4 r = vrsqrteq_f32(v);
+			r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+			return vmulq_f32(vrsqrtsq_f32(vmulq_f32(v, r), r), r);
+		}
+
+		/*
+		 * Components are truncated towards zero
+		 */
+		inline float4 truncate(float4 v)
+			{ return vcvtq_f32_s32(vcvtq_s32_f32(v)); }
+
+		inline void truncate(float4 v, int* result)
+			{ vst1q_s32(result, vcvtq_s32_f32(v)); }
+
+		/*
+		 * Returns components of x, where a is greater than b, and components of y otherwise
+		 */
+		inline float4 selectGreater(float4 a, float4 b, float4 x, float4 y)
+			{ return vbslq_f32(vcgtq_f32(a, b), x, y); }
+
+		/*
+		 * Returns (a[x], a[y], b[z], b[w])
+		 */
+		template <int x, int y, int z, int w>
+		inline float4 shuffle(float4 a, float4 b)
+		{
+			float4 r = vdupq_n_f32(vgetq_lane_f32(a, x));
+			r = vsetq_lane_f32(vgetq_lane_f32(a, y), r, 1);
+			r = vsetq_lane_f32(vgetq_lane_f32(b, z), r, 2);
+			return vsetq_lane_f32(vgetq_lane_f32(b, w), r, 3);
+		}
+
+#	endif
+
+		template <int i>
+		inline float4 lane(float4 v)
+			{ return shuffle<i, i, i, i>(v, v); }
+
+		template <int x, int y, int z, int w>
+		inline float4 swizzle(float4 v)
+			{ return shuffle<x, y, z, w>(v, v); }
+
+		/*
+		 * Sum of all components in each component
+		 */
+		inline float4 horizontalSum(float4 v)
+		{
+			float4 t = add(v, swizzle<2, 3, 0, 1>(v));
+			return add(t, swizzle<1, 0, 3, 2>(t));
+		}
+
+		inline float dot(const float* a, const float* b)
+			{ return first(horizontalSum(mul(load(a), load(b)))); }
+
+		inline float4 combineRows(float4 v, float4 r0, float4 r1, float4 r2, float4 r3)
+		{
+			return add(add(mul(lane<0>(v), r0), mul(lane<1>(v), r1)),
+				add(mul(lane<2>(v), r2), mul(lane<3>(v), r3)));
+		}
+
+		/*
+		 * Rows of the result are linear combinations of rows of b, as in scalar matrix4.
+		 * All rows are loaded before storing, so result could be the same as a or b.
+		 */
+		inline void multiplyMatrix(const float* a, const float* b, float* result)
+		{
+			float4 b0 = load(b);
+			float4 b1 = load(b + 4);
+			float4 b2 = load(b + 8);
+			float4 b3 = load(b + 12);
+
+			float4 r0 = combineRows(load(a), b0, b1, b2, b3);
+			float4 r1 = combineRows(load(a + 4), b0, b1, b2, b3);
+			float4 r2 = combineRows(load(a + 8), b0, b1, b2, b3);
+			float4 r3 = combineRows(load(a + 12), b0, b1, b2, b3);
+
+			store(result, r0);
+			store(result + 4, r1);
+			store(result + 8, r2);
+			store(result + 12, r3);
+		}
+
+		inline void transformVector(const float* m, const float* v, float* result)
+		{
+			store(result, combineRows(load(v), load(m), load(m + 4), load(m + 8), load(m + 12)));
+		}
+
+		/*
+		 * Quaternions are stored as (scalar, x, y, z)
+		 */
+		inline void multiplyQuaternion(const float* a, const float* b, float* result)
+		{
+			float4 qa = load(a);
+			float4 qb = load(b);
+
+			float4 r = mul(lane<0>(qa), qb);
+			r = add(r, mul(mul(lane<1>(qa), swizzle<1, 0, 3, 2>(qb)), set(-1.0f, 1.0f, -1.0f, 1.0f)));
+			r = add(r, mul(mul(lane<2>(qa), swizzle<2, 3, 0, 1>(qb)), set(-1.0f, 1.0f, 1.0f, -1.0f)));
+			r = add(r, mul(mul(lane<3>(qa), swizzle<3, 2, 1, 0>(qb)), set(-1.0f, -1.0f, 1.0f, 1.0f)));
+			store(result, r);
+		}
+
+		/*
+		 * Returns false and leaves result untouched if vector has zero length
+		 */
+		inline bool normalize(const float* v, float* result)
+		{
+			float4 vec = load(v);
+			float lengthSquared = first(horizontalSum(mul(vec, vec)));
+			if (!(lengthSquared > 0.0f)) return false;
+
+			store(result, div(vec, splat(std::sqrt(lengthSquared))));
+			return true;
+		}
+
+		/*
+		 * 2x2 blocks are stored as (m00, m01, m10, m11)
+		 */
+		inline float4 block2Multiply(float4 a, float4 b)
+		{
+			return add(mul(a, swizzle<0, 3, 0, 3>(b)),
+				mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+
+		inline float4 block2AdjugateMultiply(float4 a, float4 b)
+		{
+			return sub(mul(swizzle<3, 3, 0, 0>(a), b),
+				mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+		}
+
+		inline float4 block2MultiplyAdjugate(float4 a, float4 b)
+		{
+			return sub(mul(a, swizzle<3, 0, 3, 0>(b)),
+				mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+		}
+
+		/*
+		 * Inverse by 2x2 blocks. Returns false and leaves result untouched if matrix is singular.
+		 */
+		inline bool inverseMatrix(const float* m, float* result)
+		{
+			float4 m0 = load(m);
+			float4 m1 = load(m + 4);
+			float4 m2 = load(m + 8);
+			float4 m3 = load(m + 12);
+
+			float4 a = shuffle<0, 1, 0, 1>(m0, m1);
+			float4 b = shuffle<2, 3, 2, 3>(m0, m1);
+			float4 c = shuffle<0, 1, 0, 1>(m2, m3);
+			float4 d = shuffle<2, 3, 2, 3>(m2, m3);
+
+			float4 detSub = sub(mul(shuffle<0, 2, 0, 2>(m0, m2), shuffle<1, 3, 1, 3>(m1, m3)),
+				mul(shuffle<1, 3, 1, 3>(m0, m2), shuffle<0, 2, 0, 2>(m1, m3)));
+
+			float4 detA = lane<0>(detSub);
+			float4 detB = lane<1>(detSub);
+			float4 detC = lane<2>(detSub);
+			float4 detD = lane<3>(detSub);
+
+			float4 dc = block2AdjugateMultiply(d, c);
+			float4 ab = block2AdjugateMultiply(a, b);
+
+			float4 x = sub(mul(detD, a), block2Multiply(b, dc));
+			float4 w = sub(mul(detA, d), block2Multiply(c, ab));
+			float4 y = sub(mul(detB, c), block2MultiplyAdjugate(d, ab));
+			float4 z = sub(mul(detC, b), block2MultiplyAdjugate(a, dc));
+
+			float4 det = add(mul(detA, detD), mul(detB, detC));
+			det = sub(det, horizontalSum(mul(ab, swizzle<0, 2, 1, 3>(dc))));
+
+			float determinant = first(det);
+			if (determinant * determinant <= 0.0f) return false;
+
+			float4 inverseDet = div(set(1.0f, -1.0f, -1.0f, 1.0f), det);
+			x = mul(x, inverseDet);
+			y = mul(y, inverseDet);
+			z = mul(z, inverseDet);
+			w = mul(w, inverseDet);
+
+			store(result, shuffle<3, 1, 3, 1>(x, y));
+			store(result + 4, shuffle<2, 0, 2, 0>(x, y));
+			store(result + 8, shuffle<3, 1, 3, 1>(z, w));
+			store(result + 12, shuffle<2, 0, 2, 0>(z, w));
+			return true;
+		}
+	}
+}
+
+#endif
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <et/geometry/simd.h>
 #include <et/geometry/vector2.h>
 #include <et/geometry/vector3.h>
 
@@ -154,4 +155,14 @@ namespace et
 	inline vector4<T> operator * (T value, const vector4<T>& vec) 
 		{ return vector4<T>(vec.x * value, vec.y * value, vec.z * value, vec.w * value); }
 
+#if (ET_SIMD)
+	template <>
+	inline float vector4<float>::dot(const vector4<float>& vector) const
+		{ return simd::dot(c, vector.c); }
+
+	template <>
+	inline float vector4<float>::dotSelf() const
+		{ return simd::dot(c, c); }
+#endif
+
 }
\ No newline at end of file
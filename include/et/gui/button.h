@@ -132,6 +132,7 @@ namespace et
 			bool _pressed;
 			bool _hovered;
 			bool _selected;
+			size_t _fontGeneration;
 		};
 	}
 }
\ No newline at end of file
@@ -131,6 +131,11 @@ namespace et
 		private:
 			void addToRenderQueue(RenderContext* rc, GuiRenderer& gr);
 
+			/*
+			 * Items are rendered by the carousel, so it is rebuilt with them
+			 */
+			void elementInvalidated(Element* element);
+
 			void buildItems();
 			void buildRibbonItems();
 			void buildRoundItems();
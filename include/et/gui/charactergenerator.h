@@ -7,29 +7,64 @@
 
 #pragma once
 
+#include <list>
 #include <et/gui/fontbase.h>
+#include <et/geometry/rectplacer.h>
 #include <et/apiobjects/texture.h>
 
 namespace et
 {
 	class RenderContext;
-	
+
 	namespace gui
 	{
+		struct CharacterGeneratorStatistics
+		{
+			size_t hits;
+			size_t misses;
+			size_t evictions;
+			size_t textureUpdates;
+			size_t pagesCount;
+
+			CharacterGeneratorStatistics() :
+				hits(0), misses(0), evictions(0), textureUpdates(0), pagesCount(0) { }
+
+			float hitRate() const
+				{ return (hits + misses > 0) ? static_cast<float>(hits) / static_cast<float>(hits + misses) : 1.0f; }
+		};
+
+		/*
+		 * Renders characters on demand into pages of glyph cache. When all pages are full,
+		 * least recently used characters of the least recently used page are evicted.
+		 * Generation is increased on every eviction, so descriptors obtained before are outdated.
+		 * Page of the character is stored in CharDescriptor::extra.x
+		 */
 		class CharacterGeneratorPrivate;
 		class CharacterGenerator : public Shared
 		{
 		public:
 			ET_DECLARE_POINTER(CharacterGenerator)
 
+			enum
+			{
+				PageSize = 1024,
+				DefaultMaxPages = 4
+			};
+
 		public:
 			CharacterGenerator(RenderContext* _rc, const std::string& face,
 				const std::string& boldFace, size_t size);
-			
+
 			~CharacterGenerator();
 
-			const Texture& texture() const 
-				{ return _texture; }
+			const Texture& texture(size_t page = 0) const
+				{ return _pages.at(page)->texture; }
+
+			size_t pagesCount() const
+				{ return _pages.size(); }
+
+			void setMaxPages(size_t value)
+				{ _maxPages = etMax(size_t(1), value); }
 
 			size_t size() const
 				{ return _size; }
@@ -37,39 +72,103 @@ namespace et
 			const std::string& face() const
 				{ return _face; }
 
+			size_t generation() const
+				{ return _generation; }
+
 			CharDescriptor charDescription(int c)
-			{
-				auto i = _chars.find(c);
-				return (i != _chars.end()) ? i->second : generateCharacter(c, true);
-			}
+				{ return characterDescription(c, 0); }
 
 			CharDescriptor boldCharDescription(int c)
-			{
-				auto i = _boldChars.find(c);
-				return (i != _boldChars.end()) ? i->second : generateBoldCharacter(c, true);
-			}
+				{ return characterDescription(c, CharParameter_Bold); }
 
 			float lineHeight() const
-				{ return _chars.size() ? _chars.begin()->second.size.y : static_cast<float>(_size); }
+				{ return (_lineHeight > 0.0f) ? _lineHeight : static_cast<float>(_size); }
+
+			/*
+			 * Characters generated between begin and end are uploaded when the batch ends
+			 * and are not evicted by each other. Batches could be nested.
+			 */
+			void beginBatch();
+			void endBatch();
+
+			const CharacterGeneratorStatistics& statistics() const
+				{ return _statistics; }
 
 		private:
-			CharDescriptor generateCharacter(int value, bool updateTexture);
-			CharDescriptor generateBoldCharacter(int value, bool updateTexture);
+			typedef std::pair<int, int> CharacterKey;
+			typedef std::list<CharacterKey> CharacterKeyList;
+
+			struct Page
+			{
+				Texture texture;
+				RectPlacer placer;
+				CharacterKeyList usage;
+				uint64_t lastUsage;
+				vec2i dirtyMin;
+				vec2i dirtyMax;
+
+				Page();
+			};
+
+			struct CachedCharacter
+			{
+				CharDescriptor descriptor;
+				rect place;
+				size_t page;
+				uint64_t lastUsage;
+				CharacterKeyList::iterator usagePosition;
+
+				/*
+				 * Texture could not be read back on all platforms, so pixels of cached
+				 * characters are kept to compose region uploaded at the end of batch.
+				 * Released when character is evicted.
+				 */
+				BinaryDataStorage pixels;
+			};
+
+			typedef std::map<CharacterKey, CachedCharacter> CachedCharacterMap;
+
+		private:
+			void initialize();
+			void releasePages();
+
+			CharDescriptor characterDescription(int value, int params);
+			CharDescriptor generateCharacter(int value, int params);
+
+			bool placeCharacter(const vec2i& size, rect& place, size_t& page);
+			bool evictCharacters(const vec2i& size, rect& place, size_t& page);
+			void evictCharacter(CachedCharacterMap::iterator i);
+
+			void addPage();
+			void storeCharacterPixels(Page* page, CachedCharacter& c, const vec2i& size, const BinaryDataStorage& data);
+			void updatePages();
+
+			/*
+			 * Platform-specific
+			 */
+			vec2i measureCharacter(int value, bool bold);
+			void renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage& data);
 
 		private:
 			RenderContext* _rc;
 			CharacterGeneratorPrivate* _private;
 
-			Texture _texture;
-			CharDescriptorMap _chars;
-			CharDescriptorMap _boldChars;
+			std::vector<Page*> _pages;
+			CachedCharacterMap _characters;
+			CharacterGeneratorStatistics _statistics;
 
 			std::string _face;
 			std::string _boldFace;
 
 			size_t _size;
+			size_t _maxPages;
+			size_t _generation;
+			size_t _batchDepth;
+			uint64_t _usageCounter;
+			uint64_t _batchStartUsage;
+			float _lineHeight;
 		};
 
 	}
 
-}
\ No newline at end of file
+}
@@ -24,13 +24,20 @@ namespace et
 
 			void loadFromFile(RenderContext* rc, const std::string& fileName, ObjectsCache& cache);
 
-			const Texture& texture() const 
-				{ return _generator.valid() ? _generator->texture() : _texture; }
+			const Texture& texture(size_t page = 0) const 
+				{ return _generator.valid() ? _generator->texture(page) : _texture; }
 			const std::string& face() const
 				{ return _generator.valid() ? _generator->face() : _face; }
 			size_t size() const
 				{ return _generator.valid() ? _generator->size() : _size; }
 
+			/*
+			 * Changes when characters are evicted from the glyph cache,
+			 * strings built with the previous generation should be rebuilt
+			 */
+			size_t generation() const
+				{ return _generator.valid() ? _generator->generation() : 0; }
+
 			CharDescriptor charDescription(int c);
 			CharDescriptor boldCharDescription(int c);
 
@@ -46,6 +53,9 @@ namespace et
 		private:
 			bool isUtf8String(const std::string& s) const;
 
+			void beginBatch();
+			void endBatch();
+
 			CharDescriptorList parseString(const std::string& s);
 			CharDescriptorList parseString(const std::wstring& s);
 
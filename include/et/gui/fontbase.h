@@ -33,6 +33,10 @@ namespace et
 			vec2 size;
 			vec2 uvOrigin;
 			vec2 uvSize;
+			
+			/*
+			 * x - page of the glyph cache for generated characters
+			 */
 			vec4i extra;
 			
 			CharDescriptor() : value(0), params(0) 
@@ -41,6 +41,12 @@ namespace et
 			GuiRenderer& renderer() 
 				{ return _renderer; }
 
+			/*
+			 * Vertices of all layouts which were changed during the last frame
+			 */
+			size_t verticesRebuilt() const
+				{ return _verticesRebuilt; }
+
 			Layout::Pointer topmostLayout() const
 				{ return _layouts.size() ? _layouts.back()->layout : Layout::Pointer(); }
 
@@ -168,6 +174,7 @@ namespace et
 
 			LayoutEntryStack _layouts;
 			vec2 _screenSize;
+			size_t _verticesRebuilt;
 			bool _backgroundValid;
 		};
 
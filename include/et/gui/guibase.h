@@ -178,9 +178,18 @@ namespace et
 			bool inverseTransformValid()
 				{ return _inverseTransformValid; }
 
+			/*
+			 * Whole layout should be rebuilt, e.g. when order of elements changes
+			 */
 			virtual void setInvalid()
 				{ if (parent()) parent()->setInvalid(); }
 
+			/*
+			 * Only vertices of the element should be rebuilt
+			 */
+			virtual void elementInvalidated(Element* element)
+				{ if (parent()) parent()->elementInvalidated(element); }
+
 			void setTransformValid(bool v) 
 				{ _transformValid = v; }
 
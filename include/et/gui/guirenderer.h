@@ -38,7 +38,30 @@ namespace et
 			size_t addVertices(const GuiVertexList& vertices, const Texture& texture,
 				ElementRepresentation cls, RenderLayer layer);
 
+			/*
+			 * Vertices created with createStringVertices are split by pages of the font
+			 */
+			void addStringVertices(const GuiVertexList& vertices, const Font& font,
+				ElementRepresentation cls, RenderLayer layer);
+
 			size_t measusevertexCountForImageDescriptor(const ImageDescriptor& desc);
+
+			/*
+			 * Vertices added between begin and end are attributed to the element,
+			 * so they could be rebuilt in place later
+			 */
+			void beginElement(const Element* element);
+			void endElement();
+
+			bool elementHasVertices(const Element* element) const;
+
+			/*
+			 * Rebuilds vertices of the element in place. Element should add vertices with the same
+			 * textures, clip rects and layers as before and not more of them, unused vertices are cleared.
+			 * Returns false otherwise, the whole rendering element should be rebuilt then.
+			 */
+			bool beginElementUpdate(const Element* element);
+			bool endElementUpdate();
 			
 			void createStringVertices(GuiVertexList& vertices, const CharDescriptorList& chars, 
 				Alignment hAlign, Alignment vAlign, const vec2& pos,
@@ -64,7 +87,9 @@ namespace et
 		private:
 			void init(RenderContext* rc);
 			void alloc(size_t count);
-			GuiVertexPointer allocateVertices(size_t count, const Texture& texture,
+			size_t allocateVertices(size_t count, size_t reserve, const Texture& texture,
+				ElementRepresentation cls, RenderLayer layer);
+			size_t reuseVertices(size_t count, const Texture& texture,
 				ElementRepresentation cls, RenderLayer layer);
 
 			GuiRenderer& operator = (const GuiRenderer&)
@@ -76,6 +101,7 @@ namespace et
 			RenderingElement::Pointer _renderingElement;
 			Texture _lastTextures[RenderLayer_max];
 			Texture _defaultTexture;
+			GuiVertexList _pageVertices;
 			
 			Program::Pointer _guiProgram;
 			mat4 _defaultTransform;
@@ -94,6 +120,11 @@ namespace et
 			bool _depthTestEnabled;
 			bool _depthMask;
 			bool _blendEnabled;
+
+			std::vector<RenderingElement::ElementVertices*> _elementsStack;
+			RenderingElement::ElementVertices* _updatedElement;
+			size_t _updatedAllocation;
+			bool _updateFailed;
 		};
 	}
 }
@@ -73,6 +73,7 @@ namespace et
 			float _textFadeStartTime;
 			Alignment _horizontalAlignment;
 			Alignment _verticalAlignment;
+			size_t _fontGeneration;
 			bool _animatingText;
 			bool _allowFormatting;
 		};
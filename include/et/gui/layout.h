@@ -29,6 +29,11 @@ namespace et
 
 			void addToRenderQueue(RenderContext* rc, GuiRenderer& gr);
 
+			/*
+			 * Rebuilds only invalidated elements, returns false if the whole layout should be rebuilt
+			 */
+			bool updateRenderQueue(RenderContext* rc, GuiRenderer& gr);
+
 			void update(float);
 			void cancelDragging(float returnDuration = 0.0f);
 
@@ -51,6 +56,7 @@ namespace et
 			bool pointerScrolled(const et::PointerInputInfo&);
 
 			void setInvalid();
+			void elementInvalidated(Element* element);
 			void collectTopmostElements(Element* element);
 
 			Layout* owner()
@@ -68,11 +74,13 @@ namespace et
 			Element* getActiveElement(const PointerInputInfo& p, Element* e);
 			void setCurrentElement(const PointerInputInfo& p, Element* e);
 			void addElementToRenderQueue(Element* element, RenderContext* rc, GuiRenderer& gr);
+			bool updateElementInRenderQueue(Element* element, RenderContext* rc, GuiRenderer& gr);
 			
 			void performDragging(const PointerInputInfo&);
 
 		private:
 			RenderingElement::Pointer _renderingElement;
+			std::map<Element*, Element::Pointer> _invalidElements;
 			
 			Element* _currentElement;
 			Element* _focusedElement;
@@ -64,6 +64,7 @@ namespace et
 			GuiVertexList _textVertices;
 			FloatAnimator* _textAlphaAnimator;
 			size_t _selectedIndex;
+			size_t _fontGeneration;
 			float _textAlpha;
 			bool _pressed;
 		};
@@ -142,6 +143,7 @@ namespace et
 			ListboxState _state;
 			vec2 _contentOffset;
 			size_t _selectedIndex;
+			size_t _fontGeneration;
 			ListboxPopupDirection _direction;
 			bool _popupOpened;
 			bool _popupOpening;
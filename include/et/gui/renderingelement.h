@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <et/apiobjects/vertexarrayobject.h>
 #include <et/gui/guibase.h>
+#include <et/gui/font.h>
 
 namespace et
 {
@@ -23,20 +25,115 @@ namespace et
 			RenderingElement(RenderContext* rc);
 			void clear();
 
+			/*
+			 * Uploads only ranges of vertices which were changed since the previous call
+			 */
 			const VertexArrayObject& vertexArrayObject();
 
+			/*
+			 * Number of vertices changed and uploaded during the last call of vertexArrayObject()
+			 */
+			size_t verticesRebuilt() const
+				{ return _verticesRebuilt; }
+
+			size_t verticesUploaded() const
+				{ return _verticesUploaded; }
+
+			/*
+			 * Characters of fonts used by vertices were evicted from the glyph cache
+			 */
+			bool fontsOutdated() const;
+
 		private:
 			friend class GuiRenderer;
 
+			struct VertexRange
+			{
+				size_t first;
+				size_t count;
+
+				VertexRange(size_t f, size_t c) :
+					first(f), count(c) { }
+			};
+
+			typedef std::vector<VertexRange> VertexRangeList;
+
+			struct FontGeneration
+			{
+				Font font;
+				size_t generation;
+
+				FontGeneration(const Font& f, size_t g) :
+					font(f), generation(g) { }
+			};
+
+			typedef std::vector<FontGeneration> FontGenerationList;
+
+			/*
+			 * Vertices allocated by the element with the same configuration as render chunk
+			 */
+			struct ElementAllocation
+			{
+				size_t first;
+				size_t count;
+				Texture texture;
+				recti clip;
+				ElementRepresentation representation;
+				RenderLayer layer;
+
+				ElementAllocation(size_t f, size_t c, const Texture& t, const recti& aClip,
+					ElementRepresentation r, RenderLayer l) : first(f), count(c), texture(t), clip(aClip),
+					representation(r), layer(l) { }
+			};
+
+			typedef std::vector<ElementAllocation> ElementAllocationList;
+
+			/*
+			 * Element is not dereferenced, it is removed from the map by full rebuild
+			 * whenever hierarchy of the layout changes
+			 */
+			struct ElementVertices
+			{
+				recti clip;
+				ElementAllocationList allocations;
+				size_t visits;
+
+				ElementVertices() :
+					visits(0) { }
+			};
+
+			typedef std::unordered_map<const Element*, ElementVertices> ElementVerticesMap;
+
+		private:
+			void setVertices(size_t first, const GuiVertex* vertices, size_t count);
+
+			/*
+			 * Zeroed vertices form degenerate triangles, which are not rasterized
+			 */
+			void clearVertices(size_t first, size_t count);
+			void addChangedRange(size_t first, size_t count);
+
+			/*
+			 * Earliest generation of the font is kept, so eviction of characters used
+			 * by any of the strings is detected
+			 */
+			void useFont(const Font& font);
+
 		private:
 			RenderState& _rs;
 			RenderChunkList _chunks;
 			IndexArray::Pointer _indexArray;
 			GuiVertexList _vertexList;
+			VertexRangeList _changedRanges;
+			FontGenerationList _fonts;
+			ElementVerticesMap _elements;
 
 			VertexArrayObject _vao;
 
-			bool _changed;
+			size_t _uploadedCapacity;
+			size_t _changedVertices;
+			size_t _verticesRebuilt;
+			size_t _verticesUploaded;
 		};
 	}
 }
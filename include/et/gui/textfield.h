@@ -55,6 +55,7 @@ namespace et
 			GuiVertexList _backgroundVertices;
 			NotifyTimer _caretBlinkTimer;
 			vec4 _backgroundColor;
+			size_t _fontGeneration;
 			bool _secured;
 			bool _caretVisible;
 		};
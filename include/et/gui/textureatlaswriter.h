@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <et/geometry/rectplacer.h>
 #include <et/gui/guibase.h>
 
 namespace et
@@ -29,12 +30,13 @@ namespace et
 		{
 			TextureDescription::Pointer texture;
 			ImageItemList images;
+			RectPlacer placer;
 			int maxWidth;
 			int maxHeight;
 
 		public:
 			TextureAtlasItem() : 
-				maxWidth(0), maxHeight(0) { }
+				placer(vec2i(0), false), maxWidth(0), maxHeight(0) { }
 		};
 
 		typedef std::vector<TextureAtlasItem> TextureAtlasItemList;
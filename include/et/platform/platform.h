@@ -65,6 +65,30 @@
 #
 #endif
 
+#if defined(ET_DISABLE_SIMD)
+#
+#	define ET_SIMD_SSE2	0
+#	define ET_SIMD_NEON	0
+#
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#
+#	define ET_SIMD_SSE2	1
+#	define ET_SIMD_NEON	0
+#
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#
+#	define ET_SIMD_SSE2	0
+#	define ET_SIMD_NEON	1
+#
+#else
+#
+#	define ET_SIMD_SSE2	0
+#	define ET_SIMD_NEON	0
+#
+#endif
+
+#define ET_SIMD		(ET_SIMD_SSE2 || ET_SIMD_NEON)
+
 #define ET_TOCONSTCHAR_IMPL(a)	#a
 #define ET_TOCONSTCHAR(a)		ET_TOCONSTCHAR_IMPL(a)
 
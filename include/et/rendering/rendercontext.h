@@ -16,6 +16,7 @@
 #include <et/rendering/rendercontextparams.h>
 #include <et/rendering/renderer.h>
 #include <et/rendering/renderstate.h>
+#include <et/rendering/uploadqueue.h>
 
 #include <et/apiobjects/programfactory.h>
 #include <et/apiobjects/texturefactory.h>
@@ -81,6 +82,9 @@ namespace et
 		VertexBufferFactory& vertexBufferFactory()
 			{ return _vertexBufferFactory.reference(); }
 
+		UploadQueue& uploadQueue()
+			{ return _uploadQueue; }
+
 		size_t lastFPSValue() const
 			{ return _info.averageFramePerSecond; }
 
@@ -119,6 +123,7 @@ namespace et
 		RenderingInfo _info;
 
 		RenderState _renderState;
+		UploadQueue _uploadQueue;
 
 		AutoPtr<ProgramFactory> _programFactory;
 		AutoPtr<TextureFactory> _textureFactory;
@@ -0,0 +1,151 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <deque>
+#include <et/app/invocation.h>
+#include <et/apiobjects/texture.h>
+#include <et/apiobjects/vertexbuffer.h>
+#include <et/apiobjects/indexbuffer.h>
+#include <et/threading/criticalsection.h>
+
+namespace et
+{
+	class RenderContext;
+
+	struct UploadQueueStatistics
+	{
+		size_t queuedItems;
+		size_t queuedBytes;
+		size_t uploadedItems;
+		size_t uploadedBytes;
+
+		size_t lastFrameUploadedBytes;
+		uint64_t lastFrameUploadTime;
+
+		/*
+		 * Time from adding item to the queue until it's completely uploaded, in microseconds
+		 */
+		uint64_t averageLatency;
+		uint64_t maxLatency;
+
+		UploadQueueStatistics() : queuedItems(0), queuedBytes(0), uploadedItems(0), uploadedBytes(0),
+			lastFrameUploadedBytes(0), lastFrameUploadTime(0), averageLatency(0), maxLatency(0) { }
+	};
+
+	/*
+	 * Uploads data to the GPU by slices (texture levels, ranges of texture rows or buffer ranges),
+	 * spending no more than given time and amount of data per frame.
+	 * Items could be added from any thread, completion is invoked in the rendering thread.
+	 */
+	class UploadQueue
+	{
+	public:
+		enum
+		{
+			DefaultFrameTimeBudget = 3000,
+			DefaultFrameDataBudget = 8 * 1024 * 1024,
+			MaxSliceSize = 1024 * 1024
+		};
+
+	public:
+		UploadQueue();
+		~UploadQueue();
+
+		/*
+		 * Zero value removes the limit, at least one slice is uploaded per frame anyway
+		 */
+		void setFrameTimeBudget(uint64_t microseconds)
+			{ _frameTimeBudget = microseconds; }
+
+		void setFrameDataBudget(size_t bytes)
+			{ _frameDataBudget = bytes; }
+
+		void uploadTexture(Texture texture, TextureDescription::Pointer desc,
+			const Invocation& completion = Invocation());
+
+		/*
+		 * Vertex declaration of the array should match declaration of the buffer
+		 */
+		void uploadVertexData(VertexBuffer buffer, VertexArray::Pointer data,
+			const Invocation& completion = Invocation());
+
+		void uploadIndexData(IndexBuffer buffer, IndexArray::Pointer data,
+			const Invocation& completion = Invocation());
+
+		/*
+		 * Should be called from the rendering thread once per frame
+		 */
+		void process(RenderContext* rc);
+
+		/*
+		 * Uploads everything regardless of budget
+		 */
+		void flush(RenderContext* rc);
+
+		bool empty();
+
+		UploadQueueStatistics statistics();
+
+	private:
+		enum ItemType
+		{
+			ItemType_Texture,
+			ItemType_VertexBuffer,
+			ItemType_IndexBuffer
+		};
+
+		struct Item
+		{
+			ItemType type;
+
+			Texture texture;
+			TextureDescription::Pointer textureDescription;
+
+			VertexBuffer vertexBuffer;
+			VertexArray::Pointer vertexArray;
+			BinaryDataStorage vertexData;
+
+			IndexBuffer indexBuffer;
+			IndexArray::Pointer indexArray;
+
+			Invocation completion;
+
+			size_t totalBytes;
+			size_t layer;
+			size_t level;
+			size_t offset;
+			uint64_t enqueueTime;
+			bool started;
+			bool finished;
+
+			Item(ItemType t);
+		};
+
+	private:
+		ET_DENY_COPY(UploadQueue)
+
+		void enqueue(Item* item);
+		void process(RenderContext* rc, uint64_t timeBudget, size_t dataBudget);
+
+		size_t uploadSlice(RenderContext* rc, Item* item, size_t maxSize);
+		size_t uploadTextureSlice(RenderContext* rc, Item* item, size_t maxSize);
+		size_t uploadVertexSlice(Item* item, size_t maxSize);
+		size_t uploadIndexSlice(Item* item, size_t maxSize);
+
+		void complete(Item* item);
+
+	private:
+		CriticalSection _csItems;
+		std::deque<Item*> _items;
+		UploadQueueStatistics _statistics;
+		uint64_t _totalLatency;
+		uint64_t _frameTimeBudget;
+		size_t _frameDataBudget;
+	};
+}
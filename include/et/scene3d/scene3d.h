@@ -9,6 +9,7 @@
 
 #include <et/app/events.h>
 #include <et/core/objectscache.h>
+#include <et/camera/frustum.h>
 #include <et/scene3d/element.h>
 #include <et/scene3d/storage.h>
 #include <et/scene3d/mesh.h>
@@ -18,6 +19,8 @@
 
 namespace et
 {
+	class JobSystem;
+
 	namespace s3d
 	{
 		class Scene : public ElementContainer, public ElementFactory
@@ -47,6 +50,13 @@ namespace et
 			void deserializeAsync(const std::string& filename, RenderContext* rc, ObjectsCache& tc,
 				ElementFactory* factory);
 
+			/*
+			 * Tests bounding boxes of all support meshes against frustum, visible meshes are added to the list.
+			 * If job system is provided, large amount of meshes is tested in parallel.
+			 * Returns amount of visible meshes.
+			 */
+			size_t cullSupportMeshes(const Frustum& frustum, Element::List& visible, JobSystem* jobSystem = nullptr);
+
 		public:
 			ET_DECLARE_EVENT1(deserializationFinished, size_t)
 
@@ -71,6 +81,9 @@ namespace et
 			VertexBufferList _vertexBuffers;
 			IndexBufferList _indexBuffers;
 			VertexArrayObjectList _vaos;
+
+			AABBArray _cullingBoxes;
+			VisibilityMask _cullingMask;
 		};
 	}
 }
\ No newline at end of file
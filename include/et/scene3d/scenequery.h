@@ -0,0 +1,111 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/scene3d/supportmesh.h>
+
+namespace et
+{
+	class JobSystem;
+
+	namespace s3d
+	{
+		struct SceneQueryHit
+		{
+			SupportMesh* mesh;
+			size_t triangleIndex;
+			vec3 point;
+			vec3 normal;
+
+			/*
+			 * As returned by barycentricCoordinates for the triangle in mesh space
+			 */
+			vec2 barycentric;
+
+			/*
+			 * For rays - in lengths of ray direction, for segments - fraction of the segment
+			 */
+			float distance;
+
+			SceneQueryHit() :
+				mesh(nullptr), triangleIndex(0), distance(0.0f) { }
+
+			bool valid() const
+				{ return mesh != nullptr; }
+		};
+		typedef std::vector<SceneQueryHit> SceneQueryHitList;
+
+		/*
+		 * Ray and segment queries against collision data of all support meshes of the hierarchy.
+		 * Two-level hierarchy is used: top level over world bounds of meshes and triangle BVH
+		 * of each mesh in mesh space. Changed transformations are detected on update and only bounds
+		 * of the top level are refitted, hierarchy is rebuilt when meshes are added or removed.
+		 *
+		 * update() should be called from the thread, which owns the scene, queries only read
+		 * data gathered by update, so batches could be processed by the job system.
+		 */
+		class SceneQuery
+		{
+		public:
+			SceneQuery(Element::Pointer root);
+
+			void update();
+
+			bool raycast(const ray3d& r, SceneQueryHit& hit) const;
+			bool raycast(const segment3d& s, SceneQueryHit& hit) const;
+
+			/*
+			 * Hits are written in the order of rays, hits without intersection are not valid
+			 */
+			void raycast(const std::vector<ray3d>& rays, SceneQueryHitList& hits,
+				JobSystem* jobSystem = nullptr) const;
+			void raycast(const std::vector<segment3d>& segments, SceneQueryHitList& hits,
+				JobSystem* jobSystem = nullptr) const;
+
+			size_t meshesCount() const
+				{ return _instances.size(); }
+
+		private:
+			struct Instance
+			{
+				SupportMesh* mesh;
+				mat4 transform;
+				mat4 inverseTransform;
+				vec3 minVertex;
+				vec3 maxVertex;
+				size_t transformVersion;
+			};
+
+			struct Query
+			{
+				vec3 origin;
+				vec3 direction;
+				float maxDistance;
+			};
+
+			class QueryTask;
+
+			void updateInstance(Instance& instance);
+			void rebuild();
+			void refit();
+			uint32_t buildNode(std::vector<uint32_t>& order, size_t begin, size_t end);
+
+			bool closestHit(const Query& query, SceneQueryHit& hit) const;
+			void processQueries(const std::vector<Query>& queries, SceneQueryHitList& hits,
+				JobSystem* jobSystem) const;
+			void processQueries(const std::vector<Query>& queries, SceneQueryHitList& hits,
+				size_t begin, size_t end) const;
+
+		private:
+			Element::Pointer _root;
+			std::vector<Instance> _instances;
+			TriangleBVH::NodeList _nodes;
+			TriangleBVH::IndexList _indices;
+		};
+	}
+}
@@ -9,6 +9,7 @@
 
 #include <et/scene3d/mesh.h>
 #include <et/collision/collision.h>
+#include <et/collision/trianglebvh.h>
 
 namespace et
 {
@@ -34,6 +35,9 @@ namespace et
 			const CollisionData& triangles() const
 				{ return _data; }
 
+			const TriangleBVH& bvh() const
+				{ return _bvh; }
+
 			void setNumIndexes(size_t num);
 			void fillCollisionData(VertexArray::Pointer v, IndexArray::Pointer i);
 
@@ -50,16 +54,26 @@ namespace et
 			mat4 finalTransformInverse();
 			float finalTransformScale();
 
+			void invalidateTransform();
+
+			/*
+			 * Increased each time transformation of the mesh or any of its parents is changed
+			 */
+			size_t transformVersion() const
+				{ return _transformVersion; }
+
 		private:
 			void buildInverseTransform();
 
 		private:
 			mat4 _cachedInverseTransform;
 			CollisionData _data;
+			TriangleBVH _bvh;
 			vec3 _size;
 			vec3 _center;
 			float _radius;
 			float _cachedFinalTransformScale;
+			size_t _transformVersion;
 			bool _inverseTransformValid;
 		};
 	}
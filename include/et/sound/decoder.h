@@ -0,0 +1,49 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/sound/sounddescription.h>
+
+namespace et
+{
+	namespace audio
+	{
+		/*
+		 * Produces PCM data in portions, format is described by description() (without data).
+		 * Decoders do not depend on the audio device and should be used by one thread at a time.
+		 */
+		class Decoder : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(Decoder)
+
+		public:
+			Decoder(Description::Pointer desc) :
+				_description(desc) { }
+
+			virtual ~Decoder() { }
+
+			Description::Pointer description() const
+				{ return _description; }
+
+			/*
+			 * Returns number of bytes written, which is less than size only at the end of data.
+			 * Size should be a multiple of the sample frame size.
+			 */
+			virtual size_t read(char* buffer, size_t size) = 0;
+
+			virtual void rewind() = 0;
+
+		private:
+			ET_DENY_COPY(Decoder)
+
+		private:
+			Description::Pointer _description;
+		};
+	}
+}
@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include <et/sound/sounddescription.h>
+#include <et/sound/decoder.h>
 
 namespace et
 {
@@ -18,6 +18,15 @@ namespace et
 		Description::Pointer loadAIFFile(const std::string&);
 
 		Description::Pointer loadFile(const std::string&);
+
+		/*
+		 * Only headers are read on open, samples are read from the file by decoder
+		 */
+		Decoder::Pointer openWAVFile(const std::string&);
+		Decoder::Pointer openAIFFile(const std::string&);
+		Decoder::Pointer openOGGFile(const std::string&);
+
+		Decoder::Pointer openFile(const std::string&);
 		
 		size_t openALFormatFromChannelsAndBitDepth(size_t numChannels, size_t bitDepth);
 	}
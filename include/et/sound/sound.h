@@ -16,6 +16,8 @@ namespace et
     {
 		class Player;
 		class Manager;
+		class VoiceManager;
+		class OpenALVoiceBackend;
 
         class TrackPrivate;
         class Track : public Object
@@ -32,8 +34,15 @@ namespace et
 			size_t sampleRate() const;
 			size_t bitDepth() const;
 
+			/*
+			 * Streaming tracks keep no samples in memory, each player decodes the file
+			 * on the streaming thread into a small queue of buffers
+			 */
+			bool streaming() const;
+
 		private:
             Track(const std::string& fileName);
+			Track(const std::string& fileName, bool streaming);
 			Track(Description::Pointer data);
 
 			ET_SINGLETON_COPY_DENY(Track)
@@ -44,6 +53,7 @@ namespace et
 		private:
 			friend class Player;
 			friend class Manager;
+			friend class OpenALVoiceBackend;
             TrackPrivate* _private;
         };
         
@@ -103,11 +113,18 @@ namespace et
 			~Manager();
 
 			Track::Pointer loadTrack(const std::string& fileName);
+			Track::Pointer streamTrack(const std::string& fileName);
 			Track::Pointer genTrack(Description::Pointer desc);
 
 			Player::Pointer genPlayer(Track::Pointer track);
 			Player::Pointer genPlayer();
 
+			/*
+			 * Voices share a fixed pool of sources, separate from the sources of players.
+			 * Pool is created on first access, update should be called every frame.
+			 */
+			VoiceManager& voices();
+
         private:
             Manager();
 			
@@ -0,0 +1,296 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/geometry/geometry.h>
+#include <et/sound/sound.h>
+
+namespace et
+{
+	namespace audio
+	{
+		class VoiceManager;
+
+		struct VoiceParameters
+		{
+			/*
+			 * Voices with higher priority take sources first, volume decides between equal priorities
+			 */
+			int priority;
+			size_t category;
+			float volume;
+			bool looped;
+
+			/*
+			 * Relative voices are not attenuated by distance (interface sounds, music)
+			 */
+			bool relative;
+			vec3 location;
+			float referenceDistance;
+			float maxDistance;
+
+			VoiceParameters() : priority(0), category(0), volume(1.0f), looped(false), relative(true),
+				referenceDistance(1.0f), maxDistance(100.0f) { }
+		};
+
+		struct VoiceManagerStatistics
+		{
+			size_t sources;
+			size_t voices;
+			size_t realVoices;
+			size_t virtualVoices;
+
+			/*
+			 * Virtual voices, which are quieter than the audibility threshold
+			 */
+			size_t inaudibleVoices;
+
+			/*
+			 * Audible voices left without source by the pool size or category limits
+			 */
+			size_t limitedVoices;
+
+			size_t startedVoices;
+			size_t finishedVoices;
+
+			VoiceManagerStatistics() : sources(0), voices(0), realVoices(0), virtualVoices(0),
+				inaudibleVoices(0), limitedVoices(0), startedVoices(0), finishedVoices(0) { }
+		};
+
+		/*
+		 * Playing instance of the track. Voice is virtual while it has no source,
+		 * position of the virtual voice advances, so it continues from the right place when heard again.
+		 */
+		class Voice : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(Voice)
+
+			enum
+			{
+				InvalidSource = static_cast<size_t>(-1)
+			};
+
+		public:
+			Track::Pointer track() const
+				{ return _track; }
+
+			const VoiceParameters& parameters() const
+				{ return _parameters; }
+
+			bool playing() const
+				{ return _playing; }
+
+			bool isVirtual() const
+				{ return _playing && (_source == InvalidSource); }
+
+			float position() const
+				{ return _position; }
+
+			/*
+			 * Volume including category volume and distance attenuation, computed on update
+			 */
+			float audibility() const
+				{ return _audibility; }
+
+			void setVolume(float value)
+				{ _parameters.volume = value; }
+
+			void setLocation(const vec3& value)
+				{ _parameters.location = value; }
+
+			void stop();
+
+		private:
+			friend class VoiceManager;
+
+			Voice(VoiceManager* owner, Track::Pointer track, const VoiceParameters& params) :
+				_owner(owner), _track(track), _parameters(params), _source(InvalidSource),
+				_position(0.0f), _audibility(0.0f), _playing(true), _started(false) { }
+
+			ET_DENY_COPY(Voice)
+
+		private:
+			VoiceManager* _owner;
+			Track::Pointer _track;
+			VoiceParameters _parameters;
+			size_t _source;
+			float _position;
+			float _audibility;
+			bool _playing;
+			bool _started;
+		};
+
+		/*
+		 * Fixed pool of real sources. Backend should not allocate sources after construction.
+		 */
+		class VoiceBackend
+		{
+		public:
+			virtual ~VoiceBackend() { }
+
+			virtual size_t sourcesCount() const = 0;
+
+			/*
+			 * Called at the beginning of VoiceManager::update
+			 */
+			virtual void update(float) { }
+
+			/*
+			 * Position is in seconds, looped position is always less than duration of the track
+			 */
+			virtual void start(size_t source, Track::Pointer track, float position, bool looped) = 0;
+			virtual void stop(size_t source) = 0;
+
+			/*
+			 * Gain includes distance attenuation, location is relative to the listener
+			 */
+			virtual void apply(size_t source, float gain, const vec3& location) = 0;
+
+			virtual bool playing(size_t source) = 0;
+			virtual float position(size_t source) = 0;
+		};
+
+		/*
+		 * Plays nothing, sources advance positions by time passed to update.
+		 * Allows to use and test voice management without the audio device.
+		 */
+		class NullVoiceBackend : public VoiceBackend
+		{
+		public:
+			struct Source
+			{
+				Track::Pointer track;
+				vec3 location;
+				float position;
+				float gain;
+				bool looped;
+				bool playing;
+
+				Source() :
+					position(0.0f), gain(0.0f), looped(false), playing(false) { }
+			};
+
+		public:
+			NullVoiceBackend(size_t sourcesCount) :
+				_sources(sourcesCount) { }
+
+			const Source& source(size_t index) const
+				{ return _sources.at(index); }
+
+			size_t sourcesCount() const
+				{ return _sources.size(); }
+
+			void update(float deltaTime);
+
+			void start(size_t source, Track::Pointer track, float position, bool looped);
+			void stop(size_t source);
+			void apply(size_t source, float gain, const vec3& location);
+
+			bool playing(size_t source)
+				{ return _sources.at(source).playing; }
+
+			float position(size_t source)
+				{ return _sources.at(source).position; }
+
+		private:
+			std::vector<Source> _sources;
+		};
+
+		/*
+		 * Keeps any number of voices and gives sources of the backend to the most important audible ones.
+		 * Distance attenuation is linear and clamped, as the distance model of the audio manager.
+		 * Should be used from one thread, update is expected every frame.
+		 */
+		class VoiceManager
+		{
+		public:
+			enum
+			{
+				UnlimitedVoices = static_cast<size_t>(-1)
+			};
+
+		public:
+			/*
+			 * Takes ownership of the backend
+			 */
+			VoiceManager(VoiceBackend* backend);
+			~VoiceManager();
+
+			VoiceBackend* backend()
+				{ return _backend; }
+
+			/*
+			 * Voice gets source on the next update
+			 */
+			Voice::Pointer play(Track::Pointer track, const VoiceParameters& params = VoiceParameters());
+			void stop(Voice::Pointer voice);
+			void stopAll();
+
+			void update(float deltaTime);
+
+			void setListenerLocation(const vec3& value)
+				{ _listenerLocation = value; }
+
+			/*
+			 * Voices quieter than threshold are virtual regardless of priority
+			 */
+			void setAudibilityThreshold(float value)
+				{ _audibilityThreshold = value; }
+
+			/*
+			 * Limits number of voices of the category, which are playing on sources at the same time
+			 */
+			void setCategoryLimit(size_t category, size_t maxRealVoices);
+			void setCategoryVolume(size_t category, float volume);
+
+			const VoiceManagerStatistics& statistics() const
+				{ return _statistics; }
+
+		private:
+			ET_DENY_COPY(VoiceManager)
+
+			struct Category
+			{
+				size_t limit;
+				size_t realVoices;
+				float volume;
+
+				Category() :
+					limit(UnlimitedVoices), realVoices(0), volume(1.0f) { }
+			};
+
+			struct RankedVoice
+			{
+				Voice* voice;
+				float score;
+				int priority;
+				bool audible;
+				bool real;
+			};
+
+			Category& category(size_t index);
+
+			float audibility(const Voice* voice);
+			void advance(Voice* voice, float deltaTime);
+			void virtualize(Voice* voice);
+			void finish(Voice* voice);
+			void remove(Voice* voice);
+
+		private:
+			VoiceBackend* _backend;
+			std::vector<Voice::Pointer> _voices;
+			std::vector<RankedVoice> _order;
+			std::vector<size_t> _freeSources;
+			std::vector<Category> _categories;
+			VoiceManagerStatistics _statistics;
+			vec3 _listenerLocation;
+			float _audibilityThreshold;
+		};
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <vector>
+#include <et/tasks/tasks.h>
+#include <et/threading/atomiccounter.h>
+#include <et/threading/criticalsection.h>
+
+namespace et
+{
+	class JobCounter;
+
+	struct Job
+	{
+		Task* task;
+		JobCounter* counter;
+
+		Job() :
+			task(nullptr), counter(nullptr) { }
+
+		Job(Task* t, JobCounter* c) :
+			task(t), counter(c) { }
+	};
+
+	/*
+	 * Counts jobs which are submitted but not yet finished.
+	 * Could be used as a fence (JobSystem::wait) or as a dependency for other jobs.
+	 * Counter should outlive all jobs, associated with it.
+	 */
+	class JobCounter
+	{
+	public:
+		JobCounter() { }
+
+		bool completed() const
+			{ return _counter.atomicCounterValue() == 0; }
+
+		AtomicCounterType pendingJobs() const
+			{ return _counter.atomicCounterValue(); }
+
+	private:
+		ET_DENY_COPY(JobCounter)
+
+		friend class JobSystemPrivate;
+
+	private:
+		AtomicCounter _counter;
+		CriticalSection _csDependent;
+		std::vector<Job> _dependent;
+	};
+
+	class JobSystemPrivate;
+	class JobSystem
+	{
+	public:
+		/*
+		 * Creates one worker per each available core
+		 */
+		JobSystem();
+		JobSystem(size_t workersCount);
+
+		~JobSystem();
+
+		size_t workersCount() const;
+
+		/*
+		 * Takes ownership of the task. Task will be executed on one of the workers
+		 * and deleted afterwards. If dependency is provided, task will not start
+		 * until all jobs of the dependency counter are finished.
+		 */
+		void submit(Task* task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+		/*
+		 * Blocks until all jobs of the counter are finished.
+		 * Calling thread executes pending jobs while waiting.
+		 */
+		void wait(JobCounter& counter);
+
+	private:
+		ET_DENY_COPY(JobSystem)
+
+	private:
+		JobSystemPrivate* _private;
+	};
+}
@@ -7,11 +7,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
 #include <et/tasks/tasks.h>
+#include <et/threading/mpscqueue.h>
 #include <et/threading/criticalsection.h>
 
 namespace et
 {
+	class JobSystem;
+	
+	/*
+	 * Tasks are posted into the lock-free inbox and moved from there in batches
+	 * into a binary heap ordered by execution time, so update only touches tasks which are due.
+	 * Cancelled tasks are removed from the map of pending tasks and their heap entries
+	 * are skipped once they reach the top.
+	 */
 	class TaskPool
 	{
 	public:
@@ -19,19 +32,58 @@ namespace et
 		~TaskPool();
 		
 		void update(float t);
-		void addTask(Task* t, float delay = 0.0f);
+		/*
+		 * Returns InvalidTaskHandle if task was already posted
+		 */
+		TaskHandle addTask(Task* t, float delay = 0.0f);
+		
+		/*
+		 * Removes and deletes task, if it was not taken for execution yet.
+		 * Returns false for executed, running or cancelled tasks.
+		 */
+		bool cancelTask(TaskHandle handle);
 		
 		bool hasTasks();
 		
+		/*
+		 * Returns false if there are no pending tasks.
+		 */
+		bool nextTaskTime(float& t);
+		
+		/*
+		 * If set, due tasks are submitted to the job system instead of executing in place.
+		 */
+		void setJobSystem(JobSystem* js)
+			{ _jobSystem = js; }
+		
 	private:
-		void joinTasks();
+		struct ScheduledTask
+		{
+			Task* task;
+			float executionTime;
+			uint64_t index;
+			
+			ScheduledTask(Task* t, float time, uint64_t i) :
+				task(t), executionTime(time), index(i) { }
+			
+			bool operator < (const ScheduledTask& r) const
+			{
+				return (executionTime == r.executionTime) ?
+					(index > r.index) : (executionTime > r.executionTime);
+			}
+		};
 		
 	private:
+		void joinPostedTasks();
+		
+	private:
+		MPSCQueue<Task, &Task::_nextPosted> _inbox;
 		CriticalSection _csModifying;
-		TaskList _tasks;
-		TaskList _tasksToAdd;
+		std::vector<ScheduledTask> _schedule;
+		std::unordered_map<TaskHandle, Task*> _pendingTasks;
+		std::vector<Task*> _dueTasks;
+		JobSystem* _jobSystem;
+		std::atomic<TaskHandle> _lastIndex;
 		float _lastTime;
 	};
-
-
-}
\ No newline at end of file
+}
@@ -8,28 +8,39 @@
 #pragma once
 
 #include <list>
+#include <et/threading/atomiccounter.h>
 
 namespace et
 {
+	/*
+	 * Identifies task posted to TaskPool, stays valid after task was executed or cancelled
+	 */
+	typedef uint64_t TaskHandle;
+	const TaskHandle InvalidTaskHandle = 0;
+
 	class Task
 	{
 	protected:
-		Task() : _executionTime(0.0f) { }
+		Task() :
+			_nextPosted(nullptr), _scheduleIndex(0), _delay(0.0f) { }
+		
 		virtual ~Task()	{ }
 
 		virtual void execute() = 0;
 
 	private:
-		float executionTime() const 
-			{ return _executionTime; }
-
-		void setExecutionTime(float t)
-			{ _executionTime = t; }
-
 		friend class TaskPool;
+		friend class JobSystemPrivate;
 
 	private:
-		float _executionTime;
+		Task* _nextPosted;
+		AtomicCounter _posted;
+		
+		/*
+		 * Assigned when task is posted, read by TaskPool only while task is not executed
+		 */
+		TaskHandle _scheduleIndex;
+		float _delay;
 	};
 	typedef std::list<Task*> TaskList;
 
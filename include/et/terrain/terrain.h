@@ -11,10 +11,13 @@
 #include <et/collision/collision.h>
 #include <et/primitives/primitives.h>
 #include <et/rendering/rendercontext.h>
+#include <et/camera/camera.h>
 #include <et/terrain/terraindata.h>
 
 namespace et
 {
+	class JobCounter;
+	class JobSystem;
 	class Terrain;
 	class TerrainChunk;
 	class TerrainLODLevels;
@@ -26,6 +29,16 @@ namespace et
 			{ return 0; };
 	};
 
+	/*
+	 * Terrain is split into chunks of the fixed size, organized into quadtree.
+	 *
+	 * Geomorphing (see setGeomorphingEnabled): Usage_TexCoord1 of each vertex contains offset
+	 * to the position on the coarser level (xyz) and index of the level, on which vertex disappears (w).
+	 * Vertex shader should do:
+	 *   vec2 range = morphRanges[int(w)];
+	 *   position += clamp((length(position - cameraPosition) - range.x) * range.y, 0.0, 1.0) * offset.xyz;
+	 * Morph factor depends only on the vertex position, so shared vertices of adjacent chunks match.
+	 */
 	class Terrain : public Shared
 	{
 	public:
@@ -39,6 +52,8 @@ namespace et
 			LodLevel_max
 		};
 
+		typedef StaticDataStorage<vec2, LodLevel_max> MorphRanges;
+
 	public:
 		Terrain(RenderContext* rc, TerrainDelegate* tDelegate);
 		~Terrain();
@@ -47,19 +62,82 @@ namespace et
 		void loadFromRAWFile(const std::string& fileName, const vec2i& dimension, TerrainData::Format format);
 		void loadFromStream(std::istream& stream, const vec2i& dimension, TerrainData::Format format);
 
+		/*
+		 * Adds 16 bytes of geomorphing data per vertex to the terrain data loaded after the call.
+		 * Data passed to loadFromData should enable it with TerrainData::setMorphDataEnabled.
+		 */
+		void setGeomorphingEnabled(bool value)
+			{ _geomorphingEnabled = value; }
+
+		/*
+		 * Lod levels and visibility are provided by delegate for each chunk
+		 */
 		void recomputeLodLevels();
+
+		/*
+		 * Quadtree is culled against camera frustum, lod level of the chunk is the coarsest one,
+		 * which projected error does not exceed maxScreenSpaceError (in pixels).
+		 * Subtrees are processed in parallel, if job system is provided.
+		 */
+		void recomputeLodLevels(const Camera& camera, float viewportHeight, JobSystem* jobSystem = nullptr);
+
+		/*
+		 * Renders only visible chunks
+		 */
 		void render(RenderContext* rc);
 
 		inline const TerrainDataRef terrainData() const
 			{ return _tdata; }
 
+		float maxScreenSpaceError() const
+			{ return _maxScreenSpaceError; }
+
+		void setMaxScreenSpaceError(float value)
+			{ _maxScreenSpaceError = value; }
+
+		/*
+		 * Start of the morph and inverse of its length for each level, updated by recomputeLodLevels
+		 */
+		const MorphRanges& morphRanges() const
+			{ return _morphRanges; }
+
+		size_t visibleChunksCount() const
+			{ return _visibleChunks.size(); }
+
 	private:
 		typedef std::vector<TerrainChunk*> TerrainChunkList;
 		typedef TerrainChunkList::iterator ChunkIterator;
 
+		struct QuadtreeNode
+		{
+			vec3 minVertex;
+			vec3 maxVertex;
+			vec2i firstChunk;
+			vec2i lastChunk;
+			uint32_t firstChild;
+			uint32_t childrenCount;
+		};
+		typedef std::vector<QuadtreeNode> QuadtreeNodeList;
+
+		struct LodSelection
+		{
+			Frustum frustum;
+			vec3 cameraPosition;
+			float distanceScale;
+		};
+
+		class LodSelectionTask;
+
 		void generateBuffer();
+		void generateMorphData();
 		void generateChunks();
 		void validateLODLevels();
+		void limitLodDifference();
+
+		void buildQuadtree(uint32_t nodeIndex, const vec2i& firstChunk, const vec2i& lastChunk);
+		void selectLodLevels(uint32_t nodeIndex, uint32_t planeMask, const LodSelection& selection,
+			size_t depth, JobSystem* jobSystem, JobCounter* counter);
+		void hideChunks(const QuadtreeNode& node);
 
 		void releaseData();
 
@@ -71,6 +149,13 @@ namespace et
 		TerrainDelegate* _delegate;
 		TerrainLODLevels* _lods;
 		TerrainChunkList _chunks;
+		TerrainChunkList _visibleChunks;
+		QuadtreeNodeList _nodes;
+
+		StaticDataStorage<float, LodLevel_max> _lodErrors;
+		MorphRanges _morphRanges;
+		float _maxScreenSpaceError;
+		bool _geomorphingEnabled;
 
 		VertexBuffer _vertexBuffer;
 		IndexBuffer _indexBuffer;
@@ -10,9 +10,12 @@
 #include <et/core/containers.h>
 #include <et/collision/collision.h>
 #include <et/vertexbuffer/vertexarray.h>
+#include <et/threading/criticalsection.h>
+#include <et/terrain/terraintiles.h>
 
 namespace et
 {
+	class JobSystem;
 	class TerrainData;
 
 	struct TerrainContact
@@ -50,9 +53,40 @@ namespace et
 	public:
 		TerrainData(TerrainDataDelegate* aDelegate);
 		TerrainData(TerrainDataDelegate* aDelegate, std::istream& stream, const vec2i& dimension, Format format);
+		~TerrainData();
 
 		void loadFromStream(std::istream& stream, const vec2i& dimension, Format format);
 
+		/*
+		 * Adds vec4 of geomorphing data (Usage_TexCoord1) to each vertex, it is filled by Terrain.
+		 * Should be enabled before loading, disabled by default.
+		 */
+		void setMorphDataEnabled(bool value)
+			{ _morphDataEnabled = value; }
+
+		bool morphDataEnabled() const
+			{ return _morphDataEnabled; }
+
+		/*
+		 * Streaming mode: heights are read from the memory-mapped tiled file (see TerrainTiles).
+		 * Positions and normals are computed for the tiles on demand and kept while total size
+		 * of the resident tiles fits memory budget, least recently used tiles are evicted.
+		 * Vertex data is not generated in this mode. Bounds are computed from the corners
+		 * of the heightfield, so delegate is expected to scale and translate vertices only.
+		 */
+		bool loadFromTiledFile(const std::string& fileName, size_t memoryBudget);
+
+		/*
+		 * Loads tiles around the point (nearest first) within the memory budget
+		 */
+		void updateStreaming(const vec3& center, float radius);
+
+		bool streaming() const
+			{ return _tiles != nullptr; }
+
+		size_t residentMemory() const
+			{ return _residentMemory; }
+
 		inline const vec2i& dimension() const 
 			{ return _dimension; }
 
@@ -71,23 +105,72 @@ namespace et
 		TerrainContact contactForSphere(const Sphere& s) const;
 		void gatherContactsForSphere(const Sphere& s, TerrainDataDelegate* contactDelegate) const;
 
+		/*
+		 * Batched queries, results are written in the order of points or spheres.
+		 * Batch is split into jobs when job system is provided. In streaming mode tiles are loaded
+		 * on demand, so the whole batch is processed on the calling thread under one lock.
+		 */
+		void heightsAtPoints(const std::vector<vec3>& points, std::vector<float>& heights,
+			JobSystem* jobSystem = nullptr) const;
+		void normalsAtPoints(const std::vector<vec3>& points, std::vector<vec3>& normals,
+			JobSystem* jobSystem = nullptr) const;
+		void contactsForSpheres(const std::vector<Sphere>& spheres, std::vector<TerrainContact>& contacts,
+			JobSystem* jobSystem = nullptr) const;
+
+		/*
+		 * Contacts of the sphere i are stored in range [firstContact[i], firstContact[i + 1])
+		 */
+		void gatherContactsForSpheres(const std::vector<Sphere>& spheres, std::vector<TerrainContact>& contacts,
+			std::vector<size_t>& firstContact, JobSystem* jobSystem = nullptr) const;
+
 	private:
+		ET_DENY_COPY(TerrainData)
+
+		struct StreamedTile
+		{
+			std::vector<vec3> positions;
+			std::vector<vec3> normals;
+			size_t lastUse;
+
+			StreamedTile() :
+				lastUse(0) { }
+		};
+
 		void generateVertexData(const FloatDataStorage& hm);
+		void releaseTiles();
 
 		triangle triangleForXZ(const vec2i& pt, int side) const;
 
 		vec2 normalizePoint(const vec3& pt) const;
 
 		vec3 normalAtNormalizedPoint(const vec2& pt) const;
-		const vec3& normalAtIndex(int index) const;
-		const vec3& normalAtXZ(const vec2i& xy) const;
+		vec3 normalAtXZ(const vec2i& xy) const;
 
 		float heightAtNormalizedPoint(const vec2& pt) const;
-		float heightAtIndex(int index) const;
 		float heightAtXZ(const vec2i& xy) const;
 
-		const vec3& positionAtIndex(int index) const;
-		const vec3& positionAtXZ(const vec2i& xy) const;
+		vec3 positionAtXZ(const vec2i& xy) const;
+
+		vec3 processedPosition(const vec2i& xy, float height) const;
+		const StreamedTile& residentTile(size_t index) const;
+		void loadTile(size_t index) const;
+
+		template <typename F>
+		void enumerateSphereContacts(const Sphere& s, F callback) const;
+		TerrainContact averageContactForSphere(const Sphere& s) const;
+
+		struct Batch;
+		class BatchTask;
+
+		void processBatch(Batch& batch, JobSystem* jobSystem) const;
+		void processBatch(Batch& batch, size_t begin, size_t end) const;
+
+		/*
+		 * Vectorized sampling of the heightfield in memory, four points at a time.
+		 * Returns index of the first point, which was not processed.
+		 */
+		size_t sampleHeights(const vec3* points, float* heights, size_t begin, size_t end) const;
+		size_t sampleNormals(const vec3* points, vec3* normals, size_t begin, size_t end) const;
 
 	private:
 		TerrainDataDelegate* _delegate;
@@ -103,6 +186,15 @@ namespace et
 		DataStorage<vec3> _normals;
 
 		VertexArray::Pointer _vertexData;
+
+		TerrainTiles* _tiles;
+		mutable std::vector<StreamedTile> _streamedTiles;
+		mutable std::vector<size_t> _residentTiles;
+		mutable CriticalSection _tilesLock;
+		mutable size_t _residentMemory;
+		mutable size_t _useCounter;
+		size_t _memoryBudget;
+		bool _morphDataEnabled;
 	};
 
 	typedef IntrusivePtr<TerrainData> TerrainDataRef;
@@ -0,0 +1,102 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/core/mappedfile.h>
+#include <et/geometry/geometry.h>
+
+namespace et
+{
+	/*
+	 * Heightfield, split into square tiles of 16-bit samples. Each tile is stored contiguously,
+	 * with tile size multiple of 64 tiles start at page boundaries and could be paged in
+	 * and discarded independently.
+	 * Tiles on the right and bottom edges are padded with the last sample.
+	 */
+	class TerrainTiles
+	{
+	public:
+		enum
+		{
+			HeaderSize = 4096,
+			DefaultTileSize = 256
+		};
+
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			int32_t width;
+			int32_t height;
+			int32_t tileSize;
+			int32_t tilesX;
+			int32_t tilesY;
+			uint16_t minSample;
+			uint16_t maxSample;
+		};
+
+		/*
+		 * Reads RAW heightmap (8 or 16 bits per sample) row by row and writes tiled file,
+		 * only one row of tiles is kept in memory.
+		 */
+		static bool convertRAW(std::istream& stream, const vec2i& dimension, bool sixteenBits,
+			const std::string& outputFile, int tileSize = DefaultTileSize);
+
+	public:
+		TerrainTiles(const std::string& fileName);
+
+		bool valid() const
+			{ return _header != nullptr; }
+
+		const vec2i& dimension() const
+			{ return _dimension; }
+
+		const vec2i& tilesCount() const
+			{ return _tilesCount; }
+
+		int tileSize() const
+			{ return _header->tileSize; }
+
+		size_t tileIndex(int x, int z) const
+			{ return static_cast<size_t>((x / _header->tileSize) + (z / _header->tileSize) * _tilesCount.x); }
+
+		/*
+		 * Heights are normalized to [0, 1]
+		 */
+		float minHeight() const
+			{ return static_cast<float>(_header->minSample) / 65535.0f; }
+
+		float maxHeight() const
+			{ return static_cast<float>(_header->maxSample) / 65535.0f; }
+
+		float heightAtXZ(int x, int z) const
+		{
+			int ts = _header->tileSize;
+			return static_cast<float>(tileSamples(tileIndex(x, z))[(x % ts) + (z % ts) * ts]) / 65535.0f;
+		}
+
+		const uint16_t* tileSamples(size_t index) const
+			{ return reinterpret_cast<const uint16_t*>(_file.data() + tileOffset(index)); }
+
+		void prefetchTile(size_t index);
+		void discardTile(size_t index);
+
+	private:
+		size_t tileDataSize() const
+			{ return static_cast<size_t>(_header->tileSize * _header->tileSize) * sizeof(uint16_t); }
+
+		size_t tileOffset(size_t index) const
+			{ return HeaderSize + index * tileDataSize(); }
+
+	private:
+		MappedFile _file;
+		const Header* _header;
+		vec2i _dimension;
+		vec2i _tilesCount;
+	};
+}
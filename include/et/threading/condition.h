@@ -0,0 +1,42 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+namespace et
+{
+	/*
+	 * Auto-reset wait condition. Notification is kept until one of the waiting
+	 * threads consumes it, so notify() followed by wait() does not block.
+	 */
+	class ConditionPrivate;
+	class Condition
+	{
+	public:
+		Condition();
+		~Condition();
+
+		void wait();
+		
+		/*
+		 * Returns false if timeout expired before notification.
+		 */
+		bool wait(float seconds);
+		
+		void notify();
+
+	private:
+		Condition(const Condition&)
+			{ }
+
+		Condition& operator = (const Condition&)
+			{ return *this; }
+
+	private:
+		ConditionPrivate* _private;
+	};
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace et
+{
+	/*
+	 * Lock-free intrusive multiple producers / single consumer queue.
+	 * Producers push items onto the atomic stack, consumer takes the whole
+	 * stack at once and receives it as a linked list in the order of pushing.
+	 * Since items are never removed one by one, queue is not prone to ABA problem.
+	 */
+	template <typename T, T* T::*next>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue() :
+			_head(nullptr) { }
+
+		void push(T* item)
+		{
+			T* head = _head.load(std::memory_order_relaxed);
+			do
+			{
+				item->*next = head;
+			}
+			while (!_head.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/*
+		 * Returns first item of the batch, items are linked using `next` member
+		 */
+		T* drain()
+		{
+			T* item = _head.exchange(nullptr, std::memory_order_acquire);
+
+			T* result = nullptr;
+			while (item != nullptr)
+			{
+				T* following = item->*next;
+				item->*next = result;
+				result = item;
+				item = following;
+			}
+
+			return result;
+		}
+
+		bool empty() const
+			{ return _head.load(std::memory_order_relaxed) == nullptr; }
+
+	private:
+		MPSCQueue(const MPSCQueue&);
+		MPSCQueue& operator = (const MPSCQueue&);
+
+	private:
+		std::atomic<T*> _head;
+	};
+}
@@ -33,7 +33,14 @@ namespace et
 		virtual ~Thread();
 
 		void run();
+		
+		/*
+		 * Resume requests are not lost: if thread was resumed before suspending
+		 * it continues immediately. Timed version returns when timeout expires.
+		 */
 		void suspend();
+		void suspend(float seconds);
+		
 		void resume();
 		void stop();
 
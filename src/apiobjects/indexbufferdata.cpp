@@ -85,3 +85,18 @@ void IndexBufferData::setData(const IndexArray::Pointer& i)
 {
 	build(i);
 }
+
+void IndexBufferData::allocateData(const IndexArray::Pointer& i)
+{
+	setProperties(i);
+	internal_setData(nullptr, i->format() * _size);
+}
+
+void IndexBufferData::setDataWithOffset(const void* data, size_t offset, size_t dataSize)
+{
+	assert(offset + dataSize <= _format * _size);
+	
+	_rs.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(dataSize), data);
+	checkOpenGLError("glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, %u, %u, 0x%08X)", offset, dataSize, data);
+}
@@ -16,6 +16,15 @@ using namespace et;
 
 StringList parseDefinesString(std::string defines, std::string separators = ",; \t");
 
+/*
+ * Looks for the file next to the program first, then in the search path
+ */
+static bool findProgramSource(const std::string& folder, const std::string& name, std::string& result)
+{
+	const AppEnvironment& env = application().environment();
+	return env.resolveFile(folder + name, result) || env.resolveFile(name, result);
+}
+
 ProgramFactory::ProgramFactory(RenderContext* rc) : APIObjectFactory(rc)
 {
 	retain();
@@ -100,8 +109,8 @@ StringList ProgramFactory::loadProgramSources(const std::string& file, std::stri
 {
 	StringList sources;
 	
-	std::string filename = application().environment().findFile(file);
-	if (!fileExists(filename))
+	std::string filename;
+	if (!application().environment().resolveFile(file, filename))
 	{
 		log::error("Unable to find file: %s", file.c_str());
 		return sources;
@@ -144,15 +153,9 @@ StringList ProgramFactory::loadProgramSources(const std::string& file, std::stri
 	normalizeFilePath(trim(fragment_source));
 	
 	std::string programFolder = getFilePath(filename);
-	std::string fName = programFolder + vertex_source;
-	
-	if (!fileExists(fName))
-		fName = application().environment().findFile(fName);
+	std::string fName;
 	
-	if (!fileExists(fName))
-		fName = application().environment().findFile(vertex_source);
-	
-	if (fileExists(fName))
+	if (findProgramSource(programFolder, vertex_source, fName))
 	{
 		sources.push_back(fName);
 		vertex_shader = loadTextFile(fName);
@@ -161,29 +164,14 @@ StringList ProgramFactory::loadProgramSources(const std::string& file, std::stri
 	
 	if (!geometry_source.empty())
 	{
-		fName = programFolder + geometry_source;
-		if (!fileExists(fName))
-			fName = application().environment().findFile(fName);
-		
-		if (!fileExists(fName))
-			fName = application().environment().findFile(geometry_source);
-		
-		if (fileExists(fName))
+		if (findProgramSource(programFolder, geometry_source, fName))
 		{
 			geom_shader = loadTextFile(fName);
 			sources.push_back(fName);
 		}
 	}
 	
-	fName = programFolder + fragment_source;
-	
-	if (!fileExists(fName))
-		fName = application().environment().findFile(fName);
-	
-	if (!fileExists(fName))
-		fName = application().environment().findFile(fragment_source);
-	
-	if (fileExists(fName))
+	if (findProgramSource(programFolder, fragment_source, fName))
 	{
 		sources.push_back(fName);
 		frag_shader = loadTextFile(fName);
@@ -322,23 +310,16 @@ void ProgramFactory::parseSourceCode(ShaderType type, std::string& source, const
 			}
 			
 			std::string include = "";
+			std::string includeFile;
 			
-			if (fileExists(workFolder + ifname))
+			if (findProgramSource(workFolder, ifname, includeFile))
 			{
-				include = loadTextFile(workFolder + ifname);
+				include = loadTextFile(includeFile);
 			}
 			else
 			{
-				ifname = application().environment().findFile(ifname);
-				if (fileExists(ifname))
-				{
-					include = loadTextFile(ifname);
-				}
-				else
-				{
-					log::error("failed to include %s, starting from folder %s",
-						ifname.c_str(), workFolder.c_str());
-				}
+				log::error("failed to include %s, starting from folder %s",
+					ifname.c_str(), workFolder.c_str());
 			}
 			
 			source = before + include + after;
@@ -51,6 +51,13 @@ TextureData::~TextureData()
 		glDeleteTextures(1, &_glID);
 }
 
+uint64_t TextureData::memoryUsage() const
+{
+	if (!_own || _desc.invalid()) return 0;
+	
+	return static_cast<uint64_t>(_desc->dataSizeForAllMipLevels()) * etMax(size_t(1), _desc->layersCount);
+}
+
 void TextureData::setWrap(RenderContext* rc, TextureWrap s, TextureWrap t, TextureWrap r)
 {
 	_wrap = vector3<TextureWrap>(s, t, r);
@@ -144,50 +151,12 @@ void TextureData::buildData(const char* aDataPtr, size_t aDataSize)
 	}
 	else
 #endif
-	if (_desc->target == GL_TEXTURE_2D)
+	if ((_desc->target == GL_TEXTURE_2D) || (_desc->target == GL_TEXTURE_CUBE_MAP))
 	{
-		for (size_t level = 0; level < _desc->mipMapCount; ++level)
-		{
-			vec2i t_mipSize = _desc->sizeForMipLevel(level);
-			GLsizei t_dataSize = static_cast<GLsizei>(_desc->dataSizeForMipLevel(level));
-			size_t t_offset = _desc->dataOffsetForMipLevel(level, 0);
-			
-			const char* ptr = (aDataPtr && (t_offset < aDataSize)) ? &aDataPtr[t_offset] : 0;
-			if (_desc->compressed && ptr)
-			{
-				etCompressedTexImage2D(_desc->target, static_cast<int>(level),
-					static_cast<uint32_t>(_desc->internalformat), t_mipSize.x, t_mipSize.y, 0, t_dataSize, ptr);
-			}
-			else
-			{
-				etTexImage2D(_desc->target, static_cast<int>(level), _desc->internalformat,
-					t_mipSize.x, t_mipSize.y, 0, _desc->format, _desc->type, ptr);
-			}
-		}
-	}
-	else if (_desc->target == GL_TEXTURE_CUBE_MAP)
-	{
-		uint32_t target = GL_TEXTURE_CUBE_MAP_POSITIVE_X;
-		
-		for (size_t layer = 0; layer < _desc->layersCount; ++layer, ++target)
+		for (size_t layer = 0; layer < layersCount(); ++layer)
 		{
 			for (size_t level = 0; level < _desc->mipMapCount; ++level)
-			{
-				vec2i t_mipSize = _desc->sizeForMipLevel(level);
-				size_t t_offset = _desc->dataOffsetForMipLevel(level, layer);
-				
-				const char* ptr = (aDataPtr && (t_offset < aDataSize)) ? &aDataPtr[t_offset] : nullptr;
-				if (_desc->compressed && (ptr != nullptr))
-				{
-					etCompressedTexImage2D(target, static_cast<int>(level), static_cast<uint32_t>(_desc->internalformat),
-						t_mipSize.x, t_mipSize.y, 0, static_cast<GLsizei>(_desc->dataSizeForMipLevel(level)), ptr);
-				}
-				else
-				{
-					etTexImage2D(target, static_cast<int>(level), _desc->internalformat, t_mipSize.x, t_mipSize.y,
-						0, _desc->format, _desc->type, ptr);
-				}
-			}
+				buildLevelData(level, layer, aDataPtr, aDataSize);
 		}
 	}
 	else
@@ -196,12 +165,38 @@ void TextureData::buildData(const char* aDataPtr, size_t aDataSize)
 	}
 }
 
-void TextureData::build(RenderContext* rc)
+void TextureData::buildLevelData(size_t level, size_t layer, const char* aDataPtr, size_t aDataSize)
+{
+	uint32_t target = (_desc->target == GL_TEXTURE_CUBE_MAP) ?
+		GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(layer) : _desc->target;
+	
+	vec2i t_mipSize = _desc->sizeForMipLevel(level);
+	size_t t_offset = _desc->dataOffsetForMipLevel(level, layer);
+	
+	const char* ptr = (aDataPtr && (t_offset < aDataSize)) ? &aDataPtr[t_offset] : nullptr;
+	if (_desc->compressed && (ptr != nullptr))
+	{
+		etCompressedTexImage2D(target, static_cast<int>(level), static_cast<uint32_t>(_desc->internalformat),
+			t_mipSize.x, t_mipSize.y, 0, static_cast<GLsizei>(_desc->dataSizeForMipLevel(level)), ptr);
+	}
+	else
+	{
+		etTexImage2D(target, static_cast<int>(level), _desc->internalformat, t_mipSize.x, t_mipSize.y,
+			0, _desc->format, _desc->type, ptr);
+	}
+}
+
+size_t TextureData::layersCount() const
+{
+	return (_desc->target == GL_TEXTURE_CUBE_MAP) ? _desc->layersCount : 1;
+}
+
+bool TextureData::buildProperties(RenderContext* rc)
 {
 	assert(_desc.valid());
 	setOrigin(_desc->origin());
 
-	if ((_desc->size.square() == 0) || (_desc->internalformat == 0) || (_desc->type == 0)) return;
+	if ((_desc->size.square() == 0) || (_desc->internalformat == 0) || (_desc->type == 0)) return false;
 
 	_texel = vec2( 1.0f / static_cast<float>(_desc->size.x), 1.0f / static_cast<float>(_desc->size.y) );
 	
@@ -217,12 +212,20 @@ void TextureData::build(RenderContext* rc)
 
 	if (_desc->mipMapCount > 1)
 		setMaxLod(rc, _desc->mipMapCount - 1);
+	
+	return true;
+}
 
-    buildData(_desc->data.constBinaryData(), _desc->data.dataSize());
-	checkOpenGLError("buildData");
+void TextureData::build(RenderContext* rc)
+{
+	if (buildProperties(rc))
+	{
+		buildData(_desc->data.constBinaryData(), _desc->data.dataSize());
+		checkOpenGLError("buildData");
+		assert(glIsTexture(_glID));
+	}
 	
-	_desc->data.resize(0);
-	assert(glIsTexture(_glID));
+	releaseData();
 }
 
 vec2 TextureData::getTexCoord(const vec2& vec, TextureOrigin origin) const
@@ -239,6 +242,58 @@ void TextureData::updateData(RenderContext* rc, TextureDescription::Pointer desc
 	build(rc);
 }
 
+bool TextureData::beginStagedUpdate(RenderContext* rc, TextureDescription::Pointer desc)
+{
+	_desc = desc;
+	generateTexture(rc);
+	
+	bool supported = (_desc->target == GL_TEXTURE_2D) || (_desc->target == GL_TEXTURE_CUBE_MAP);
+	return buildProperties(rc) && supported;
+}
+
+void TextureData::updateLevel(RenderContext* rc, size_t level, size_t layer)
+{
+	rc->renderState().bindTexture(defaultBindingUnit, _glID, _desc->target);
+	
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	buildLevelData(level, layer, _desc->data.constBinaryData(), _desc->data.dataSize());
+	checkOpenGLError("TextureData::updateLevel - %s", name().c_str());
+}
+
+void TextureData::updateLevelRows(RenderContext* rc, size_t level, size_t layer, int firstRow, int rowsCount)
+{
+	assert(!_desc->compressed);
+	
+	rc->renderState().bindTexture(defaultBindingUnit, _glID, _desc->target);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	
+	if (firstRow == 0)
+		buildLevelData(level, layer, nullptr, 0);
+	
+	vec2i mipSize = _desc->sizeForMipLevel(level);
+	size_t rowSize = _desc->dataSizeForMipLevel(level) / static_cast<size_t>(mipSize.y);
+	size_t offset = _desc->dataOffsetForMipLevel(level, layer) + static_cast<size_t>(firstRow) * rowSize;
+	
+	if (offset + static_cast<size_t>(rowsCount) * rowSize > _desc->data.dataSize()) return;
+	
+	uint32_t target = (_desc->target == GL_TEXTURE_CUBE_MAP) ?
+		GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<uint32_t>(layer) : _desc->target;
+	
+	glTexSubImage2D(target, static_cast<int>(level), 0, firstRow, mipSize.x, rowsCount,
+		_desc->format, _desc->type, _desc->data.constBinaryData() + offset);
+	checkOpenGLError("TextureData::updateLevelRows - %s", name().c_str());
+}
+
+void TextureData::endStagedUpdate()
+{
+	releaseData();
+}
+
+void TextureData::releaseData()
+{
+	_desc->data.resize(0);
+}
+
 void TextureData::updateDataDirectly(RenderContext* rc, const vec2i& size, char* data, size_t dataSize)
 {
 	if (_glID == 0)
@@ -20,21 +20,26 @@ TextureFactory::TextureFactory(RenderContext* rc) :
 	APIObjectFactory(rc)
 {
 	_loader = ObjectLoader::Pointer(this);
-	_loadingThread = new TextureLoadingThread(this);
+	
+	/*
+	 * Leave one core for the main thread
+	 */
+	size_t cores = Threading::coresCount();
+	_loadingPool = new TextureLoadingPool(this, (cores > 1) ? cores - 1 : 1);
+	
 	retain();
 }
 
 TextureFactory::~TextureFactory()
 {
-	_loadingThread->stop();
-	_loadingThread->waitForTermination();
+	_loadingPool.release();
 	
 	_loader.reset(nullptr);
 	release();
 }
 
 Texture TextureFactory::loadTexture(const std::string& fileName, ObjectsCache& cache,
-	bool async, TextureLoaderDelegate* delegate)
+	bool async, TextureLoaderDelegate* delegate, TextureLoadingPriority priority)
 {
 	if (fileName.length() == 0)
 		return Texture();
@@ -65,7 +70,7 @@ Texture TextureFactory::loadTexture(const std::string& fileName, ObjectsCache& c
 			cache.manage(texture, ObjectLoader::Pointer(this));
 			
 			if (async)
-				_loadingThread->addRequest(desc->origin(), texture, delegate);
+				_loadingPool->addRequest(desc->origin(), texture, delegate, priority);
 			else if (calledFromAnotherThread)
 				assert(false && "ERROR: Unable to load texture synchronously from non-rendering thread.");
 		}
@@ -76,10 +81,16 @@ Texture TextureFactory::loadTexture(const std::string& fileName, ObjectsCache& c
 		auto newProperty = cache.getFileProperty(file);
 		if (cachedFileProperty != newProperty)
 			reloadObject(texture, cache);
-	
-		if (async && (delegate != nullptr))
+		
+		/*
+		 * Texture could be still loading or its loading was cancelled,
+		 * in this case delegate will be notified once it's loaded
+		 */
+		bool loading = _loadingPool->joinRequest(texture, async ? delegate : nullptr, priority);
+		
+		if (!loading && async && (delegate != nullptr))
 		{
-			Invocation1 i;
+			Invocation i;
 			i.setTarget(delegate, &TextureLoaderDelegate::textureDidStartLoading, texture);
 			i.invokeInMainRunLoop();
 			i.setTarget(delegate, &TextureLoaderDelegate::textureDidLoad, texture);
@@ -155,15 +166,38 @@ Texture TextureFactory::genNoiseTexture(const vec2i& size, bool norm, const std:
 	return Texture(new TextureData(renderContext(), desc, id, false));
 }
 
+bool TextureFactory::setTextureLoadingPriority(const Texture& texture, TextureLoadingPriority priority)
+{
+	return texture.valid() && _loadingPool->setPriority(texture->origin(), priority);
+}
+
+bool TextureFactory::cancelTextureLoading(const Texture& texture)
+{
+	return texture.valid() && _loadingPool->cancelRequest(texture->origin());
+}
+
+/*
+ * Loaded data is uploaded in slices over several frames,
+ * request stays active until upload is finished, so new delegates still could join it
+ */
 void TextureFactory::textureLoadingThreadDidLoadTextureData(TextureLoadingRequest* request)
+{
+	Invocation completion;
+	completion.setTarget(this, &TextureFactory::textureDidUpload, request);
+	renderContext()->uploadQueue().uploadTexture(request->texture, request->textureDescription, completion);
+}
+
+void TextureFactory::textureDidUpload(TextureLoadingRequest* request)
 {
 	CriticalSectionScope lock(_csTextureLoading);
+	
+	std::vector<TextureLoaderDelegate*> delegates;
+	_loadingPool->finishRequest(request, delegates);
 
-	request->texture->updateData(renderContext(), request->textureDescription);
 	textureDidLoad.invoke(request->texture);
 
-	if (request->delegate)
-		request->delegate->textureDidLoad(request->texture);
+	for (auto d : delegates)
+		d->textureDidLoad(request->texture);
 
 	delete request;
 }
@@ -5,6 +5,7 @@
 *
 */
 
+#include <algorithm>
 #include <et/apiobjects/textureloadingthread.h>
 #include <et/resources/textureloader.h>
 #include <et/app/invocation.h>
@@ -13,95 +14,345 @@ using namespace et;
 
 TextureLoaderDelegate::~TextureLoaderDelegate()
 {
-	for (auto i : _requests)
-		i->discardDelegate();
+	TextureLoadingRequestList requests;
+	{
+		CriticalSectionScope lock(_csRequest);
+		requests.swap(_requests);
+	}
+
+	for (auto i : requests)
+		i->pool->discardDelegate(i, this);
 }
 
+/*
+ * Texture loading request
+ */
 TextureLoadingRequest::TextureLoadingRequest(const std::string& name, const Texture& tex,
-	TextureLoaderDelegate* d) : fileName(name), textureDescription(new TextureDescription),
-	texture(tex), delegate(d)
+	TextureLoadingPool* p, TextureLoadingPriority pr) : fileName(name), textureDescription(new TextureDescription),
+	texture(tex), pool(p), priority(pr), state(State_Queued), requestedWithoutDelegate(false), cancelled(false)
 {
-	if (delegate)
-		delegate->addTextureLoadingRequest(this);
 }
 
 TextureLoadingRequest::~TextureLoadingRequest()
 {
-	if (delegate)
-		delegate->removeTextureLoadingRequest(this);
+	for (auto d : delegates)
+		d->removeTextureLoadingRequest(this);
 }
 
-void TextureLoadingRequest::discardDelegate()
+void TextureLoadingRequest::addDelegate(TextureLoaderDelegate* d)
 {
-	delegate = nullptr;
+	if (d == nullptr)
+	{
+		requestedWithoutDelegate = true;
+	}
+	else if (std::find(delegates.begin(), delegates.end(), d) == delegates.end())
+	{
+		delegates.push_back(d);
+		d->addTextureLoadingRequest(this);
+	}
 }
 
-TextureLoadingThread::TextureLoadingThread(TextureLoadingThreadDelegate* delegate) :
-	Thread(false), _delegate(delegate), _running(false)
+void TextureLoadingRequest::discardDelegate(TextureLoaderDelegate* d)
 {
+	auto i = std::find(delegates.begin(), delegates.end(), d);
+	if (i != delegates.end())
+		delegates.erase(i);
 }
 
-TextureLoadingThread::~TextureLoadingThread()
+/*
+ * Texture loading thread
+ */
+TextureLoadingThread::TextureLoadingThread(TextureLoadingPool* pool) :
+	Thread(false), _pool(pool)
 {
-	stop();
+}
 
-	CriticalSectionScope lock(_requestsCriticalSection);
-	while (_requests.size())
+ThreadResult TextureLoadingThread::main()
+{
+	while (running())
 	{
-		delete _requests.front();
-		_requests.pop();
+		TextureLoadingRequest* req = _pool->dequeRequest();
+
+		if (req)
+			_pool->processRequest(req);
+		else
+			suspend();
 	}
+
+	return 0;
 }
 
-TextureLoadingRequest* TextureLoadingThread::dequeRequest()
+/*
+ * Texture loading pool
+ */
+TextureLoadingPool::TextureLoadingPool(TextureLoadingThreadDelegate* delegate, size_t threadsCount) :
+	_delegate(delegate), _threadsStarted(false)
 {
-	CriticalSectionScope lock(_requestsCriticalSection);
-	TextureLoadingRequest* result = 0;
+	threadsCount = std::max(size_t(1), threadsCount);
 
-	if (_requests.size()) 
+	for (size_t i = 0; i < threadsCount; ++i)
+		_threads.push_back(new TextureLoadingThread(this));
+}
+
+TextureLoadingPool::~TextureLoadingPool()
+{
+	for (auto t : _threads)
 	{
-		result = _requests.front();
-		_requests.pop();
+		if (t->running())
+		{
+			t->stop();
+			t->waitForTermination();
+		}
+		delete t;
 	}
 
-	return result;
+	/*
+	 * Decoded requests are already posted to the delegate
+	 */
+	CriticalSectionScope lock(_csRequests);
+	for (auto& i : _activeRequests)
+	{
+		if (i.second->state != TextureLoadingRequest::State_Decoded)
+			delete i.second;
+	}
 }
 
-ThreadResult TextureLoadingThread::main()
+void TextureLoadingPool::startThreads()
 {
-	while (running())
-	{
-		TextureLoadingRequest* req = dequeRequest();
+	if (_threadsStarted) return;
 
-		if (req)
+	for (auto t : _threads)
+		t->run();
+
+	_threadsStarted = true;
+}
+
+void TextureLoadingPool::wakeThread()
+{
+	/*
+	 * Resume is not lost even if thread is just about to suspend,
+	 * so one of the threads is always notified
+	 */
+	size_t index = static_cast<size_t>(_nextThread.retain()) % _threads.size();
+	_threads.at(index)->resume();
+
+	for (auto t : _threads)
+	{
+		if (t->suspended())
 		{
-			req->textureDescription = loadTexture(req->fileName);
+			t->resume();
+			break;
+		}
+	}
+}
 
-			Invocation1 invocation;
-			invocation.setTarget(_delegate,
-				&TextureLoadingThreadDelegate::textureLoadingThreadDidLoadTextureData, req);
-			invocation.invokeInMainRunLoop();
+void TextureLoadingPool::enqueue(TextureLoadingRequest* request)
+{
+	request->state = TextureLoadingRequest::State_Queued;
+	_queues[request->priority].push_back(request);
+	_activeRequests[request->fileName] = request;
+}
+
+bool TextureLoadingPool::removeFromQueue(TextureLoadingRequest* request)
+{
+	TextureLoadingRequestQueue& queue = _queues[request->priority];
+
+	auto i = std::find(queue.begin(), queue.end(), request);
+	if (i == queue.end()) return false;
+
+	queue.erase(i);
+	return true;
+}
+
+void TextureLoadingPool::addRequest(const std::string& fileName, Texture texture,
+	TextureLoaderDelegate* delegate, TextureLoadingPriority priority)
+{
+	if (delegate != nullptr)
+		delegate->textureDidStartLoading(texture);
+
+	CriticalSectionScope lock(_csRequests);
+
+	auto active = _activeRequests.find(fileName);
+	if (active != _activeRequests.end())
+	{
+		active->second->addDelegate(delegate);
+		
+		if (priority > active->second->priority)
+			changePriority(active->second, priority);
+		
+		return;
+	}
+
+	TextureLoadingRequest* request = new TextureLoadingRequest(fileName, texture, this, priority);
+	request->addDelegate(delegate);
+
+	_cancelledTextures.erase(fileName);
+	enqueue(request);
+
+	startThreads();
+	wakeThread();
+}
+
+bool TextureLoadingPool::joinRequest(Texture texture, TextureLoaderDelegate* delegate,
+	TextureLoadingPriority priority)
+{
+	std::string fileName = texture->origin();
+	{
+		CriticalSectionScope lock(_csRequests);
+
+		auto active = _activeRequests.find(fileName);
+		if (active != _activeRequests.end())
+		{
+			TextureLoadingRequest* request = active->second;
+			request->addDelegate(delegate);
+			texture = request->texture;
+			
+			if (priority > request->priority)
+				changePriority(request, priority);
 		}
 		else
 		{
-			suspend();
+			auto cancelled = _cancelledTextures.find(fileName);
+			if (cancelled == _cancelledTextures.end()) return false;
+
+			_cancelledTextures.erase(cancelled);
+
+			TextureLoadingRequest* request = new TextureLoadingRequest(fileName, texture, this, priority);
+			request->addDelegate(delegate);
+			enqueue(request);
+
+			startThreads();
+			wakeThread();
 		}
 	}
 
-	return 0;
+	if (delegate != nullptr)
+		delegate->textureDidStartLoading(texture);
+
+	return true;
 }
 
-void TextureLoadingThread::addRequest(const std::string& fileName, Texture texture,
-	TextureLoaderDelegate* delegate)
+/*
+ * Priority is only raised when request is joined, but could be lowered explicitly
+ */
+bool TextureLoadingPool::setPriority(const std::string& fileName, TextureLoadingPriority priority)
 {
-	if (delegate != nullptr)
-		delegate->textureDidStartLoading(texture);
+	CriticalSectionScope lock(_csRequests);
+
+	auto active = _activeRequests.find(fileName);
+	if (active == _activeRequests.end()) return false;
+
+	changePriority(active->second, priority);
+	return true;
+}
 
-	CriticalSectionScope lock(_requestsCriticalSection);
-	_requests.push(new TextureLoadingRequest(fileName, texture, delegate));
+void TextureLoadingPool::changePriority(TextureLoadingRequest* request, TextureLoadingPriority priority)
+{
+	if (request->priority == priority) return;
+
+	bool queued = removeFromQueue(request);
+	request->priority = priority;
+
+	if (queued)
+		_queues[priority].push_back(request);
+}
+
+bool TextureLoadingPool::cancelRequest(const std::string& fileName)
+{
+	CriticalSectionScope lock(_csRequests);
+
+	auto active = _activeRequests.find(fileName);
+	return (active != _activeRequests.end()) && cancel(active->second);
+}
 
-	if (running())
-		resume();
+bool TextureLoadingPool::cancel(TextureLoadingRequest* request)
+{
+	if (request->state == TextureLoadingRequest::State_Decoded) return false;
+
+	_activeRequests.erase(request->fileName);
+	_cancelledTextures.insert(request->fileName);
+
+	if (request->state == TextureLoadingRequest::State_Queued)
+	{
+		removeFromQueue(request);
+		delete request;
+	}
 	else
-		run();
+	{
+		/*
+		 * Request will be deleted when decoding is finished
+		 */
+		request->cancelled = true;
+	}
+
+	return true;
+}
+
+void TextureLoadingPool::discardDelegate(TextureLoadingRequest* request, TextureLoaderDelegate* delegate)
+{
+	CriticalSectionScope lock(_csRequests);
+
+	request->discardDelegate(delegate);
+
+	if (request->delegates.empty() && !request->requestedWithoutDelegate && !request->cancelled)
+		cancel(request);
+}
+
+void TextureLoadingPool::finishRequest(TextureLoadingRequest* request,
+	std::vector<TextureLoaderDelegate*>& delegates)
+{
+	CriticalSectionScope lock(_csRequests);
+
+	auto active = _activeRequests.find(request->fileName);
+	if ((active != _activeRequests.end()) && (active->second == request))
+		_activeRequests.erase(active);
+
+	_cancelledTextures.erase(request->fileName);
+	delegates = request->delegates;
+}
+
+TextureLoadingRequest* TextureLoadingPool::dequeRequest()
+{
+	CriticalSectionScope lock(_csRequests);
+
+	for (size_t p = TextureLoadingPriority_max; p > 0; --p)
+	{
+		TextureLoadingRequestQueue& queue = _queues[p - 1];
+		if (queue.size())
+		{
+			TextureLoadingRequest* result = queue.front();
+			result->state = TextureLoadingRequest::State_Decoding;
+			queue.pop_front();
+			return result;
+		}
+	}
+
+	return nullptr;
+}
+
+void TextureLoadingPool::processRequest(TextureLoadingRequest* req)
+{
+	TextureDescription::Pointer desc = loadTexture(req->fileName);
+
+	{
+		CriticalSectionScope lock(_csRequests);
+
+		if (!req->cancelled)
+		{
+			req->textureDescription = desc;
+			req->state = TextureLoadingRequest::State_Decoded;
+
+			Invocation invocation;
+			invocation.setTarget(_delegate, &TextureLoadingThreadDelegate::textureLoadingThreadDidLoadTextureData, req);
+			invocation.invokeInMainRunLoop();
+			return;
+		}
+	}
+
+	/*
+	 * Requests are only deleted in the main thread, same as delegates
+	 */
+	Invocation invocation;
+	invocation.setFunction([req]() { delete req; });
+	invocation.invokeInMainRunLoop();
 }
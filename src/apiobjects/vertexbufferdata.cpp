@@ -46,6 +46,15 @@ void VertexBufferData::setData(const void* data, size_t dataSize)
 	}
 }
 
+void VertexBufferData::setDataWithOffset(const void* data, size_t offset, size_t dataSize)
+{
+	assert(offset + dataSize <= _dataSize);
+	
+	_rs.bindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(dataSize), data);
+	checkOpenGLError("glBufferSubData(GL_ARRAY_BUFFER, %u, %u, 0x%08X)", offset, dataSize, data);
+}
+
 void VertexBufferData::serialize(std::ostream&)
 {
 	assert(false && "Unsupported");
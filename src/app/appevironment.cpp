@@ -5,6 +5,7 @@
  *
  */
 
+#include <algorithm>
 #include <et/core/filesystem.h>
 #include <et/app/application.h>
 #include <et/app/appevironment.h>
@@ -60,83 +61,168 @@ void AppEnvironment::updateDocumentsFolder(const ApplicationIdentifier& i)
 
 void AppEnvironment::addSearchPath(const std::string& path)
 {
-	_searchPath.push_back(addTrailingSlash(normalizeFilePath(path)));
+	std::string normalizedPath = addTrailingSlash(normalizeFilePath(path));
+
+	CriticalSectionScope lock(_resolvedPathsLock);
+	if (std::find(_searchPath.begin(), _searchPath.end(), normalizedPath) != _searchPath.end()) return;
+
+	_searchPath.push_back(normalizedPath);
+	clearResolvedPaths();
 }
 
 void AppEnvironment::addRelativeSearchPath(const std::string& path)
 {
-	_searchPath.push_back(addTrailingSlash(normalizeFilePath(_appPath + path)));
+	addSearchPath(_appPath + path);
 }
 
-std::string AppEnvironment::findFile(const std::string& name) const
+void AppEnvironment::invalidateResolvedPaths()
 {
-	if (fileExists(name)) return name;
+	CriticalSectionScope lock(_resolvedPathsLock);
+	clearResolvedPaths();
+}
+
+/*
+ * Should be called with the lock taken
+ */
+void AppEnvironment::clearResolvedPaths()
+{
+	_resolvedFiles.clear();
+	_resolvedFolders.clear();
+	_expandedFiles.clear();
+	_scalableFiles.clear();
+}
 
-	for (auto& i : _searchPath)
+/*
+ * Files which were not found are stored with empty path
+ */
+bool AppEnvironment::resolveFile(const std::string& name, std::string& result) const
+{
+	CriticalSectionScope lock(_resolvedPathsLock);
+
+	auto cached = _resolvedFiles.find(name);
+	if (cached == _resolvedFiles.end())
 	{
-		std::string currentName = i + name;
-		if (fileExists(currentName))
-			return currentName;
+		std::string found;
+		if (fileExists(name))
+		{
+			found = name;
+		}
+		else
+		{
+			for (auto& i : _searchPath)
+			{
+				std::string currentName = i + name;
+				if (fileExists(currentName))
+				{
+					found = currentName;
+					break;
+				}
+			}
+		}
+
+		cached = _resolvedFiles.insert(std::make_pair(name, found)).first;
 	}
 
-	return name;
+	result = cached->second.empty() ? name : cached->second;
+	return !cached->second.empty();
+}
+
+std::string AppEnvironment::findFile(const std::string& name) const
+{
+	std::string result;
+	resolveFile(name, result);
+	return result;
 }
 
 std::string AppEnvironment::findFolder(const std::string& name) const
 {
-	if (folderExists(name)) return name;
-	
-	for (auto& i : _searchPath)
+	CriticalSectionScope lock(_resolvedPathsLock);
+
+	auto cached = _resolvedFolders.find(name);
+	if (cached != _resolvedFolders.end())
+		return cached->second;
+
+	std::string result = name;
+	if (!folderExists(name))
 	{
-		std::string currentName = i + name;
-		if (folderExists(currentName))
-			return currentName;
+		for (auto& i : _searchPath)
+		{
+			std::string currentName = i + name;
+			if (folderExists(currentName))
+			{
+				result = currentName;
+				break;
+			}
+		}
 	}
-	
-	return name;	
+
+	_resolvedFolders.insert(std::make_pair(name, result));
+	return result;
 }
 
 bool AppEnvironment::expandFileName(std::string& name) const
 {
-	for (auto& i : _searchPath)
+	CriticalSectionScope lock(_resolvedPathsLock);
+
+	auto cached = _expandedFiles.find(name);
+	if (cached == _expandedFiles.end())
 	{
-		const std::string currentName = i + name;
-		if (fileExists(currentName))
+		std::string found;
+		for (auto& i : _searchPath)
 		{
-			name = currentName;
-			return true;
+			std::string currentName = i + name;
+			if (fileExists(currentName))
+			{
+				found = currentName;
+				break;
+			}
 		}
+
+		cached = _expandedFiles.insert(std::make_pair(name, found)).first;
 	}
 
-	return false;
+	if (cached->second.empty())
+		return false;
+
+	name = cached->second;
+	return true;
 }
 
 std::string AppEnvironment::resolveScalableFileName(const std::string& name, size_t scale) const
 {
 	assert(scale > 0);
-	std::string foundFile = findFile(name);
 
-	if ((foundFile.find_last_of("@") != std::string::npos) && fileExists(foundFile))
-		return foundFile;
+	std::string key = name + "\n" + intToStr(scale);
+	{
+		CriticalSectionScope lock(_resolvedPathsLock);
+		auto cached = _scalableFiles.find(key);
+		if (cached != _scalableFiles.end())
+			return cached->second;
+	}
 
-	std::string baseName = removeFileExt(foundFile);
-	std::string ext = getFileExt(foundFile);
+	std::string foundFile;
+	bool found = resolveFile(name, foundFile);
 
-	while (scale >= 1)
+	std::string result = foundFile;
+	if (!found || (foundFile.find_last_of("@") == std::string::npos))
 	{
-		std::string newFile = findFile(baseName + "@" + intToStr(scale) + "x." + ext);
-		if (fileExists(newFile))
-			return newFile;
+		std::string baseName = removeFileExt(foundFile);
+		std::string ext = getFileExt(foundFile);
 
-		if (scale == 1)
+		std::string newFile;
+		for (; scale >= 1; --scale)
 		{
-			newFile = findFile(baseName + "." + ext);
-			if (fileExists(newFile))
-				return newFile;
+			if (resolveFile(baseName + "@" + intToStr(scale) + "x." + ext, newFile) ||
+				((scale == 1) && resolveFile(baseName + "." + ext, newFile)))
+			{
+				result = newFile;
+				break;
+			}
 		}
-
-		scale -= 1;
 	}
 
-	return foundFile;
+	CriticalSectionScope lock(_resolvedPathsLock);
+	_scalableFiles.insert(std::make_pair(key, result));
+
+	return result;
 }
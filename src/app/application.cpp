@@ -60,6 +60,7 @@ int Application::run(int argc, char* argv[])
 void Application::performRendering()
 {
 	_renderContext->beginRender();
+	_renderContext->uploadQueue().process(_renderContext);
 	_delegate->render(_renderContext);
 	_renderContext->endRender();
 }
@@ -14,12 +14,25 @@ BackgroundRunLoop::BackgroundRunLoop() :
 	_owner(nullptr) { }
 
 void BackgroundRunLoop::setOwner(BackgroundThread* owner)
-	{ _owner = owner; }
+{
+	_owner = owner;
+	taskPool().setJobSystem(&owner->jobSystem());
+}
 
-void BackgroundRunLoop::addTask(Task* t, float delay)
+/*
+ * Tasks without delay are submitted to the job system immediately and could not be cancelled
+ */
+TaskHandle BackgroundRunLoop::addTask(Task* t, float delay)
 {
-	RunLoop::addTask(t, delay);
-	_owner->resume();
+	if (delay > 0.0f)
+	{
+		TaskHandle handle = RunLoop::addTask(t, delay);
+		_owner->resume();
+		return handle;
+	}
+
+	_owner->jobSystem().submit(t);
+	return InvalidTaskHandle;
 }
 
 BackgroundThread::BackgroundThread()
@@ -31,10 +44,22 @@ ThreadResult BackgroundThread::main()
 {
 	while (running())
 	{
-		if (_runLoop.hasTasks())
-			_runLoop.update(queryContiniousTimeInMilliSeconds());
+		_runLoop.update(queryContiniousTimeInMilliSeconds());
+		
+		/*
+		 * Sleep until the next delayed task is due or new task is posted
+		 */
+		float nextTaskTime = 0.0f;
+		if (_runLoop.nextTaskTime(nextTaskTime))
+		{
+			float delay = nextTaskTime - _runLoop.time();
+			if (delay > 0.0f)
+				suspend(delay);
+		}
 		else
+		{
 			suspend();
+		}
 	}
 	
 	return 0;
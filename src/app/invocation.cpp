@@ -5,98 +5,121 @@
  *
  */
 
+#include <et/threading/criticalsection.h>
 #include <et/app/invocation.h>
 #include <et/app/application.h>
 
 using namespace et;
 
-/*
- * Invocation Task
- */
-
-InvocationTask::InvocationTask(PureInvocationTarget* invocation) :
-	_invocation(invocation)
+namespace et
 {
+	/*
+	 * Blocks are never returned to the system, pool grows in chunks
+	 * and keeps freed blocks in the list for the next allocations.
+	 * Pool itself is never destroyed, since tasks could be released
+	 * by static objects during termination.
+	 */
+	class InvocationTaskPool
+	{
+	public:
+		enum
+		{
+			BlocksPerChunk = 256
+		};
+
+	public:
+		InvocationTaskPool() :
+			_freeBlocks(nullptr) { }
+
+		void* allocate();
+		void free(void*);
+
+	private:
+		union Block
+		{
+			Block* next;
+			char data[sizeof(InvocationTask)];
+			double alignDouble;
+			uint64_t alignInteger;
+		};
+
+	private:
+		CriticalSection _csModifying;
+		Block* _freeBlocks;
+	};
+
+	InvocationTaskPool& invocationTaskPool()
+	{
+		static InvocationTaskPool* pool = new InvocationTaskPool;
+		return *pool;
+	}
 }
 
-InvocationTask::~InvocationTask()
+void* InvocationTaskPool::allocate()
 {
-	delete _invocation; 
-}
+	CriticalSectionScope lock(_csModifying);
 
-void InvocationTask::execute() 
-{
-	_invocation->invoke(); 
-}
+	if (_freeBlocks == nullptr)
+	{
+		Block* chunk = new Block[BlocksPerChunk];
+		for (size_t i = 0; i + 1 < BlocksPerChunk; ++i)
+			chunk[i].next = chunk + i + 1;
 
-/*
- * Invocation (0)
- */
+		chunk[BlocksPerChunk - 1].next = nullptr;
+		_freeBlocks = chunk;
+	}
 
-void Invocation::invoke()
-{
-	_target->invoke();	 
-}
-
-void Invocation::invokeInMainRunLoop(float delay)
-{
-	invokeInRunLoop(mainRunLoop(), delay);
+	Block* result = _freeBlocks;
+	_freeBlocks = result->next;
+	return result;
 }
 
-void Invocation::invokeInBackground(float delay)
+void InvocationTaskPool::free(void* ptr)
 {
-	invokeInRunLoop(backgroundRunLoop(), delay);
-}
+	CriticalSectionScope lock(_csModifying);
 
-void Invocation::invokeInRunLoop(RunLoop& rl, float delay)
-{
-	rl.addTask(new InvocationTask(_target->copy()), delay);
+	Block* block = static_cast<Block*>(ptr);
+	block->next = _freeBlocks;
+	_freeBlocks = block;
 }
 
 /*
- * Invocation (1)
+ * Invocation Task
  */
 
-void Invocation1::invoke()
-{ 
-	_target->invoke();	 
-}
-
-void Invocation1::invokeInMainRunLoop(float delay)
+void* InvocationTask::operator new(size_t size)
 {
-	invokeInRunLoop(mainRunLoop(), delay);
+	assert(size == sizeof(InvocationTask));
+	return invocationTaskPool().allocate();
 }
 
-void Invocation1::invokeInBackground(float delay)
+void InvocationTask::operator delete(void* ptr)
 {
-	invokeInRunLoop(backgroundRunLoop(), delay);
-}
-
-void Invocation1::invokeInRunLoop(RunLoop& rl, float delay)
-{
-	rl.addTask(new InvocationTask(_target->copy()), delay);
+	if (ptr != nullptr)
+		invocationTaskPool().free(ptr);
 }
 
 /*
- * Invocation (2)
+ * Invocation
  */
 
-void Invocation2::invoke()
-{ 
-	_target->invoke();	 
+void Invocation::invoke()
+{
+	_storage.invoke();
 }
 
-void Invocation2::invokeInMainRunLoop(float delay)
+void Invocation::invokeInMainRunLoop(float delay)
 {
 	invokeInRunLoop(mainRunLoop(), delay);
 }
 
-void Invocation2::invokeInBackground(float delay)
+void Invocation::invokeInBackground(float delay)
 {
 	invokeInRunLoop(backgroundRunLoop(), delay);
 }
 
-void Invocation2::invokeInRunLoop(RunLoop& rl, float delay)
+void Invocation::invokeInRunLoop(RunLoop& rl, float delay)
 {
-	rl.addTask(new InvocationTask(_target->copy()), delay);
+	assert(_storage.valid());
+	rl.addTask(new InvocationTask(std::move(_storage)), delay);
 }
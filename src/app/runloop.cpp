@@ -29,9 +29,9 @@ void RunLoop::update(uint64_t t)
 	}
 }
 
-void RunLoop::addTask(Task* t, float delay)
+TaskHandle RunLoop::addTask(Task* t, float delay)
 {
-	_taskPool.addTask(t, delay);
+	return _taskPool.addTask(t, delay);
 }
 
 void RunLoop::attachTimerPool(TimerPool::Pointer pool)
@@ -5,13 +5,130 @@
  *
  */
 
+#include <et/geometry/simd.h>
 #include <et/camera/frustum.h>
 
 using namespace et;
 
-inline FrustumPlane operator ++(FrustumPlane p)
-	{ return static_cast<FrustumPlane>(p + 1); }
+namespace
+{
+	const int bitsCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+	inline FrustumPlane& operator ++(FrustumPlane& p)
+		{ return p = static_cast<FrustumPlane>(p + 1); }
+
+	inline void resizeArrays(size_t size, std::vector<float>* arrays[], size_t count)
+	{
+		size_t paddedSize = (size + 3) & ~size_t(3);
+		for (size_t i = 0; i < count; ++i)
+			arrays[i]->resize(paddedSize, 0.0f);
+	}
+
+	inline void reserveArrays(size_t size, std::vector<float>* arrays[], size_t count)
+	{
+		size_t paddedSize = (size + 3) & ~size_t(3);
+		for (size_t i = 0; i < count; ++i)
+			arrays[i]->reserve(paddedSize);
+	}
+
+	/*
+	 * Distance from the plane to the farthest point of the box (p-vertex)
+	 */
+	inline float boxDistance(const vec4& plane, const vec3& center, const vec3& dimension)
+	{
+		return plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w +
+			std::abs(plane.x) * dimension.x + std::abs(plane.y) * dimension.y + std::abs(plane.z) * dimension.z;
+	}
+
+	/*
+	 * Mask covers four objects starting from index, all of them are in the same word
+	 */
+	inline size_t writeMask(VisibilityMask& mask, size_t index, int lanes)
+	{
+		mask[index / 32] |= static_cast<uint32_t>(lanes) << (index % 32);
+		return static_cast<size_t>(bitsCount[lanes]);
+	}
+
+	inline int tailLanes(size_t index, size_t end)
+		{ return (end - index < 4) ? (1 << (end - index)) - 1 : 0x0f; }
+
+	inline void clearMaskRange(VisibilityMask& mask, size_t begin, size_t end)
+	{
+		assert((begin % 32) == 0);
+		assert(mask.size() * 32 >= end);
+
+		for (size_t w = begin / 32, e = (end + 31) / 32; w < e; ++w)
+			mask[w] = 0;
+	}
+}
+
+/*
+ * AABBArray
+ */
+void AABBArray::reserve(size_t count)
+{
+	std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &dimensionX, &dimensionY, &dimensionZ };
+	reserveArrays(count, arrays, 6);
+}
+
+void AABBArray::push_back(const AABB& aabb)
+{
+	if (_size == centerX.size())
+	{
+		std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &dimensionX, &dimensionY, &dimensionZ };
+		resizeArrays(_size + 1, arrays, 6);
+	}
 
+	centerX[_size] = aabb.center.x;
+	centerY[_size] = aabb.center.y;
+	centerZ[_size] = aabb.center.z;
+	dimensionX[_size] = aabb.dimension.x;
+	dimensionY[_size] = aabb.dimension.y;
+	dimensionZ[_size] = aabb.dimension.z;
+	++_size;
+}
+
+void AABBArray::clear()
+{
+	std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &dimensionX, &dimensionY, &dimensionZ };
+	resizeArrays(0, arrays, 6);
+	_size = 0;
+}
+
+/*
+ * SphereArray
+ */
+void SphereArray::reserve(size_t count)
+{
+	std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &radius };
+	reserveArrays(count, arrays, 4);
+}
+
+void SphereArray::push_back(const Sphere& sphere)
+{
+	if (_size == centerX.size())
+	{
+		std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &radius };
+		resizeArrays(_size + 1, arrays, 4);
+	}
+
+	centerX[_size] = sphere.center().x;
+	centerY[_size] = sphere.center().y;
+	centerZ[_size] = sphere.center().z;
+	radius[_size] = sphere.radius();
+	++_size;
+}
+
+void SphereArray::clear()
+{
+	std::vector<float>* arrays[] = { &centerX, &centerY, &centerZ, &radius };
+	resizeArrays(0, arrays, 4);
+	_size = 0;
+}
+
+/*
+ * Frustum
+ */
 Frustum::Frustum()
 {
 }
@@ -41,24 +158,197 @@ bool Frustum::containAABB(const AABB& aabb) const
 {
 	for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
 	{
-		const vec4 plane = _data[p];
+		if (boxDistance(_data[p], aabb.center, aabb.dimension) <= 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Rows of the OBB transform are axes of the box in world space
+ */
+bool Frustum::containOBB(const OBB& obb) const
+{
+	for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+	{
+		const vec4& plane = _data[p];
+		vec3 normal = plane.xyz();
 
-		if (aabb.corners[0].dot(plane) > 0) continue;
-		if (aabb.corners[1].dot(plane) > 0) continue;
-		if (aabb.corners[2].dot(plane) > 0) continue;
-		if (aabb.corners[3].dot(plane) > 0) continue;
-		if (aabb.corners[4].dot(plane) > 0) continue;
-		if (aabb.corners[5].dot(plane) > 0) continue;
-		if (aabb.corners[6].dot(plane) > 0) continue;
-		if (aabb.corners[7].dot(plane) > 0) continue;
+		float distance = dot(normal, obb.center) + plane.w +
+			obb.dimension.x * std::abs(dot(normal, obb.transform[0])) +
+			obb.dimension.y * std::abs(dot(normal, obb.transform[1])) +
+			obb.dimension.z * std::abs(dot(normal, obb.transform[2]));
 
-		return false;
+		if (distance <= 0.0f)
+			return false;
 	}
 
 	return true;
 }
 
-bool Frustum::containOBB(const OBB&) const
+size_t Frustum::cullAABBs(const AABBArray& boxes, VisibilityMask& mask) const
+{
+	mask.resize((boxes.size() + 31) / 32);
+	return cullAABBs(boxes, mask, 0, boxes.size());
+}
+
+size_t Frustum::cullSpheres(const SphereArray& spheres, VisibilityMask& mask) const
+{
+	mask.resize((spheres.size() + 31) / 32);
+	return cullSpheres(spheres, mask, 0, spheres.size());
+}
+
+#if (ET_SIMD)
+
+size_t Frustum::cullAABBs(const AABBArray& boxes, VisibilityMask& mask, size_t begin, size_t end) const
+{
+	clearMaskRange(mask, begin, end);
+
+	simd::float4 nx[FrustumPlane_max];
+	simd::float4 ny[FrustumPlane_max];
+	simd::float4 nz[FrustumPlane_max];
+	simd::float4 d[FrustumPlane_max];
+	simd::float4 ax[FrustumPlane_max];
+	simd::float4 ay[FrustumPlane_max];
+	simd::float4 az[FrustumPlane_max];
+
+	for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+	{
+		nx[p] = simd::splat(_data[p].x);
+		ny[p] = simd::splat(_data[p].y);
+		nz[p] = simd::splat(_data[p].z);
+		d[p] = simd::splat(_data[p].w);
+		ax[p] = simd::abs(nx[p]);
+		ay[p] = simd::abs(ny[p]);
+		az[p] = simd::abs(nz[p]);
+	}
+
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i += 4)
+	{
+		simd::float4 cx = simd::load(boxes.centerX.data() + i);
+		simd::float4 cy = simd::load(boxes.centerY.data() + i);
+		simd::float4 cz = simd::load(boxes.centerZ.data() + i);
+		simd::float4 ex = simd::load(boxes.dimensionX.data() + i);
+		simd::float4 ey = simd::load(boxes.dimensionY.data() + i);
+		simd::float4 ez = simd::load(boxes.dimensionZ.data() + i);
+
+		int lanes = tailLanes(i, end);
+		for (int p = 0; (p < FrustumPlane_max) && (lanes != 0); ++p)
+		{
+			simd::float4 distance = simd::add(simd::add(simd::mul(nx[p], cx), simd::mul(ny[p], cy)),
+				simd::add(simd::mul(nz[p], cz), d[p]));
+			simd::float4 extent = simd::add(simd::add(simd::mul(ax[p], ex), simd::mul(ay[p], ey)),
+				simd::mul(az[p], ez));
+			lanes &= simd::positiveMask(simd::add(distance, extent));
+		}
+
+		visible += writeMask(mask, i, lanes);
+	}
+
+	return visible;
+}
+
+size_t Frustum::cullSpheres(const SphereArray& spheres, VisibilityMask& mask, size_t begin, size_t end) const
+{
+	clearMaskRange(mask, begin, end);
+
+	simd::float4 nx[FrustumPlane_max];
+	simd::float4 ny[FrustumPlane_max];
+	simd::float4 nz[FrustumPlane_max];
+	simd::float4 d[FrustumPlane_max];
+
+	for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+	{
+		nx[p] = simd::splat(_data[p].x);
+		ny[p] = simd::splat(_data[p].y);
+		nz[p] = simd::splat(_data[p].z);
+		d[p] = simd::splat(_data[p].w);
+	}
+
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i += 4)
+	{
+		simd::float4 cx = simd::load(spheres.centerX.data() + i);
+		simd::float4 cy = simd::load(spheres.centerY.data() + i);
+		simd::float4 cz = simd::load(spheres.centerZ.data() + i);
+		simd::float4 r = simd::load(spheres.radius.data() + i);
+
+		int lanes = tailLanes(i, end);
+		for (int p = 0; (p < FrustumPlane_max) && (lanes != 0); ++p)
+		{
+			simd::float4 distance = simd::add(simd::add(simd::mul(nx[p], cx), simd::mul(ny[p], cy)),
+				simd::add(simd::mul(nz[p], cz), d[p]));
+			lanes &= simd::positiveMask(simd::add(distance, r));
+		}
+
+		visible += writeMask(mask, i, lanes);
+	}
+
+	return visible;
+}
+
+#else
+
+size_t Frustum::cullAABBs(const AABBArray& boxes, VisibilityMask& mask, size_t begin, size_t end) const
 {
-	return false;
-}
\ No newline at end of file
+	clearMaskRange(mask, begin, end);
+
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i += 4)
+	{
+		int lanes = tailLanes(i, end);
+		for (int l = 0; l < 4; ++l)
+		{
+			if ((lanes & (1 << l)) == 0) continue;
+
+			vec3 center(boxes.centerX[i + l], boxes.centerY[i + l], boxes.centerZ[i + l]);
+			vec3 dimension(boxes.dimensionX[i + l], boxes.dimensionY[i + l], boxes.dimensionZ[i + l]);
+
+			for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+			{
+				if (boxDistance(_data[p], center, dimension) <= 0.0f)
+				{
+					lanes &= ~(1 << l);
+					break;
+				}
+			}
+		}
+
+		visible += writeMask(mask, i, lanes);
+	}
+
+	return visible;
+}
+
+size_t Frustum::cullSpheres(const SphereArray& spheres, VisibilityMask& mask, size_t begin, size_t end) const
+{
+	clearMaskRange(mask, begin, end);
+
+	size_t visible = 0;
+	for (size_t i = begin; i < end; i += 4)
+	{
+		int lanes = tailLanes(i, end);
+		for (int l = 0; l < 4; ++l)
+		{
+			if ((lanes & (1 << l)) == 0) continue;
+
+			vec4 center(spheres.centerX[i + l], spheres.centerY[i + l], spheres.centerZ[i + l], 1.0f);
+			for (FrustumPlane p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+			{
+				if (_data[p].dot(center) + spheres.radius[i + l] <= 0.0f)
+				{
+					lanes &= ~(1 << l);
+					break;
+				}
+			}
+		}
+
+		visible += writeMask(mask, i, lanes);
+	}
+
+	return visible;
+}
+
+#endif
@@ -0,0 +1,328 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/collision/broadphase.h>
+
+using namespace et;
+
+namespace
+{
+	const float axisSwitchThreshold = 1.25f;
+	const int maxCellsPerProxy = 64;
+	const size_t minHashTableSize = 64;
+
+	inline vec3 obbExtent(const OBB& obb)
+	{
+		return absv(obb.transform[0]) * obb.dimension.x + absv(obb.transform[1]) * obb.dimension.y +
+			absv(obb.transform[2]) * obb.dimension.z;
+	}
+
+	inline uint32_t cellHash(const vec3i& c)
+	{
+		return (static_cast<uint32_t>(c.x) * 73856093u) ^ (static_cast<uint32_t>(c.y) * 19349663u) ^
+			(static_cast<uint32_t>(c.z) * 83492791u);
+	}
+}
+
+/*
+ * Broadphase
+ */
+Broadphase::Broadphase() :
+	_proxiesCount(0)
+{
+}
+
+BroadphaseProxy Broadphase::addProxy(const AABB& aabb, void* userData)
+	{ return addProxy(aabb.center, aabb.dimension, userData); }
+
+BroadphaseProxy Broadphase::addProxy(const Sphere& sphere, void* userData)
+	{ return addProxy(sphere.center(), vec3(sphere.radius()), userData); }
+
+BroadphaseProxy Broadphase::addProxy(const OBB& obb, void* userData)
+	{ return addProxy(obb.center, obbExtent(obb), userData); }
+
+void Broadphase::moveProxy(BroadphaseProxy proxy, const AABB& aabb)
+	{ moveProxy(proxy, aabb.center, aabb.dimension); }
+
+void Broadphase::moveProxy(BroadphaseProxy proxy, const Sphere& sphere)
+	{ moveProxy(proxy, sphere.center(), vec3(sphere.radius())); }
+
+void Broadphase::moveProxy(BroadphaseProxy proxy, const OBB& obb)
+	{ moveProxy(proxy, obb.center, obbExtent(obb)); }
+
+BroadphaseProxy Broadphase::addProxy(const vec3& center, const vec3& extent, void* userData)
+{
+	BroadphaseProxy result = static_cast<BroadphaseProxy>(_proxies.size());
+	if (_freeProxies.empty())
+	{
+		_proxies.push_back(Proxy());
+	}
+	else
+	{
+		result = _freeProxies.back();
+		_freeProxies.pop_back();
+	}
+
+	Proxy& p = _proxies[result];
+	p.minVertex = center - extent;
+	p.maxVertex = center + extent;
+	p.userData = userData;
+	p.active = true;
+	++_proxiesCount;
+
+	proxyAdded(result);
+	return result;
+}
+
+void Broadphase::moveProxy(BroadphaseProxy proxy, const vec3& center, const vec3& extent)
+{
+	Proxy& p = _proxies.at(proxy);
+	assert(p.active);
+
+	p.minVertex = center - extent;
+	p.maxVertex = center + extent;
+}
+
+void Broadphase::removeProxy(BroadphaseProxy proxy)
+{
+	Proxy& p = _proxies.at(proxy);
+	if (!p.active) return;
+
+	proxyRemoved(proxy);
+
+	p.active = false;
+	p.userData = nullptr;
+	_freeProxies.push_back(proxy);
+	--_proxiesCount;
+}
+
+void Broadphase::clear()
+{
+	for (BroadphaseProxy i = 0, e = static_cast<BroadphaseProxy>(_proxies.size()); i < e; ++i)
+		removeProxy(i);
+}
+
+/*
+ * SweepAndPrune
+ */
+SweepAndPrune::SweepAndPrune() :
+	_axis(0)
+{
+}
+
+void SweepAndPrune::proxyAdded(BroadphaseProxy proxy)
+{
+	if (_entryOfProxy.size() <= proxy)
+		_entryOfProxy.resize(proxy + 1, 0);
+
+	Entry e;
+	e.proxy = proxy;
+	_entryOfProxy[proxy] = static_cast<uint32_t>(_entries.size());
+	_entries.push_back(e);
+}
+
+void SweepAndPrune::proxyRemoved(BroadphaseProxy proxy)
+{
+	_entries[_entryOfProxy.at(proxy)].proxy = InvalidBroadphaseProxy;
+}
+
+int SweepAndPrune::selectAxis() const
+{
+	if (_entries.empty()) return _axis;
+
+	vec3 sum;
+	vec3 sumSquared;
+	for (const Entry& e : _entries)
+	{
+		vec3 center = e.minVertex + e.maxVertex;
+		sum += center;
+		sumSquared += center * center;
+	}
+
+	vec3 variance = sumSquared - sum * sum / static_cast<float>(_entries.size());
+	int axis = (variance.x > variance.y) ? ((variance.x > variance.z) ? 0 : 2) : ((variance.y > variance.z) ? 1 : 2);
+
+	return (variance[axis] > axisSwitchThreshold * variance[_axis]) ? axis : _axis;
+}
+
+/*
+ * Removed entries are dropped, bounds are copied from proxies to keep the sweep in contiguous memory
+ */
+void SweepAndPrune::updateEntries()
+{
+	const ProxyList& p = proxies();
+
+	size_t count = 0;
+	for (size_t i = 0, e = _entries.size(); i < e; ++i)
+	{
+		Entry& entry = _entries[i];
+		if (entry.proxy == InvalidBroadphaseProxy) continue;
+
+		entry.minVertex = p[entry.proxy].minVertex;
+		entry.maxVertex = p[entry.proxy].maxVertex;
+		_entries[count++] = entry;
+	}
+	_entries.resize(count);
+
+	int axis = selectAxis();
+	if (axis != _axis)
+	{
+		_axis = axis;
+		std::sort(_entries.begin(), _entries.end(), [axis](const Entry& a, const Entry& b)
+			{ return a.minVertex[axis] < b.minVertex[axis]; });
+	}
+	else
+	{
+		for (size_t i = 1; i < count; ++i)
+		{
+			Entry entry = _entries[i];
+			float value = entry.minVertex[axis];
+
+			size_t j = i;
+			while ((j > 0) && (_entries[j - 1].minVertex[axis] > value))
+			{
+				_entries[j] = _entries[j - 1];
+				--j;
+			}
+
+			if (j != i)
+				_entries[j] = entry;
+		}
+	}
+
+	for (size_t i = 0; i < count; ++i)
+		_entryOfProxy[_entries[i].proxy] = static_cast<uint32_t>(i);
+}
+
+void SweepAndPrune::findOverlappingPairs(BroadphasePairList& pairs)
+{
+	updateEntries();
+
+	int axis = _axis;
+	int axis1 = (axis + 1) % 3;
+	int axis2 = (axis + 2) % 3;
+
+	for (size_t i = 0, e = _entries.size(); i < e; ++i)
+	{
+		const Entry& a = _entries[i];
+		float maxValue = a.maxVertex[axis];
+
+		for (size_t j = i + 1; (j < e) && (_entries[j].minVertex[axis] <= maxValue); ++j)
+		{
+			const Entry& b = _entries[j];
+			if ((a.minVertex[axis1] <= b.maxVertex[axis1]) && (a.maxVertex[axis1] >= b.minVertex[axis1]) &&
+				(a.minVertex[axis2] <= b.maxVertex[axis2]) && (a.maxVertex[axis2] >= b.minVertex[axis2]))
+			{
+				pairs.push_back(BroadphasePair(a.proxy, b.proxy));
+			}
+		}
+	}
+}
+
+/*
+ * UniformGrid
+ */
+UniformGrid::UniformGrid(float cellSize) :
+	_cellSize(cellSize)
+{
+}
+
+vec3i UniformGrid::cellForPoint(const vec3& p) const
+{
+	return vec3i(static_cast<int>(std::floor(p.x / _cellSize)), static_cast<int>(std::floor(p.y / _cellSize)),
+		static_cast<int>(std::floor(p.z / _cellSize)));
+}
+
+void UniformGrid::findOverlappingPairs(BroadphasePairList& pairs)
+{
+	const ProxyList& p = proxies();
+
+	_entries.clear();
+	_largeProxies.clear();
+
+	for (BroadphaseProxy i = 0, e = static_cast<BroadphaseProxy>(p.size()); i < e; ++i)
+	{
+		if (!p[i].active) continue;
+
+		vec3i c0 = cellForPoint(p[i].minVertex);
+		vec3i c1 = cellForPoint(p[i].maxVertex);
+		vec3i cells = c1 - c0 + vec3i(1);
+
+		if (static_cast<int64_t>(cells.x) * static_cast<int64_t>(cells.y) * static_cast<int64_t>(cells.z) > maxCellsPerProxy)
+		{
+			_largeProxies.push_back(i);
+			continue;
+		}
+
+		CellEntry entry;
+		entry.proxy = i;
+		for (entry.cell.z = c0.z; entry.cell.z <= c1.z; ++entry.cell.z)
+		{
+			for (entry.cell.y = c0.y; entry.cell.y <= c1.y; ++entry.cell.y)
+			{
+				for (entry.cell.x = c0.x; entry.cell.x <= c1.x; ++entry.cell.x)
+					_entries.push_back(entry);
+			}
+		}
+	}
+
+	/*
+	 * Counting sort of entries by hash table buckets
+	 */
+	size_t tableSize = minHashTableSize;
+	while (tableSize < 2 * _entries.size())
+		tableSize *= 2;
+
+	uint32_t mask = static_cast<uint32_t>(tableSize - 1);
+	_buckets.assign(tableSize + 1, 0);
+
+	for (const CellEntry& entry : _entries)
+		_buckets[(cellHash(entry.cell) & mask) + 1]++;
+
+	for (size_t i = 1; i <= tableSize; ++i)
+		_buckets[i] += _buckets[i - 1];
+
+	_sortedEntries.resize(_entries.size());
+	for (const CellEntry& entry : _entries)
+		_sortedEntries[_buckets[cellHash(entry.cell) & mask]++] = entry;
+
+	/*
+	 * After placement each bucket's counter points to the beginning of the next one
+	 */
+	for (size_t bucket = 0, begin = 0; bucket < tableSize; ++bucket)
+	{
+		size_t end = _buckets[bucket];
+		for (size_t i = begin; i < end; ++i)
+		{
+			const CellEntry& a = _sortedEntries[i];
+			const Proxy& pa = p[a.proxy];
+
+			for (size_t j = i + 1; j < end; ++j)
+			{
+				const CellEntry& b = _sortedEntries[j];
+				if ((a.cell != b.cell) || !overlaps(pa, p[b.proxy])) continue;
+
+				vec3i firstShared = maxv(cellForPoint(pa.minVertex), cellForPoint(p[b.proxy].minVertex));
+				if (firstShared == a.cell)
+					pairs.push_back(BroadphasePair(a.proxy, b.proxy));
+			}
+		}
+		begin = end;
+	}
+
+	for (BroadphaseProxy large : _largeProxies)
+	{
+		for (BroadphaseProxy i = 0, e = static_cast<BroadphaseProxy>(p.size()); i < e; ++i)
+		{
+			if ((i == large) || !p[i].active || !overlaps(p[large], p[i])) continue;
+
+			if ((i > large) || !std::binary_search(_largeProxies.begin(), _largeProxies.end(), i))
+				pairs.push_back(BroadphasePair(large, i));
+		}
+	}
+}
@@ -0,0 +1,418 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/core/serialization.h>
+#include <et/collision/trianglebvh.h>
+
+using namespace et;
+
+namespace
+{
+	const size_t binsCount = 16;
+	const float traversalCost = 1.0f;
+	const float intersectionCost = 1.0f;
+
+	struct Bounds
+	{
+		vec3 minVertex;
+		vec3 maxVertex;
+
+		Bounds() :
+			minVertex(std::numeric_limits<float>::max()), maxVertex(-std::numeric_limits<float>::max()) { }
+
+		void add(const vec3& p)
+		{
+			minVertex = minv(minVertex, p);
+			maxVertex = maxv(maxVertex, p);
+		}
+
+		void add(const Bounds& b)
+		{
+			minVertex = minv(minVertex, b.minVertex);
+			maxVertex = maxv(maxVertex, b.maxVertex);
+		}
+
+		float area() const
+		{
+			vec3 d = maxv(maxVertex - minVertex, vec3(0.0f));
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+	};
+
+	inline bool nodeIntersectsBox(const TriangleBVH::Node& node, const vec3& minVertex, const vec3& maxVertex)
+	{
+		return (node.minVertex.x <= maxVertex.x) && (node.maxVertex.x >= minVertex.x) &&
+			(node.minVertex.y <= maxVertex.y) && (node.maxVertex.y >= minVertex.y) &&
+			(node.minVertex.z <= maxVertex.z) && (node.maxVertex.z >= minVertex.z);
+	}
+
+}
+
+vec3 TriangleBVH::inverseDirection(const vec3& d)
+{
+	const float eps = std::numeric_limits<float>::epsilon();
+	const float large = std::numeric_limits<float>::max();
+
+	return vec3((std::abs(d.x) > eps) ? 1.0f / d.x : large, (std::abs(d.y) > eps) ? 1.0f / d.y : large,
+		(std::abs(d.z) > eps) ? 1.0f / d.z : large);
+}
+
+struct TriangleBVH::BuildItem
+{
+	Bounds bounds;
+	vec3 center;
+	uint32_t index;
+};
+
+void TriangleBVH::clear()
+{
+	_nodes.clear();
+	_indices.clear();
+}
+
+void TriangleBVH::build(const triangle* triangles, size_t triangleCount)
+{
+	clear();
+	if (triangleCount == 0) return;
+
+	std::vector<BuildItem> items(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const triangle& t = triangles[i];
+		BuildItem& item = items[i];
+		item.bounds.add(t.v1());
+		item.bounds.add(t.v2());
+		item.bounds.add(t.v3());
+		item.center = 0.5f * (item.bounds.minVertex + item.bounds.maxVertex);
+		item.index = static_cast<uint32_t>(i);
+	}
+
+	_nodes.reserve(2 * triangleCount / MaxTrianglesInLeaf + 1);
+	_indices.reserve(triangleCount);
+
+	buildNode(items, 0, triangleCount, 0);
+}
+
+/*
+ * Binned SAH split along the longest axis of centers bounds
+ */
+uint32_t TriangleBVH::buildNode(std::vector<BuildItem>& items, size_t begin, size_t end, size_t depth)
+{
+	uint32_t nodeIndex = static_cast<uint32_t>(_nodes.size());
+	_nodes.push_back(Node());
+
+	Bounds bounds;
+	Bounds centers;
+	for (size_t i = begin; i < end; ++i)
+	{
+		bounds.add(items[i].bounds);
+		centers.add(items[i].center);
+	}
+
+	_nodes[nodeIndex].minVertex = bounds.minVertex;
+	_nodes[nodeIndex].maxVertex = bounds.maxVertex;
+
+	size_t count = end - begin;
+	vec3 extent = centers.maxVertex - centers.minVertex;
+	int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+
+	size_t splitBin = 0;
+	if ((count > MaxTrianglesInLeaf) && (depth + 1 < MaxDepth) && (extent[axis] > 0.0f))
+	{
+		Bounds binBounds[binsCount];
+		size_t binCounts[binsCount] = { };
+		float binScale = static_cast<float>(binsCount) * (1.0f - std::numeric_limits<float>::epsilon()) / extent[axis];
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			size_t bin = etMin(binsCount - 1,
+				static_cast<size_t>((items[i].center[axis] - centers.minVertex[axis]) * binScale));
+			binBounds[bin].add(items[i].bounds);
+			binCounts[bin]++;
+		}
+
+		float rightAreas[binsCount] = { };
+		size_t rightCounts[binsCount] = { };
+		Bounds accumulated;
+		size_t accumulatedCount = 0;
+		for (size_t i = binsCount - 1; i > 0; --i)
+		{
+			accumulated.add(binBounds[i]);
+			accumulatedCount += binCounts[i];
+			rightAreas[i] = accumulated.area();
+			rightCounts[i] = accumulatedCount;
+		}
+
+		float bestCost = intersectionCost * static_cast<float>(count);
+		float invArea = 1.0f / etMax(bounds.area(), std::numeric_limits<float>::epsilon());
+
+		accumulated = Bounds();
+		accumulatedCount = 0;
+		for (size_t i = 1; i < binsCount; ++i)
+		{
+			accumulated.add(binBounds[i - 1]);
+			accumulatedCount += binCounts[i - 1];
+			if ((accumulatedCount == 0) || (rightCounts[i] == 0)) continue;
+
+			float cost = traversalCost + intersectionCost * invArea * (accumulated.area() *
+				static_cast<float>(accumulatedCount) + rightAreas[i] * static_cast<float>(rightCounts[i]));
+
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				splitBin = i;
+			}
+		}
+
+		if (splitBin > 0)
+		{
+			float splitPosition = centers.minVertex[axis] + static_cast<float>(splitBin) / binScale;
+			auto middle = std::partition(items.begin() + static_cast<std::ptrdiff_t>(begin),
+				items.begin() + static_cast<std::ptrdiff_t>(end), [axis, splitPosition](const BuildItem& item)
+				{ return item.center[axis] < splitPosition; });
+
+			size_t split = static_cast<size_t>(middle - items.begin());
+			if ((split == begin) || (split == end))
+				splitBin = 0;
+			else
+			{
+				buildNode(items, begin, split, depth + 1);
+				uint32_t secondChild = buildNode(items, split, end, depth + 1);
+				_nodes[nodeIndex].offset = secondChild;
+				_nodes[nodeIndex].count = 0;
+			}
+		}
+	}
+
+	if (splitBin == 0)
+	{
+		_nodes[nodeIndex].offset = static_cast<uint32_t>(_indices.size());
+		_nodes[nodeIndex].count = static_cast<uint32_t>(count);
+		for (size_t i = begin; i < end; ++i)
+			_indices.push_back(items[i].index);
+	}
+
+	return nodeIndex;
+}
+
+bool TriangleBVH::sphereTriangles(const triangle* triangles, const Sphere& s,
+	vec3& point, vec3& normal, float& penetration) const
+{
+	if (_nodes.empty()) return false;
+
+	vec3 minVertex = s.center() - vec3(s.radius());
+	vec3 maxVertex = s.center() + vec3(s.radius());
+
+	bool found = false;
+	uint32_t stack[MaxDepth];
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+		if (!nodeIntersectsBox(node, minVertex, maxVertex)) continue;
+
+		if (node.isLeaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				vec3 p;
+				vec3 n;
+				float d = 0.0f;
+				if (intersect::sphereTriangle(s.center(), s.radius(), triangles[_indices[i]], p, n, d) &&
+					(!found || (d > penetration)))
+				{
+					point = p;
+					normal = n;
+					penetration = d;
+					found = true;
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return found;
+}
+
+bool TriangleBVH::sphereTriangles(const triangle* triangles, const Sphere& s, const vec3& velocity,
+	vec3& point, vec3& normal, float& penetration, float& intersectionTime) const
+{
+	if (_nodes.empty()) return false;
+
+	vec3 endCenter = s.center() + velocity;
+	vec3 minVertex = minv(s.center(), endCenter) - vec3(s.radius());
+	vec3 maxVertex = maxv(s.center(), endCenter) + vec3(s.radius());
+
+	bool found = false;
+	uint32_t stack[MaxDepth];
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+		if (!nodeIntersectsBox(node, minVertex, maxVertex)) continue;
+
+		if (node.isLeaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				vec3 p;
+				vec3 n;
+				float d = 0.0f;
+				float t = 0.0f;
+				if (intersect::sphereTriangle(s, velocity, triangles[_indices[i]], p, n, d, t) &&
+					(t <= 1.0f) && (!found || (t < intersectionTime)))
+				{
+					point = p;
+					normal = n;
+					penetration = d;
+					intersectionTime = t;
+					found = true;
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return found;
+}
+
+bool TriangleBVH::rayTriangles(const triangle* triangles, const ray3d& r, vec3* intersection_pt) const
+{
+	RayHit hit;
+	if (!closestHit(triangles, r.origin, r.direction, std::numeric_limits<float>::max(), hit)) return false;
+
+	if (intersection_pt)
+		*intersection_pt = hit.point;
+
+	return true;
+}
+
+bool TriangleBVH::segmentTriangles(const triangle* triangles, const segment3d& s, vec3* intersection_pt) const
+{
+	RayHit hit;
+	if (!closestHit(triangles, s.start, s.end - s.start, 1.0f, hit)) return false;
+
+	if (intersection_pt)
+		*intersection_pt = hit.point;
+
+	return true;
+}
+
+/*
+ * Children are visited front to back, nodes farther than the closest hit are skipped
+ */
+bool TriangleBVH::closestHit(const triangle* triangles, const vec3& origin, const vec3& direction,
+	float maxDistance, RayHit& hit) const
+{
+	if (_nodes.empty()) return false;
+
+	vec3 invDirection = TriangleBVH::inverseDirection(direction);
+	float invLengthSquared = 1.0f / etMax(direction.dotSelf(), std::numeric_limits<float>::epsilon());
+	ray3d r(origin, direction);
+
+	float closest = maxDistance;
+	bool found = false;
+
+	uint32_t stack[MaxDepth];
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = _nodes[nodeIndex];
+
+		float distance = 0.0f;
+		if (!node.intersectsRay(origin, invDirection, closest, distance)) continue;
+
+		if (node.isLeaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				vec3 p;
+				if (intersect::rayTriangle(r, triangles[_indices[i]], &p))
+				{
+					float t = dot(p - origin, direction) * invLengthSquared;
+					if (t <= closest)
+					{
+						closest = t;
+						found = true;
+						hit.point = p;
+						hit.distance = t;
+						hit.triangle = _indices[i];
+					}
+				}
+			}
+		}
+		else
+		{
+			uint32_t first = nodeIndex + 1;
+			uint32_t second = node.offset;
+
+			float firstDistance = 0.0f;
+			float secondDistance = 0.0f;
+			bool hitFirst = _nodes[first].intersectsRay(origin, invDirection, closest, firstDistance);
+			bool hitSecond = _nodes[second].intersectsRay(origin, invDirection, closest, secondDistance);
+
+			if (hitFirst && hitSecond)
+			{
+				if (firstDistance < secondDistance)
+					std::swap(first, second);
+
+				stack[stackSize++] = first;
+				stack[stackSize++] = second;
+			}
+			else if (hitFirst)
+			{
+				stack[stackSize++] = first;
+			}
+			else if (hitSecond)
+			{
+				stack[stackSize++] = second;
+			}
+		}
+	}
+
+	return found;
+}
+
+void TriangleBVH::serialize(std::ostream& stream) const
+{
+	serializeInt(stream, _nodes.size());
+	if (_nodes.size() > 0)
+		stream.write(reinterpret_cast<const char*>(_nodes.data()), static_cast<std::streamsize>(_nodes.size() * sizeof(Node)));
+
+	serializeInt(stream, _indices.size());
+	if (_indices.size() > 0)
+		stream.write(reinterpret_cast<const char*>(_indices.data()), static_cast<std::streamsize>(_indices.size() * sizeof(uint32_t)));
+}
+
+void TriangleBVH::deserialize(std::istream& stream)
+{
+	_nodes.resize(deserializeUInt(stream));
+	if (_nodes.size() > 0)
+		stream.read(reinterpret_cast<char*>(_nodes.data()), static_cast<std::streamsize>(_nodes.size() * sizeof(Node)));
+
+	_indices.resize(deserializeUInt(stream));
+	if (_indices.size() > 0)
+		stream.read(reinterpret_cast<char*>(_indices.data()), static_cast<std::streamsize>(_indices.size() * sizeof(uint32_t)));
+}
@@ -0,0 +1,412 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <streambuf>
+#include <et/core/assetpack.h>
+#include <et/core/tools.h>
+#include <et/threading/criticalsection.h>
+
+using namespace et;
+
+namespace
+{
+	const uint32_t assetPackMagic = ET_COMPOSE_UINT32('E', 'T', 'P', 'K');
+	const uint32_t assetPackVersion = 1;
+
+	/*
+	 * Names are compared with forward slashes, leading "./" is ignored
+	 */
+	std::string normalizedAssetName(const std::string& name)
+	{
+		std::string result(name);
+		std::replace(result.begin(), result.end(), '\\', '/');
+
+		while ((result.size() > 1) && (result[0] == '.') && (result[1] == '/'))
+			result.erase(0, 2);
+
+		return result;
+	}
+
+	/*
+	 * FNV-1a
+	 */
+	uint64_t assetNameHash(const char* name, size_t length)
+	{
+		uint64_t result = 14695981039346656037ull;
+		for (size_t i = 0; i < length; ++i)
+		{
+			result ^= static_cast<unsigned char>(name[i]);
+			result *= 1099511628211ull;
+		}
+		return result;
+	}
+
+	class AssetStreamBuffer : public std::streambuf
+	{
+	public:
+		AssetStreamBuffer(const char* data, size_t size)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			if ((which & std::ios_base::in) == 0)
+				return pos_type(off_type(-1));
+
+			off_type base = 0;
+			if (dir == std::ios_base::cur)
+				base = gptr() - eback();
+			else if (dir == std::ios_base::end)
+				base = egptr() - eback();
+
+			off_type position = base + offset;
+			if ((position < 0) || (position > egptr() - eback()))
+				return pos_type(off_type(-1));
+
+			setg(eback(), eback() + position, egptr());
+			return pos_type(position);
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which)
+			{ return seekoff(off_type(position), std::ios_base::beg, which); }
+	};
+
+	class AssetInputStream : public std::istream
+	{
+	public:
+		AssetInputStream(AssetPack::Pointer pack, const char* data, size_t size) :
+			std::istream(nullptr), _pack(pack), _buffer(data, size) { rdbuf(&_buffer); }
+
+	private:
+		AssetPack::Pointer _pack;
+		AssetStreamBuffer _buffer;
+	};
+
+	struct MountedAssetPack
+	{
+		AssetPack::Pointer pack;
+		std::string rootFolder;
+	};
+
+	struct MountedAssetPacks
+	{
+		CriticalSection lock;
+		std::vector<MountedAssetPack> packs;
+	};
+
+	MountedAssetPacks& mountedAssetPacks()
+	{
+		static MountedAssetPacks packs;
+		return packs;
+	}
+
+	/*
+	 * Should be called with the lock of mounted packs taken
+	 */
+	const AssetPack::Entry* findMountedEntry(const std::string& fileName, AssetPack::Pointer& pack)
+	{
+		std::vector<MountedAssetPack>& packs = mountedAssetPacks().packs;
+		if (packs.empty()) return nullptr;
+
+		std::string name = normalizedAssetName(fileName);
+		for (auto i = packs.rbegin(), e = packs.rend(); i != e; ++i)
+		{
+			const std::string& root = i->rootFolder;
+			if (name.compare(0, root.size(), root) != 0) continue;
+
+			const AssetPack::Entry* entry = i->pack->find(name.substr(root.size()));
+			if (entry != nullptr)
+			{
+				pack = i->pack;
+				return entry;
+			}
+		}
+
+		return nullptr;
+	}
+}
+
+bool AssetPack::build(const std::string& outputFile, const std::string& rootFolder,
+	const StringList& files, size_t alignment)
+{
+	if ((alignment == 0) || !isPowerOfTwo(alignment))
+	{
+		log::error("Asset pack alignment should be power of two, got %u", static_cast<uint32_t>(alignment));
+		return false;
+	}
+
+	std::string root = normalizedAssetName(rootFolder);
+	if (!root.empty() && (root.back() != '/'))
+		root.push_back('/');
+
+	struct SourceFile
+	{
+		std::string path;
+		std::string name;
+		uint64_t hash;
+	};
+
+	std::vector<SourceFile> sources;
+	sources.reserve(files.size());
+	for (const std::string& path : files)
+	{
+		SourceFile source;
+		source.path = path;
+		source.name = normalizedAssetName(path);
+
+		if (source.name.compare(0, root.size(), root) == 0)
+			source.name.erase(0, root.size());
+
+		source.hash = assetNameHash(source.name.data(), source.name.size());
+		sources.push_back(source);
+	}
+
+	std::sort(sources.begin(), sources.end(), [](const SourceFile& a, const SourceFile& b)
+		{ return (a.hash < b.hash) || ((a.hash == b.hash) && (a.name < b.name)); });
+
+	for (size_t i = 1; i < sources.size(); ++i)
+	{
+		if (sources[i].name == sources[i - 1].name)
+		{
+			log::error("File %s is added to the asset pack twice", sources[i].name.c_str());
+			return false;
+		}
+	}
+
+	std::ofstream output(outputFile.c_str(), std::ios::out | std::ios::binary);
+	if (output.fail())
+	{
+		log::error("Unable to create file: %s", outputFile.c_str());
+		return false;
+	}
+
+	Header header = { };
+	header.magic = assetPackMagic;
+	header.version = assetPackVersion;
+	header.entriesCount = static_cast<uint32_t>(sources.size());
+	header.alignment = static_cast<uint32_t>(alignment);
+	header.namesOffset = sizeof(Header) + sources.size() * sizeof(Entry);
+
+	std::vector<Entry> entries(sources.size());
+	std::string names;
+	for (size_t i = 0; i < sources.size(); ++i)
+	{
+		entries[i].nameHash = sources[i].hash;
+		entries[i].nameOffset = static_cast<uint32_t>(names.size());
+		entries[i].nameLength = static_cast<uint32_t>(sources[i].name.size());
+		names.append(sources[i].name);
+	}
+	header.namesSize = names.size();
+
+	/*
+	 * Table of contents is written again when offsets and sizes are known
+	 */
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+	output.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+	uint64_t offset = header.namesOffset + header.namesSize;
+	std::vector<char> buffer(1024 * 1024);
+	const std::vector<char> padding(alignment, 0);
+
+	for (size_t i = 0; i < sources.size(); ++i)
+	{
+		std::ifstream input(sources[i].path.c_str(), std::ios::in | std::ios::binary);
+		if (input.fail())
+		{
+			log::error("Unable to open file: %s", sources[i].path.c_str());
+			return false;
+		}
+
+		uint64_t alignedOffset = (offset + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+		output.write(padding.data(), static_cast<std::streamsize>(alignedOffset - offset));
+
+		entries[i].offset = alignedOffset;
+		offset = alignedOffset;
+
+		while (input)
+		{
+			input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			std::streamsize bytesRead = input.gcount();
+			output.write(buffer.data(), bytesRead);
+			offset += static_cast<uint64_t>(bytesRead);
+		}
+
+		entries[i].size = offset - entries[i].offset;
+	}
+
+	output.seekp(sizeof(Header), std::ios::beg);
+	output.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+
+	if (output.fail())
+	{
+		log::error("Unable to write file: %s", outputFile.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void AssetPack::mount(AssetPack::Pointer pack, const std::string& rootFolder)
+{
+	if (pack.invalid() || !pack->valid()) return;
+
+	MountedAssetPack mounted;
+	mounted.pack = pack;
+	mounted.rootFolder = normalizedAssetName(rootFolder);
+	if (!mounted.rootFolder.empty() && (mounted.rootFolder.back() != '/'))
+		mounted.rootFolder.push_back('/');
+
+	MountedAssetPacks& packs = mountedAssetPacks();
+	CriticalSectionScope lock(packs.lock);
+	packs.packs.push_back(mounted);
+}
+
+void AssetPack::unmount(AssetPack::Pointer pack)
+{
+	MountedAssetPacks& packs = mountedAssetPacks();
+	CriticalSectionScope lock(packs.lock);
+
+	packs.packs.erase(std::remove_if(packs.packs.begin(), packs.packs.end(),
+		[&pack](const MountedAssetPack& m) { return m.pack == pack; }), packs.packs.end());
+}
+
+bool AssetPack::mountedFileExists(const std::string& fileName)
+{
+	CriticalSectionScope lock(mountedAssetPacks().lock);
+
+	AssetPack::Pointer pack;
+	return findMountedEntry(fileName, pack) != nullptr;
+}
+
+std::istream* AssetPack::openMountedFile(const std::string& fileName)
+{
+	CriticalSectionScope lock(mountedAssetPacks().lock);
+
+	AssetPack::Pointer pack;
+	const Entry* entry = findMountedEntry(fileName, pack);
+	return (entry == nullptr) ? nullptr : pack->createStream(*entry);
+}
+
+AssetPack::AssetPack() :
+	_header(nullptr), _entries(nullptr), _names(nullptr)
+{
+}
+
+AssetPack::AssetPack(const std::string& fileName) :
+	_header(nullptr), _entries(nullptr), _names(nullptr)
+{
+	open(fileName);
+}
+
+bool AssetPack::open(const std::string& fileName)
+{
+	close();
+
+	if (!_file.open(fileName))
+		return false;
+
+	size_t fileSize = _file.size();
+	const Header* header = reinterpret_cast<const Header*>(_file.data());
+
+	if ((fileSize < sizeof(Header)) || (header->magic != assetPackMagic) || (header->version != assetPackVersion))
+	{
+		log::error("File %s is not an asset pack", fileName.c_str());
+		_file.close();
+		return false;
+	}
+
+	uint64_t tableSize = sizeof(Header) + static_cast<uint64_t>(header->entriesCount) * sizeof(Entry);
+	bool validTable = (tableSize <= header->namesOffset) && (header->namesOffset <= fileSize) &&
+		(header->namesSize <= fileSize - header->namesOffset);
+
+	const Entry* entries = reinterpret_cast<const Entry*>(_file.data() + sizeof(Header));
+	for (uint32_t i = 0; validTable && (i < header->entriesCount); ++i)
+	{
+		const Entry& e = entries[i];
+		validTable = (e.offset <= fileSize) && (e.size <= fileSize - e.offset) &&
+			(static_cast<uint64_t>(e.nameOffset) + e.nameLength <= header->namesSize) &&
+			((i == 0) || (entries[i - 1].nameHash <= e.nameHash));
+	}
+
+	if (!validTable)
+	{
+		log::error("Asset pack %s is damaged", fileName.c_str());
+		_file.close();
+		return false;
+	}
+
+	_header = header;
+	_entries = entries;
+	_names = _file.data() + header->namesOffset;
+	_file.prefetch(0, static_cast<size_t>(header->namesOffset + header->namesSize));
+
+	return true;
+}
+
+void AssetPack::close()
+{
+	_file.close();
+	_header = nullptr;
+	_entries = nullptr;
+	_names = nullptr;
+}
+
+std::string AssetPack::entryName(size_t index) const
+{
+	const Entry& e = entry(index);
+	return std::string(_names + e.nameOffset, e.nameLength);
+}
+
+const AssetPack::Entry* AssetPack::find(const std::string& name) const
+{
+	if (!valid()) return nullptr;
+
+	std::string normalizedName = normalizedAssetName(name);
+	uint64_t hash = assetNameHash(normalizedName.data(), normalizedName.size());
+
+	const Entry* end = _entries + _header->entriesCount;
+	const Entry* i = std::lower_bound(_entries, end, hash,
+		[](const Entry& e, uint64_t value) { return e.nameHash < value; });
+
+	for (; (i != end) && (i->nameHash == hash); ++i)
+	{
+		if ((i->nameLength == normalizedName.size()) &&
+			(normalizedName.compare(0, i->nameLength, _names + i->nameOffset, i->nameLength) == 0))
+		{
+			return i;
+		}
+	}
+
+	return nullptr;
+}
+
+bool AssetPack::data(const std::string& name, BinaryDataStorage& result) const
+{
+	const Entry* e = find(name);
+	if (e == nullptr) return false;
+
+	result.resize(0);
+	result = BinaryDataStorage(reinterpret_cast<const unsigned char*>(entryData(*e)), static_cast<size_t>(e->size));
+	return true;
+}
+
+InputStream::Pointer AssetPack::stream(const std::string& name)
+{
+	const Entry* e = find(name);
+	return (e == nullptr) ? InputStream::Pointer() : InputStream::Pointer(new InputStream(createStream(*e)));
+}
+
+std::istream* AssetPack::createStream(const Entry& e)
+{
+	return new AssetInputStream(AssetPack::Pointer(this), entryData(e), static_cast<size_t>(e.size));
+}
@@ -5,8 +5,10 @@
  *
  */
 
+#include <set>
 #include <et/core/filesystem.h>
 #include <et/core/objectscache.h>
+#include <et/threading/threading.h>
 
 using namespace et;
 
@@ -26,29 +28,45 @@ void ObjectsCache::manage(const LoadableObject::Pointer& o, const ObjectLoader::
 	{
 		CriticalSectionScope lock(_lock);
 		
-		if (_objects.count(o->origin()) > 0)
-		{
-			ObjectPropertyList& list = _objects[o->origin()];
-			list.push_back(ObjectProperty(o, loader));
-			ObjectProperty& newObject = list.back();
-			newObject.identifiers[o->origin()] = getFileProperty(o->origin());
-			for (auto& s : o->distributedOrigins())
-				newObject.identifiers[s] = getFileProperty(s);
-		}
-		else
-		{
-			ObjectPropertyList newList(1, ObjectProperty(o, loader));
-			ObjectProperty& newObject = newList.back();
-			newObject.identifiers[o->origin()] = getFileProperty(o->origin());
-			for (auto& s : o->distributedOrigins())
-				newObject.identifiers[s] = getFileProperty(s);
-			_objects.insert(std::make_pair(o->origin(), newList));
-		}
+		remove(o.ptr());
+
+		auto i = _objects.find(o->origin());
+		if (i == _objects.end())
+			i = _objects.insert(std::make_pair(o->origin(), ObjectPropertyList())).first;
+
+		ObjectPropertyList& list = i->second;
+		list.push_back(ObjectProperty(o, loader));
+		
+		ObjectProperty& newObject = list.back();
+		newObject.identifiers[o->origin()] = getFileProperty(o->origin());
+		for (auto& s : o->distributedOrigins())
+			newObject.identifiers[s] = getFileProperty(s);
+		
+		for (auto& id : newObject.identifiers)
+			retainFile(id.first);
+
+		_usage.push_front(o.ptr());
+
+		ObjectEntry& entry = _entries[o.ptr()];
+		entry.origin = &i->first;
+		entry.usage = _usage.begin();
+		entry.memoryUsage = o->memoryUsage();
+		_statistics.memoryUsage += entry.memoryUsage;
+
+		evictUnusedObjects();
 	}
 	else
 	{
 		log::warning("[ObjectsCache] Trying to manage invalid object");
+		return;
 	}
+
+	/*
+	 * Objects are loaded from background threads as well, where evicted objects
+	 * could not be destroyed. Those are released by the next update or flush.
+	 */
+	if (Threading::currentThread() == Threading::mainThread())
+		releaseEvictedObjects();
 }
 
 std::vector<LoadableObject::Pointer> ObjectsCache::findObjects(const std::string& key)
@@ -56,11 +74,17 @@ std::vector<LoadableObject::Pointer> ObjectsCache::findObjects(const std::string
 	CriticalSectionScope lock(_lock);
 	auto i = _objects.find(key);
 	if (i == _objects.end())
+	{
+		++_statistics.misses;
 		return std::vector<LoadableObject::Pointer>();
+	}
+
+	++_statistics.hits;
+	touch(i->second);
 		
 	std::vector<LoadableObject::Pointer> result;
 	
-	for (auto prop : i->second)
+	for (auto& prop : i->second)
 		result.push_back(prop.object);
 	
 	return result;
@@ -73,6 +97,8 @@ LoadableObject::Pointer ObjectsCache::findAnyObject(const std::string& key, uint
 	auto i = _objects.find(key);
 	if (i == _objects.end())
 	{
+		++_statistics.misses;
+
 		if (property)
 			*property = 0;
 		
@@ -80,6 +106,9 @@ LoadableObject::Pointer ObjectsCache::findAnyObject(const std::string& key, uint
 	}
 	else
 	{
+		++_statistics.hits;
+		touch(i->second);
+
 		if (property)
 			*property = i->second.front().identifiers[key];
 		
@@ -93,63 +122,63 @@ void ObjectsCache::discard(const LoadableObject::Pointer& o)
 	if (o.valid())
 	{
 		CriticalSectionScope lock(_lock);
-		if (_objects.count(o->origin()) == 0) return;
-		
-		ObjectPropertyList& list = _objects[o->origin()];
-		for (auto i = list.begin(), e = list.end(); i != e; ++i)
-		{
-			if (i->object == o)
-			{
-				list.erase(i);
-				break;
-			}
-		}
-		
-		if (list.empty())
-			_objects.erase(o->origin());
+		remove(o.ptr());
 	}
 }
 
 void ObjectsCache::clear()
 {
 	CriticalSectionScope lock(_lock);
+
+	for (auto& f : _watchedFiles)
+		_watcher.unwatch(f.first);
+
+	_watchedFiles.clear();
+	_pendingChanges.clear();
+	_entries.clear();
+	_usage.clear();
 	_objects.clear();
+	_evictedObjects.clear();
+	_statistics.memoryUsage = 0;
 }
 
 void ObjectsCache::flush()
 {
-	size_t objectsErased = 0;
+	releaseEvictedObjects();
+
 	CriticalSectionScope lock(_lock);
-	auto i = _objects.begin();
-	while (i != _objects.end())
+
+	std::vector<const LoadableObject*> unusedObjects;
+	for (auto object : _usage)
 	{
-		auto obj = i->second.begin();
-		while (obj != i->second.end())
-		{
-			if (obj->object->atomicCounterValue() == 1)
-			{
-				auto toErase = obj++;
-				i->second.erase(toErase);
-				++objectsErased;
-			}
-			else
-			{
-				++obj;
-			}
-		}
-		
-		if (i->second.empty())
-		{
-			auto j = i++;
-			_objects.erase(i);
-			i = j;
-		}
-		else
-			++i;
+		if (object->atomicCounterValue() == 1)
+			unusedObjects.push_back(object);
 	}
-	
-	if (objectsErased > 0)
-		log::info("[ObjectsCache] %lu objects flushed.", objectsErased);
+
+	for (auto object : unusedObjects)
+		remove(object);
+
+	if (unusedObjects.size() > 0)
+		log::info("[ObjectsCache] %lu objects flushed.", unusedObjects.size());
+}
+
+void ObjectsCache::setMemoryBudget(uint64_t bytes)
+{
+	{
+		CriticalSectionScope lock(_lock);
+		_statistics.memoryBudget = bytes;
+		evictUnusedObjects();
+	}
+	releaseEvictedObjects();
+}
+
+ObjectsCacheStatistics ObjectsCache::statistics()
+{
+	CriticalSectionScope lock(_lock);
+
+	ObjectsCacheStatistics result = _statistics;
+	result.objects = _entries.size();
+	return result;
 }
 
 void ObjectsCache::startMonitoring()
@@ -166,6 +195,14 @@ void ObjectsCache::update(float t)
 {
 	static const float updateInterval = 0.5f;
 	
+	releaseEvictedObjects();
+
+	if (_watcher.available())
+	{
+		processFileChanges(t);
+		return;
+	}
+	
 	if (_updateTime == 0.0f)
 		_updateTime = t;
 	
@@ -187,12 +224,16 @@ uint64_t ObjectsCache::getObjectProperty(LoadableObject::Pointer ptr)
 {
 	CriticalSectionScope lock(_lock);
 	
-	for (auto& entry : _objects)
+	auto e = _entries.find(ptr.ptr());
+	if (e == _entries.end()) return 0;
+
+	const std::string& origin = *e->second.origin;
+	for (auto& p : _objects[origin])
 	{
-		for (auto& p : entry.second)
+		if (p.object == ptr)
 		{
-			if (p.object == ptr)
-				return p.identifiers[ptr->origin()];
+			auto id = p.identifiers.find(origin);
+			return (id == p.identifiers.end()) ? 0 : id->second;
 		}
 	}
 	
@@ -201,17 +242,18 @@ uint64_t ObjectsCache::getObjectProperty(LoadableObject::Pointer ptr)
 
 void ObjectsCache::performUpdate()
 {
-	ObjectsCache& cache = *this;
-	
-	for (auto& entry : _objects)
+	ObjectPropertyList reloadList;
 	{
-		for (auto& p : entry.second)
+		CriticalSectionScope lock(_lock);
+		
+		for (auto& entry : _objects)
 		{
-			if (p.loader.valid() && p.object->canBeReloaded())
+			for (auto& p : entry.second)
 			{
-				bool shouldReload = false;
+				if (p.loader.invalid() || !p.object->canBeReloaded()) continue;
 				
-				for (auto i : p.identifiers)
+				bool shouldReload = false;
+				for (auto& i : p.identifiers)
 				{
 					int64_t prop = getFileProperty(i.first);
 					if (prop != i.second)
@@ -222,13 +264,202 @@ void ObjectsCache::performUpdate()
 				}
 				
 				if (shouldReload)
-					p.loader->reloadObject(p.object, cache);
+					reloadList.push_back(ObjectProperty(p.object, p.loader));
+			}
+		}
+	}
+	
+	reloadObjects(reloadList);
+}
+
+/*
+ * Editors usually write file several times while saving,
+ * so file is reloaded when there were no events for it during debounce interval
+ */
+void ObjectsCache::processFileChanges(float t)
+{
+	static const float debounceInterval = 0.25f;
+	
+	ObjectPropertyList reloadList;
+	{
+		CriticalSectionScope lock(_lock);
+		
+		StringList changedFiles;
+		_watcher.poll(changedFiles);
+		
+		for (auto& f : changedFiles)
+			_pendingChanges[f] = t;
+		
+		std::set<std::string> settledFiles;
+		for (auto i = _pendingChanges.begin(); i != _pendingChanges.end(); )
+		{
+			if (t - i->second >= debounceInterval)
+			{
+				settledFiles.insert(i->first);
+				_pendingChanges.erase(i++);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		
+		if (settledFiles.empty()) return;
+		
+		for (auto& entry : _objects)
+		{
+			for (auto& p : entry.second)
+			{
+				if (p.loader.invalid() || !p.object->canBeReloaded()) continue;
+				
+				bool shouldReload = false;
+				for (auto& i : p.identifiers)
+				{
+					if (settledFiles.count(i.first) > 0)
+					{
+						i.second = getFileProperty(i.first);
+						shouldReload = true;
+					}
+				}
+				
+				if (shouldReload)
+					reloadList.push_back(ObjectProperty(p.object, p.loader));
 			}
 		}
 	}
+	
+	reloadObjects(reloadList);
+}
+
+void ObjectsCache::reloadObjects(ObjectPropertyList& objects)
+{
+	if (objects.empty()) return;
+
+	for (auto& p : objects)
+		p.loader->reloadObject(p.object, *this);
+
+	/*
+	 * Reloaded objects could change their size
+	 */
+	{
+		CriticalSectionScope lock(_lock);
+		for (auto& p : objects)
+		{
+			auto e = _entries.find(p.object.ptr());
+			if (e == _entries.end()) continue;
+
+			_statistics.memoryUsage -= e->second.memoryUsage;
+			e->second.memoryUsage = p.object->memoryUsage();
+			_statistics.memoryUsage += e->second.memoryUsage;
+		}
+
+		evictUnusedObjects();
+	}
+	releaseEvictedObjects();
+}
+
+void ObjectsCache::touch(const ObjectPropertyList& objects)
+{
+	for (auto& p : objects)
+	{
+		auto e = _entries.find(p.object.ptr());
+		if (e != _entries.end())
+			_usage.splice(_usage.begin(), _usage, e->second.usage);
+	}
+}
+
+/*
+ * Should be called with the lock taken. Object could be destroyed here,
+ * if it is referenced only by the cache.
+ */
+void ObjectsCache::remove(const LoadableObject* object)
+{
+	auto e = _entries.find(object);
+	if (e == _entries.end()) return;
+
+	ObjectEntry entry = e->second;
+	_entries.erase(e);
+	_usage.erase(entry.usage);
+	_statistics.memoryUsage -= entry.memoryUsage;
+
+	auto i = _objects.find(*entry.origin);
+	assert(i != _objects.end());
+
+	ObjectPropertyList& list = i->second;
+	for (auto p = list.begin(), end = list.end(); p != end; ++p)
+	{
+		if (p->object.ptr() == object)
+		{
+			for (auto& id : p->identifiers)
+				releaseFile(id.first);
+
+			list.erase(p);
+			break;
+		}
+	}
+
+	if (list.empty())
+		_objects.erase(i);
+}
+
+/*
+ * Objects are evicted starting from the least recently used,
+ * objects which are referenced outside of the cache are skipped.
+ * Evicted objects are kept alive until releaseEvictedObjects is called.
+ */
+void ObjectsCache::evictUnusedObjects()
+{
+	if (_statistics.memoryBudget == UnlimitedMemory) return;
+
+	auto i = _usage.end();
+	while ((_statistics.memoryUsage > _statistics.memoryBudget) && (i != _usage.begin()))
+	{
+		const LoadableObject* object = *(--i);
+		if ((object->atomicCounterValue() > 1) || (_entries[object].memoryUsage == 0)) continue;
+
+		++i;
+		_evictedObjects.push_back(LoadableObject::Pointer(const_cast<LoadableObject*>(object)));
+		remove(object);
+		++_statistics.evictions;
+	}
+}
+
+/*
+ * Evicted objects are destroyed outside of the lock, on the thread which owns the cache
+ */
+void ObjectsCache::releaseEvictedObjects()
+{
+	std::vector<LoadableObject::Pointer> evictedObjects;
+	{
+		CriticalSectionScope lock(_lock);
+		evictedObjects.swap(_evictedObjects);
+	}
+}
+
+void ObjectsCache::retainFile(const std::string& fileName)
+{
+	if (_watchedFiles[fileName]++ == 0)
+		_watcher.watch(fileName);
+}
+
+void ObjectsCache::releaseFile(const std::string& fileName)
+{
+	auto i = _watchedFiles.find(fileName);
+	if (i == _watchedFiles.end()) return;
+
+	if (--i->second == 0)
+	{
+		_watcher.unwatch(fileName);
+		_pendingChanges.erase(fileName);
+		_watchedFiles.erase(i);
+	}
 }
 
 void ObjectsCache::report()
 {
-	log::info("[ObjectsCache] Contains %lu objects", _objects.size());
+	CriticalSectionScope lock(_lock);
+	log::info("[ObjectsCache] Contains %lu objects, %lu Kb of %lu Kb budget, hits: %lu, misses: %lu, evictions: %lu",
+		_entries.size(), static_cast<unsigned long>(_statistics.memoryUsage / 1024),
+		static_cast<unsigned long>(_statistics.memoryBudget / 1024), static_cast<unsigned long>(_statistics.hits),
+		static_cast<unsigned long>(_statistics.misses), static_cast<unsigned long>(_statistics.evictions));
 }
@@ -8,6 +8,7 @@
 #include <fstream>
 #include <et/core/et.h>
 #include <et/core/stream.h>
+#include <et/core/assetpack.h>
 
 #if (ET_PLATFORM_ANDROID)
 #
@@ -39,6 +40,9 @@ InputStream::InputStream() : _private(new InputStreamPrivate)
 
 InputStream::InputStream(const std::string& file, StreamMode mode) : _private(new InputStreamPrivate)
 {
+	_private->stream = AssetPack::openMountedFile(file);
+	if (_private->stream != nullptr) return;
+
 	std::ios::openmode openMode = std::ios::in;
 	
 	if (mode == StreamMode_Binary)
@@ -54,6 +58,11 @@ InputStream::InputStream(const std::string& file, StreamMode mode) : _private(ne
 	}
 }
 
+InputStream::InputStream(std::istream* stream) : _private(new InputStreamPrivate)
+{
+	_private->stream = stream;
+}
+
 InputStream::~InputStream()
 {
 	delete _private;
@@ -5,84 +5,332 @@
  *
  */
 
+#include <limits>
+#include <algorithm>
 #include <et/geometry/rectplacer.h>
 
 using namespace et;
 
-RectPlacer::RectPlacer(const vec2i& contextSize, bool addSpace) : _contextSize(contextSize), _addSpace(addSpace)
+namespace
 {
+	inline rect toRect(const recti& r)
+	{
+		return rect(static_cast<float>(r.left), static_cast<float>(r.top),
+			static_cast<float>(r.width), static_cast<float>(r.height));
+	}
+
+	inline recti toRecti(const rect& r)
+	{
+		return recti(static_cast<int>(r.left), static_cast<int>(r.top),
+			static_cast<int>(r.width), static_cast<int>(r.height));
+	}
+
+	inline bool mergeRects(recti& a, const recti& b)
+	{
+		if ((a.top == b.top) && (a.height == b.height))
+		{
+			if ((a.right() == b.left) || (b.right() == a.left))
+			{
+				a.left = etMin(a.left, b.left);
+				a.width += b.width;
+				return true;
+			}
+		}
+		else if ((a.left == b.left) && (a.width == b.width))
+		{
+			if ((a.bottom() == b.top) || (b.bottom() == a.top))
+			{
+				a.top = etMin(a.top, b.top);
+				a.height += b.height;
+				return true;
+			}
+		}
 
+		return false;
+	}
+
+	int sortKey(const vec2i& s, RectPlacer::SortMode mode)
+	{
+		switch (mode)
+		{
+			case RectPlacer::SortMode_Height:
+				return s.y;
+
+			case RectPlacer::SortMode_Area:
+				return s.x * s.y;
+
+			case RectPlacer::SortMode_LongestSide:
+				return etMax(s.x, s.y);
+
+			default:
+				return 0;
+		}
+	}
+
+	typedef std::pair<int, size_t> SortEntry;
+
+	inline bool sortEntryCompare(const SortEntry& a, const SortEntry& b)
+		{ return (a.first > b.first) || ((a.first == b.first) && (a.second < b.second)); }
+}
+
+RectPlacer::RectPlacer(const vec2i& contextSize, bool addSpace) :
+	_contextSize(contextSize), _usedArea(0), _addSpace(addSpace)
+{
+	clear();
+}
+
+void RectPlacer::clear()
+{
+	_placedItems.clear();
+	_freeRects.clear();
+	_skyline.clear();
+	_skyline.push_back(SkylineNode(0, 0, _contextSize.x));
+	_minSize = _contextSize;
+	_usedArea = 0;
 }
 
 bool RectPlacer::place(const vec2i& size, rect& placedPosition)
 {
-	int w = size.x;
-	int h = size.y;
+	vec2i s = size;
 
 	if (_addSpace)
 	{
-		if (w < _contextSize.x - 1)
-			w++;
+		if (s.x < _contextSize.x - 1)
+			s.x++;
 
-		if (h < _contextSize.y - 1)
-			h++;
+		if (s.y < _contextSize.y - 1)
+			s.y++;
 	}
 
-	placedPosition = rect(vec2(0.0f), vec2(static_cast<float>(w), static_cast<float>(h)));
+	if ((s.x <= 0) || (s.y <= 0)) return false;
+
+	_minSize.x = etMin(_minSize.x, s.x);
+	_minSize.y = etMin(_minSize.y, s.y);
+
+	recti result;
+	if (!placeToFreeRect(s, result) && !placeToSkyline(s, result)) return false;
 
-	if (_placedItems.size() == 0)
+	placedPosition = toRect(result);
+	_placedItems.push_back(placedPosition);
+	_usedArea += static_cast<int64_t>(result.square());
+
+	return true;
+}
+
+size_t RectPlacer::place(const SizeList& sizes, RectList& placedPositions, SortMode sortMode)
+{
+	std::vector<SortEntry> order(sizes.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = SortEntry(sortKey(sizes[i], sortMode), i);
+
+	if (sortMode != SortMode_None)
+		std::sort(order.begin(), order.end(), sortEntryCompare);
+
+	placedPositions.assign(sizes.size(), rect());
+	_placedItems.reserve(_placedItems.size() + sizes.size());
+
+	size_t placed = 0;
+	for (const SortEntry& i : order)
 	{
-		_placedItems.push_back(placedPosition);
-		return true;
+		if (place(sizes[i.second], placedPositions[i.second]))
+			++placed;
 	}
-	
-	for (const rect& i : _placedItems)
-	{
-		placedPosition.setOrigin(i.origin() + vec2(i.size().x, 0.0f));
 
-		bool placed = (placedPosition.origin().x + w <= _contextSize.x) &&
-			(placedPosition.origin().y + h <= _contextSize.y);
-		
-		if (placed)
+	return placed;
+}
+
+bool RectPlacer::remove(const rect& placedPosition)
+{
+	auto i = std::find(_placedItems.begin(), _placedItems.end(), placedPosition);
+	if (i == _placedItems.end()) return false;
+
+	recti r = toRecti(*i);
+
+	*i = _placedItems.back();
+	_placedItems.pop_back();
+	_usedArea -= static_cast<int64_t>(r.square());
+
+	addFreeRect(r);
+	return true;
+}
+
+float RectPlacer::occupancy() const
+{
+	int64_t totalArea = static_cast<int64_t>(_contextSize.x) * static_cast<int64_t>(_contextSize.y);
+	return (totalArea > 0) ? static_cast<float>(_usedArea) / static_cast<float>(totalArea) : 0.0f;
+}
+
+/*
+ * Best short side fit, the rest of free rect is split along the shorter leftover side
+ */
+bool RectPlacer::placeToFreeRect(const vec2i& size, recti& result)
+{
+	size_t bestIndex = _freeRects.size();
+	int bestFit = std::numeric_limits<int>::max();
+
+	for (size_t i = 0, e = _freeRects.size(); i < e; ++i)
+	{
+		const recti& f = _freeRects[i];
+		if ((f.width >= size.x) && (f.height >= size.y))
 		{
-			for (const rect& ii : _placedItems)
+			int fit = etMin(f.width - size.x, f.height - size.y);
+			if (fit < bestFit)
 			{
-				if (ii.intersects(placedPosition) && (ii != i))
-				{
-					placed = false;
-					break;
-				}
+				bestFit = fit;
+				bestIndex = i;
+				if (fit == 0) break;
 			}
 		}
+	}
 
-		if (placed)
+	if (bestIndex == _freeRects.size()) return false;
+
+	recti f = _freeRects[bestIndex];
+	_freeRects[bestIndex] = _freeRects.back();
+	_freeRects.pop_back();
+
+	result = recti(f.left, f.top, size.x, size.y);
+
+	int dw = f.width - size.x;
+	int dh = f.height - size.y;
+
+	if (dw < dh)
+	{
+		addFreeRect(recti(f.left + size.x, f.top, dw, size.y));
+		addFreeRect(recti(f.left, f.top + size.y, f.width, dh));
+	}
+	else
+	{
+		addFreeRect(recti(f.left + size.x, f.top, dw, f.height));
+		addFreeRect(recti(f.left, f.top + size.y, size.x, dh));
+	}
+
+	return true;
+}
+
+bool RectPlacer::placeToSkyline(const vec2i& size, recti& result)
+{
+	size_t bestIndex = _skyline.size();
+	int bestBottom = std::numeric_limits<int>::max();
+	int bestWidth = std::numeric_limits<int>::max();
+
+	for (size_t i = 0, e = _skyline.size(); i < e; ++i)
+	{
+		if (_skyline[i].y + size.y > bestBottom) continue;
+
+		int y = skylineFit(i, size, bestBottom);
+		if (y < 0) continue;
+
+		int bottom = y + size.y;
+		if ((bottom < bestBottom) || ((bottom == bestBottom) && (_skyline[i].width < bestWidth)))
+		{
+			bestIndex = i;
+			bestBottom = bottom;
+			bestWidth = _skyline[i].width;
+			result = recti(_skyline[i].x, y, size.x, size.y);
+		}
+	}
+
+	if (bestIndex == _skyline.size()) return false;
+
+	addSkylineLevel(bestIndex, result);
+	return true;
+}
+
+/*
+ * Returns y coordinate of the rect placed at the node, or -1 if it does not fit
+ * or could not be placed higher than given bottom
+ */
+int RectPlacer::skylineFit(size_t index, const vec2i& size, int maxBottom)
+{
+	const SkylineNode& node = _skyline[index];
+	if (node.x + size.x > _contextSize.x) return -1;
+
+	int y = node.y;
+	int widthLeft = size.x;
+
+	for (size_t i = index; widthLeft > 0; ++i)
+	{
+		y = etMax(y, _skyline[i].y);
+		if ((y + size.y > _contextSize.y) || (y + size.y > maxBottom)) return -1;
+
+		widthLeft -= _skyline[i].width;
+	}
+
+	return y;
+}
+
+void RectPlacer::addSkylineLevel(size_t index, const recti& r)
+{
+	/*
+	 * Space between covered nodes and the bottom of the new level goes to free rects
+	 */
+	int right = r.right();
+	for (size_t i = index, e = _skyline.size(); (i < e) && (_skyline[i].x < right); ++i)
+	{
+		const SkylineNode& node = _skyline[i];
+		int coveredWidth = etMin(right, node.x + node.width) - node.x;
+
+		if (node.y < r.top)
+			addFreeRect(recti(node.x, node.y, coveredWidth, r.top - node.y));
+	}
+
+	_skyline.insert(_skyline.begin() + index, SkylineNode(r.left, r.bottom(), r.width));
+
+	for (size_t i = index + 1; i < _skyline.size(); )
+	{
+		SkylineNode& node = _skyline[i];
+		if (node.x >= right) break;
+
+		int shrink = right - node.x;
+		if (shrink < node.width)
 		{
-			_placedItems.push_back(placedPosition);
-			return true;
+			node.x += shrink;
+			node.width -= shrink;
+			break;
 		}
 
-		placedPosition.setOrigin(i.origin() + vec2(0.0f, i.size().y));
-		placed = (placedPosition.origin().x + w <= _contextSize.x) &&
-			(placedPosition.origin().y + h <= _contextSize.y);
-		
-		if (placed)
+		_skyline.erase(_skyline.begin() + i);
+	}
+
+	size_t last = index + 1;
+	for (size_t i = (index > 0) ? index - 1 : 0; (i < last) && (i + 1 < _skyline.size()); )
+	{
+		if (_skyline[i].y == _skyline[i + 1].y)
 		{
-			for (const rect& ii : _placedItems)
-			{
-				if (ii.intersects(placedPosition) && (ii != i))
-				{
-					placed = false;
-					break;
-				}
-			}
+			_skyline[i].width += _skyline[i + 1].width;
+			_skyline.erase(_skyline.begin() + i + 1);
+			--last;
 		}
+		else
+		{
+			++i;
+		}
+	}
+}
 
-		if (placed) 
+void RectPlacer::addFreeRect(const recti& r)
+{
+	if ((r.width <= 0) || (r.height <= 0)) return;
+
+	recti merged = r;
+
+	bool mergedAny = true;
+	while (mergedAny)
+	{
+		mergedAny = false;
+		for (size_t i = 0, e = _freeRects.size(); i < e; ++i)
 		{
-			_placedItems.push_back(placedPosition);
-			return true;
+			if (mergeRects(merged, _freeRects[i]))
+			{
+				_freeRects[i] = _freeRects.back();
+				_freeRects.pop_back();
+				mergedAny = true;
+				break;
+			}
 		}
 	}
-	
-	return false;
+
+	if ((merged.width >= _minSize.x) && (merged.height >= _minSize.y))
+		_freeRects.push_back(merged);
 }
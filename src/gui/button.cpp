@@ -18,13 +18,19 @@ Button::Button(const std::string& title, Font font, Element2d* parent, const std
 	_textSize(font->measureStringSize(title, true)), _textColor(vec3(0.0f), 1.0f),
 	_textPressedColor(vec3(0.0f), 1.0f), _type(Button::Type_PushButton), _state(State_Default),
 	_imageLayout(ImageLayout_Left), _contentMode(ContentMode_Fit), _pressed(false),
-	_hovered(false), _selected(false)
+	_hovered(false), _selected(false), _fontGeneration(0)
 {
 	setSize(sizeForText(title));
 }
 
 void Button::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 {
+	if (_font.valid() && (_fontGeneration != _font->generation()))
+	{
+		_fontGeneration = _font->generation();
+		invalidateContent();
+	}
+
 	if (!contentValid() || !transformValid())
 		buildVertices(rc, gr);
 
@@ -32,7 +38,7 @@ void Button::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 		gr.addVertices(_bgVertices, _background[_state].texture, ElementRepresentation_2d, RenderLayer_Layer0);
 
 	if (_textVertices.lastElementIndex() > 0)
-		gr.addVertices(_textVertices, _font->texture(), ElementRepresentation_2d, RenderLayer_Layer1);
+		gr.addStringVertices(_textVertices, _font, ElementRepresentation_2d, RenderLayer_Layer1);
 
 	if (_imageVertices.lastElementIndex() > 0)
 		gr.addVertices(_imageVertices, _image.texture, ElementRepresentation_2d, RenderLayer_Layer0);
@@ -153,6 +153,14 @@ void Carousel::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 		i->addToRenderQueue(rc, gr);
 }
 
+void Carousel::elementInvalidated(Element* element)
+{
+	Element3D::elementInvalidated(element);
+
+	if (element != this)
+		Element3D::elementInvalidated(this);
+}
+
 void Carousel::setScale(const vec2& s)
 {
 	_scale = s;
@@ -0,0 +1,301 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/core/conversion.h>
+#include <et/rendering/rendercontext.h>
+#include <et/gui/charactergenerator.h>
+
+using namespace et;
+using namespace et::gui;
+
+namespace
+{
+	const size_t bytesPerPixel = 4;
+	const vec2i characterPadding(2);
+}
+
+CharacterGenerator::Page::Page() :
+	placer(vec2i(PageSize), true), lastUsage(0), dirtyMin(PageSize), dirtyMax(0)
+{
+}
+
+void CharacterGenerator::initialize()
+{
+	_maxPages = DefaultMaxPages;
+	_generation = 0;
+	_batchDepth = 0;
+	_usageCounter = 0;
+	_batchStartUsage = 0;
+	_lineHeight = 0.0f;
+
+	addPage();
+}
+
+void CharacterGenerator::releasePages()
+{
+	for (auto p : _pages)
+		delete p;
+
+	_pages.clear();
+	_characters.clear();
+}
+
+void CharacterGenerator::addPage()
+{
+	std::string textureName = _face + "font";
+	if (_pages.size() > 0)
+		textureName += intToStr(_pages.size());
+
+	Page* page = new Page;
+	page->texture = _rc->textureFactory().genTexture(GL_TEXTURE_2D, GL_RGBA, vec2i(PageSize),
+		GL_RGBA, GL_UNSIGNED_BYTE, BinaryDataStorage(bytesPerPixel * PageSize * PageSize, 0), textureName);
+
+	_pages.push_back(page);
+	_statistics.pagesCount = _pages.size();
+}
+
+void CharacterGenerator::beginBatch()
+{
+	if (_batchDepth++ == 0)
+		_batchStartUsage = _usageCounter + 1;
+}
+
+void CharacterGenerator::endBatch()
+{
+	assert(_batchDepth > 0);
+
+	if (--_batchDepth == 0)
+		updatePages();
+}
+
+CharDescriptor CharacterGenerator::characterDescription(int value, int params)
+{
+	auto i = _characters.find(CharacterKey(value, params));
+	if (i == _characters.end())
+	{
+		_statistics.misses++;
+		return generateCharacter(value, params);
+	}
+
+	_statistics.hits++;
+
+	CachedCharacter& c = i->second;
+	c.lastUsage = ++_usageCounter;
+
+	if (c.place.square() > 0.0f)
+	{
+		Page* page = _pages.at(c.page);
+		page->usage.splice(page->usage.end(), page->usage, c.usagePosition);
+		page->lastUsage = c.lastUsage;
+	}
+
+	return c.descriptor;
+}
+
+CharDescriptor CharacterGenerator::generateCharacter(int value, int params)
+{
+	CharacterKey key(value, params);
+	bool bold = (params & CharParameter_Bold) == CharParameter_Bold;
+
+	CachedCharacter c;
+	c.descriptor = CharDescriptor(value, params);
+	c.lastUsage = ++_usageCounter;
+	c.page = 0;
+
+	vec2i charSize = measureCharacter(value, bold);
+	if (charSize.square() > 0)
+	{
+		rect place;
+		if (!placeCharacter(charSize, place, c.page))
+		{
+			log::warning("Unable to place character %d into glyph cache of %s", value, _face.c_str());
+			c.descriptor.size = vec2(static_cast<float>(charSize.x), static_cast<float>(charSize.y));
+			return c.descriptor;
+		}
+
+		BinaryDataStorage data(bytesPerPixel * static_cast<size_t>(charSize.square()), 0);
+		renderCharacter(value, bold, charSize, data);
+
+		Page* page = _pages.at(c.page);
+
+		c.place = place;
+		c.descriptor.origin = place.origin() + vec2(1.0f);
+		c.descriptor.size = place.size() - vec2(2.0f);
+		c.descriptor.uvOrigin = page->texture->getTexCoord(c.descriptor.origin);
+		c.descriptor.uvSize = c.descriptor.size / page->texture->sizeFloat();
+		c.descriptor.extra.x = static_cast<int>(c.page);
+
+		page->usage.push_back(key);
+		page->lastUsage = c.lastUsage;
+		c.usagePosition = --page->usage.end();
+
+		if ((params == 0) && (_lineHeight == 0.0f))
+			_lineHeight = c.descriptor.size.y;
+
+		auto i = _characters.insert(std::make_pair(key, c)).first;
+		storeCharacterPixels(page, i->second, charSize, data);
+
+		if (_batchDepth == 0)
+			updatePages();
+
+		return c.descriptor;
+	}
+
+	_characters.insert(std::make_pair(key, c));
+	return c.descriptor;
+}
+
+bool CharacterGenerator::placeCharacter(const vec2i& size, rect& place, size_t& page)
+{
+	vec2i paddedSize = size + characterPadding;
+	if ((paddedSize.x >= PageSize) || (paddedSize.y >= PageSize)) return false;
+
+	for (size_t i = 0, e = _pages.size(); i < e; ++i)
+	{
+		if (_pages[i]->placer.place(paddedSize, place))
+		{
+			page = i;
+			return true;
+		}
+	}
+
+	if (_pages.size() < _maxPages)
+	{
+		addPage();
+		page = _pages.size() - 1;
+		return _pages.back()->placer.place(paddedSize, place);
+	}
+
+	return evictCharacters(paddedSize, place, page);
+}
+
+/*
+ * Characters used in the current batch are never evicted,
+ * so descriptors of the string being built stay valid.
+ */
+bool CharacterGenerator::evictCharacters(const vec2i& size, rect& place, size_t& page)
+{
+	std::vector<std::pair<uint64_t, size_t>> pagesByUsage;
+	for (size_t i = 0, e = _pages.size(); i < e; ++i)
+		pagesByUsage.push_back(std::make_pair(_pages[i]->lastUsage, i));
+
+	std::sort(pagesByUsage.begin(), pagesByUsage.end());
+
+	for (auto& p : pagesByUsage)
+	{
+		Page* candidate = _pages.at(p.second);
+
+		while (candidate->usage.size() > 0)
+		{
+			auto i = _characters.find(candidate->usage.front());
+			assert(i != _characters.end());
+
+			if ((_batchDepth > 0) && (i->second.lastUsage >= _batchStartUsage)) break;
+
+			evictCharacter(i);
+
+			if (candidate->placer.place(size, place))
+			{
+				page = p.second;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void CharacterGenerator::evictCharacter(CachedCharacterMap::iterator i)
+{
+	CachedCharacter& c = i->second;
+	Page* page = _pages.at(c.page);
+
+	page->placer.remove(c.place);
+	page->usage.erase(c.usagePosition);
+
+	_characters.erase(i);
+
+	_statistics.evictions++;
+	_generation++;
+}
+
+/*
+ * Character is stored together with the padding around it, so pixels left
+ * by evicted characters are overwritten and never sampled by neighbours.
+ * Rows are stored in the same order as in the texture, from the bottom.
+ */
+void CharacterGenerator::storeCharacterPixels(Page* page, CachedCharacter& c, const vec2i& size,
+	const BinaryDataStorage& data)
+{
+	vec2i paddedSize(static_cast<int>(c.place.width), static_cast<int>(c.place.height));
+	vec2i origin(static_cast<int>(c.place.left), PageSize - static_cast<int>(c.place.top) - paddedSize.y);
+
+	c.pixels.resize(bytesPerPixel * static_cast<size_t>(paddedSize.square()));
+	c.pixels.fill(0);
+
+	size_t rowSize = bytesPerPixel * static_cast<size_t>(size.x);
+	size_t paddedRowSize = bytesPerPixel * static_cast<size_t>(paddedSize.x);
+	for (int row = 0; row < size.y; ++row)
+	{
+		size_t offset = static_cast<size_t>(row + 1) * paddedRowSize + bytesPerPixel;
+		etCopyMemory(c.pixels.binary() + offset, data.binary() + static_cast<size_t>(row) * rowSize, rowSize);
+	}
+
+	page->dirtyMin = vec2i(etMin(page->dirtyMin.x, origin.x), etMin(page->dirtyMin.y, origin.y));
+	page->dirtyMax = vec2i(etMax(page->dirtyMax.x, origin.x + paddedSize.x),
+		etMax(page->dirtyMax.y, origin.y + paddedSize.y));
+}
+
+/*
+ * Region covering characters generated in the batch is composed from all characters
+ * of the page intersecting it, and uploaded by single update per page
+ */
+void CharacterGenerator::updatePages()
+{
+	for (auto page : _pages)
+	{
+		if ((page->dirtyMax.x <= page->dirtyMin.x) || (page->dirtyMax.y <= page->dirtyMin.y)) continue;
+
+		vec2i regionSize = page->dirtyMax - page->dirtyMin;
+		size_t regionRowSize = bytesPerPixel * static_cast<size_t>(regionSize.x);
+		BinaryDataStorage region(regionRowSize * static_cast<size_t>(regionSize.y), 0);
+
+		for (const auto& key : page->usage)
+		{
+			const CachedCharacter& c = _characters.at(key);
+
+			vec2i size(static_cast<int>(c.place.width), static_cast<int>(c.place.height));
+			vec2i origin(static_cast<int>(c.place.left), PageSize - static_cast<int>(c.place.top) - size.y);
+
+			int left = etMax(origin.x, page->dirtyMin.x);
+			int right = etMin(origin.x + size.x, page->dirtyMax.x);
+			int bottom = etMax(origin.y, page->dirtyMin.y);
+			int top = etMin(origin.y + size.y, page->dirtyMax.y);
+			if ((left >= right) || (bottom >= top)) continue;
+
+			size_t rowSize = bytesPerPixel * static_cast<size_t>(size.x);
+			size_t copySize = bytesPerPixel * static_cast<size_t>(right - left);
+			for (int row = bottom; row < top; ++row)
+			{
+				size_t srcOffset = static_cast<size_t>(row - origin.y) * rowSize +
+					bytesPerPixel * static_cast<size_t>(left - origin.x);
+				size_t dstOffset = static_cast<size_t>(row - page->dirtyMin.y) * regionRowSize +
+					bytesPerPixel * static_cast<size_t>(left - page->dirtyMin.x);
+				etCopyMemory(region.binary() + dstOffset, c.pixels.binary() + srcOffset, copySize);
+			}
+		}
+
+		page->texture->updatePartialDataDirectly(_rc, page->dirtyMin, regionSize,
+			region.binary(), region.dataSize());
+
+		page->dirtyMin = vec2i(PageSize);
+		page->dirtyMax = vec2i(0);
+
+		_statistics.textureUpdates++;
+	}
+}
@@ -168,18 +168,12 @@ vec2 FontData::measureStringSize(const CharDescriptorList& s)
 
 vec2 FontData::measureStringSize(const std::string& s, bool formatted)
 {
-	if (isUtf8String(s))
-	{
-		std::wstring ws = utf8ToUnicode(s);
-		return measureStringSize(formatted ? parseString(ws) : buildString(ws, formatted));
-	}
-	
-	return measureStringSize(formatted ? parseString(s) : buildString(s, formatted));
+	return measureStringSize(buildString(s, formatted));
 }
 
 vec2 FontData::measureStringSize(const std::wstring& s, bool formatted)
 {
-	return measureStringSize(formatted ? parseString(s) : buildString(s, formatted));
+	return measureStringSize(buildString(s, formatted));
 }
 
 CharDescriptorList FontData::buildString(const std::string& s, bool formatted)
@@ -187,24 +181,47 @@ CharDescriptorList FontData::buildString(const std::string& s, bool formatted)
 	if (isUtf8String(s))
 		return buildString(utf8ToUnicode(s), formatted);
 
+	CharDescriptorList result;
+	beginBatch();
+	
 	if (formatted)
-		return parseString(s);
+		result = parseString(s);
+	else
+		ET_ITERATE(s, auto, i, result.push_back(charDescription(i)));
 
-	CharDescriptorList result;
-	ET_ITERATE(s, auto, i, result.push_back(charDescription(i)));
+	endBatch();
 	return result;
 }
 
 CharDescriptorList FontData::buildString(const std::wstring& s, bool formatted)
 {
+	CharDescriptorList result;
+	beginBatch();
+	
 	if (formatted)
-		return parseString(s);
+		result = parseString(s);
+	else
+		ET_ITERATE(s, auto, i, result.push_back(charDescription(i)));
 
-	CharDescriptorList result;
-	ET_ITERATE(s, auto, i, result.push_back(charDescription(i)));
+	endBatch();
 	return result;
 }
 
+/*
+ * Missing characters of the string are generated with single texture update
+ */
+void FontData::beginBatch()
+{
+	if (_generator.valid())
+		_generator->beginBatch();
+}
+
+void FontData::endBatch()
+{
+	if (_generator.valid())
+		_generator->endBatch();
+}
+
 CharDescriptorList FontData::parseString(const std::string& s)
 {
 	CharDescriptorList result;
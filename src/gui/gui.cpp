@@ -19,7 +19,7 @@ static const bool shouldSaveFillRate = false;
 
 Gui::Gui(RenderContext* rc) : _rc(rc),  _renderer(rc, shouldSaveFillRate),
 	_renderingElementBackground(new RenderingElement(rc)),
-	_background(Texture(), 0), _backgroundValid(true)
+	_background(Texture(), 0), _verticesRebuilt(0), _backgroundValid(true)
 {
 	_background.setPivotPoint(vec2(0.5f));
 	_background.setContentMode(ImageView::ContentMode_Fill);
@@ -102,7 +102,11 @@ void Gui::buildLayoutVertices(RenderContext* rc, RenderingElement::Pointer eleme
 {
 	_renderer.setRendernigElement(element);
 
-	if (!layout->valid())
+	/*
+	 * Layout is rebuilt when characters used by it were evicted from the glyph cache,
+	 * elements update their strings comparing generation of the font
+	 */
+	if (!layout->valid() || element->fontsOutdated() || !layout->updateRenderQueue(rc, _renderer))
 	{
 		element->clear();
 		layout->addToRenderQueue(rc, _renderer);
@@ -133,6 +137,7 @@ void Gui::layout(const vec2& size)
 void Gui::render(RenderContext* rc)
 {
 	_renderer.beginRender(rc);
+	_verticesRebuilt = 0;
 
 	if (_background.texture().valid())
 	{
@@ -141,6 +146,7 @@ void Gui::render(RenderContext* rc)
 		_renderer.setCustomAlpha(1.0f);
 		_renderer.setCustomOffset(vec2(0.0f));
 		_renderer.render(rc);
+		_verticesRebuilt += _renderingElementBackground->verticesRebuilt();
 	}
 
 	for (auto& obj : _layouts)
@@ -149,6 +155,7 @@ void Gui::render(RenderContext* rc)
 		_renderer.setCustomAlpha(obj->offsetAlpha.z);
 		_renderer.setCustomOffset(obj->offsetAlpha.xy());
 		_renderer.render(rc);
+		_verticesRebuilt += obj->layout->renderingElement()->verticesRebuilt();
 	}
 
 	_renderer.endRender(rc);
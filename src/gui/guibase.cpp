@@ -28,14 +28,19 @@ State et::gui::adjustState(State s)
 Element::Element(Element* parent, const std::string& name) : ElementHierarchy(parent), tag(0), _name(name),
 	_enabled(true), _transformValid(false), _inverseTransformValid(false), _contentValid(false)
 {
-	
+	if (parent)
+		parent->setInvalid();
 }
 
 void Element::setParent(Element* element)
 {
+	if (parent())
+		parent()->setInvalid();
+
 	ElementHierarchy::setParent(element);
 	invalidateContent();
 	invalidateTransform();
+	setInvalid();
 }
 
 bool Element::enabled() const
@@ -55,7 +60,7 @@ void Element::invalidateContent()
 	for (Element::List::iterator i = children().begin(), e = children().end(); i != e; ++i)
 		(*i)->invalidateContent();
 
-	setInvalid();
+	elementInvalidated(this);
 }
 
 void Element::invalidateTransform()
@@ -66,7 +71,7 @@ void Element::invalidateTransform()
 	for (Element::List::iterator i = children().begin(), e = children().end(); i != e; ++i)
 		(*i)->invalidateTransform();
 
-	setInvalid();
+	elementInvalidated(this);
 }
 
 void Element::addToRenderQueue(RenderContext*, GuiRenderer&) 
@@ -102,12 +107,14 @@ void Element::bringToFront(Element* c)
 {
 	ElementHierarchy::bringToFront(c);
 	invalidateContent();
+	setInvalid();
 }
 
 void Element::sendToBack(Element* c)
 {
 	ElementHierarchy::sendToBack(c);
 	invalidateContent();
+	setInvalid();
 }
 
 void Element::broardcastMessage(const GuiMessage& msg)
@@ -14,13 +14,21 @@ using namespace et::gui;
 
 const size_t BlockSize = 2048;
 
+/*
+ * Strings of the elements are allocated with reserve, so text could grow
+ * by a few characters without rebuilding the whole layout
+ */
+inline size_t stringVerticesReserve(size_t count)
+	{ return 6 * (1 + count / 24); }
+
 extern std::string gui_default_vertex_src;
 extern std::string gui_default_frag_src;
 extern std::string gui_savefillrate_vertex_src;
 extern std::string gui_savefillrate_frag_src;
 
 GuiRenderer::GuiRenderer(RenderContext* rc, bool saveFillRate) :
-	_rc(rc), _customAlpha(1.0f), _saveFillRate(saveFillRate)
+	_rc(rc), _customAlpha(1.0f), _saveFillRate(saveFillRate), _updatedElement(nullptr),
+	_updatedAllocation(0), _updateFailed(false)
 {
 	pushClipRect(recti(vec2i(0), rc->sizei()));
 
@@ -112,19 +120,27 @@ void GuiRenderer::alloc(size_t count)
 	}
 }
 
-GuiVertexPointer GuiRenderer::allocateVertices(size_t count, const Texture& inTexture,
+size_t GuiRenderer::allocateVertices(size_t count, size_t reserve, const Texture& inTexture,
 	ElementRepresentation cls, RenderLayer layer)
 {
-	if (!_renderingElement.valid()) return 0;
+	assert(_renderingElement.valid());
 	
 	Texture texture = inTexture.invalid() ? _defaultTexture : inTexture;
 
+	if (_updatedElement != nullptr)
+		return reuseVertices(count, texture, cls, layer);
+
+	if (_elementsStack.empty())
+		reserve = 0;
+
+	RenderLayer elementLayer = layer;
+	size_t allocatedCount = count + reserve;
+
 	bool shouldAdd = _renderingElement->_chunks.empty() || (_saveFillRate && (layer == RenderLayer_Layer1));
 	
 	if (_saveFillRate)
 		layer = RenderLayer_Layer0;
 	
-	_renderingElement->_changed = true;
 	size_t i0 = _renderingElement->_vertexList.lastElementIndex();
 
 	if (_renderingElement->_chunks.size())
@@ -135,7 +151,7 @@ GuiVertexPointer GuiRenderer::allocateVertices(size_t count, const Texture& inTe
 			(lastChunk.layers[layer] == texture) && (lastChunk.clip == _clip.top());
 		
 		if (sameConfiguration)
-			lastChunk.count += count;
+			lastChunk.count += allocatedCount;
 		
 		shouldAdd = !sameConfiguration;
 	}
@@ -143,18 +159,120 @@ GuiVertexPointer GuiRenderer::allocateVertices(size_t count, const Texture& inTe
 	if (shouldAdd)
 	{
 		_lastTextures[layer] = texture;
-		_renderingElement->_chunks.push_back(RenderChunk(i0, count, 
+		_renderingElement->_chunks.push_back(RenderChunk(i0, allocatedCount, 
 			_lastTextures[RenderLayer_Layer0], _lastTextures[RenderLayer_Layer1], _clip.top(), cls));
 	}
 	
-	alloc(count);
+	alloc(allocatedCount);
 	
-	_renderingElement->_vertexList.applyOffset(count);
+	_renderingElement->_vertexList.applyOffset(allocatedCount);
+	_renderingElement->clearVertices(i0 + count, reserve);
+
+	if (!_elementsStack.empty() && (_elementsStack.back() != nullptr))
+	{
+		_elementsStack.back()->allocations.push_back(RenderingElement::ElementAllocation(i0,
+			allocatedCount, texture, _clip.top(), cls, elementLayer));
+	}
 
 	assert(i0 < _renderingElement->_vertexList.size());
 	assert(i0 * _renderingElement->_vertexList.typeSize() < _renderingElement->_vertexList.dataSize());
 
-	return _renderingElement->_vertexList.element_ptr(i0);
+	return i0;
+}
+
+size_t GuiRenderer::reuseVertices(size_t count, const Texture& texture,
+	ElementRepresentation cls, RenderLayer layer)
+{
+	RenderingElement::ElementAllocationList& allocations = _updatedElement->allocations;
+
+	if (!_updateFailed && (_updatedAllocation < allocations.size()))
+	{
+		const RenderingElement::ElementAllocation& a = allocations[_updatedAllocation];
+
+		bool sameConfiguration = (a.representation == cls) && (a.layer == layer) &&
+			(a.texture == texture) && (a.clip == _clip.top());
+
+		if (sameConfiguration && (count <= a.count))
+		{
+			++_updatedAllocation;
+			_renderingElement->clearVertices(a.first + count, a.count - count);
+			return a.first;
+		}
+	}
+
+	/*
+	 * Vertices are written past the end of the list, layout is rebuilt anyway
+	 */
+	_updateFailed = true;
+	alloc(count);
+
+	return _renderingElement->_vertexList.lastElementIndex();
+}
+
+void GuiRenderer::beginElement(const Element* element)
+{
+	RenderingElement::ElementVertices* vertices = nullptr;
+
+	if (_renderingElement.valid())
+	{
+		vertices = &_renderingElement->_elements[element];
+		vertices->clip = _clip.top();
+		vertices->visits++;
+	}
+
+	_elementsStack.push_back(vertices);
+}
+
+void GuiRenderer::endElement()
+{
+	assert(!_elementsStack.empty());
+	_elementsStack.pop_back();
+}
+
+bool GuiRenderer::elementHasVertices(const Element* element) const
+{
+	if (_renderingElement.invalid()) return false;
+
+	auto i = _renderingElement->_elements.find(element);
+	return (i != _renderingElement->_elements.end()) && !i->second.allocations.empty();
+}
+
+/*
+ * Elements rendered several times (e.g. topmost ones) are not updated in place
+ */
+bool GuiRenderer::beginElementUpdate(const Element* element)
+{
+	assert(_updatedElement == nullptr);
+	if (_renderingElement.invalid()) return false;
+
+	auto i = _renderingElement->_elements.find(element);
+	if ((i == _renderingElement->_elements.end()) || (i->second.visits != 1)) return false;
+
+	_updatedElement = &i->second;
+	_updatedAllocation = 0;
+	_updateFailed = false;
+
+	resetClipRect();
+	pushClipRect(_updatedElement->clip);
+
+	return true;
+}
+
+bool GuiRenderer::endElementUpdate()
+{
+	assert(_updatedElement != nullptr);
+
+	RenderingElement::ElementAllocationList& allocations = _updatedElement->allocations;
+	if (!_updateFailed)
+	{
+		for (size_t i = _updatedAllocation, e = allocations.size(); i < e; ++i)
+			_renderingElement->clearVertices(allocations[i].first, allocations[i].count);
+	}
+
+	_updatedElement = nullptr;
+	resetClipRect();
+
+	return !_updateFailed;
 }
 
 size_t GuiRenderer::addVertices(const GuiVertexList& vertices, const Texture& texture,
@@ -165,14 +283,60 @@ size_t GuiRenderer::addVertices(const GuiVertexList& vertices, const Texture& te
 	
 	if (_renderingElement.valid() && (count > 0))
 	{
-		current = _renderingElement->_vertexList.lastElementIndex();
-		GuiVertex* v0 = allocateVertices(count, texture, cls, layer);
-		etCopyMemory(v0, vertices.data(), count * vertices.typeSize());
+		current = allocateVertices(count, 0, texture, cls, layer);
+		_renderingElement->setVertices(current, vertices.data(), count);
 	}
 
 	return current;
 }
 
+/*
+ * Layer mask of string vertices is increased by doubled index of the font page
+ */
+inline size_t stringVertexPage(const GuiVertex& v)
+	{ return static_cast<size_t>(etMax(0.0f, 0.5f * v.texCoord.z)); }
+
+void GuiRenderer::addStringVertices(const GuiVertexList& vertices, const Font& font,
+	ElementRepresentation cls, RenderLayer layer)
+{
+	size_t count = vertices.lastElementIndex();
+	if (!_renderingElement.valid() || (count == 0)) return;
+
+	_renderingElement->useFont(font);
+
+	size_t first = 0;
+	while (first < count)
+	{
+		size_t page = stringVertexPage(vertices[first]);
+
+		size_t last = first + 1;
+		while ((last < count) && (stringVertexPage(vertices[last]) == page))
+			++last;
+
+		size_t runSize = last - first;
+		size_t i0 = allocateVertices(runSize, stringVerticesReserve(runSize), font->texture(page), cls, layer);
+
+		if (page == 0)
+		{
+			_renderingElement->setVertices(i0, vertices.element_ptr(first), runSize);
+		}
+		else
+		{
+			if (_pageVertices.size() < runSize)
+				_pageVertices.resize(runSize);
+
+			for (size_t i = 0; i < runSize; ++i)
+			{
+				_pageVertices[i] = vertices[first + i];
+				_pageVertices[i].texCoord.z -= 2.0f * static_cast<float>(page);
+			}
+			_renderingElement->setVertices(i0, _pageVertices.data(), runSize);
+		}
+
+		first = last;
+	}
+}
+
 void GuiRenderer::setRendernigElement(const RenderingElement::Pointer& r)
 {
 	_renderingElement = r;
@@ -301,12 +465,13 @@ void GuiRenderer::createStringVertices(GuiVertexList& vertices, const CharDescri
 			vec2 bottomLeftUV = desc.uvOrigin - vec2(0.0f, desc.uvSize.y);
 			vec2 bottomRightUV = bottomLeftUV + vec2(desc.uvSize.x, 0.0f);
 			vec4 charColor = desc.color * color;
+			vec2 charMask(mask.x + 2.0f * static_cast<float>(desc.extra.x), mask.y);
 			
 			buildQuad(vertices,
-				GuiVertex(floorv(transform * topLeft), vec4(topLeftUV, mask), charColor),
-				GuiVertex(floorv(transform * topRight), vec4(topRightUV, mask), charColor),
-				GuiVertex(floorv(transform * bottomLeft), vec4(bottomLeftUV, mask), charColor),
-				GuiVertex(floorv(transform * bottomRight), vec4(bottomRightUV, mask), charColor));
+				GuiVertex(floorv(transform * topLeft), vec4(topLeftUV, charMask), charColor),
+				GuiVertex(floorv(transform * topRight), vec4(topRightUV, charMask), charColor),
+				GuiVertex(floorv(transform * bottomLeft), vec4(bottomLeftUV, charMask), charColor),
+				GuiVertex(floorv(transform * bottomRight), vec4(bottomRightUV, charMask), charColor));
 			
 			line.x += desc.size.x;
 		}
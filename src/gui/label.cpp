@@ -18,21 +18,30 @@ Label::Label(const std::string& text, Font font, Element2d* parent, const std::s
 	Element2d(parent, ET_GUI_PASS_NAME_TO_BASE_CLASS), _text(text), _nextText(text), _font(font),
 	_vertices(0), _backgroundColor(0.0f), _shadowOffset(1.0f), _textFade(0.0f), _textFadeDuration(0.0f),
 	_textFadeStartTime(0.0f), _horizontalAlignment(Alignment_Near),
-	_verticalAlignment(Alignment_Near), _animatingText(false), _allowFormatting(false)
+	_verticalAlignment(Alignment_Near), _fontGeneration(0), _animatingText(false), _allowFormatting(false)
 {
 	setFlag(Flag_TransparentForPointer);
 	_charListText = _font->buildString(_text);
 	_charListNextText = _font->buildString(_nextText);
+	_fontGeneration = _font->generation();
 	adjustSize();
 }
 
 void Label::addToRenderQueue(RenderContext* rc, GuiRenderer& guiRenderer) 
 {
+	if (_fontGeneration != _font->generation())
+	{
+		_fontGeneration = _font->generation();
+		_charListText = _font->buildString(_text, _allowFormatting);
+		_charListNextText = _font->buildString(_nextText, _allowFormatting);
+		invalidateContent();
+	}
+
 	if (!contentValid() || !transformValid())
 		buildVertices(rc, guiRenderer);
 
 	if (_vertices.lastElementIndex() > 0)
-		guiRenderer.addVertices(_vertices, _font->texture(), ElementRepresentation_2d, RenderLayer_Layer1);
+		guiRenderer.addStringVertices(_vertices, _font, ElementRepresentation_2d, RenderLayer_Layer1);
 }
 
 void Label::buildVertices(RenderContext*, GuiRenderer& renderer)
@@ -34,6 +34,8 @@ void Layout::addElementToRenderQueue(Element* element, RenderContext* rc, GuiRen
 {
 	if (!element->visible()) return;
 
+	gr.beginElement(element);
+
 	bool clipToBounds = element->hasFlag(Flag_ClipToBounds);
 
 	if (clipToBounds)
@@ -57,6 +59,45 @@ void Layout::addElementToRenderQueue(Element* element, RenderContext* rc, GuiRen
 	
 	if (clipToBounds)
 		gr.popClipRect();
+
+	gr.endElement();
+}
+
+/*
+ * Element is rebuilt at the place of its vertices, with the clip rect it was rendered with.
+ * Elements which became visible or were removed from the layout require full rebuild.
+ */
+bool Layout::updateElementInRenderQueue(Element* element, RenderContext* rc, GuiRenderer& gr)
+{
+	bool visible = true;
+	Element* root = element;
+	while (root->parent() != nullptr)
+	{
+		visible = visible && root->visible();
+		root = root->parent();
+	}
+
+	if (root != this) return false;
+	if (!visible) return !gr.elementHasVertices(element);
+	if (!gr.beginElementUpdate(element)) return false;
+
+	bool clipToBounds = element->hasFlag(Flag_ClipToBounds);
+
+	if (clipToBounds)
+	{
+		mat4 parentTransform = element->parent()->finalTransform();
+		vec2 eSize = multiplyWithoutTranslation(element->size(), parentTransform);
+		vec2 eOrigin = parentTransform * element->origin();
+		
+		gr.pushClipRect(recti(vec2i(static_cast<int>(eOrigin.x),
+			static_cast<int>(rc->size().y - eOrigin.y - eSize.y)),
+			vec2i(static_cast<int>(eSize.x), static_cast<int>(eSize.y))));
+	}
+
+	element->addToRenderQueue(rc, gr);
+	element->addToOverlayRenderQueue(rc, gr);
+
+	return gr.endElementUpdate();
 }
 
 void Layout::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
@@ -78,9 +119,28 @@ void Layout::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 	if (elementIsBeingDragged(_capturedElement))
 		addElementToRenderQueue(_capturedElement, rc, gr);
 	
+	_invalidElements.clear();
 	_valid = true;
 }
 
+bool Layout::updateRenderQueue(RenderContext* rc, GuiRenderer& gr)
+{
+	std::map<Element*, Element::Pointer> invalidElements;
+	invalidElements.swap(_invalidElements);
+
+	for (auto& i : invalidElements)
+	{
+		if (!updateElementInRenderQueue(i.first, rc, gr))
+			return false;
+	}
+
+	/*
+	 * Elements invalidated while adding vertices are already rebuilt
+	 */
+	_invalidElements.clear();
+	return true;
+}
+
 bool Layout::pointerPressed(const et::PointerInputInfo& p)
 { 
 	if (hasFlag(Flag_TransparentForPointer)) return false;
@@ -242,7 +302,7 @@ bool Layout::pointerScrolled(const et::PointerInputInfo& p)
 
 Element* Layout::activeElement(const PointerInputInfo& p)
 {
-	if (!_valid)
+	if (!_valid || !_invalidElements.empty())
 	{
 		_topmostElements.clear();
 		ET_ITERATE(children(), auto&, i, collectTopmostElements(i.ptr()))
@@ -365,6 +425,14 @@ void Layout::setInvalid()
 	_valid = false;
 }
 
+void Layout::elementInvalidated(Element* element)
+{
+	if (element == this)
+		setInvalid();
+	else if (_valid)
+		_invalidElements[element] = Element::Pointer(element);
+}
+
 void Layout::collectTopmostElements(Element* element)
 {
 	if (!element->visible()) return;
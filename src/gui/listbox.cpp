@@ -21,7 +21,7 @@ ET_DECLARE_GUI_ELEMENT_CLASS(ListboxPopup)
 
 ListboxPopup::ListboxPopup(Listbox* owner, const std::string& name) :
 	Element2d(owner, ET_GUI_PASS_NAME_TO_BASE_CLASS), _owner(owner), _textAlphaAnimator(0),
-	_selectedIndex(invalidSelectedIndex), _textAlpha(0.0f), _pressed(false)
+	_selectedIndex(invalidSelectedIndex), _fontGeneration(0), _textAlpha(0.0f), _pressed(false)
 {
 	setFlag(Flag_RenderTopmost);
 }
@@ -115,6 +115,12 @@ void ListboxPopup::animatorFinished(BaseAnimator* a)
 
 void ListboxPopup::addToRenderQueue(RenderContext*, GuiRenderer& gr)
 {
+	if (_fontGeneration != _owner->_font->generation())
+	{
+		_fontGeneration = _owner->_font->generation();
+		invalidateContent();
+	}
+
 	if (!contentValid() || !transformValid())
 		buildVertices(gr);
 
@@ -125,7 +131,7 @@ void ListboxPopup::addToRenderQueue(RenderContext*, GuiRenderer& gr)
 		gr.addVertices(_selectionVertices, _owner->_selection.texture, ElementRepresentation_2d, RenderLayer_Layer0);
 
 	if (_textVertices.lastElementIndex() > 0)
-		gr.addVertices(_textVertices, _owner->_font->texture(), ElementRepresentation_2d, RenderLayer_Layer1);
+		gr.addStringVertices(_textVertices, _owner->_font, ElementRepresentation_2d, RenderLayer_Layer1);
 }
 
 bool ListboxPopup::pointerPressed(const PointerInputInfo&)
@@ -173,7 +179,7 @@ ET_DECLARE_GUI_ELEMENT_CLASS(Listbox)
 
 Listbox::Listbox(Font font, Element2d* parent, const std::string& name) :
 	Element2d(parent, ET_GUI_PASS_NAME_TO_BASE_CLASS), _font(font), _state(ListboxState_Default),
-	_contentOffset(0.0f), _selectedIndex(invalidSelectedIndex), _direction(ListboxPopupDirection_Bottom),
+	_contentOffset(0.0f), _selectedIndex(invalidSelectedIndex), _fontGeneration(0), _direction(ListboxPopupDirection_Bottom),
 	_popupOpened(false), _popupOpening(false), _popupValid(false)
 {
 	_popup = ListboxPopup::Pointer(new ListboxPopup(this));
@@ -231,6 +237,12 @@ void Listbox::buildVertices(GuiRenderer& gr)
 
 void Listbox::addToRenderQueue(RenderContext*, GuiRenderer& gr)
 {
+	if (_fontGeneration != _font->generation())
+	{
+		_fontGeneration = _font->generation();
+		invalidateContent();
+	}
+
 	if (!contentValid())
 		buildVertices(gr);
 
@@ -238,7 +250,7 @@ void Listbox::addToRenderQueue(RenderContext*, GuiRenderer& gr)
 		gr.addVertices(_backgroundVertices, _images[_state].texture, ElementRepresentation_2d, RenderLayer_Layer0);
 
 	if (shouldDrawText())
-		gr.addVertices(_textVertices, _font->texture(),  ElementRepresentation_2d, RenderLayer_Layer1);
+		gr.addStringVertices(_textVertices, _font, ElementRepresentation_2d, RenderLayer_Layer1);
 }
 
 bool Listbox::shouldDrawText()
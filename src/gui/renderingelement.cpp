@@ -12,7 +12,8 @@ using namespace et;
 using namespace et::gui;
 
 RenderingElement::RenderingElement(RenderContext* rc) : _rs(rc->renderState()),
-	_indexArray(new IndexArray(IndexArrayFormat_16bit, 0, PrimitiveType_Triangles)), _changed(false)
+	_indexArray(new IndexArray(IndexArrayFormat_16bit, 0, PrimitiveType_Triangles)), _uploadedCapacity(0),
+	_changedVertices(0), _verticesRebuilt(0), _verticesUploaded(0)
 {
 	VertexDeclaration decl(true, Usage_Position, Type_Vec3);
 	decl.push_back(Usage_TexCoord0, Type_Vec4);
@@ -30,21 +31,101 @@ void RenderingElement::clear()
 	_vertexList.setOffset(0);
 	_indexArray->setActualSize(0);
 	_chunks.clear();
-	_changed = true;
+	_fonts.clear();
+	_elements.clear();
 }
 
+void RenderingElement::useFont(const Font& font)
+{
+	for (auto& f : _fonts)
+	{
+		if (f.font == font) return;
+	}
+
+	_fonts.push_back(FontGeneration(font, font->generation()));
+}
+
+bool RenderingElement::fontsOutdated() const
+{
+	for (auto& f : _fonts)
+	{
+		if (f.font->generation() != f.generation)
+			return true;
+	}
+
+	return false;
+}
+
+void RenderingElement::setVertices(size_t first, const GuiVertex* vertices, size_t count)
+{
+	if (count == 0) return;
+
+	etCopyMemory(_vertexList.element_ptr(first), vertices, count * _vertexList.typeSize());
+	addChangedRange(first, count);
+}
+
+void RenderingElement::clearVertices(size_t first, size_t count)
+{
+	if (count == 0) return;
+
+	etFillMemory(_vertexList.element_ptr(first), 0, count * _vertexList.typeSize());
+	addChangedRange(first, count);
+}
+
+void RenderingElement::addChangedRange(size_t first, size_t count)
+{
+	_changedVertices += count;
+
+	/*
+	 * Elements are rebuilt in any order, so only touching ranges are merged
+	 */
+	if (_changedRanges.size() && (first <= _changedRanges.back().first + _changedRanges.back().count) &&
+		(_changedRanges.back().first <= first + count))
+	{
+		VertexRange& last = _changedRanges.back();
+		size_t end = etMax(last.first + last.count, first + count);
+		last.first = etMin(last.first, first);
+		last.count = end - last.first;
+	}
+	else
+	{
+		_changedRanges.push_back(VertexRange(first, count));
+	}
+}
+
+/*
+ * Buffers are reallocated only when vertex list grows, index array is linear and is uploaded only then
+ */
 const VertexArrayObject& RenderingElement::vertexArrayObject()
 {
 	_rs.bindVertexArray(_vao);
 
-	if (_changed)
+	_verticesRebuilt = _changedVertices;
+	_verticesUploaded = 0;
+
+	size_t capacity = _vertexList.size();
+	size_t vertexSize = _vertexList.typeSize();
+
+	if (capacity != _uploadedCapacity)
 	{
-		size_t count = _vertexList.lastElementIndex();
-		_indexArray->setActualSize(count);
-		_vao->vertexBuffer()->setData(_vertexList.data(), count * _vertexList.typeSize());
+		_indexArray->setActualSize(capacity);
+		_vao->vertexBuffer()->setData(_vertexList.data(), _vertexList.dataSize());
 		_vao->indexBuffer()->setData(_indexArray);
-		_changed = false;
+		_uploadedCapacity = capacity;
+		_verticesUploaded = capacity;
+	}
+	else
+	{
+		for (auto& r : _changedRanges)
+		{
+			_vao->vertexBuffer()->setDataWithOffset(_vertexList.element_ptr(r.first),
+				r.first * vertexSize, r.count * vertexSize);
+			_verticesUploaded += r.count;
+		}
 	}
 
+	_changedRanges.clear();
+	_changedVertices = 0;
+
 	return _vao;
 }
@@ -18,7 +18,8 @@ ET_DECLARE_GUI_ELEMENT_CLASS(TextField)
 
 TextField::TextField(const Image& background, const std::string& text, Font font,
 	Element* parent, const std::string& name) : Element2d(parent, ET_GUI_PASS_NAME_TO_BASE_CLASS),
-	_font(font), _background(background), _text(text), _secured(false), _caretVisible(false)
+	_font(font), _background(background), _text(text), _fontGeneration(0),
+	_secured(false), _caretVisible(false)
 {
 	setFlag(Flag_RequiresKeyboard);
 	setSize(font->measureStringSize(text));
@@ -28,6 +29,12 @@ TextField::TextField(const Image& background, const std::string& text, Font font
 
 void TextField::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 {
+	if (_fontGeneration != _font->generation())
+	{
+		_fontGeneration = _font->generation();
+		invalidateContent();
+	}
+
 	if (!contentValid() || !transformValid())
 		buildVertices(rc, gr);
 	
@@ -38,7 +45,7 @@ void TextField::addToRenderQueue(RenderContext* rc, GuiRenderer& gr)
 		gr.addVertices(_imageVertices, _background.texture, ElementRepresentation_2d, RenderLayer_Layer0);
 	
 	if (_textVertices.lastElementIndex() > 0)
-		gr.addVertices(_textVertices, _font->texture(), ElementRepresentation_2d, RenderLayer_Layer1);
+		gr.addStringVertices(_textVertices, _font, ElementRepresentation_2d, RenderLayer_Layer1);
 }
 
 void TextField::buildVertices(RenderContext*, GuiRenderer& gr)
@@ -25,107 +25,25 @@ TextureAtlasWriter::TextureAtlasItem& TextureAtlasWriter::addItem(const vec2i& t
 	TextureAtlasItem& item = _items.back();
 	item.texture = et::TextureDescription::Pointer(new et::TextureDescription);
 	item.texture->size = textureSize;
+	item.placer = RectPlacer(textureSize, _addSpace);
 	return item;
 }
 
 bool TextureAtlasWriter::placeImage(TextureDescription::Pointer image, TextureAtlasItem& item)
 {
-	int w = image->size.x;
-	int h = image->size.y;
+	rect place;
+	if (!item.placer.place(image->size, place)) return false;
 
-	int xOffset = 0;
-	int yOffset = 0;
+	int xOffset = (static_cast<int>(place.width) > image->size.x) ? 1 : 0;
+	int yOffset = (static_cast<int>(place.height) > image->size.y) ? 1 : 0;
 
-	if (_addSpace)
-	{
-		if (w < item.texture->size.x - 1)
-		{
-			w++;
-			xOffset = 1;
-		}
-
-		if (h < item.texture->size.y - 1)
-		{
-			h++;
-			yOffset = 1;
-		}
-	}
-
-	vec2 size(static_cast<float>(w), static_cast<float>(h));
-	gui::ImageDescriptor desc(vec2(0.0f), size);
-
-	if (item.images.size() == 0)
-	{
-		item.images.push_back(ImageItem(image, desc));
-
-		if (desc.origin.x + desc.size.x > item.maxWidth) 
-			item.maxWidth = static_cast<int>(desc.origin.x + desc.size.x) - xOffset;
-
-		if (desc.origin.y + desc.size.y > item.maxHeight) 
-			item.maxHeight = static_cast<int>(desc.origin.y + desc.size.y) - yOffset;
-
-		return true;
-	}
-	
-	for (ImageItemList::iterator i = item.images.begin(), e = item.images.end(); i != e; ++i)
-	{
-		desc.origin = i->place.origin + vec2(i->place.size.x, 0.0f);
-
-		bool placed = (desc.origin.x + w <= item.texture->size.x) && (desc.origin.y + h <= item.texture->size.y);
-		if (placed)
-		{
-			for (ImageItemList::iterator ii = item.images.begin(); ii != e; ++ii)
-			{
-				if ((ii != i) && ii->place.rectangle().intersects(desc.rectangle()))
-				{
-					placed = false;
-					break;
-				}
-			}
-		}
-
-		if (placed)
-		{
-			item.images.push_back(ImageItem(image, desc));
-
-			if (desc.origin.x + desc.size.x > item.maxWidth) 
-				item.maxWidth = static_cast<int>(desc.origin.x + desc.size.x) - xOffset;
-
-			if (desc.origin.y + desc.size.y > item.maxHeight) 
-				item.maxHeight = static_cast<int>(desc.origin.y + desc.size.y) - yOffset;
-			
-			return true;
-		}
-
-		desc.origin = i->place.origin + vec2(0.0f, i->place.size.y);
-		placed = (desc.origin.x + w <= item.texture->size.x) && (desc.origin.y + h <= item.texture->size.y);
-		if (placed)
-		{
-			for (ImageItemList::iterator ii = item.images.begin(); ii != e; ++ii)
-			{
-				if ((ii != i) && ii->place.rectangle().intersects(desc.rectangle()))
-				{
-					placed = false;
-					break;
-				}
-			}
-		}
+	gui::ImageDescriptor desc(place.origin(), place.size());
+	item.images.push_back(ImageItem(image, desc));
 
-		if (placed)
-		{
-			item.images.push_back(ImageItem(image, desc));
-
-			if (desc.origin.x + desc.size.x > item.maxWidth) 
-				item.maxWidth = static_cast<int>(desc.origin.x + desc.size.x) - xOffset;
-
-			if (desc.origin.y + desc.size.y > item.maxHeight) 
-				item.maxHeight = static_cast<int>(desc.origin.y + desc.size.y) - yOffset;
-
-			return true;
-		}
-	}
+	item.maxWidth = etMax(item.maxWidth, static_cast<int>(desc.origin.x + desc.size.x) - xOffset);
+	item.maxHeight = etMax(item.maxHeight, static_cast<int>(desc.origin.y + desc.size.y) - yOffset);
 
-	return false;
+	return true;
 }
 
 inline bool textureNameSort(const TextureAtlasWriter::ImageItem& i1, const TextureAtlasWriter::ImageItem& i2)
@@ -1,13 +1,10 @@
 #include <et/rendering/rendercontext.h>
-#include <et/geometry/rectplacer.h>
 #include <et/gui/charactergenerator.h>
 #include <et/imaging/imagewriter.h>
 
 using namespace et;
 using namespace et::gui;
 
-const int defaultTextureSize = 1024;
-
 class et::gui::CharacterGeneratorPrivate
 {
 };
@@ -16,25 +13,20 @@ CharacterGenerator::CharacterGenerator(RenderContext* rc, const std::string& fac
 	const std::string& boldFace, size_t size) : _rc(rc), _private(new CharacterGeneratorPrivate),
 	_face(face), _size(size)
 {
-	_texture = _rc->textureFactory().genTexture(GL_TEXTURE_2D, GL_RGBA, vec2i(defaultTextureSize),
-		GL_RGBA, GL_UNSIGNED_BYTE, BinaryDataStorage(), face + "font");
+	initialize();
 }
 
 CharacterGenerator::~CharacterGenerator()
 {
+	releasePages();
 	delete _private;
 }
 
-CharDescriptor CharacterGenerator::generateCharacter(int value, bool updateTexture)
+vec2i CharacterGenerator::measureCharacter(int, bool)
 {
-	CharDescriptor desc(value);
-	_chars[value] = desc;
-	return desc;
+	return vec2i(0);
 }
 
-CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool updateTexture)
+void CharacterGenerator::renderCharacter(int, bool, const vec2i&, BinaryDataStorage&)
 {
-	CharDescriptor desc(value, CharParameter_Bold);
-	_boldChars[value] = desc;
-	return desc;
-}
+}
\ No newline at end of file
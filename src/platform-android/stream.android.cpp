@@ -12,6 +12,7 @@
 
 #include <et/core/et.h>
 #include <et/core/stream.h>
+#include <et/core/assetpack.h>
 #include <et/core/containers.h>
 
 namespace et
@@ -52,6 +53,9 @@ InputStream::InputStream(const std::string& file, StreamMode mode) : _private(ne
 	if (mode == StreamMode_Binary)
 		openMode |= std::ios::binary;
 	
+	_private->stream = AssetPack::openMountedFile(file);
+	if (_private->stream != nullptr) return;
+
 	zip* a = sharedAndroidZipArchive();
 
 	_private->zipFileIndex = zip_name_locate(a, file.c_str(), 0);
@@ -105,6 +109,11 @@ InputStream::InputStream(const std::string& file, StreamMode mode) : _private(ne
 	}
 }
 
+InputStream::InputStream(std::istream* stream) : _private(new InputStreamPrivate)
+{
+	_private->stream = stream;
+}
+
 InputStream::~InputStream()
 {
 	delete _private;
@@ -11,6 +11,7 @@
 #include <sys/stat.h>
 
 #include <et/core/tools.h>
+#include <et/core/assetpack.h>
 #include <et/core/datastorage.h>
 #include <et/platform-android/nativeactivity.h>
 
@@ -87,6 +88,9 @@ std::string et::applicationDataFolder()
 
 bool et::fileExists(const std::string& name)
 {
+	if (AssetPack::mountedFileExists(name))
+		return true;
+
 	int index = -1;
 	bool shouldCheckExternalFolder = false;
 	zip* arch = et::sharedAndroidZipArchive();
@@ -9,6 +9,7 @@
 #include <sys/stat.h>
 #include <et/core/datastorage.h>
 #include <et/core/tools.h>
+#include <et/core/assetpack.h>
 #include <et/core/filesystem.h>
 
 #if (ET_PLATFORM_MAC)
@@ -94,6 +95,9 @@ std::string et::applicationDataFolder()
 
 bool et::fileExists(const std::string& name)
 {
+	if (AssetPack::mountedFileExists(name))
+		return true;
+
     NSString* fileName = [[NSString alloc] initWithUTF8String:name.c_str()];
 	
 	BOOL isDir = NO;
@@ -4,31 +4,24 @@
 #include <UIKit/UIGraphics.h>
 
 #include <et/rendering/rendercontext.h>
-#include <et/geometry/rectplacer.h>
 #include <et/gui/charactergenerator.h>
 #include <et/imaging/imagewriter.h>
 
 using namespace et;
 using namespace et::gui;
 
-const size_t defaultTextureSize = 1024;
-
 class et::gui::CharacterGeneratorPrivate
 {
 	public:
 		CharacterGeneratorPrivate(const std::string& face, const std::string& boldFace, size_t size);
 		~CharacterGeneratorPrivate();
 
-		void updateTexture(RenderContext* rc, const vec2i& position, const vec2i& size,
-			Texture texture, BinaryDataStorage& data);
-	
+		NSString* createString(int value);
 		void renderCharacter(NSString* value, const vec2i& size, bool bold, BinaryDataStorage& data);
 
 	public:
 		std::string _fontFace;
 		size_t _fontSize;
-	
-		RectPlacer _placer;
    
         UIFont* _font;
         UIFont* _boldFont;
@@ -40,80 +33,35 @@ CharacterGenerator::CharacterGenerator(RenderContext* rc, const std::string& fac
 	const std::string& boldFace, size_t size) : _rc(rc),
 	_private(new CharacterGeneratorPrivate(face, boldFace, size)), _face(face), _size(size)
 {
-	_texture = _rc->textureFactory().genTexture(GL_TEXTURE_2D, GL_RGBA, vec2i(defaultTextureSize), GL_RGBA,
-		GL_UNSIGNED_BYTE, BinaryDataStorage(4 * defaultTextureSize * defaultTextureSize, 0), face + "font");
+	initialize();
 }
 
 CharacterGenerator::~CharacterGenerator()
 {
+	releasePages();
 	delete _private;
 }
 
-CharDescriptor CharacterGenerator::generateCharacter(int value, bool)
+vec2i CharacterGenerator::measureCharacter(int value, bool bold)
 {
-	wchar_t string[2] = { value, 0 };
-	
-    NSString* wString = [[NSString alloc] initWithBytes:string length:sizeof(string)
-		encoding:NSUTF32LittleEndianStringEncoding];
-	
-    CGSize characterSize = [wString sizeWithFont:_private->_font];
-	vec2i charSize = vec2i(static_cast<int>(characterSize.width), static_cast<int>(characterSize.height));
-	
-	CharDescriptor desc(value);
-	if (charSize.square() > 0)
-	{
-		rect textureRect;
-		
-		BinaryDataStorage data(charSize.square() * 4, 0);
-		_private->_placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(wString, charSize, false, data);
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-		
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
+	NSString* wString = _private->createString(value);
+    CGSize characterSize = [wString sizeWithFont:(bold ? _private->_boldFont : _private->_font)];
 	
 #if (!ET_OBJC_ARC_ENABLED)
 	[wString release];
 #endif
 	
-	return (_chars[value] = desc);
+	return vec2i(static_cast<int>(characterSize.width), static_cast<int>(characterSize.height));
 }
 
-CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool)
+void CharacterGenerator::renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage& data)
 {
-	wchar_t string[2] = { value, 0 };
-    NSString* wString = [[NSString alloc] initWithBytes:string length:sizeof(string)
-											   encoding:NSUTF32LittleEndianStringEncoding];
-	
-    CGSize characterSize = [wString sizeWithFont:_private->_boldFont];
-	vec2i charSize = vec2i(static_cast<int>(characterSize.width), static_cast<int>(characterSize.height));
-	
-	CharDescriptor desc(value, CharParameter_Bold);
-	if (charSize.square() > 0)
-	{
-		rect textureRect;
-		
-		BinaryDataStorage data(charSize.square() * 4, 0);
-		_private->_placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(wString, charSize, true, data);
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-		
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
+	NSString* wString = _private->createString(value);
+	_private->renderCharacter(wString, size, bold, data);
 	
 #if (!ET_OBJC_ARC_ENABLED)
 	[wString release];
 #endif
-	
-	return (_boldChars[value] = desc);
 }
 
 /*
@@ -121,8 +69,7 @@ CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool)
  */
 
 CharacterGeneratorPrivate::CharacterGeneratorPrivate(const std::string& face,
-	const std::string& boldFace, size_t size) : _fontFace(face), _fontSize(size),
-	_placer(vec2i(defaultTextureSize), true)
+	const std::string& boldFace, size_t size) : _fontFace(face), _fontSize(size)
 {
     NSString* cFace = [NSString stringWithCString:face.c_str() encoding:NSASCIIStringEncoding];
     NSString* cBoldFace = [NSString stringWithCString:boldFace.c_str() encoding:NSASCIIStringEncoding];
@@ -157,11 +104,12 @@ CharacterGeneratorPrivate::~CharacterGeneratorPrivate()
 #endif
 }
 
-void CharacterGeneratorPrivate::updateTexture(RenderContext* rc, const vec2i& position,
-	const vec2i& size, Texture texture, BinaryDataStorage& data)
+NSString* CharacterGeneratorPrivate::createString(int value)
 {
-	vec2i dest(position.x, defaultTextureSize - position.y - size.y);
-	texture->updatePartialDataDirectly(rc, dest, size, data.binary(), data.dataSize());
+	wchar_t string[2] = { value, 0 };
+	
+	return [[NSString alloc] initWithBytes:string length:sizeof(string)
+		encoding:NSUTF32LittleEndianStringEncoding];
 }
 
 void CharacterGeneratorPrivate::renderCharacter(NSString* value, const vec2i& size,
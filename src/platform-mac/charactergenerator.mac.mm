@@ -1,22 +1,18 @@
 #include <AppKit/AppKit.h>
 #include <et/rendering/rendercontext.h>
-#include <et/geometry/rectplacer.h>
 #include <et/gui/charactergenerator.h>
 #include <et/imaging/imagewriter.h>
 
 using namespace et;
 using namespace et::gui;
 
-const int defaultTextureSize = 1024;
-
 class et::gui::CharacterGeneratorPrivate
 {
 public:
 	CharacterGeneratorPrivate(const std::string& face, const std::string& boldFace, size_t size);
 	~CharacterGeneratorPrivate();
 	
-	void updateTexture(RenderContext* rc, const vec2i& position, const vec2i& size,
-		Texture texture, BinaryDataStorage& data);
+	NSMutableAttributedString* createAttributedString(int value, bool bold);
 	
 	void renderCharacter(NSAttributedString* value, const vec2i& size,
 		NSFont* font, BinaryDataStorage& data);
@@ -25,8 +21,6 @@ public:
 	std::string fontFace;
 	size_t fontSize;
 	
-	RectPlacer _placer;
-	
 	NSFont* font;
 	NSFont* boldFont;
 	NSColor* whiteColor;
@@ -38,102 +32,35 @@ CharacterGenerator::CharacterGenerator(RenderContext* rc, const std::string& fac
 	const std::string& boldFace, size_t size) : _rc(rc),
 	_private(new CharacterGeneratorPrivate(face, boldFace, size)), _face(face), _size(size)
 {
-	BinaryDataStorage emptyData(defaultTextureSize * defaultTextureSize * 4, 0);
-	
-	_texture = _rc->textureFactory().genTexture(GL_TEXTURE_2D, GL_RGBA, vec2i(defaultTextureSize),
-												GL_RGBA, GL_UNSIGNED_BYTE, emptyData, face + "font");
+	initialize();
 }
 
 CharacterGenerator::~CharacterGenerator()
 {
+	releasePages();
 	delete _private;
 }
 
-CharDescriptor CharacterGenerator::generateCharacter(int value, bool)
+vec2i CharacterGenerator::measureCharacter(int value, bool bold)
 {
-	wchar_t string[2] = { value, 0 };
-	
-	NSString* wString = [[NSString alloc] initWithBytesNoCopy:string length:sizeof(string)
-		encoding:NSUTF32LittleEndianStringEncoding freeWhenDone:NO];
-
-	NSMutableAttributedString* attrString = [[NSMutableAttributedString alloc] initWithString:wString];
-
-	NSRange wholeString = NSMakeRange(0, [attrString length]);
-	[attrString addAttribute:NSFontAttributeName value:_private->font range:wholeString];
-	[attrString addAttribute:NSForegroundColorAttributeName value:_private->whiteColor range:wholeString];
-
+	NSMutableAttributedString* attrString = _private->createAttributedString(value, bold);
 	NSSize characterSize = [attrString size];
-	vec2i charSize = vec2i(static_cast<int>(characterSize.width),
-        static_cast<int>(characterSize.height));
-	
-	CharDescriptor desc(value);
 	
-	if (charSize.square() > 0)
-	{
-		BinaryDataStorage data(charSize.square() * 4, 0);
-		
-		rect textureRect;
-		_private->_placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(attrString, charSize, _private->font, data);
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
-
 #if (!ET_OBJC_ARC_ENABLED)
 	[attrString release];
-	[wString release];
 #endif
-	_chars[value] = desc;
-	return desc;
+	
+	return vec2i(static_cast<int>(characterSize.width), static_cast<int>(characterSize.height));
 }
 
-CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool)
+void CharacterGenerator::renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage& data)
 {
-	wchar_t string[2] = { value, 0 };
-
-	NSString* wString = [[NSString alloc] initWithBytesNoCopy:string length:sizeof(string)
-		encoding:NSUTF32LittleEndianStringEncoding freeWhenDone:NO];
-
-	NSMutableAttributedString* attrString = [[NSMutableAttributedString alloc] initWithString:wString];
-
-	NSRange wholeString = NSMakeRange(0, [attrString length]);
-	[attrString addAttribute:NSFontAttributeName value:_private->boldFont range:wholeString];
-	[attrString addAttribute:NSForegroundColorAttributeName value:_private->whiteColor range:wholeString];
-
-	NSSize characterSize = [attrString size];
-	vec2i charSize = vec2i(static_cast<int>(characterSize.width),
-        static_cast<int>(characterSize.height));
+	NSMutableAttributedString* attrString = _private->createAttributedString(value, bold);
+	_private->renderCharacter(attrString, size, _private->font, data);
 	
-	CharDescriptor desc(value, CharParameter_Bold);
-	if (charSize.square() > 0)
-	{
-		BinaryDataStorage data(charSize.square() * 4, 0);
-
-		rect textureRect;
-		
-		_private->_placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(attrString, charSize, _private->font, data);
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
-
 #if (!ET_OBJC_ARC_ENABLED)
 	[attrString release];
-	[wString release];
 #endif
-	
-	_boldChars[value] = desc;
-	return desc;
 }
 
 /*
@@ -141,8 +68,7 @@ CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool)
  */
 
 CharacterGeneratorPrivate::CharacterGeneratorPrivate(const std::string& face,
-	const std::string&, size_t size) : fontFace(face), fontSize(size),
-	_placer(vec2i(defaultTextureSize), true)
+	const std::string&, size_t size) : fontFace(face), fontSize(size)
 {
     NSString* cFace = [NSString stringWithCString:face.c_str() encoding:NSUTF8StringEncoding];
 	
@@ -188,11 +114,24 @@ CharacterGeneratorPrivate::~CharacterGeneratorPrivate()
 #endif
 }
 
-void CharacterGeneratorPrivate::updateTexture(RenderContext* rc, const vec2i& position,
-	const vec2i& size, Texture texture, BinaryDataStorage& data)
+NSMutableAttributedString* CharacterGeneratorPrivate::createAttributedString(int value, bool bold)
 {
-	vec2i dest(position.x, defaultTextureSize - position.y - size.y);
-	texture->updatePartialDataDirectly(rc, dest, size, data.binary(), data.dataSize());
+	wchar_t string[2] = { value, 0 };
+	
+	NSString* wString = [[NSString alloc] initWithBytesNoCopy:string length:sizeof(string)
+		encoding:NSUTF32LittleEndianStringEncoding freeWhenDone:NO];
+	
+	NSMutableAttributedString* attrString = [[NSMutableAttributedString alloc] initWithString:wString];
+	
+	NSRange wholeString = NSMakeRange(0, [attrString length]);
+	[attrString addAttribute:NSFontAttributeName value:(bold ? boldFont : font) range:wholeString];
+	[attrString addAttribute:NSForegroundColorAttributeName value:whiteColor range:wholeString];
+	
+#if (!ET_OBJC_ARC_ENABLED)
+	[wString release];
+#endif
+	
+	return attrString;
 }
 
 void CharacterGeneratorPrivate::renderCharacter(NSAttributedString* value,
@@ -8,9 +8,7 @@
 
 #include <et/core/et.h>
 
-#if (ET_PLATFORM_ANDROID)
-#	include <sys/atomics.h>
-#else
+#if (ET_PLATFORM_APPLE)
 #	include <libkern/OSAtomic.h>
 #endif
 
@@ -25,7 +23,7 @@ AtomicCounter::AtomicCounter() : _counter(0)
 AtomicCounterType AtomicCounter::retain()
 {
 #if (ET_PLATFORM_ANDROID)
-	return __atomic_dec(&_counter);
+	return __sync_add_and_fetch(&_counter, 1);
 #else
 	return OSAtomicIncrement32(&_counter);
 #endif
@@ -34,7 +32,7 @@ AtomicCounterType AtomicCounter::retain()
 AtomicCounterType AtomicCounter::release()
 {
 #if (ET_PLATFORM_ANDROID)
-	return __atomic_dec(&_counter);
+	return __sync_sub_and_fetch(&_counter, 1);
 #else
 	return OSAtomicDecrement32(&_counter);
 #endif
@@ -48,7 +46,11 @@ AtomicBool::AtomicBool() :
 bool AtomicBool::operator = (bool b)
 {
 	assert((_value & validMask) == 0);
+#if (ET_PLATFORM_ANDROID)
+	__sync_val_compare_and_swap(&_value, _value, AtomicCounterType(b));
+#else
 	OSAtomicCompareAndSwap32Barrier(_value, AtomicCounterType(b), &_value);
+#endif
 	return (_value != 0);
 }
 
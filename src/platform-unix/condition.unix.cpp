@@ -0,0 +1,90 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <et/threading/condition.h>
+
+namespace et
+{
+	class ConditionPrivate
+	{
+	public:
+		pthread_mutex_t mutex;
+		pthread_cond_t condition;
+		bool signaled;
+	};
+}
+
+using namespace et;
+
+Condition::Condition() :
+	_private(new ConditionPrivate)
+{
+	_private->signaled = false;
+	pthread_mutex_init(&_private->mutex, 0);
+	pthread_cond_init(&_private->condition, 0);
+}
+
+Condition::~Condition()
+{
+	pthread_cond_destroy(&_private->condition);
+	pthread_mutex_destroy(&_private->mutex);
+	delete _private;
+}
+
+void Condition::wait()
+{
+	pthread_mutex_lock(&_private->mutex);
+	
+	while (!_private->signaled)
+		pthread_cond_wait(&_private->condition, &_private->mutex);
+	
+	_private->signaled = false;
+	pthread_mutex_unlock(&_private->mutex);
+}
+
+bool Condition::wait(float seconds)
+{
+	if (seconds < 0.0f)
+		seconds = 0.0f;
+	
+	/*
+	 * pthread_cond_timedwait expects absolute time,
+	 * gettimeofday is used since clock_gettime is not available on every platform
+	 */
+	timeval now = { };
+	gettimeofday(&now, nullptr);
+	
+	long long nanoseconds = static_cast<long long>(now.tv_usec) * 1000ll +
+		static_cast<long long>(static_cast<double>(seconds) * 1.0e+9);
+	
+	timespec deadline = { };
+	deadline.tv_sec = now.tv_sec + static_cast<time_t>(nanoseconds / 1000000000ll);
+	deadline.tv_nsec = static_cast<long>(nanoseconds % 1000000000ll);
+	
+	pthread_mutex_lock(&_private->mutex);
+	
+	int result = 0;
+	while (!_private->signaled && (result != ETIMEDOUT))
+		result = pthread_cond_timedwait(&_private->condition, &_private->mutex, &deadline);
+	
+	bool signaled = _private->signaled;
+	_private->signaled = false;
+	
+	pthread_mutex_unlock(&_private->mutex);
+	return signaled;
+}
+
+void Condition::notify()
+{
+	pthread_mutex_lock(&_private->mutex);
+	_private->signaled = true;
+	pthread_cond_signal(&_private->condition);
+	pthread_mutex_unlock(&_private->mutex);
+}
@@ -0,0 +1,224 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et/core/et.h>
+#include <et/core/filewatcher.h>
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+namespace et
+{
+	class FileWatcherPrivate
+	{
+	public:
+		enum
+		{
+			FolderEvents = IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB
+		};
+
+		struct Folder
+		{
+			std::string path;
+
+			/*
+			 * Names within folder, mapped to the names passed to watch
+			 */
+			std::map<std::string, std::string> files;
+		};
+
+	public:
+		FileWatcherPrivate() :
+			descriptor(inotify_init())
+		{
+			if (descriptor == -1)
+			{
+				log::warning("[FileWatcher] Unable to initialize inotify, error %d", errno);
+				return;
+			}
+
+			fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+			fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+		}
+
+		~FileWatcherPrivate()
+		{
+			if (descriptor != -1)
+				close(descriptor);
+		}
+
+		static void split(const std::string& fileName, std::string& folder, std::string& name)
+		{
+			size_t delimiter = fileName.find_last_of("/\\");
+			if (delimiter == std::string::npos)
+			{
+				folder = ".";
+				name = fileName;
+			}
+			else
+			{
+				folder = (delimiter == 0) ? std::string("/") : fileName.substr(0, delimiter);
+				name = fileName.substr(delimiter + 1);
+			}
+		}
+
+	public:
+		int descriptor;
+		std::map<int, Folder> folders;
+		std::map<std::string, int> folderWatches;
+	};
+}
+
+using namespace et;
+
+FileWatcher::FileWatcher() :
+	_private(new FileWatcherPrivate)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	delete _private;
+}
+
+bool FileWatcher::available() const
+{
+	return _private->descriptor != -1;
+}
+
+void FileWatcher::watch(const std::string& fileName)
+{
+	if (!available()) return;
+
+	std::string folder;
+	std::string name;
+	FileWatcherPrivate::split(fileName, folder, name);
+
+	auto i = _private->folderWatches.find(folder);
+	if (i == _private->folderWatches.end())
+	{
+		int watch = inotify_add_watch(_private->descriptor, folder.c_str(), FileWatcherPrivate::FolderEvents);
+		if (watch == -1)
+		{
+			log::warning("[FileWatcher] Unable to watch folder %s, error %d", folder.c_str(), errno);
+			return;
+		}
+
+		i = _private->folderWatches.insert(std::make_pair(folder, watch)).first;
+		_private->folders[watch].path = folder;
+	}
+
+	_private->folders[i->second].files[name] = fileName;
+}
+
+void FileWatcher::unwatch(const std::string& fileName)
+{
+	std::string folder;
+	std::string name;
+	FileWatcherPrivate::split(fileName, folder, name);
+
+	auto i = _private->folderWatches.find(folder);
+	if (i == _private->folderWatches.end()) return;
+
+	FileWatcherPrivate::Folder& watched = _private->folders[i->second];
+	watched.files.erase(name);
+
+	if (watched.files.empty())
+	{
+		inotify_rm_watch(_private->descriptor, i->second);
+		_private->folders.erase(i->second);
+		_private->folderWatches.erase(i);
+	}
+}
+
+void FileWatcher::poll(StringList& changedFiles)
+{
+	if (!available()) return;
+
+	union
+	{
+		inotify_event event;
+		char data[4096];
+	} buffer;
+
+	for (;;)
+	{
+		ssize_t bytesRead = read(_private->descriptor, buffer.data, sizeof(buffer.data));
+		if (bytesRead <= 0) break;
+
+		for (ssize_t offset = 0; offset < bytesRead; )
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer.data + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				/*
+				 * Events were lost, every watched file could be changed
+				 */
+				for (auto& folder : _private->folders)
+				{
+					for (auto& file : folder.second.files)
+						changedFiles.push_back(file.second);
+				}
+				continue;
+			}
+
+			auto folder = _private->folders.find(event->wd);
+			if (folder == _private->folders.end()) continue;
+
+			if (event->mask & IN_IGNORED)
+			{
+				_private->folderWatches.erase(folder->second.path);
+				_private->folders.erase(folder);
+				continue;
+			}
+
+			if (event->len == 0) continue;
+
+			auto file = folder->second.files.find(std::string(event->name));
+			if (file != folder->second.files.end())
+				changedFiles.push_back(file->second);
+		}
+	}
+}
+
+#else
+
+namespace et
+{
+	class FileWatcherPrivate
+	{
+	};
+}
+
+using namespace et;
+
+FileWatcher::FileWatcher() :
+	_private(new FileWatcherPrivate)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	delete _private;
+}
+
+bool FileWatcher::available() const
+{
+	return false;
+}
+
+void FileWatcher::watch(const std::string&) { }
+void FileWatcher::unwatch(const std::string&) { }
+void FileWatcher::poll(StringList&) { }
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <et/core/et.h>
+#include <et/core/mappedfile.h>
+
+namespace et
+{
+	class MappedFilePrivate
+	{
+	public:
+		MappedFilePrivate() :
+			mapping(MAP_FAILED), mappingSize(0), pageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE))) { }
+
+		/*
+		 * Range is reduced to the pages, which are completely inside it
+		 */
+		bool alignRange(size_t& offset, size_t& length) const
+		{
+			size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+			size_t end = std::min(offset + length, mappingSize) / pageSize * pageSize;
+			if (begin >= end) return false;
+
+			offset = begin;
+			length = end - begin;
+			return true;
+		}
+
+	public:
+		void* mapping;
+		size_t mappingSize;
+		size_t pageSize;
+	};
+}
+
+using namespace et;
+
+MappedFile::MappedFile() :
+	_private(new MappedFilePrivate), _data(nullptr), _size(0)
+{
+}
+
+MappedFile::MappedFile(const std::string& fileName) :
+	_private(new MappedFilePrivate), _data(nullptr), _size(0)
+{
+	open(fileName);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+	delete _private;
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+	close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd == -1)
+	{
+		log::error("Unable to open file for mapping: %s", fileName.c_str());
+		return false;
+	}
+
+	struct stat fileInfo = { };
+	if ((fstat(fd, &fileInfo) == 0) && (fileInfo.st_size > 0))
+	{
+		_private->mappingSize = static_cast<size_t>(fileInfo.st_size);
+		_private->mapping = mmap(nullptr, _private->mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+
+	/*
+	 * Mapping remains valid after the descriptor is closed
+	 */
+	::close(fd);
+
+	if (_private->mapping == MAP_FAILED)
+	{
+		log::error("Unable to map file: %s", fileName.c_str());
+		_private->mappingSize = 0;
+		return false;
+	}
+
+	_data = static_cast<const char*>(_private->mapping);
+	_size = _private->mappingSize;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_private->mapping != MAP_FAILED)
+		munmap(_private->mapping, _private->mappingSize);
+
+	_private->mapping = MAP_FAILED;
+	_private->mappingSize = 0;
+	_data = nullptr;
+	_size = 0;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length)
+{
+	if (!valid() || (offset >= _size)) return;
+
+	size_t begin = offset / _private->pageSize * _private->pageSize;
+	madvise(static_cast<char*>(_private->mapping) + begin, std::min(offset + length, _size) - begin, MADV_WILLNEED);
+}
+
+void MappedFile::discard(size_t offset, size_t length)
+{
+	if (valid() && _private->alignRange(offset, length))
+		madvise(static_cast<char*>(_private->mapping) + offset, length, MADV_DONTNEED);
+}
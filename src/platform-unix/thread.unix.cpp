@@ -8,6 +8,7 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <et/threading/atomiccounter.h>
+#include <et/threading/condition.h>
 #include <et/threading/thread.h>
 
 namespace et
@@ -23,8 +24,7 @@ namespace et
 	public:
 		pthread_attr_t attrib;
 		pthread_t thread;
-		pthread_mutex_t suspendMutex;
-		pthread_cond_t suspend;
+		Condition activity;
 		ThreadId threadId;
 		AtomicBool running;
 		AtomicBool suspended;
@@ -37,20 +37,13 @@ ThreadPrivate::ThreadPrivate() :
 	thread(nullptr), threadId(0)
 {
 	attrib = { };
-	suspendMutex = { };
-	suspend = { };
 	
 	pthread_attr_init(&attrib);
-	pthread_mutex_init(&suspendMutex, 0);
-	pthread_cond_init(&suspend, 0);
-	
 	pthread_attr_setdetachstate(&attrib, PTHREAD_CREATE_JOINABLE);
 }
 
 ThreadPrivate::~ThreadPrivate()
 {
-	pthread_mutex_destroy(&suspendMutex);
-	pthread_cond_destroy(&suspend);
 	pthread_attr_destroy(&attrib);
 }
 
@@ -88,24 +81,21 @@ void Thread::run()
 
 void Thread::suspend()
 {
-	if (_private->suspended) return;
-	
 	_private->suspended = true;
-	
-	pthread_mutex_lock(&_private->suspendMutex);
-	pthread_cond_wait(&_private->suspend, &_private->suspendMutex);
-	pthread_mutex_unlock(&_private->suspendMutex);
+	_private->activity.wait();
+	_private->suspended = false;
+}
+
+void Thread::suspend(float seconds)
+{
+	_private->suspended = true;
+	_private->activity.wait(seconds);
+	_private->suspended = false;
 }
 
 void Thread::resume()
 {
-	if (_private->suspended)
-	{
-		_private->suspended = false;
-		pthread_mutex_lock(&_private->suspendMutex);
-		pthread_cond_signal(&_private->suspend);
-		pthread_mutex_unlock(&_private->suspendMutex);
-	}
+	_private->activity.notify();
 }
 
 void Thread::stop()
@@ -6,6 +6,7 @@
  */
 
 #include <pthread.h>
+#include <unistd.h>
 #include <execinfo.h>
 #include <et/threading/threading.h>
 
@@ -37,7 +38,8 @@ void Threading::setRenderingThread(ThreadId t)
 
 size_t Threading::coresCount()
 {
-	return 0;
+	long result = sysconf(_SC_NPROCESSORS_ONLN);
+	return (result > 0) ? static_cast<size_t>(result) : 1;
 }
 
 float Threading::cpuUsage()
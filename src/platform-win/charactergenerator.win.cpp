@@ -1,5 +1,4 @@
 #include <Windows.h>
-#include <et/geometry/rectplacer.h>
 #include <et/gui/charactergenerator.h>
 #include <et/rendering/rendercontext.h>
 #include <et/imaging/imagewriter.h>
@@ -8,18 +7,12 @@
 using namespace et;
 using namespace et::gui;
 
-const int defaultTextureBindUnit = 7;
-const int defaultTextureSize = 1024;
-
 class et::gui::CharacterGeneratorPrivate
 {
 	public:
 		CharacterGeneratorPrivate(const std::string& face, const std::string& boldFace, size_t size);
 		~CharacterGeneratorPrivate();
 
-		void updateTexture(RenderContext* rc, const vec2i& position, const vec2i& size,
-			Texture texture, BinaryDataStorage& data);
-
 		void renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage&);
 
 	public:
@@ -27,9 +20,6 @@ class et::gui::CharacterGeneratorPrivate
 		std::string _face;
 		std::string _boldFace;
 
-		RectPlacer placer;
-		BinaryDataStorage _textureData;
-
 		HDC commonDC;
 		HFONT _font;
 		HFONT _boldFont;
@@ -38,76 +28,29 @@ class et::gui::CharacterGeneratorPrivate
 CharacterGenerator::CharacterGenerator(RenderContext* rc, const std::string& face, const std::string& boldFace, size_t size) : _rc(rc),
 	_private(new CharacterGeneratorPrivate(face, boldFace, size)), _face(face), _boldFace(boldFace), _size(size)
 {
-	_texture = _rc->textureFactory().genTexture(GL_TEXTURE_2D, GL_RGBA, vec2i(defaultTextureSize), GL_RGBA, 
-		GL_UNSIGNED_BYTE, BinaryDataStorage(4 * defaultTextureSize * defaultTextureSize, 0), face + "font");
+	initialize();
 }
 
 CharacterGenerator::~CharacterGenerator()
 {
+	releasePages();
 	delete _private;
 }
 
-CharDescriptor CharacterGenerator::generateCharacter(int value, bool updateTexture)
+vec2i CharacterGenerator::measureCharacter(int value, bool bold)
 {
 	SIZE characterSize = { };
 	wchar_t string[2] = { static_cast<wchar_t>(value), 0 };
 
-	SelectObject(_private->commonDC, _private->_font);
+	SelectObject(_private->commonDC, bold ? _private->_boldFont : _private->_font);
 	GetTextExtentPointW(_private->commonDC, string, 1, &characterSize);
-	vec2i charSize(characterSize.cx, characterSize.cy);
-
-	CharDescriptor desc(value);
-	if (charSize.square() > 0)
-	{
-		rect textureRect;
-
-		BinaryDataStorage data(charSize.square() * 4, 0);
-		_private->placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(value, false, charSize, data);
 
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
-
-	_chars[value] = desc;
-	return desc;
+	return vec2i(characterSize.cx, characterSize.cy);
 }
 
-CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool updateTexture)
+void CharacterGenerator::renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage& data)
 {
-	SIZE characterSize = { };
-	wchar_t string[2] = { static_cast<wchar_t>(value), 0 };
-
-	SelectObject(_private->commonDC, _private->_boldFont);
-	GetTextExtentPointW(_private->commonDC, string, 1, &characterSize);
-
-	vec2i charSize(characterSize.cx, characterSize.cy);
-
-	CharDescriptor desc(value, CharParameter_Bold);
-	if (charSize.square() > 0)
-	{
-		rect textureRect;
-
-		BinaryDataStorage data(charSize.square() * 4, 0);
-		_private->placer.place(charSize + vec2i(2), textureRect);
-		_private->renderCharacter(value, true, charSize, data);
-
-		_private->updateTexture(_rc, vec2i(static_cast<int>(textureRect.left + 1.0f),
-			static_cast<int>(textureRect.top + 1.0f)), charSize, _texture, data);
-
-		desc.origin = textureRect.origin() + vec2(1.0f);
-		desc.size = textureRect.size() - vec2(2.0f);
-		desc.uvOrigin = _texture->getTexCoord(desc.origin);
-		desc.uvSize = desc.size / _texture->sizeFloat();
-	}
-
-	_boldChars[value] = desc;
-	return desc;
+	_private->renderCharacter(value, bold, size, data);
 }
 
 /*
@@ -115,7 +58,7 @@ CharDescriptor CharacterGenerator::generateBoldCharacter(int value, bool updateT
  */
 
 CharacterGeneratorPrivate::CharacterGeneratorPrivate(const std::string& face, const std::string& boldFace, size_t size) : 
-	_size(size), _face(face), _boldFace(boldFace), placer(vec2i(defaultTextureSize), true), _textureData(sqr(defaultTextureSize) * 4)
+	_size(size), _face(face), _boldFace(boldFace)
 {
 	commonDC = CreateCompatibleDC(nullptr);
 
@@ -135,13 +78,6 @@ CharacterGeneratorPrivate::~CharacterGeneratorPrivate()
 	DeleteDC(commonDC);
 }
 
-void CharacterGeneratorPrivate::updateTexture(RenderContext* rc, const vec2i& position, const vec2i& size,
-	Texture texture, BinaryDataStorage& data)
-{
-	vec2i dest(position.x, defaultTextureSize - position.y - size.y);
-	texture->updatePartialDataDirectly(rc, dest, size, data.binary(), data.dataSize());
-}
-
 void CharacterGeneratorPrivate::renderCharacter(int value, bool bold, const vec2i& size, BinaryDataStorage& data)
 {
 	RECT r = { 0, 0, size.x, size.y };
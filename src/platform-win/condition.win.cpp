@@ -0,0 +1,53 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <Windows.h>
+#include <et/threading/condition.h>
+
+namespace et
+{
+	class ConditionPrivate
+	{
+	public:
+		ConditionPrivate()
+			{ event = CreateEvent(0, false, false, 0); }
+
+		~ConditionPrivate()
+			{ CloseHandle(event); }
+
+	public:
+		HANDLE event;
+	};
+}
+
+using namespace et;
+
+Condition::Condition() :
+	_private(new ConditionPrivate)
+{
+}
+
+Condition::~Condition()
+{
+	delete _private;
+}
+
+void Condition::wait()
+{
+	WaitForSingleObject(_private->event, INFINITE);
+}
+
+bool Condition::wait(float seconds)
+{
+	DWORD msec = (seconds > 0.0f) ? static_cast<DWORD>(1000.0f * seconds + 0.5f) : 0;
+	return WaitForSingleObject(_private->event, msec) == WAIT_OBJECT_0;
+}
+
+void Condition::notify()
+{
+	SetEvent(_private->event);
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et/core/et.h>
+#include <et/core/filewatcher.h>
+
+/*
+ * No event backend on Windows yet, ObjectsCache falls back to checking modification dates
+ */
+namespace et
+{
+	class FileWatcherPrivate
+	{
+	};
+}
+
+using namespace et;
+
+FileWatcher::FileWatcher() :
+	_private(new FileWatcherPrivate)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	delete _private;
+}
+
+bool FileWatcher::available() const
+{
+	return false;
+}
+
+void FileWatcher::watch(const std::string&) { }
+void FileWatcher::unwatch(const std::string&) { }
+void FileWatcher::poll(StringList&) { }
@@ -0,0 +1,137 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <Windows.h>
+#include <et/core/et.h>
+#include <et/core/mappedfile.h>
+
+namespace et
+{
+	class MappedFilePrivate
+	{
+	public:
+		MappedFilePrivate() :
+			file(INVALID_HANDLE_VALUE), mapping(nullptr), view(nullptr), viewSize(0), pageSize(0)
+		{
+			SYSTEM_INFO info = { };
+			GetSystemInfo(&info);
+			pageSize = info.dwPageSize;
+		}
+
+		bool alignRange(size_t& offset, size_t& length) const
+		{
+			size_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+			size_t end = (std::min)(offset + length, viewSize) / pageSize * pageSize;
+			if (begin >= end) return false;
+
+			offset = begin;
+			length = end - begin;
+			return true;
+		}
+
+	public:
+		HANDLE file;
+		HANDLE mapping;
+		void* view;
+		size_t viewSize;
+		size_t pageSize;
+	};
+}
+
+using namespace et;
+
+MappedFile::MappedFile() :
+	_private(new MappedFilePrivate), _data(nullptr), _size(0)
+{
+}
+
+MappedFile::MappedFile(const std::string& fileName) :
+	_private(new MappedFilePrivate), _data(nullptr), _size(0)
+{
+	open(fileName);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+	delete _private;
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+	close();
+
+	_private->file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+	if (_private->file == INVALID_HANDLE_VALUE)
+	{
+		log::error("Unable to open file for mapping: %s", fileName.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = { };
+	if (GetFileSizeEx(_private->file, &fileSize) && (fileSize.QuadPart > 0))
+	{
+		_private->mapping = CreateFileMappingA(_private->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (_private->mapping != nullptr)
+			_private->view = MapViewOfFile(_private->mapping, FILE_MAP_READ, 0, 0, 0);
+	}
+
+	if (_private->view == nullptr)
+	{
+		log::error("Unable to map file: %s", fileName.c_str());
+		close();
+		return false;
+	}
+
+	_private->viewSize = static_cast<size_t>(fileSize.QuadPart);
+	_data = static_cast<const char*>(_private->view);
+	_size = _private->viewSize;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_private->view != nullptr)
+		UnmapViewOfFile(_private->view);
+
+	if (_private->mapping != nullptr)
+		CloseHandle(_private->mapping);
+
+	if (_private->file != INVALID_HANDLE_VALUE)
+		CloseHandle(_private->file);
+
+	_private->file = INVALID_HANDLE_VALUE;
+	_private->mapping = nullptr;
+	_private->view = nullptr;
+	_private->viewSize = 0;
+	_data = nullptr;
+	_size = 0;
+}
+
+/*
+ * Pages are touched in the order of access, system reads ahead for sequential faults
+ */
+void MappedFile::prefetch(size_t offset, size_t length)
+{
+	if (!valid() || (offset >= _size)) return;
+
+	volatile char value = 0;
+	for (size_t i = offset, e = (std::min)(offset + length, _size); i < e; i += _private->pageSize)
+		value += _data[i];
+}
+
+/*
+ * Unlocking pages, which are not locked, removes them from the working set of the process
+ */
+void MappedFile::discard(size_t offset, size_t length)
+{
+	if (valid() && _private->alignRange(offset, length))
+		VirtualUnlock(static_cast<char*>(_private->view) + offset, length);
+}
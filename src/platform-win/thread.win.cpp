@@ -9,6 +9,7 @@
 #include <Windows.h>
 #include <et/core/tools.h>
 #include <et/threading/atomiccounter.h>
+#include <et/threading/condition.h>
 #include <et/threading/thread.h>
 
 namespace et
@@ -17,14 +18,14 @@ namespace et
 	{
 	public:
 		ThreadPrivate::ThreadPrivate() : 
-		  threadId(0), thread(nullptr), activityEvent(nullptr) { }
+		  threadId(0), thread(nullptr) { }
 
 		static DWORD WINAPI threadProc(LPVOID lpParameter);
 
 	public:
 		DWORD threadId;
 		HANDLE thread;
-		HANDLE activityEvent;
+		Condition activity;
 		AtomicCounter running;
 		AtomicCounter suspended;
 	};
@@ -47,14 +48,11 @@ DWORD WINAPI ThreadPrivate::threadProc(LPVOID lpParameter)
 Thread::Thread() : 
 	_private(new ThreadPrivate())
 {
-	_private->activityEvent = CreateEvent(0, false, false, 0);
 }
 
 Thread::Thread(bool runImmediately) :
 	_private(new ThreadPrivate())
 {
-	_private->activityEvent = CreateEvent(0, false, false, 0);
-
 	if (runImmediately)
 		run();
 }
@@ -62,7 +60,6 @@ Thread::Thread(bool runImmediately) :
 Thread::~Thread()
 {
 	terminate();
-	CloseHandle(_private->activityEvent);
 	delete _private;
 }
 
@@ -89,26 +86,29 @@ ThreadResult Thread::main()
 
 void Thread::suspend()
 {
-	if (_private->suspended.atomicCounterValue() != 0) return;
+	_private->suspended.retain();
+	_private->activity.wait();
+	_private->suspended.release();
+}
 
+void Thread::suspend(float seconds)
+{
 	_private->suspended.retain();
-	WaitForSingleObject(_private->activityEvent, INFINITE);
+	_private->activity.wait(seconds);
+	_private->suspended.release();
 }
 
 void Thread::resume()
 {
-	if (_private->suspended.atomicCounterValue() == 0) return;
-
-	_private->suspended.release();
-	SetEvent(_private->activityEvent);
+	_private->activity.notify();
 }
 
 void Thread::stop()
 {
 	if (_private->running.atomicCounterValue() != 0)
 	{
-		resume();
 		_private->running.release();
+		resume();
 	}
 }
 
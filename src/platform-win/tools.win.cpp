@@ -8,6 +8,7 @@
 #include <Windows.h>
 #include <Shlobj.h>
 #include <et/core/tools.h>
+#include <et/core/assetpack.h>
 #include <et/core/filesystem.h>
 #include <et/core/containers.h>
 
@@ -57,6 +58,9 @@ std::string et::applicationPath()
 
 bool et::fileExists(const std::string& name)
 {
+	if (AssetPack::mountedFileExists(name))
+		return true;
+
 	return GetFileAttributes(name.c_str()) != INVALID_FILE_ATTRIBUTES;
 }
 
@@ -0,0 +1,288 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/core/tools.h>
+#include <et/rendering/rendercontext.h>
+#include <et/rendering/uploadqueue.h>
+
+using namespace et;
+
+UploadQueue::Item::Item(ItemType t) :
+	type(t), totalBytes(0), layer(0), level(0), offset(0), enqueueTime(queryCurrentTimeInMicroSeconds()),
+	started(false), finished(false)
+{
+}
+
+UploadQueue::UploadQueue() :
+	_totalLatency(0), _frameTimeBudget(DefaultFrameTimeBudget), _frameDataBudget(DefaultFrameDataBudget)
+{
+}
+
+UploadQueue::~UploadQueue()
+{
+	CriticalSectionScope lock(_csItems);
+
+	for (auto i : _items)
+		delete i;
+}
+
+void UploadQueue::uploadTexture(Texture texture, TextureDescription::Pointer desc, const Invocation& completion)
+{
+	assert(texture.valid() && desc.valid());
+
+	Item* item = new Item(ItemType_Texture);
+	item->texture = texture;
+	item->textureDescription = desc;
+	item->completion = completion;
+	item->totalBytes = desc->data.dataSize();
+	enqueue(item);
+}
+
+void UploadQueue::uploadVertexData(VertexBuffer buffer, VertexArray::Pointer data, const Invocation& completion)
+{
+	assert(buffer.valid() && data.valid());
+
+	Item* item = new Item(ItemType_VertexBuffer);
+	item->vertexBuffer = buffer;
+	item->vertexArray = data;
+	item->completion = completion;
+	item->totalBytes = data->size() * data->decl().dataSize();
+	enqueue(item);
+}
+
+void UploadQueue::uploadIndexData(IndexBuffer buffer, IndexArray::Pointer data, const Invocation& completion)
+{
+	assert(buffer.valid() && data.valid());
+
+	Item* item = new Item(ItemType_IndexBuffer);
+	item->indexBuffer = buffer;
+	item->indexArray = data;
+	item->completion = completion;
+	item->totalBytes = data->actualSize() * data->format();
+	enqueue(item);
+}
+
+void UploadQueue::enqueue(Item* item)
+{
+	CriticalSectionScope lock(_csItems);
+
+	_items.push_back(item);
+	_statistics.queuedItems++;
+	_statistics.queuedBytes += item->totalBytes;
+}
+
+bool UploadQueue::empty()
+{
+	CriticalSectionScope lock(_csItems);
+	return _items.empty();
+}
+
+UploadQueueStatistics UploadQueue::statistics()
+{
+	CriticalSectionScope lock(_csItems);
+	return _statistics;
+}
+
+void UploadQueue::process(RenderContext* rc)
+{
+	process(rc, _frameTimeBudget, _frameDataBudget);
+}
+
+void UploadQueue::flush(RenderContext* rc)
+{
+	process(rc, 0, 0);
+}
+
+void UploadQueue::process(RenderContext* rc, uint64_t timeBudget, size_t dataBudget)
+{
+	uint64_t startTime = queryCurrentTimeInMicroSeconds();
+	size_t uploadedBytes = 0;
+
+	while (true)
+	{
+		Item* item = nullptr;
+		{
+			CriticalSectionScope lock(_csItems);
+			if (_items.empty()) break;
+
+			/*
+			 * Only this method removes items, so front item stays valid after leaving the lock
+			 */
+			item = _items.front();
+		}
+
+		size_t maxSize = static_cast<size_t>(MaxSliceSize);
+		if (dataBudget > 0)
+			maxSize = std::min(maxSize, dataBudget - uploadedBytes);
+
+		size_t sliceSize = uploadSlice(rc, item, maxSize);
+		uploadedBytes += sliceSize;
+
+		{
+			CriticalSectionScope lock(_csItems);
+
+			_statistics.queuedBytes -= std::min(_statistics.queuedBytes, sliceSize);
+			_statistics.uploadedBytes += sliceSize;
+
+			if (item->finished)
+			{
+				_items.pop_front();
+				_statistics.queuedItems--;
+			}
+		}
+
+		if (item->finished)
+			complete(item);
+
+		bool dataBudgetExceeded = (dataBudget > 0) && (uploadedBytes >= dataBudget);
+		bool timeBudgetExceeded = (timeBudget > 0) && (queryCurrentTimeInMicroSeconds() - startTime >= timeBudget);
+
+		if (dataBudgetExceeded || timeBudgetExceeded) break;
+	}
+
+	CriticalSectionScope lock(_csItems);
+	_statistics.lastFrameUploadedBytes = uploadedBytes;
+	_statistics.lastFrameUploadTime = queryCurrentTimeInMicroSeconds() - startTime;
+}
+
+void UploadQueue::complete(Item* item)
+{
+	uint64_t latency = queryCurrentTimeInMicroSeconds() - item->enqueueTime;
+	{
+		CriticalSectionScope lock(_csItems);
+
+		_totalLatency += latency;
+		_statistics.uploadedItems++;
+		_statistics.averageLatency = _totalLatency / _statistics.uploadedItems;
+		_statistics.maxLatency = std::max(_statistics.maxLatency, latency);
+	}
+
+	if (item->completion.valid())
+		item->completion.invoke();
+
+	delete item;
+}
+
+size_t UploadQueue::uploadSlice(RenderContext* rc, Item* item, size_t maxSize)
+{
+	switch (item->type)
+	{
+		case ItemType_Texture:
+			return uploadTextureSlice(rc, item, maxSize);
+
+		case ItemType_VertexBuffer:
+			return uploadVertexSlice(item, maxSize);
+
+		case ItemType_IndexBuffer:
+			return uploadIndexSlice(item, maxSize);
+
+		default:
+			assert(false && "Invalid upload item type");
+	}
+
+	item->finished = true;
+	return 0;
+}
+
+/*
+ * Compressed levels and levels which fit into the slice are uploaded at once,
+ * other levels are uploaded by ranges of rows.
+ */
+size_t UploadQueue::uploadTextureSlice(RenderContext* rc, Item* item, size_t maxSize)
+{
+	TextureDescription::Pointer& desc = item->textureDescription;
+
+	if (!item->started)
+	{
+		item->started = true;
+
+		if (!item->texture->beginStagedUpdate(rc, desc))
+		{
+			item->texture->updateData(rc, desc);
+			item->finished = true;
+			return item->totalBytes;
+		}
+	}
+
+	vec2i mipSize = desc->sizeForMipLevel(item->level);
+	size_t levelSize = desc->dataSizeForMipLevel(item->level);
+	size_t uploaded = 0;
+
+	if (desc->compressed || (mipSize.y < 2) || ((item->offset == 0) && (levelSize <= maxSize)))
+	{
+		item->texture->updateLevel(rc, item->level, item->layer);
+		item->offset = static_cast<size_t>(mipSize.y);
+		uploaded = levelSize;
+	}
+	else
+	{
+		size_t rowSize = std::max(size_t(1), levelSize / static_cast<size_t>(mipSize.y));
+		size_t rowsLeft = static_cast<size_t>(mipSize.y) - item->offset;
+		size_t rowsCount = std::min(rowsLeft, std::max(size_t(1), maxSize / rowSize));
+
+		item->texture->updateLevelRows(rc, item->level, item->layer,
+			static_cast<int>(item->offset), static_cast<int>(rowsCount));
+
+		item->offset += rowsCount;
+		uploaded = rowsCount * rowSize;
+	}
+
+	if (item->offset >= static_cast<size_t>(mipSize.y))
+	{
+		item->offset = 0;
+		if (++item->level >= desc->mipMapCount)
+		{
+			item->level = 0;
+			if (++item->layer >= item->texture->layersCount())
+			{
+				item->texture->endStagedUpdate();
+				item->finished = true;
+			}
+		}
+	}
+
+	return uploaded;
+}
+
+size_t UploadQueue::uploadVertexSlice(Item* item, size_t maxSize)
+{
+	if (!item->started)
+	{
+		item->started = true;
+		item->vertexData = item->vertexArray->generateDescription().data;
+		item->vertexArray.reset(nullptr);
+		item->vertexBuffer->setData(nullptr, item->vertexData.dataSize());
+	}
+
+	size_t sliceSize = std::min(maxSize, item->vertexData.dataSize() - item->offset);
+	if (sliceSize > 0)
+		item->vertexBuffer->setDataWithOffset(item->vertexData.binary() + item->offset, item->offset, sliceSize);
+
+	item->offset += sliceSize;
+	item->finished = (item->offset >= item->vertexData.dataSize());
+
+	return sliceSize;
+}
+
+size_t UploadQueue::uploadIndexSlice(Item* item, size_t maxSize)
+{
+	if (!item->started)
+	{
+		item->started = true;
+		item->indexBuffer->allocateData(item->indexArray);
+	}
+
+	size_t sliceSize = std::min(maxSize, item->totalBytes - item->offset);
+	if (sliceSize > 0)
+		item->indexBuffer->setDataWithOffset(item->indexArray->data() + item->offset, item->offset, sliceSize);
+
+	item->offset += sliceSize;
+	item->finished = (item->offset >= item->totalBytes);
+
+	return sliceSize;
+}
@@ -9,12 +9,39 @@
 #include <et/core/filesystem.h>
 #include <et/core/stream.h>
 #include <et/rendering/rendercontext.h>
+#include <et/tasks/jobsystem.h>
 #include <et/scene3d/scene3d.h>
 #include <et/scene3d/serialization.h>
 
 using namespace et;
 using namespace s3d;
 
+namespace
+{
+	const size_t parallelCullingThreshold = 4096;
+	const size_t cullingJobSize = 1024;
+
+	class CullingTask : public Task
+	{
+	public:
+		CullingTask(const Frustum& frustum, const AABBArray& boxes, VisibilityMask& mask,
+			size_t begin, size_t end, size_t& visible) : _frustum(frustum), _boxes(boxes),
+			_mask(mask), _begin(begin), _end(end), _visible(visible) { }
+
+	private:
+		void execute()
+			{ _visible = _frustum.cullAABBs(_boxes, _mask, _begin, _end); }
+
+	private:
+		const Frustum& _frustum;
+		const AABBArray& _boxes;
+		VisibilityMask& _mask;
+		size_t _begin;
+		size_t _end;
+		size_t& _visible;
+	};
+}
+
 Scene::Scene(const std::string& name) :
 	ElementContainer(name, nullptr), _externalFactory(nullptr)
 {
@@ -112,8 +139,10 @@ void Scene::deserializeAsync(std::istream& stream, RenderContext* rc, ObjectsCac
 void Scene::deserializeAsync(const std::string& filename, RenderContext* rc, ObjectsCache& tc, 
 	ElementFactory* factory)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::in);
-	deserializeAsync(file, rc, tc, factory, getFilePath(filename));
+	InputStream file(filename, StreamMode_Binary);
+	if (file.invalid()) return;
+
+	deserializeAsync(file.stream(), rc, tc, factory, getFilePath(filename));
 }
 
 bool Scene::deserialize(std::istream& stream, RenderContext* rc, ObjectsCache& tc,
@@ -237,8 +266,8 @@ void Scene::serialize(const std::string& filename, s3d::StorageFormat fmt)
 bool Scene::deserialize(const std::string& filename, RenderContext* rc, ObjectsCache& tc,
 	ElementFactory* factory)
 {
-	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::in);
-	bool success = deserialize(file, rc, tc, factory, getFilePath(filename));
+	InputStream file(filename, StreamMode_Binary);
+	bool success = file.valid() && deserialize(file.stream(), rc, tc, factory, getFilePath(filename));
 
 	if (!success)
 		log::error("Unable to load scene from file: %s", filename.c_str());
@@ -275,6 +304,55 @@ Element::Pointer Scene::createElementOfType(size_t type, Element* parent)
 	}
 }
 
+/*
+ * Bounding boxes are gathered sequentially, since transformations of the elements are cached
+ * on demand, only the tests are performed in parallel. Each job covers a multiple of 32 meshes,
+ * so jobs never write the same word of the mask.
+ */
+size_t Scene::cullSupportMeshes(const Frustum& frustum, Element::List& visible, JobSystem* jobSystem)
+{
+	Element::List meshes = childrenOfType(ElementType_SupportMesh);
+
+	_cullingBoxes.clear();
+	_cullingBoxes.reserve(meshes.size());
+	for (SupportMesh::Pointer mesh : meshes)
+		_cullingBoxes.push_back(mesh->aabb());
+
+	size_t meshesCount = _cullingBoxes.size();
+	_cullingMask.resize((meshesCount + 31) / 32);
+
+	size_t visibleCount = 0;
+	if ((jobSystem == nullptr) || (meshesCount < parallelCullingThreshold))
+	{
+		visibleCount = frustum.cullAABBs(_cullingBoxes, _cullingMask, 0, meshesCount);
+	}
+	else
+	{
+		std::vector<size_t> visibleInJobs((meshesCount + cullingJobSize - 1) / cullingJobSize, 0);
+
+		JobCounter counter;
+		for (size_t i = 0; i < visibleInJobs.size(); ++i)
+		{
+			size_t begin = i * cullingJobSize;
+			jobSystem->submit(new CullingTask(frustum, _cullingBoxes, _cullingMask, begin,
+				etMin(begin + cullingJobSize, meshesCount), visibleInJobs[i]), &counter);
+		}
+		jobSystem->wait(counter);
+
+		for (size_t v : visibleInJobs)
+			visibleCount += v;
+	}
+
+	size_t index = 0;
+	for (auto& mesh : meshes)
+	{
+		if (isVisible(_cullingMask, index++))
+			visible.push_back(mesh);
+	}
+
+	return visibleCount;
+}
+
 Material Scene::materialWithId(int id)
 {
 	Element::List storages = childrenOfType(ElementType_Storage);
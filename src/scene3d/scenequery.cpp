@@ -0,0 +1,348 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/tasks/jobsystem.h>
+#include <et/scene3d/scenequery.h>
+
+using namespace et;
+using namespace et::s3d;
+
+namespace
+{
+	const size_t maxInstancesInLeaf = 2;
+	const size_t queriesPerJob = 64;
+}
+
+class SceneQuery::QueryTask : public Task
+{
+public:
+	QueryTask(const SceneQuery* owner, const std::vector<Query>& queries, SceneQueryHitList& hits,
+		size_t begin, size_t end) : _owner(owner), _queries(queries), _hits(hits), _begin(begin), _end(end) { }
+
+private:
+	void execute()
+		{ _owner->processQueries(_queries, _hits, _begin, _end); }
+
+private:
+	const SceneQuery* _owner;
+	const std::vector<Query>& _queries;
+	SceneQueryHitList& _hits;
+	size_t _begin;
+	size_t _end;
+};
+
+SceneQuery::SceneQuery(Element::Pointer root) :
+	_root(root)
+{
+	update();
+}
+
+/*
+ * Transformations are read here, since finalTransform updates caches of the elements
+ */
+void SceneQuery::update()
+{
+	Element::List meshes = _root->childrenOfType(ElementType_SupportMesh);
+
+	size_t index = 0;
+	bool sameMeshes = true;
+	for (auto& e : meshes)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(e.ptr());
+		if (!mesh->active() || mesh->bvh().empty()) continue;
+
+		if ((index >= _instances.size()) || (_instances[index].mesh != mesh))
+		{
+			sameMeshes = false;
+			break;
+		}
+		++index;
+	}
+
+	if (sameMeshes && (index == _instances.size()))
+	{
+		bool changed = false;
+		for (Instance& i : _instances)
+		{
+			if (i.transformVersion != i.mesh->transformVersion())
+			{
+				updateInstance(i);
+				changed = true;
+			}
+		}
+
+		if (changed)
+			refit();
+
+		return;
+	}
+
+	_instances.clear();
+	for (auto& e : meshes)
+	{
+		SupportMesh* mesh = static_cast<SupportMesh*>(e.ptr());
+		if (!mesh->active() || mesh->bvh().empty()) continue;
+
+		Instance i;
+		i.mesh = mesh;
+		updateInstance(i);
+		_instances.push_back(i);
+	}
+
+	rebuild();
+}
+
+/*
+ * World bounds are computed from the mesh space bounds of the triangle hierarchy
+ */
+void SceneQuery::updateInstance(Instance& i)
+{
+	i.transform = i.mesh->finalTransform();
+	i.inverseTransform = i.mesh->finalTransformInverse();
+	i.transformVersion = i.mesh->transformVersion();
+
+	const TriangleBVH::Node& root = i.mesh->bvh().nodes().front();
+	vec3 center = i.transform * (0.5f * (root.minVertex + root.maxVertex));
+	vec3 extent = 0.5f * (root.maxVertex - root.minVertex);
+
+	vec3 worldExtent = absv(i.transform[0].xyz()) * extent.x + absv(i.transform[1].xyz()) * extent.y +
+		absv(i.transform[2].xyz()) * extent.z;
+
+	i.minVertex = center - worldExtent;
+	i.maxVertex = center + worldExtent;
+}
+
+void SceneQuery::rebuild()
+{
+	_nodes.clear();
+	_indices.clear();
+	if (_instances.empty()) return;
+
+	std::vector<uint32_t> order(_instances.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = static_cast<uint32_t>(i);
+
+	buildNode(order, 0, order.size());
+}
+
+/*
+ * Median split along the longest axis, top level is small and rebuilt rarely
+ */
+uint32_t SceneQuery::buildNode(std::vector<uint32_t>& order, size_t begin, size_t end)
+{
+	uint32_t nodeIndex = static_cast<uint32_t>(_nodes.size());
+	_nodes.push_back(TriangleBVH::Node());
+
+	vec3 minVertex = _instances[order[begin]].minVertex;
+	vec3 maxVertex = _instances[order[begin]].maxVertex;
+	for (size_t i = begin + 1; i < end; ++i)
+	{
+		minVertex = minv(minVertex, _instances[order[i]].minVertex);
+		maxVertex = maxv(maxVertex, _instances[order[i]].maxVertex);
+	}
+
+	_nodes[nodeIndex].minVertex = minVertex;
+	_nodes[nodeIndex].maxVertex = maxVertex;
+
+	if (end - begin <= maxInstancesInLeaf)
+	{
+		_nodes[nodeIndex].offset = static_cast<uint32_t>(_indices.size());
+		_nodes[nodeIndex].count = static_cast<uint32_t>(end - begin);
+		_indices.insert(_indices.end(), order.begin() + static_cast<std::ptrdiff_t>(begin),
+			order.begin() + static_cast<std::ptrdiff_t>(end));
+	}
+	else
+	{
+		vec3 extent = maxVertex - minVertex;
+		int axis = (extent.x > extent.y) ? ((extent.x > extent.z) ? 0 : 2) : ((extent.y > extent.z) ? 1 : 2);
+
+		size_t middle = begin + (end - begin) / 2;
+		const std::vector<Instance>& instances = _instances;
+		std::nth_element(order.begin() + static_cast<std::ptrdiff_t>(begin), order.begin() + static_cast<std::ptrdiff_t>(middle),
+			order.begin() + static_cast<std::ptrdiff_t>(end), [&instances, axis](uint32_t a, uint32_t b)
+			{ return instances[a].minVertex[axis] + instances[a].maxVertex[axis] <
+				instances[b].minVertex[axis] + instances[b].maxVertex[axis]; });
+
+		buildNode(order, begin, middle);
+		_nodes[nodeIndex].offset = buildNode(order, middle, end);
+		_nodes[nodeIndex].count = 0;
+	}
+
+	return nodeIndex;
+}
+
+/*
+ * Children are always stored after parents, so reverse pass updates nodes bottom-up
+ */
+void SceneQuery::refit()
+{
+	for (size_t n = _nodes.size(); n > 0; --n)
+	{
+		TriangleBVH::Node& node = _nodes[n - 1];
+		if (node.isLeaf())
+		{
+			const Instance& first = _instances[_indices[node.offset]];
+			node.minVertex = first.minVertex;
+			node.maxVertex = first.maxVertex;
+			for (uint32_t i = node.offset + 1, e = node.offset + node.count; i < e; ++i)
+			{
+				node.minVertex = minv(node.minVertex, _instances[_indices[i]].minVertex);
+				node.maxVertex = maxv(node.maxVertex, _instances[_indices[i]].maxVertex);
+			}
+		}
+		else
+		{
+			const TriangleBVH::Node& a = _nodes[n];
+			const TriangleBVH::Node& b = _nodes[node.offset];
+			node.minVertex = minv(a.minVertex, b.minVertex);
+			node.maxVertex = maxv(a.maxVertex, b.maxVertex);
+		}
+	}
+}
+
+/*
+ * Ray is transformed into the mesh space without normalization,
+ * so distances of hits in different meshes are comparable
+ */
+bool SceneQuery::closestHit(const Query& query, SceneQueryHit& hit) const
+{
+	hit = SceneQueryHit();
+	if (_nodes.empty()) return false;
+
+	vec3 invDirection = TriangleBVH::inverseDirection(query.direction);
+	float closest = query.maxDistance;
+
+	const Instance* hitInstance = nullptr;
+	TriangleBVH::RayHit meshHit;
+
+	uint32_t stack[TriangleBVH::MaxDepth];
+	size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const TriangleBVH::Node& node = _nodes[stack[--stackSize]];
+
+		float distance = 0.0f;
+		if (!node.intersectsRay(query.origin, invDirection, closest, distance)) continue;
+
+		if (node.isLeaf())
+		{
+			for (uint32_t i = node.offset, e = node.offset + node.count; i < e; ++i)
+			{
+				const Instance& instance = _instances[_indices[i]];
+				vec3 origin = instance.inverseTransform * query.origin;
+				vec3 direction = instance.inverseTransform.rotationMultiply(query.direction);
+
+				TriangleBVH::RayHit h;
+				if (instance.mesh->bvh().closestHit(instance.mesh->triangles().data(), origin, direction, closest, h))
+				{
+					closest = h.distance;
+					meshHit = h;
+					hitInstance = &instance;
+				}
+			}
+		}
+		else
+		{
+			uint32_t first = static_cast<uint32_t>(&node - _nodes.data()) + 1;
+			uint32_t second = node.offset;
+
+			float firstDistance = 0.0f;
+			float secondDistance = 0.0f;
+			bool hitFirst = _nodes[first].intersectsRay(query.origin, invDirection, closest, firstDistance);
+			bool hitSecond = _nodes[second].intersectsRay(query.origin, invDirection, closest, secondDistance);
+
+			if (hitFirst && hitSecond && (firstDistance < secondDistance))
+				std::swap(first, second);
+
+			if (hitFirst || hitSecond)
+				stack[stackSize++] = first;
+
+			if (hitFirst && hitSecond)
+				stack[stackSize++] = second;
+		}
+	}
+
+	if (hitInstance == nullptr) return false;
+
+	const triangle& t = hitInstance->mesh->triangles()[static_cast<size_t>(meshHit.triangle)];
+	vec3 v1 = hitInstance->transform * t.v1();
+	vec3 v2 = hitInstance->transform * t.v2();
+	vec3 v3 = hitInstance->transform * t.v3();
+
+	hit.mesh = hitInstance->mesh;
+	hit.triangleIndex = meshHit.triangle;
+	hit.distance = meshHit.distance;
+	hit.point = query.origin + meshHit.distance * query.direction;
+	hit.normal = normalize(cross(v2 - v1, v3 - v1));
+	hit.barycentric = barycentricCoordinates(meshHit.point, t);
+	return true;
+}
+
+bool SceneQuery::raycast(const ray3d& r, SceneQueryHit& hit) const
+{
+	Query q = { r.origin, r.direction, std::numeric_limits<float>::max() };
+	return closestHit(q, hit);
+}
+
+bool SceneQuery::raycast(const segment3d& s, SceneQueryHit& hit) const
+{
+	Query q = { s.start, s.end - s.start, 1.0f };
+	return closestHit(q, hit);
+}
+
+void SceneQuery::raycast(const std::vector<ray3d>& rays, SceneQueryHitList& hits, JobSystem* jobSystem) const
+{
+	std::vector<Query> queries(rays.size());
+	for (size_t i = 0, e = rays.size(); i < e; ++i)
+	{
+		queries[i].origin = rays[i].origin;
+		queries[i].direction = rays[i].direction;
+		queries[i].maxDistance = std::numeric_limits<float>::max();
+	}
+
+	processQueries(queries, hits, jobSystem);
+}
+
+void SceneQuery::raycast(const std::vector<segment3d>& segments, SceneQueryHitList& hits, JobSystem* jobSystem) const
+{
+	std::vector<Query> queries(segments.size());
+	for (size_t i = 0, e = segments.size(); i < e; ++i)
+	{
+		queries[i].origin = segments[i].start;
+		queries[i].direction = segments[i].end - segments[i].start;
+		queries[i].maxDistance = 1.0f;
+	}
+
+	processQueries(queries, hits, jobSystem);
+}
+
+void SceneQuery::processQueries(const std::vector<Query>& queries, SceneQueryHitList& hits, JobSystem* jobSystem) const
+{
+	hits.resize(queries.size());
+
+	if ((jobSystem == nullptr) || (queries.size() <= queriesPerJob))
+	{
+		processQueries(queries, hits, 0, queries.size());
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin = 0, e = queries.size(); begin < e; begin += queriesPerJob)
+		jobSystem->submit(new QueryTask(this, queries, hits, begin, etMin(begin + queriesPerJob, e)), &counter);
+
+	jobSystem->wait(counter);
+}
+
+void SceneQuery::processQueries(const std::vector<Query>& queries, SceneQueryHitList& hits,
+	size_t begin, size_t end) const
+{
+	for (size_t i = begin; i < end; ++i)
+		closestHit(queries[i], hits[i]);
+}
@@ -11,7 +11,7 @@ namespace et
 {
 	namespace s3d
 	{
-		const SceneVersion SceneVersionLatest = SceneVersion_1_0_3;
+		const SceneVersion SceneVersionLatest = SceneVersion_1_0_4;
 		const StorageVersion StorageVersionLatest = StorageVersion_1_0_1;
 
 		ChunkId HeaderScene = "ETSCN";
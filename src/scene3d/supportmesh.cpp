@@ -11,14 +11,14 @@ using namespace et;
 using namespace et::s3d;
 
 SupportMesh::SupportMesh(const std::string& name, Element* parent) : Mesh(name, parent),
-	_cachedFinalTransformScale(0.0f), _inverseTransformValid(false)
+	_cachedFinalTransformScale(0.0f), _transformVersion(0), _inverseTransformValid(false)
 {
 
 }
 
 SupportMesh::SupportMesh(const std::string& name, const VertexArrayObject& ib, const Material& material,
 	IndexType startIndex, size_t numIndexes, Element* parent) : Mesh(name, ib, material, startIndex, numIndexes, parent),
-	_data(numIndexes / 3), _cachedFinalTransformScale(0.0f), _inverseTransformValid(false)
+	_data(numIndexes / 3), _cachedFinalTransformScale(0.0f), _transformVersion(0), _inverseTransformValid(false)
 {
 
 }
@@ -70,6 +70,8 @@ void SupportMesh::fillCollisionData(VertexArray::Pointer v, IndexArray::Pointer
 	_size = maxv(0.5f * (maxOffset - minOffset), vec3(std::numeric_limits<float>::epsilon()));
 	_center = 0.5f * (maxOffset + minOffset);
 	_radius = distance;
+
+	_bvh.build(_data.data(), index);
 }
 
 SupportMesh* SupportMesh::duplicate()
@@ -84,6 +86,7 @@ SupportMesh* SupportMesh::duplicate()
 	result->_center = _center;
 	result->_radius = _radius;
 	result->_data = _data;
+	result->_bvh = _bvh;
 	
 	return result;
 }
@@ -115,6 +118,7 @@ void SupportMesh::serialize(std::ostream& stream, SceneVersion version)
 	serializeVector(stream, _center);
 	serializeInt(stream, _data.size());
 	stream.write(_data.binary(), static_cast<std::streamsize>(_data.dataSize()));
+	_bvh.serialize(stream);
 	Mesh::serialize(stream, version);
 }
 
@@ -139,6 +143,11 @@ void SupportMesh::deserialize(std::istream& stream, ElementFactory* factory, Sce
 		stream.read(_data.binary(), static_cast<std::streamsize>(_data.dataSize()));
 	}
 
+	if (version >= SceneVersion_1_0_4)
+		_bvh.deserialize(stream);
+	else
+		_bvh.build(_data.data(), _data.size());
+
 	Mesh::deserialize(stream, factory, version);
 }
 
@@ -151,6 +160,12 @@ mat4 SupportMesh::finalTransform()
 }
 
 
+void SupportMesh::invalidateTransform()
+{
+	Mesh::invalidateTransform();
+	++_transformVersion;
+}
+
 mat4 SupportMesh::finalTransformInverse()
 {
 	if (!_inverseTransformValid)
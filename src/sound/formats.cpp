@@ -33,6 +33,9 @@ const uint32_t AIFFCompressedDataChunkID = 'DNSC';
 const uint32_t WAVFileChunkID = 'FFIR';
 const uint32_t WAVDataChunkID = 'atad';
 const uint32_t WAVFormatChunkID = ' tmf';
+const uint32_t WAVFactChunkID = 'tcaf';
+
+const uint16_t WAVFormatIMAADPCM = 0x0011;
 
 #pragma pack(1)
 
@@ -53,6 +56,12 @@ struct WAVFormatChunk
 	uint16_t bitsPerSample;
 };
 
+struct WAVADPCMFormatExtension
+{
+	uint16_t extensionSize;
+	uint16_t samplesPerBlock;
+};
+
 struct AIFFFileChunk
 {
 	ChunkIdentifier ckID;
@@ -82,12 +91,75 @@ struct AIFFSoundDataChunk
 	uint32_t blockSize;
 };
 
+#pragma pack()
+
+struct PCMDataLocation
+{
+	std::streamoff offset;
+	size_t size;
+};
+
+/*
+ * Block layout of IMA ADPCM data, blockAlign is zero for PCM files
+ */
+struct ADPCMFormat
+{
+	size_t blockAlign;
+	size_t framesPerBlock;
+	size_t frames;
+};
+
+class PCMFileDecoder : public Decoder
+{
+public:
+	PCMFileDecoder(Description::Pointer desc, InputStream::Pointer file, const PCMDataLocation& location,
+		bool bigEndian);
+
+	size_t read(char* buffer, size_t size);
+	void rewind();
+
+private:
+	InputStream::Pointer _file;
+	PCMDataLocation _location;
+	size_t _position;
+	bool _bigEndian;
+};
+
+/*
+ * Blocks are decoded one at a time, so the file is never kept in memory in the compressed form
+ */
+class ADPCMFileDecoder : public Decoder
+{
+public:
+	ADPCMFileDecoder(Description::Pointer desc, InputStream::Pointer file, const PCMDataLocation& location,
+		const ADPCMFormat& format);
+
+	size_t read(char* buffer, size_t size);
+	void rewind();
+
+private:
+	bool decodeBlock();
+
+private:
+	InputStream::Pointer _file;
+	PCMDataLocation _location;
+	ADPCMFormat _format;
+	BinaryDataStorage _block;
+	std::vector<int16_t> _samples;
+	size_t _sampleOffset;
+	size_t _position;
+	size_t _framesDecoded;
+};
+
 uint32_t swapEndiannes(uint32_t i);
 uint16_t swapEndiannes(uint16_t i);
-void swapEndiannes(unsigned char* data, size_t dataSize);
+void convertAIFFSamples(unsigned char* data, size_t dataSize, size_t bitDepth);
 double _af_convert_from_ieee_extended (const unsigned char *bytes);
+Description::Pointer loadDecodedFile(Decoder::Pointer decoder);
 
-#pragma pack()
+Description* readWAVHeader(std::istream& stream, const std::string& fileName, PCMDataLocation& location,
+	ADPCMFormat& adpcm);
+Description* readAIFFHeader(std::istream& stream, const std::string& fileName, PCMDataLocation& location);
 
 size_t et::audio::openALFormatFromChannelsAndBitDepth(size_t numChannels, size_t bitDepth)
 {
@@ -138,41 +210,399 @@ Description::Pointer et::audio::loadWAVFile(const std::string& fileName)
 		return Description::Pointer();
 	}
 
+	PCMDataLocation location = { };
+	ADPCMFormat adpcm = { };
+	Description::Pointer result(readWAVHeader(file.stream(), fileName, location, adpcm));
+
+	if (result.valid() && (adpcm.blockAlign > 0))
+		return loadDecodedFile(openWAVFile(fileName));
+
+	if (result.valid() && (location.size > 0))
+	{
+		result->data.resize(location.size);
+		file.stream().read(result->data.binary(), static_cast<std::streamsize>(location.size));
+	}
+
+	return result;
+}
+
+Description::Pointer et::audio::loadCAFFile(const std::string&)
+{
+	assert(false && "CAF is not currently supported");
+	return Description::Pointer();
+}
+
+Description::Pointer et::audio::loadAIFFile(const std::string& fileName)
+{
+	InputStream file(fileName, StreamMode_Binary);
+	if (file.invalid())
+		return Description::Pointer();
+
+	PCMDataLocation location = { };
+	Description::Pointer result(readAIFFHeader(file.stream(), fileName, location));
+
+	if (result.valid() && (location.size > 0))
+	{
+		result->data.resize(location.size);
+		file.stream().read(result->data.binary(), static_cast<std::streamsize>(location.size));
+		convertAIFFSamples(result->data.data(), result->data.dataSize(), result->bitDepth);
+	}
+
+	return result;
+}
+
+Description::Pointer et::audio::loadFile(const std::string& fileName)
+{
+	size_t dotPos = fileName.rfind('.');
+	if (dotPos == std::string::npos)
+		return Description::Pointer();
+
+	std::string ext = fileName.substr(dotPos);
+	lowercase(ext);
+
+	if (ext == ".wav")
+	{
+		return loadWAVFile(fileName);
+	}
+	else if (ext == ".caf")
+	{
+		return loadCAFFile(fileName);
+	}
+	else if ((ext == ".aif") || (ext == ".aiff") || (ext == ".aifc"))
+	{
+		return loadAIFFile(fileName);
+	}
+	else if (ext == ".ogg")
+	{
+		return loadDecodedFile(openOGGFile(fileName));
+	}
+
+	return Description::Pointer();
+}
+
+Decoder::Pointer et::audio::openWAVFile(const std::string& fileName)
+{
+	InputStream::Pointer file(new InputStream(fileName, StreamMode_Binary));
+	if (file->invalid())
+	{
+		std::cout << "Unable to open WAV file " << fileName << std::endl;
+		return Decoder::Pointer();
+	}
+
+	PCMDataLocation location = { };
+	ADPCMFormat adpcm = { };
+	Description::Pointer desc(readWAVHeader(file->stream(), fileName, location, adpcm));
+	if (desc.invalid())
+		return Decoder::Pointer();
+
+	if (adpcm.blockAlign > 0)
+		return Decoder::Pointer(new ADPCMFileDecoder(desc, file, location, adpcm));
+
+	return Decoder::Pointer(new PCMFileDecoder(desc, file, location, false));
+}
+
+Decoder::Pointer et::audio::openAIFFile(const std::string& fileName)
+{
+	InputStream::Pointer file(new InputStream(fileName, StreamMode_Binary));
+	if (file->invalid())
+		return Decoder::Pointer();
+
+	PCMDataLocation location = { };
+	Description::Pointer desc(readAIFFHeader(file->stream(), fileName, location));
+	if (desc.invalid())
+		return Decoder::Pointer();
+
+	return Decoder::Pointer(new PCMFileDecoder(desc, file, location, true));
+}
+
+Decoder::Pointer et::audio::openFile(const std::string& fileName)
+{
+	size_t dotPos = fileName.rfind('.');
+	if (dotPos == std::string::npos)
+		return Decoder::Pointer();
+
+	std::string ext = fileName.substr(dotPos);
+	lowercase(ext);
+
+	if (ext == ".wav")
+	{
+		return openWAVFile(fileName);
+	}
+	else if ((ext == ".aif") || (ext == ".aiff") || (ext == ".aifc"))
+	{
+		return openAIFFile(fileName);
+	}
+	else if (ext == ".ogg")
+	{
+		return openOGGFile(fileName);
+	}
+
+	return Decoder::Pointer();
+}
+
+/*
+ * PCM file decoder
+ */
+PCMFileDecoder::PCMFileDecoder(Description::Pointer desc, InputStream::Pointer file,
+	const PCMDataLocation& location, bool bigEndian) : Decoder(desc), _file(file), _location(location),
+	_position(0), _bigEndian(bigEndian)
+{
+	rewind();
+}
+
+size_t PCMFileDecoder::read(char* buffer, size_t size)
+{
+	size_t bytesToRead = etMin(size, _location.size - _position);
+	if (bytesToRead == 0) return 0;
+
+	_file->stream().read(buffer, static_cast<std::streamsize>(bytesToRead));
+	size_t bytesRead = static_cast<size_t>(_file->stream().gcount());
+
+	if (_bigEndian)
+		convertAIFFSamples(reinterpret_cast<unsigned char*>(buffer), bytesRead, description()->bitDepth);
+
+	_position = (bytesRead < bytesToRead) ? _location.size : _position + bytesRead;
+	return bytesRead;
+}
+
+void PCMFileDecoder::rewind()
+{
+	_file->stream().clear();
+	_file->stream().seekg(_location.offset);
+	_position = 0;
+}
+
+/*
+ * IMA ADPCM file decoder
+ */
+namespace
+{
+	const int ADPCMIndexTable[16] =
+	{
+		-1, -1, -1, -1, 2, 4, 6, 8,
+		-1, -1, -1, -1, 2, 4, 6, 8
+	};
+
+	const int ADPCMStepTable[89] =
+	{
+		7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+		50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+		253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+		1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+		3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+		12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+	};
+
+	struct ADPCMChannelState
+	{
+		int predictor;
+		int stepIndex;
+
+		int16_t decode(int nibble)
+		{
+			int step = ADPCMStepTable[stepIndex];
+
+			int difference = step >> 3;
+			if (nibble & 1)
+				difference += step >> 2;
+			if (nibble & 2)
+				difference += step >> 1;
+			if (nibble & 4)
+				difference += step;
+
+			predictor = clamp(predictor + ((nibble & 8) ? -difference : difference), -32768, 32767);
+			stepIndex = clamp(stepIndex + ADPCMIndexTable[nibble], 0, 88);
+			return static_cast<int16_t>(predictor);
+		}
+	};
+}
+
+ADPCMFileDecoder::ADPCMFileDecoder(Description::Pointer desc, InputStream::Pointer file,
+	const PCMDataLocation& location, const ADPCMFormat& format) : Decoder(desc), _file(file),
+	_location(location), _format(format), _block(format.blockAlign), _sampleOffset(0), _position(0),
+	_framesDecoded(0)
+{
+	_samples.reserve(_format.framesPerBlock * desc->channels);
+	rewind();
+}
+
+size_t ADPCMFileDecoder::read(char* buffer, size_t size)
+{
+	size_t channels = description()->channels;
+	size_t samplesToWrite = size / (channels * sizeof(int16_t)) * channels;
+	size_t samplesWritten = 0;
+
+	while (samplesWritten < samplesToWrite)
+	{
+		if ((_sampleOffset >= _samples.size()) && !decodeBlock())
+			break;
+
+		size_t count = etMin(samplesToWrite - samplesWritten, _samples.size() - _sampleOffset);
+		etCopyMemory(buffer + samplesWritten * sizeof(int16_t), _samples.data() + _sampleOffset, count * sizeof(int16_t));
+		_sampleOffset += count;
+		samplesWritten += count;
+	}
+
+	return samplesWritten * sizeof(int16_t);
+}
+
+/*
+ * Each block starts with predictor and step index for every channel, the first sample is the predictor.
+ * Nibbles are stored low first, channels are interleaved by groups of 4 bytes (8 samples).
+ */
+bool ADPCMFileDecoder::decodeBlock()
+{
+	size_t channels = description()->channels;
+	size_t headerSize = 4 * channels;
+
+	_samples.clear();
+	_sampleOffset = 0;
+
+	size_t bytesToRead = etMin(_format.blockAlign, _location.size - _position);
+	if ((bytesToRead <= headerSize) || (_framesDecoded >= _format.frames))
+		return false;
+
+	_file->stream().read(_block.binary(), static_cast<std::streamsize>(bytesToRead));
+	size_t bytesRead = static_cast<size_t>(_file->stream().gcount());
+	_position = (bytesRead < bytesToRead) ? _location.size : _position + bytesRead;
+	if (bytesRead <= headerSize)
+		return false;
+
+	ADPCMChannelState state[2] = { };
+	const unsigned char* data = _block.data();
+	for (size_t c = 0; c < channels; ++c)
+	{
+		state[c].predictor = static_cast<int16_t>(data[4 * c] | (data[4 * c + 1] << 8));
+		state[c].stepIndex = clamp(static_cast<int>(data[4 * c + 2]), 0, 88);
+	}
+
+	size_t groups = (bytesRead - headerSize) / headerSize;
+	size_t frames = etMin(etMin(1 + 8 * groups, _format.framesPerBlock), _format.frames - _framesDecoded);
+	_samples.resize(frames * channels);
+
+	for (size_t c = 0; c < channels; ++c)
+		_samples[c] = static_cast<int16_t>(state[c].predictor);
+
+	for (size_t g = 0; g < groups; ++g)
+	{
+		for (size_t c = 0; c < channels; ++c)
+		{
+			const unsigned char* group = data + headerSize * (g + 1) + 4 * c;
+			for (size_t i = 0; i < 8; ++i)
+			{
+				size_t frame = 1 + 8 * g + i;
+				int16_t sample = state[c].decode((i & 1) ? (group[i / 2] >> 4) : (group[i / 2] & 0x0f));
+				if (frame < frames)
+					_samples[frame * channels + c] = sample;
+			}
+		}
+	}
+
+	_framesDecoded += frames;
+	return true;
+}
+
+void ADPCMFileDecoder::rewind()
+{
+	_file->stream().clear();
+	_file->stream().seekg(_location.offset);
+	_samples.clear();
+	_sampleOffset = 0;
+	_position = 0;
+	_framesDecoded = 0;
+}
+
+/*
+ * Headers are parsed until the beginning of sample data
+ */
+Description* readWAVHeader(std::istream& stream, const std::string& fileName, PCMDataLocation& location,
+	ADPCMFormat& adpcm)
+{
 	WAVFileChunk fileChunk = { };
-	file.stream().read(reinterpret_cast<char*>(&fileChunk), sizeof(fileChunk));
+	stream.read(reinterpret_cast<char*>(&fileChunk), sizeof(fileChunk));
 	if (fileChunk.id.nID != WAVFileChunkID)
-		return Description::Pointer();
+		return nullptr;
 
-	Description* result = 0;
+	Description* result = nullptr;
 
-	while (!file.stream().eof() && file.stream().good())
+	while (!stream.eof() && stream.good())
 	{
 		AudioFileChunk chunk = { };
-		file.stream().read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+		stream.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
 
 		if (chunk.id.nID == WAVFormatChunkID)
 		{
 			WAVFormatChunk fmt = { };
-			file.stream().read(reinterpret_cast<char*>(&fmt), sizeof(fmt));
+			stream.read(reinterpret_cast<char*>(&fmt), sizeof(fmt));
+
+			WAVADPCMFormatExtension extension = { };
+			size_t extensionSize = 0;
+			if ((fmt.audioFormat == WAVFormatIMAADPCM) && (chunk.size >= sizeof(fmt) + sizeof(extension)))
+			{
+				stream.read(reinterpret_cast<char*>(&extension), sizeof(extension));
+				extensionSize = sizeof(extension);
+			}
+
+			if (chunk.size > sizeof(fmt) + extensionSize)
+				stream.seekg(chunk.size - sizeof(fmt) - extensionSize, std::ios::cur);
+
+			if (fmt.audioFormat == WAVFormatIMAADPCM)
+			{
+				size_t headerSize = 4 * fmt.numChannels;
+				if ((fmt.numChannels < 1) || (fmt.numChannels > 2) || (fmt.blockAlign <= headerSize) ||
+					(fmt.blockAlign % headerSize != 0) || (fmt.bitsPerSample != 4))
+				{
+					log::error("Unsupported IMA ADPCM format in file %s", fileName.c_str());
+					break;
+				}
+
+				adpcm.blockAlign = fmt.blockAlign;
+				adpcm.framesPerBlock = 1 + 8 * (adpcm.blockAlign - headerSize) / headerSize;
+				if ((extension.samplesPerBlock > 0) && (extension.samplesPerBlock < adpcm.framesPerBlock))
+					adpcm.framesPerBlock = extension.samplesPerBlock;
+			}
 
 			result = new Description;
 			result->setOrigin(fileName);
 			result->sampleRate = fmt.sampleRate;
 			result->channels = fmt.numChannels;
-			result->bitDepth = fmt.bitsPerSample;
+			result->bitDepth = (adpcm.blockAlign > 0) ? 16 : fmt.bitsPerSample;
 			result->format = openALFormatFromChannelsAndBitDepth(result->channels, result->bitDepth);
 		}
+		else if ((chunk.id.nID == WAVFactChunkID) && (chunk.size >= sizeof(uint32_t)))
+		{
+			uint32_t frames = 0;
+			stream.read(reinterpret_cast<char*>(&frames), sizeof(frames));
+			stream.seekg(chunk.size - sizeof(frames), std::ios::cur);
+			adpcm.frames = frames;
+		}
 		else if ((chunk.id.nID == WAVDataChunkID) && (result != nullptr))
 		{
-			result->data.resize(chunk.size);
-			result->duration = static_cast<float>(result->data.dataSize()) / (
-				static_cast<float>(result->sampleRate * result->channels * result->bitDepth / 8));
-			file.stream().read(result->data.binary(), chunk.size);
+			location.offset = stream.tellg();
+			location.size = chunk.size;
+
+			if (adpcm.blockAlign > 0)
+			{
+				size_t lastBlock = chunk.size % adpcm.blockAlign;
+				size_t lastBlockFrames = (lastBlock > 4 * result->channels) ?
+					1 + 8 * (lastBlock - 4 * result->channels) / (4 * result->channels) : 0;
+				size_t frames = chunk.size / adpcm.blockAlign * adpcm.framesPerBlock + lastBlockFrames;
+
+				if ((adpcm.frames == 0) || (adpcm.frames > frames))
+					adpcm.frames = frames;
+
+				result->duration = static_cast<float>(adpcm.frames) / static_cast<float>(result->sampleRate);
+			}
+			else
+			{
+				result->duration = static_cast<float>(chunk.size) / (
+					static_cast<float>(result->sampleRate * result->channels * result->bitDepth / 8));
+			}
+			break;
 		}
 		else if (chunk.size > 0)
 		{
-			BinaryDataStorage data(static_cast<size_t>(chunk.size));
-			file.stream().read(data.binary(), chunk.size);
+			stream.seekg(chunk.size, std::ios::cur);
 		}
 		else 
 		{
@@ -180,37 +610,27 @@ Description::Pointer et::audio::loadWAVFile(const std::string& fileName)
 		}
 	}
 
-	return Description::Pointer(result);
+	return result;
 }
 
-Description::Pointer et::audio::loadCAFFile(const std::string&)
-{
-	assert(false && "CAF is not currently supported");
-	return Description::Pointer();
-}
-
-Description::Pointer et::audio::loadAIFFile(const std::string& fileName)
+Description* readAIFFHeader(std::istream& stream, const std::string& fileName, PCMDataLocation& location)
 {
-	InputStream file(fileName, StreamMode_Binary);
-	if (file.invalid())
-		return Description::Pointer();
-
 	AIFFFileChunk header = { };
-	file.stream().read(reinterpret_cast<char*>(&header), sizeof(header));
+	stream.read(reinterpret_cast<char*>(&header), sizeof(header));
 	header.ckDataSize = swapEndiannes(header.ckDataSize);
 
-	Description* result = 0;
+	Description* result = nullptr;
 
-	while (!file.stream().eof() && !file.stream().fail())
+	while (!stream.eof() && !stream.fail())
 	{
 		AudioFileChunk chunk = { };
-		file.stream().read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+		stream.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
 		chunk.size = swapEndiannes(chunk.size);
 
 		if (chunk.id.nID == AIFFCommonChunkID)
 		{
 			AIFFCommonChunk comm = { };
-			file.stream().read(reinterpret_cast<char*>(&comm), chunk.size);
+			stream.read(reinterpret_cast<char*>(&comm), chunk.size);
 
 			result = new Description;
 			result->setOrigin(fileName);
@@ -222,15 +642,14 @@ Description::Pointer et::audio::loadAIFFile(const std::string& fileName)
 		else if ((chunk.id.nID == AIFFUncompressedDataChunkID) && (result != nullptr))
 		{
 			AIFFSoundDataChunk ssnd = { };
-			file.stream().read(reinterpret_cast<char*>(&ssnd), sizeof(ssnd));
-			file.stream().seekg(ssnd.offset, std::ios::cur);
+			stream.read(reinterpret_cast<char*>(&ssnd), sizeof(ssnd));
+			stream.seekg(swapEndiannes(ssnd.offset), std::ios::cur);
 
-			result->data.resize(chunk.size - sizeof(ssnd));
-			result->duration = static_cast<float>(result->data.dataSize()) / 
+			location.offset = stream.tellg();
+			location.size = chunk.size - sizeof(ssnd);
+			result->duration = static_cast<float>(location.size) / 
 				static_cast<float>((result->sampleRate * result->channels * result->bitDepth / 8));
-			file.stream().read(result->data.binary(), result->data.dataSize());
-
-			swapEndiannes(result->data.data(), result->data.dataSize());
+			break;
 		}
 		else if (chunk.id.nID == AIFFCompressedDataChunkID)
 		{
@@ -238,8 +657,7 @@ Description::Pointer et::audio::loadAIFFile(const std::string& fileName)
 		}
 		else if (chunk.size > 0)
 		{
-			BinaryDataStorage data(static_cast<size_t>(chunk.size));
-			file.stream().read(data.binary(), chunk.size);
+			stream.seekg(chunk.size, std::ios::cur);
 		}
 		else 
 		{
@@ -247,32 +665,39 @@ Description::Pointer et::audio::loadAIFFile(const std::string& fileName)
 		}
 	}
 
-	return Description::Pointer(result);
+	return result;
 }
 
-Description::Pointer et::audio::loadFile(const std::string& fileName)
+/*
+ * Decodes the whole file to keep it in memory as PCM data
+ */
+Description::Pointer loadDecodedFile(Decoder::Pointer decoder)
 {
-	size_t dotPos = fileName.rfind('.');
-	if (dotPos == std::string::npos)
+	if (decoder.invalid())
 		return Description::Pointer();
 
-	std::string ext = fileName.substr(dotPos);
-	lowercase(ext);
+	Description::Pointer result = decoder->description();
+	size_t frameSize = result->channels * result->bitDepth / 8;
+	size_t chunkSize = 65536 - 65536 % frameSize;
 
-	if (ext == ".wav")
-	{
-		return loadWAVFile(fileName);
-	}
-	else if (ext == ".caf")
-	{
-		return loadCAFFile(fileName);
-	}
-	else if ((ext == ".aif") || (ext == ".aiff") || (ext == ".aifc"))
+	size_t expectedSize = static_cast<size_t>(result->duration * static_cast<float>(result->sampleRate)) * frameSize;
+	result->data.resize(expectedSize + chunkSize);
+
+	size_t size = 0;
+	for (;;)
 	{
-		return loadAIFFile(fileName);
+		if (size + chunkSize > result->data.size())
+			result->data.resize(2 * result->data.size());
+
+		size_t bytesRead = decoder->read(result->data.binary() + size, chunkSize);
+		size += bytesRead;
+
+		if (bytesRead < chunkSize) break;
 	}
 
-	return Description::Pointer();
+	result->data.resize(size);
+	result->duration = static_cast<float>(size / frameSize) / static_cast<float>(result->sampleRate);
+	return result;
 }
 
 /*
@@ -294,14 +719,21 @@ uint16_t swapEndiannes(uint16_t i)
 	return static_cast<uint16_t>((b1 << 16) | b2);
 }
 
-void swapEndiannes(unsigned char* data, size_t dataSize)
+/*
+ * AIFF samples are big endian, 8-bit samples are signed (OpenAL expects unsigned)
+ */
+void convertAIFFSamples(unsigned char* data, size_t dataSize, size_t bitDepth)
 {
-	uint32_t* ptr = reinterpret_cast<uint32_t*>(data);
-	for (size_t i = 0; i < dataSize / 4; ++i)
-    {
-        uint32_t val = *ptr;
-		*ptr++ = swapEndiannes(val);
-    }
+	if (bitDepth == 8)
+	{
+		for (size_t i = 0; i < dataSize; ++i)
+			data[i] ^= 0x80;
+	}
+	else if (bitDepth == 16)
+	{
+		for (size_t i = 0; i + 1 < dataSize; i += 2)
+			std::swap(data[i], data[i + 1]);
+	}
 }
 
 #define UnsignedToFloat(u) (((double) ((long) (u - 2147483647L - 1))) + 2147483648.0)
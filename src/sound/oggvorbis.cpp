@@ -0,0 +1,1476 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <complex>
+#include <algorithm>
+#include <et/core/stream.h>
+#include <et/geometry/geometry.h>
+#include <et/sound/openal.h>
+#include <et/sound/formats.h>
+
+using namespace et;
+using namespace et::audio;
+
+/*
+ * Ogg Vorbis I decoder. Supports floor type 1 and residue types 0, 1, 2
+ * (floor type 0 is not produced by any known encoder).
+ * Samples are decoded packet by packet, when requested by read().
+ */
+namespace
+{
+	typedef std::complex<float> complexf;
+
+	const float pi = 3.1415926535897932384626433832795f;
+
+	enum
+	{
+		MaxChannels = 2,
+		MaxFloorClasses = 16,
+		MaxSubclassBooks = 8,
+		MaxCodebookValues = 1 << 22,
+		UnusedBook = -1
+	};
+
+	int ilog(uint32_t value)
+	{
+		int result = 0;
+		while (value > 0)
+		{
+			++result;
+			value >>= 1;
+		}
+		return result;
+	}
+
+	float float32Unpack(uint32_t x)
+	{
+		float mantissa = static_cast<float>(x & 0x1fffff);
+		int exponent = static_cast<int>((x & 0x7fe00000) >> 21);
+		float result = std::ldexp(mantissa, exponent - 788);
+		return (x & 0x80000000) ? -result : result;
+	}
+
+	/*
+	 * The largest value, which raised to the power of dimensions does not exceed entries
+	 */
+	int lookup1Values(int entries, int dimensions)
+	{
+		int result = static_cast<int>(std::floor(std::pow(static_cast<double>(entries), 1.0 / dimensions)));
+		while (std::pow(static_cast<double>(result + 1), dimensions) <= entries)
+			++result;
+		while ((result > 0) && (std::pow(static_cast<double>(result), dimensions) > entries))
+			--result;
+		return result;
+	}
+
+	/*
+	 * Bits are packed starting from the least significant bit of each byte
+	 */
+	class BitReader
+	{
+	public:
+		BitReader(const std::vector<unsigned char>& data) :
+			_data(data), _position(0), _endOfPacket(false) { }
+
+		uint32_t read(int bits)
+		{
+			uint32_t result = 0;
+			for (int i = 0; i < bits; ++i)
+				result |= static_cast<uint32_t>(readBit()) << i;
+			return result;
+		}
+
+		int readBit()
+		{
+			size_t byte = _position >> 3;
+			if (byte >= _data.size())
+			{
+				_endOfPacket = true;
+				return 0;
+			}
+
+			int result = (_data[byte] >> (_position & 7)) & 1;
+			++_position;
+			return result;
+		}
+
+		bool endOfPacket() const
+			{ return _endOfPacket; }
+
+	private:
+		BitReader& operator = (const BitReader&);
+
+	private:
+		const std::vector<unsigned char>& _data;
+		size_t _position;
+		bool _endOfPacket;
+	};
+
+	/*
+	 * Huffman tree is stored as pairs of children, leaves are encoded as -(entry + 1)
+	 */
+	struct Codebook
+	{
+		int dimensions;
+		int entries;
+		std::vector<int32_t> tree;
+		std::vector<float> vectors;
+
+		Codebook() :
+			dimensions(0), entries(0) { }
+
+		bool read(BitReader& bits);
+		void insert(uint32_t code, int length, int entry);
+
+		int decodeScalar(BitReader& bits) const;
+		const float* decodeVector(BitReader& bits) const;
+	};
+
+	struct Floor
+	{
+		std::vector<int> partitionClass;
+		int classDimensions[MaxFloorClasses];
+		int classSubclasses[MaxFloorClasses];
+		int classMasterbook[MaxFloorClasses];
+		int subclassBooks[MaxFloorClasses][MaxSubclassBooks];
+		int multiplier;
+		std::vector<int> x;
+		std::vector<int> sortedOrder;
+		std::vector<int> lowNeighbour;
+		std::vector<int> highNeighbour;
+	};
+
+	struct Residue
+	{
+		int type;
+		uint32_t begin;
+		uint32_t end;
+		uint32_t partitionSize;
+		int classifications;
+		int classbook;
+		std::vector<int> books;
+	};
+
+	struct Mapping
+	{
+		std::vector<int> magnitude;
+		std::vector<int> angle;
+		std::vector<int> mux;
+		std::vector<int> submapFloor;
+		std::vector<int> submapResidue;
+	};
+
+	struct Mode
+	{
+		int blockFlag;
+		int mapping;
+	};
+
+	/*
+	 * Inverse MDCT without normalization, computed through DCT-IV of size n/2
+	 * and complex FFT of size n/4
+	 */
+	class InverseMDCT
+	{
+	public:
+		void init(int n);
+		void transform(const float* input, float* output);
+
+	private:
+		int _n;
+		std::vector<complexf> _preTwiddle;
+		std::vector<complexf> _postTwiddle;
+		std::vector<complexf> _roots;
+		std::vector<int> _bitReverse;
+		std::vector<complexf> _work;
+		std::vector<float> _dct;
+	};
+
+	class OggPacketReader
+	{
+	public:
+		OggPacketReader(InputStream::Pointer file) :
+			_file(file), _serial(0), _serialKnown(false), _segmentIndex(0), _pageOffset(0),
+			_granule(-1), _lastPage(false) { }
+
+		/*
+		 * Granule is reported for the last packet, which ends on the final page of the stream
+		 */
+		bool readPacket(std::vector<unsigned char>& packet, int64_t& finalGranule);
+
+		std::streamoff position()
+			{ return _file->stream().tellg(); }
+
+		bool pageFinished() const
+			{ return _segmentIndex >= _segments.size(); }
+
+		void seek(std::streamoff offset);
+		int64_t lastGranule();
+
+	private:
+		bool readPage();
+
+	private:
+		InputStream::Pointer _file;
+		uint32_t _serial;
+		bool _serialKnown;
+		std::vector<unsigned char> _segments;
+		std::vector<unsigned char> _page;
+		size_t _segmentIndex;
+		size_t _pageOffset;
+		int64_t _granule;
+		bool _lastPage;
+	};
+
+	class VorbisDecoder : public Decoder
+	{
+	public:
+		VorbisDecoder(Description::Pointer desc, InputStream::Pointer file) :
+			Decoder(desc), _reader(file), _channels(0), _sampleRate(0), _audioOffset(0),
+			_previousBlocksize(0), _pendingOffset(0), _framesDecoded(0), _finished(false) { }
+
+		bool open();
+
+		size_t read(char* buffer, size_t size);
+		void rewind();
+
+	private:
+		bool readIdentification(BitReader& bits);
+		bool readSetup(BitReader& bits);
+		bool readFloor(BitReader& bits, Floor& floor);
+		bool readResidue(BitReader& bits, Residue& residue);
+		bool readMapping(BitReader& bits, Mapping& mapping);
+
+		bool decodeFloor(BitReader& bits, const Floor& floor, std::vector<int>& y);
+		void synthesizeFloor(const Floor& floor, std::vector<int>& y, int n, float* output);
+		void decodeResidue(BitReader& bits, const Residue& residue, int channels,
+			const bool* doNotDecode, float** vectors, int n);
+		void decodePartition(BitReader& bits, const Codebook& book, int type, float* v, uint32_t size);
+
+		void decodePacket(const std::vector<unsigned char>& packet, int64_t finalGranule);
+		void applyWindow(float* block, int n, int blockFlag, int previousFlag, int nextFlag);
+
+	private:
+		OggPacketReader _reader;
+
+		int _channels;
+		int _sampleRate;
+		int _blocksize[2];
+
+		std::vector<Codebook> _codebooks;
+		std::vector<Floor> _floors;
+		std::vector<Residue> _residues;
+		std::vector<Mapping> _mappings;
+		std::vector<Mode> _modes;
+
+		InverseMDCT _transform[2];
+		std::vector<float> _windowSlope[2];
+
+		std::streamoff _audioOffset;
+		std::vector<unsigned char> _packet;
+
+		std::vector<float> _blocks[MaxChannels];
+		std::vector<float> _previousBlocks[MaxChannels];
+		std::vector<float> _floorCurve[MaxChannels];
+		std::vector<int> _floorY;
+		std::vector<int> _classifications;
+		int _previousBlocksize;
+
+		std::vector<int16_t> _pending;
+		size_t _pendingOffset;
+		int64_t _framesDecoded;
+		bool _finished;
+	};
+}
+
+/*
+ * Codebook
+ */
+bool Codebook::read(BitReader& bits)
+{
+	if (bits.read(24) != 0x564342) return false;
+
+	dimensions = static_cast<int>(bits.read(16));
+	entries = static_cast<int>(bits.read(24));
+	if ((dimensions == 0) || (entries == 0) || (static_cast<int64_t>(dimensions) * entries > MaxCodebookValues))
+		return false;
+
+	std::vector<int> lengths(static_cast<size_t>(entries), 0);
+	if (bits.readBit())
+	{
+		int entry = 0;
+		int length = static_cast<int>(bits.read(5)) + 1;
+		while (entry < entries)
+		{
+			int count = static_cast<int>(bits.read(ilog(static_cast<uint32_t>(entries - entry))));
+			if ((entry + count > entries) || (length > 32)) return false;
+
+			std::fill(lengths.begin() + entry, lengths.begin() + entry + count, length);
+			entry += count;
+			++length;
+		}
+	}
+	else
+	{
+		bool sparse = bits.readBit() != 0;
+		for (int& length : lengths)
+		{
+			if (!sparse || bits.readBit())
+				length = static_cast<int>(bits.read(5)) + 1;
+		}
+	}
+
+	/*
+	 * Codewords are assigned in the order of entries, each takes the lowest available code of its length
+	 */
+	tree.assign(2, 0);
+	uint32_t available[33] = { };
+	int usedEntries = 0;
+	int singleEntry = 0;
+	for (int entry = 0; entry < entries; ++entry)
+	{
+		int length = lengths[static_cast<size_t>(entry)];
+		if (length == 0) continue;
+
+		if (usedEntries++ == 0)
+		{
+			singleEntry = entry;
+			insert(0, length, entry);
+			for (int i = 1; i <= length; ++i)
+				available[i] = 1u << (32 - i);
+			continue;
+		}
+
+		int z = length;
+		while ((z > 0) && (available[z] == 0))
+			--z;
+
+		if (z == 0) return false;
+
+		uint32_t code = available[z];
+		available[z] = 0;
+		insert(code >> (32 - length), length, entry);
+
+		for (int y = length; y > z; --y)
+			available[y] = code + (1u << (32 - y));
+	}
+
+	if (usedEntries == 1)
+		tree[0] = tree[1] = -(singleEntry + 1);
+
+	uint32_t lookupType = bits.read(4);
+	if ((lookupType == 1) || (lookupType == 2))
+	{
+		float minimum = float32Unpack(bits.read(32));
+		float delta = float32Unpack(bits.read(32));
+		int valueBits = static_cast<int>(bits.read(4)) + 1;
+		bool sequence = bits.readBit() != 0;
+
+		int lookupValues = (lookupType == 1) ? lookup1Values(entries, dimensions) : entries * dimensions;
+		std::vector<uint32_t> multiplicands(static_cast<size_t>(lookupValues));
+		for (uint32_t& m : multiplicands)
+			m = bits.read(valueBits);
+
+		vectors.resize(static_cast<size_t>(entries * dimensions));
+		for (int entry = 0; entry < entries; ++entry)
+		{
+			float last = 0.0f;
+			int indexDivisor = 1;
+			for (int d = 0; d < dimensions; ++d)
+			{
+				int offset = (lookupType == 1) ? (entry / indexDivisor) % lookupValues : entry * dimensions + d;
+				float value = static_cast<float>(multiplicands[static_cast<size_t>(offset)]) * delta + minimum + last;
+				if (sequence)
+					last = value;
+
+				vectors[static_cast<size_t>(entry * dimensions + d)] = value;
+				indexDivisor *= lookupValues;
+			}
+		}
+	}
+	else if (lookupType != 0)
+	{
+		return false;
+	}
+
+	return !bits.endOfPacket();
+}
+
+/*
+ * Code is read starting from the most significant bit
+ */
+void Codebook::insert(uint32_t code, int length, int entry)
+{
+	size_t node = 0;
+	for (int bit = length - 1; bit > 0; --bit)
+	{
+		size_t child = 2 * node + ((code >> bit) & 1);
+		if (tree[child] <= 0)
+		{
+			tree[child] = static_cast<int32_t>(tree.size() / 2);
+			tree.resize(tree.size() + 2, 0);
+		}
+		node = static_cast<size_t>(tree[child]);
+	}
+	tree[2 * node + (code & 1)] = -(entry + 1);
+}
+
+int Codebook::decodeScalar(BitReader& bits) const
+{
+	size_t node = 0;
+	for (;;)
+	{
+		int32_t child = tree[2 * node + static_cast<size_t>(bits.readBit())];
+		if (bits.endOfPacket() || (child == 0)) return -1;
+		if (child < 0) return -child - 1;
+
+		node = static_cast<size_t>(child);
+	}
+}
+
+const float* Codebook::decodeVector(BitReader& bits) const
+{
+	int entry = decodeScalar(bits);
+	return ((entry < 0) || vectors.empty()) ? nullptr : vectors.data() + entry * dimensions;
+}
+
+/*
+ * Inverse MDCT
+ */
+void InverseMDCT::init(int n)
+{
+	_n = n;
+
+	int m = n / 2;
+	int q = n / 4;
+
+	_preTwiddle.resize(static_cast<size_t>(q));
+	_postTwiddle.resize(static_cast<size_t>(q));
+	_roots.resize(static_cast<size_t>(q / 2));
+	_bitReverse.resize(static_cast<size_t>(q));
+	_work.resize(static_cast<size_t>(q));
+	_dct.resize(static_cast<size_t>(m));
+
+	for (int k = 0; k < q; ++k)
+	{
+		_preTwiddle[static_cast<size_t>(k)] = std::polar(1.0f, -pi * (static_cast<float>(k) + 0.25f) / static_cast<float>(m));
+		_postTwiddle[static_cast<size_t>(k)] = std::polar(1.0f, -pi * static_cast<float>(k) / static_cast<float>(m));
+	}
+
+	for (int k = 0; k < q / 2; ++k)
+		_roots[static_cast<size_t>(k)] = std::polar(1.0f, -2.0f * pi * static_cast<float>(k) / static_cast<float>(q));
+
+	int bits = ilog(static_cast<uint32_t>(q)) - 1;
+	for (int k = 0; k < q; ++k)
+	{
+		int r = 0;
+		for (int b = 0; b < bits; ++b)
+			r |= ((k >> b) & 1) << (bits - 1 - b);
+		_bitReverse[static_cast<size_t>(k)] = r;
+	}
+}
+
+/*
+ * Output of DCT-IV u of size m = n/2 is unfolded into n samples:
+ * y[i] = u[i + m/2], -u[3m/2 - 1 - i], -u[i - 3m/2] for the three ranges of i
+ */
+void InverseMDCT::transform(const float* input, float* output)
+{
+	int m = _n / 2;
+	int q = _n / 4;
+
+	for (int k = 0; k < q; ++k)
+	{
+		complexf value(input[2 * k], input[m - 1 - 2 * k]);
+		_work[static_cast<size_t>(_bitReverse[static_cast<size_t>(k)])] = value * _preTwiddle[static_cast<size_t>(k)];
+	}
+
+	for (int size = 2; size <= q; size *= 2)
+	{
+		int half = size / 2;
+		int step = q / size;
+		for (int start = 0; start < q; start += size)
+		{
+			for (int k = 0; k < half; ++k)
+			{
+				complexf& a = _work[static_cast<size_t>(start + k)];
+				complexf& b = _work[static_cast<size_t>(start + k + half)];
+				complexf t = b * _roots[static_cast<size_t>(k * step)];
+				b = a - t;
+				a += t;
+			}
+		}
+	}
+
+	for (int k = 0; k < q; ++k)
+	{
+		complexf value = _work[static_cast<size_t>(k)] * _postTwiddle[static_cast<size_t>(k)];
+		_dct[static_cast<size_t>(2 * k)] = value.real();
+		_dct[static_cast<size_t>(m - 1 - 2 * k)] = -value.imag();
+	}
+
+	int halfM = m / 2;
+	for (int i = 0; i < halfM; ++i)
+		output[i] = _dct[static_cast<size_t>(i + halfM)];
+
+	for (int i = halfM; i < 3 * halfM; ++i)
+		output[i] = -_dct[static_cast<size_t>(3 * halfM - 1 - i)];
+
+	for (int i = 3 * halfM; i < _n; ++i)
+		output[i] = -_dct[static_cast<size_t>(i - 3 * halfM)];
+}
+
+/*
+ * Ogg pages
+ */
+bool OggPacketReader::readPage()
+{
+	std::istream& stream = _file->stream();
+	for (;;)
+	{
+		unsigned char header[27] = { };
+		stream.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (stream.gcount() != sizeof(header) || (memcmp(header, "OggS", 4) != 0) || (header[4] != 0))
+			return false;
+
+		int64_t granule = 0;
+		for (int i = 7; i >= 0; --i)
+			granule = (granule << 8) | header[6 + i];
+
+		uint32_t serial = static_cast<uint32_t>(header[14]) | (static_cast<uint32_t>(header[15]) << 8) |
+			(static_cast<uint32_t>(header[16]) << 16) | (static_cast<uint32_t>(header[17]) << 24);
+
+		_segments.resize(header[26]);
+		stream.read(reinterpret_cast<char*>(_segments.data()), static_cast<std::streamsize>(_segments.size()));
+
+		size_t dataSize = 0;
+		for (unsigned char s : _segments)
+			dataSize += s;
+
+		_page.resize(dataSize);
+		stream.read(reinterpret_cast<char*>(_page.data()), static_cast<std::streamsize>(dataSize));
+		if (static_cast<size_t>(stream.gcount()) != dataSize)
+			return false;
+
+		if (!_serialKnown)
+		{
+			_serial = serial;
+			_serialKnown = true;
+		}
+
+		if (serial == _serial)
+		{
+			_segmentIndex = 0;
+			_pageOffset = 0;
+			_granule = granule;
+			_lastPage = (header[5] & 0x04) != 0;
+			return true;
+		}
+	}
+}
+
+bool OggPacketReader::readPacket(std::vector<unsigned char>& packet, int64_t& finalGranule)
+{
+	packet.clear();
+	finalGranule = -1;
+
+	for (;;)
+	{
+		if (pageFinished() && !readPage())
+			return false;
+
+		unsigned char segment = _segments[_segmentIndex++];
+		packet.insert(packet.end(), _page.begin() + static_cast<std::ptrdiff_t>(_pageOffset),
+			_page.begin() + static_cast<std::ptrdiff_t>(_pageOffset + segment));
+		_pageOffset += segment;
+
+		if (segment < 255)
+		{
+			if (_lastPage)
+			{
+				bool lastPacketOnPage = true;
+				for (size_t i = _segmentIndex; i < _segments.size(); ++i)
+					lastPacketOnPage &= (_segments[i] == 255);
+
+				if (lastPacketOnPage)
+					finalGranule = _granule;
+			}
+			return true;
+		}
+	}
+}
+
+void OggPacketReader::seek(std::streamoff offset)
+{
+	_file->stream().clear();
+	_file->stream().seekg(offset);
+	_segments.clear();
+	_segmentIndex = 0;
+	_pageOffset = 0;
+	_lastPage = false;
+}
+
+/*
+ * Granule position of the last page is the total length of the stream in sample frames
+ */
+int64_t OggPacketReader::lastGranule()
+{
+	std::istream& stream = _file->stream();
+	std::streamoff current = stream.tellg();
+
+	stream.clear();
+	stream.seekg(0, std::ios::end);
+	std::streamoff fileSize = stream.tellg();
+	std::streamoff start = (std::max)(std::streamoff(0), fileSize - std::streamoff(65536));
+
+	std::vector<unsigned char> tail(static_cast<size_t>(fileSize - start));
+	stream.seekg(start);
+	stream.read(reinterpret_cast<char*>(tail.data()), static_cast<std::streamsize>(tail.size()));
+
+	int64_t result = -1;
+	for (size_t i = tail.size(); i >= 27; --i)
+	{
+		const unsigned char* p = tail.data() + i - 27;
+		if ((memcmp(p, "OggS", 4) != 0) || (p[4] != 0)) continue;
+
+		uint32_t serial = static_cast<uint32_t>(p[14]) | (static_cast<uint32_t>(p[15]) << 8) |
+			(static_cast<uint32_t>(p[16]) << 16) | (static_cast<uint32_t>(p[17]) << 24);
+		if (serial != _serial) continue;
+
+		result = 0;
+		for (int b = 7; b >= 0; --b)
+			result = (result << 8) | p[6 + b];
+		break;
+	}
+
+	stream.clear();
+	stream.seekg(current);
+	return result;
+}
+
+/*
+ * Vorbis decoder
+ */
+bool VorbisDecoder::open()
+{
+	int64_t granule = 0;
+	for (uint32_t headerType = 1; headerType <= 5; headerType += 2)
+	{
+		if (!_reader.readPacket(_packet, granule)) return false;
+
+		BitReader bits(_packet);
+		if ((bits.read(8) != headerType) || (_packet.size() < 7) || (memcmp(_packet.data() + 1, "vorbis", 6) != 0))
+			return false;
+
+		bits.read(32);
+		bits.read(16);
+
+		if ((headerType == 1) && !readIdentification(bits))
+			return false;
+
+		if ((headerType == 5) && !readSetup(bits))
+			return false;
+	}
+
+	if (!_reader.pageFinished())
+		return false;
+
+	_audioOffset = _reader.position();
+
+	Description::Pointer desc = description();
+	desc->channels = static_cast<size_t>(_channels);
+	desc->sampleRate = static_cast<size_t>(_sampleRate);
+	desc->bitDepth = 16;
+	desc->format = openALFormatFromChannelsAndBitDepth(desc->channels, desc->bitDepth);
+
+	int64_t frames = _reader.lastGranule();
+	if (frames > 0)
+		desc->duration = static_cast<float>(frames) / static_cast<float>(_sampleRate);
+
+	rewind();
+	return true;
+}
+
+bool VorbisDecoder::readIdentification(BitReader& bits)
+{
+	if (bits.read(32) != 0) return false;
+
+	_channels = static_cast<int>(bits.read(8));
+	_sampleRate = static_cast<int>(bits.read(32));
+	bits.read(32);
+	bits.read(32);
+	bits.read(32);
+	_blocksize[0] = 1 << bits.read(4);
+	_blocksize[1] = 1 << bits.read(4);
+
+	if ((_channels < 1) || (_channels > MaxChannels))
+	{
+		log::error("Vorbis streams with %d channels are not supported", _channels);
+		return false;
+	}
+
+	if ((_sampleRate == 0) || (_blocksize[0] < 64) || (_blocksize[1] < _blocksize[0]) || (_blocksize[1] > 8192))
+		return false;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		_transform[i].init(_blocksize[i]);
+
+		int slopeSize = _blocksize[i] / 2;
+		_windowSlope[i].resize(static_cast<size_t>(slopeSize));
+		for (int k = 0; k < slopeSize; ++k)
+		{
+			float s = std::sin((static_cast<float>(k) + 0.5f) / static_cast<float>(slopeSize) * 0.5f * pi);
+			_windowSlope[i][static_cast<size_t>(k)] = std::sin(0.5f * pi * s * s);
+		}
+	}
+
+	for (int c = 0; c < _channels; ++c)
+	{
+		_blocks[c].resize(static_cast<size_t>(_blocksize[1]));
+		_previousBlocks[c].resize(static_cast<size_t>(_blocksize[1] / 2));
+		_floorCurve[c].resize(static_cast<size_t>(_blocksize[1] / 2));
+	}
+
+	return bits.readBit() == 1;
+}
+
+bool VorbisDecoder::readSetup(BitReader& bits)
+{
+	_codebooks.resize(bits.read(8) + 1);
+	for (Codebook& book : _codebooks)
+	{
+		if (!book.read(bits)) return false;
+	}
+
+	uint32_t timeCount = bits.read(6) + 1;
+	for (uint32_t i = 0; i < timeCount; ++i)
+	{
+		if (bits.read(16) != 0) return false;
+	}
+
+	_floors.resize(bits.read(6) + 1);
+	for (Floor& floor : _floors)
+	{
+		if (bits.read(16) != 1)
+		{
+			log::error("Vorbis floor type 0 is not supported");
+			return false;
+		}
+
+		if (!readFloor(bits, floor)) return false;
+	}
+
+	_residues.resize(bits.read(6) + 1);
+	for (Residue& residue : _residues)
+	{
+		if (!readResidue(bits, residue)) return false;
+	}
+
+	_mappings.resize(bits.read(6) + 1);
+	for (Mapping& mapping : _mappings)
+	{
+		if (!readMapping(bits, mapping)) return false;
+	}
+
+	_modes.resize(bits.read(6) + 1);
+	for (Mode& mode : _modes)
+	{
+		mode.blockFlag = bits.readBit();
+		if ((bits.read(16) != 0) || (bits.read(16) != 0)) return false;
+
+		mode.mapping = static_cast<int>(bits.read(8));
+		if (mode.mapping >= static_cast<int>(_mappings.size())) return false;
+	}
+
+	return (bits.readBit() == 1) && !bits.endOfPacket();
+}
+
+bool VorbisDecoder::readFloor(BitReader& bits, Floor& floor)
+{
+	int maximumClass = -1;
+	floor.partitionClass.resize(bits.read(5));
+	for (int& c : floor.partitionClass)
+	{
+		c = static_cast<int>(bits.read(4));
+		maximumClass = (std::max)(maximumClass, c);
+	}
+
+	for (int c = 0; c <= maximumClass; ++c)
+	{
+		floor.classDimensions[c] = static_cast<int>(bits.read(3)) + 1;
+		floor.classSubclasses[c] = static_cast<int>(bits.read(2));
+		floor.classMasterbook[c] = (floor.classSubclasses[c] > 0) ? static_cast<int>(bits.read(8)) : UnusedBook;
+		if (floor.classMasterbook[c] >= static_cast<int>(_codebooks.size())) return false;
+
+		for (int s = 0; s < (1 << floor.classSubclasses[c]); ++s)
+		{
+			floor.subclassBooks[c][s] = static_cast<int>(bits.read(8)) - 1;
+			if (floor.subclassBooks[c][s] >= static_cast<int>(_codebooks.size())) return false;
+		}
+	}
+
+	floor.multiplier = static_cast<int>(bits.read(2)) + 1;
+	int rangeBits = static_cast<int>(bits.read(4));
+
+	floor.x.clear();
+	floor.x.push_back(0);
+	floor.x.push_back(1 << rangeBits);
+	for (int c : floor.partitionClass)
+	{
+		for (int d = 0; d < floor.classDimensions[c]; ++d)
+			floor.x.push_back(static_cast<int>(bits.read(rangeBits)));
+	}
+
+	size_t values = floor.x.size();
+	floor.sortedOrder.resize(values);
+	floor.lowNeighbour.resize(values);
+	floor.highNeighbour.resize(values);
+
+	for (size_t i = 0; i < values; ++i)
+		floor.sortedOrder[i] = static_cast<int>(i);
+
+	const std::vector<int>& x = floor.x;
+	std::stable_sort(floor.sortedOrder.begin(), floor.sortedOrder.end(), [&x](int a, int b)
+		{ return x[static_cast<size_t>(a)] < x[static_cast<size_t>(b)]; });
+
+	for (size_t i = 1; i < values; ++i)
+	{
+		if (x[static_cast<size_t>(floor.sortedOrder[i])] == x[static_cast<size_t>(floor.sortedOrder[i - 1])])
+			return false;
+	}
+
+	for (size_t i = 2; i < values; ++i)
+	{
+		int low = 0;
+		int high = 1;
+		for (size_t j = 0; j < i; ++j)
+		{
+			if ((x[j] < x[i]) && (x[j] > x[static_cast<size_t>(low)]))
+				low = static_cast<int>(j);
+			if ((x[j] > x[i]) && (x[j] < x[static_cast<size_t>(high)]))
+				high = static_cast<int>(j);
+		}
+		floor.lowNeighbour[i] = low;
+		floor.highNeighbour[i] = high;
+	}
+
+	return !bits.endOfPacket();
+}
+
+bool VorbisDecoder::readResidue(BitReader& bits, Residue& residue)
+{
+	residue.type = static_cast<int>(bits.read(16));
+	if (residue.type > 2) return false;
+
+	residue.begin = bits.read(24);
+	residue.end = bits.read(24);
+	residue.partitionSize = bits.read(24) + 1;
+	residue.classifications = static_cast<int>(bits.read(6)) + 1;
+	residue.classbook = static_cast<int>(bits.read(8));
+
+	if (residue.classbook >= static_cast<int>(_codebooks.size())) return false;
+
+	std::vector<uint32_t> cascade(static_cast<size_t>(residue.classifications));
+	for (uint32_t& c : cascade)
+	{
+		c = bits.read(3);
+		if (bits.readBit())
+			c |= bits.read(5) << 3;
+	}
+
+	residue.books.resize(static_cast<size_t>(residue.classifications * 8));
+	for (size_t c = 0; c < cascade.size(); ++c)
+	{
+		for (size_t pass = 0; pass < 8; ++pass)
+		{
+			int book = (cascade[c] & (1u << pass)) ? static_cast<int>(bits.read(8)) : UnusedBook;
+			if (book >= static_cast<int>(_codebooks.size())) return false;
+
+			residue.books[c * 8 + pass] = book;
+		}
+	}
+
+	return !bits.endOfPacket();
+}
+
+bool VorbisDecoder::readMapping(BitReader& bits, Mapping& mapping)
+{
+	if (bits.read(16) != 0) return false;
+
+	int submaps = bits.readBit() ? static_cast<int>(bits.read(4)) + 1 : 1;
+
+	if (bits.readBit())
+	{
+		int couplingSteps = static_cast<int>(bits.read(8)) + 1;
+		int channelBits = ilog(static_cast<uint32_t>(_channels - 1));
+		for (int i = 0; i < couplingSteps; ++i)
+		{
+			int magnitude = static_cast<int>(bits.read(channelBits));
+			int angle = static_cast<int>(bits.read(channelBits));
+			if ((magnitude == angle) || (magnitude >= _channels) || (angle >= _channels)) return false;
+
+			mapping.magnitude.push_back(magnitude);
+			mapping.angle.push_back(angle);
+		}
+	}
+
+	if (bits.read(2) != 0) return false;
+
+	mapping.mux.assign(static_cast<size_t>(_channels), 0);
+	if (submaps > 1)
+	{
+		for (int& m : mapping.mux)
+		{
+			m = static_cast<int>(bits.read(4));
+			if (m >= submaps) return false;
+		}
+	}
+
+	for (int i = 0; i < submaps; ++i)
+	{
+		bits.read(8);
+		mapping.submapFloor.push_back(static_cast<int>(bits.read(8)));
+		mapping.submapResidue.push_back(static_cast<int>(bits.read(8)));
+
+		if ((mapping.submapFloor.back() >= static_cast<int>(_floors.size())) ||
+			(mapping.submapResidue.back() >= static_cast<int>(_residues.size()))) return false;
+	}
+
+	return !bits.endOfPacket();
+}
+
+/*
+ * Returns false if the channel is unused in the current packet
+ */
+bool VorbisDecoder::decodeFloor(BitReader& bits, const Floor& floor, std::vector<int>& y)
+{
+	if (bits.readBit() == 0) return false;
+
+	static const int ranges[4] = { 256, 128, 86, 64 };
+	int rangeBits = ilog(static_cast<uint32_t>(ranges[floor.multiplier - 1] - 1));
+
+	y.resize(floor.x.size());
+	y[0] = static_cast<int>(bits.read(rangeBits));
+	y[1] = static_cast<int>(bits.read(rangeBits));
+
+	size_t offset = 2;
+	for (int c : floor.partitionClass)
+	{
+		int dimensions = floor.classDimensions[c];
+		int subclassBits = floor.classSubclasses[c];
+		int subclassMask = (1 << subclassBits) - 1;
+
+		int value = 0;
+		if (subclassBits > 0)
+		{
+			value = _codebooks[static_cast<size_t>(floor.classMasterbook[c])].decodeScalar(bits);
+			if (value < 0) return false;
+		}
+
+		for (int d = 0; d < dimensions; ++d)
+		{
+			int book = floor.subclassBooks[c][value & subclassMask];
+			value >>= subclassBits;
+
+			int result = 0;
+			if (book != UnusedBook)
+			{
+				result = _codebooks[static_cast<size_t>(book)].decodeScalar(bits);
+				if (result < 0) return false;
+			}
+			y[offset++] = result;
+		}
+	}
+
+	return !bits.endOfPacket();
+}
+
+namespace
+{
+	int renderPoint(int x0, int y0, int x1, int y1, int x)
+	{
+		int dy = y1 - y0;
+		int offset = std::abs(dy) * (x - x0) / (x1 - x0);
+		return (dy < 0) ? y0 - offset : y0 + offset;
+	}
+
+	void renderLine(int x0, int y0, int x1, int y1, int* v, int n)
+	{
+		int dy = y1 - y0;
+		int adx = x1 - x0;
+		int base = dy / adx;
+		int sy = (dy < 0) ? base - 1 : base + 1;
+		int ady = std::abs(dy) - std::abs(base) * adx;
+
+		int y = y0;
+		int error = 0;
+		if (x0 < n)
+			v[x0] = y;
+
+		for (int x = x0 + 1; (x < x1) && (x < n); ++x)
+		{
+			error += ady;
+			if (error >= adx)
+			{
+				error -= adx;
+				y += sy;
+			}
+			else
+			{
+				y += base;
+			}
+			v[x] = y;
+		}
+	}
+
+	/*
+	 * Floor amplitudes are in steps of about 0.5 dB, 255 corresponds to the unit amplitude
+	 */
+	class InverseDecibelTable
+	{
+	public:
+		InverseDecibelTable()
+		{
+			for (int i = 0; i < 256; ++i)
+				_values[i] = static_cast<float>(std::pow(1.0649863, static_cast<double>(i - 255)));
+		}
+
+		float operator [] (int value) const
+			{ return _values[clamp(value, 0, 255)]; }
+
+	private:
+		float _values[256];
+	};
+
+	const InverseDecibelTable inverseDecibel;
+}
+
+/*
+ * Amplitude values are unwrapped relative to the prediction from neighbours,
+ * then the curve is rendered by lines between used points (in the order of x)
+ */
+void VorbisDecoder::synthesizeFloor(const Floor& floor, std::vector<int>& y, int n, float* output)
+{
+	static const int ranges[4] = { 256, 128, 86, 64 };
+	int range = ranges[floor.multiplier - 1];
+
+	size_t values = floor.x.size();
+	std::vector<bool> used(values, false);
+	used[0] = used[1] = true;
+
+	for (size_t i = 2; i < values; ++i)
+	{
+		size_t low = static_cast<size_t>(floor.lowNeighbour[i]);
+		size_t high = static_cast<size_t>(floor.highNeighbour[i]);
+		int predicted = renderPoint(floor.x[low], y[low], floor.x[high], y[high], floor.x[i]);
+
+		int value = y[i];
+		int highRoom = range - predicted;
+		int lowRoom = predicted;
+		int room = 2 * (std::min)(highRoom, lowRoom);
+
+		if (value == 0)
+		{
+			y[i] = predicted;
+			continue;
+		}
+
+		used[low] = used[high] = used[i] = true;
+		if (value >= room)
+			y[i] = (highRoom > lowRoom) ? value - lowRoom + predicted : predicted - value + highRoom - 1;
+		else
+			y[i] = (value & 1) ? predicted - (value + 1) / 2 : predicted + value / 2;
+	}
+
+	std::vector<int> curve(static_cast<size_t>(n), 0);
+
+	int lx = 0;
+	int ly = y[static_cast<size_t>(floor.sortedOrder[0])] * floor.multiplier;
+	int hx = 0;
+	int hy = 0;
+	for (size_t i = 1; i < values; ++i)
+	{
+		size_t index = static_cast<size_t>(floor.sortedOrder[i]);
+		if (!used[index]) continue;
+
+		hx = floor.x[index];
+		hy = y[index] * floor.multiplier;
+		if (hx > lx)
+			renderLine(lx, ly, hx, hy, curve.data(), n);
+
+		lx = hx;
+		ly = hy;
+	}
+
+	if (hx < n)
+		renderLine(hx, hy, n, hy, curve.data(), n);
+
+	for (int i = 0; i < n; ++i)
+		output[i] = inverseDecibel[curve[static_cast<size_t>(i)]];
+}
+
+void VorbisDecoder::decodePartition(BitReader& bits, const Codebook& book, int type, float* v, uint32_t size)
+{
+	int dimensions = book.dimensions;
+	if (type == 0)
+	{
+		uint32_t step = size / static_cast<uint32_t>(dimensions);
+		for (uint32_t i = 0; i < step; ++i)
+		{
+			const float* entry = book.decodeVector(bits);
+			if (entry == nullptr) return;
+
+			for (int d = 0; d < dimensions; ++d)
+				v[i + static_cast<uint32_t>(d) * step] += entry[d];
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < size; )
+		{
+			const float* entry = book.decodeVector(bits);
+			if (entry == nullptr) return;
+
+			for (int d = 0; (d < dimensions) && (i < size); ++d)
+				v[i++] += entry[d];
+		}
+	}
+}
+
+/*
+ * Residue type 2 is decoded as type 1 into one interleaved vector of all channels
+ */
+void VorbisDecoder::decodeResidue(BitReader& bits, const Residue& residue, int channels,
+	const bool* doNotDecode, float** vectors, int n)
+{
+	int halfSize = n / 2;
+	for (int c = 0; c < channels; ++c)
+		std::fill(vectors[c], vectors[c] + halfSize, 0.0f);
+
+	std::vector<float> interleaved;
+	float* target[MaxChannels] = { };
+	bool skip[MaxChannels] = { };
+	int vectorsCount = channels;
+	uint32_t actualSize = static_cast<uint32_t>(halfSize);
+
+	if (residue.type == 2)
+	{
+		bool allSkipped = true;
+		for (int c = 0; c < channels; ++c)
+			allSkipped &= doNotDecode[c];
+
+		if (allSkipped) return;
+
+		actualSize *= static_cast<uint32_t>(channels);
+		interleaved.assign(actualSize, 0.0f);
+		target[0] = interleaved.data();
+		vectorsCount = 1;
+	}
+	else
+	{
+		for (int c = 0; c < channels; ++c)
+		{
+			target[c] = vectors[c];
+			skip[c] = doNotDecode[c];
+		}
+	}
+
+	uint32_t begin = (std::min)(residue.begin, actualSize);
+	uint32_t end = (std::min)(residue.end, actualSize);
+	uint32_t partitions = (end > begin) ? (end - begin) / residue.partitionSize : 0;
+
+	const Codebook& classbook = _codebooks[static_cast<size_t>(residue.classbook)];
+	int classesPerCodeword = classbook.dimensions;
+	_classifications.assign(static_cast<size_t>(vectorsCount) * (partitions + static_cast<uint32_t>(classesPerCodeword)), 0);
+	int* classifications = _classifications.data();
+	size_t stride = partitions + static_cast<uint32_t>(classesPerCodeword);
+
+	int decodeType = (residue.type == 0) ? 0 : 1;
+	for (uint32_t pass = 0; pass < 8; ++pass)
+	{
+		uint32_t partition = 0;
+		while (partition < partitions)
+		{
+			if (pass == 0)
+			{
+				for (int c = 0; c < vectorsCount; ++c)
+				{
+					if (skip[c]) continue;
+
+					int value = classbook.decodeScalar(bits);
+					if (value < 0) return;
+
+					for (int i = classesPerCodeword - 1; i >= 0; --i)
+					{
+						classifications[static_cast<size_t>(c) * stride + partition + static_cast<uint32_t>(i)] = value % residue.classifications;
+						value /= residue.classifications;
+					}
+				}
+			}
+
+			for (int i = 0; (i < classesPerCodeword) && (partition < partitions); ++i, ++partition)
+			{
+				for (int c = 0; c < vectorsCount; ++c)
+				{
+					if (skip[c]) continue;
+
+					size_t vqClass = static_cast<size_t>(classifications[static_cast<size_t>(c) * stride + partition]);
+					int book = residue.books[vqClass * 8 + pass];
+					if (book == UnusedBook) continue;
+
+					decodePartition(bits, _codebooks[static_cast<size_t>(book)], decodeType,
+						target[c] + begin + partition * residue.partitionSize, residue.partitionSize);
+
+					if (bits.endOfPacket()) break;
+				}
+			}
+		}
+	}
+
+	if (residue.type == 2)
+	{
+		for (int i = 0; i < halfSize; ++i)
+		{
+			for (int c = 0; c < channels; ++c)
+				vectors[c][i] = interleaved[static_cast<size_t>(i * channels + c)];
+		}
+	}
+}
+
+/*
+ * Slopes of the long window are shortened, when neighbour blocks are short
+ */
+void VorbisDecoder::applyWindow(float* block, int n, int blockFlag, int previousFlag, int nextFlag)
+{
+	int shortQuarter = _blocksize[0] / 4;
+
+	int leftSlope = (blockFlag && !previousFlag) ? 0 : blockFlag;
+	int leftBegin = (blockFlag && !previousFlag) ? n / 4 - shortQuarter : 0;
+	int leftEnd = (blockFlag && !previousFlag) ? n / 4 + shortQuarter : n / 2;
+
+	int rightSlope = (blockFlag && !nextFlag) ? 0 : blockFlag;
+	int rightBegin = (blockFlag && !nextFlag) ? 3 * n / 4 - shortQuarter : n / 2;
+	int rightEnd = (blockFlag && !nextFlag) ? 3 * n / 4 + shortQuarter : n;
+
+	const std::vector<float>& left = _windowSlope[leftSlope];
+	const std::vector<float>& right = _windowSlope[rightSlope];
+
+	std::fill(block, block + leftBegin, 0.0f);
+	for (int i = leftBegin; i < leftEnd; ++i)
+		block[i] *= left[static_cast<size_t>(i - leftBegin)];
+
+	int rightSize = rightEnd - rightBegin;
+	for (int i = rightBegin; i < rightEnd; ++i)
+		block[i] *= right[static_cast<size_t>(rightSize - 1 - (i - rightBegin))];
+	std::fill(block + rightEnd, block + n, 0.0f);
+}
+
+/*
+ * Samples between the centers of the previous and current blocks are produced by overlap-add
+ */
+void VorbisDecoder::decodePacket(const std::vector<unsigned char>& packet, int64_t finalGranule)
+{
+	BitReader bits(packet);
+	if (bits.readBit() != 0) return;
+
+	size_t modeIndex = bits.read(ilog(static_cast<uint32_t>(_modes.size() - 1)));
+	if (bits.endOfPacket() || (modeIndex >= _modes.size())) return;
+
+	const Mode& mode = _modes[modeIndex];
+	const Mapping& mapping = _mappings[static_cast<size_t>(mode.mapping)];
+
+	int n = _blocksize[mode.blockFlag];
+	int halfSize = n / 2;
+
+	int previousFlag = 0;
+	int nextFlag = 0;
+	if (mode.blockFlag)
+	{
+		previousFlag = bits.readBit();
+		nextFlag = bits.readBit();
+	}
+
+	bool noResidue[MaxChannels] = { };
+	for (int c = 0; c < _channels; ++c)
+	{
+		const Floor& floor = _floors[static_cast<size_t>(mapping.submapFloor[static_cast<size_t>(mapping.mux[static_cast<size_t>(c)])])];
+		noResidue[c] = !decodeFloor(bits, floor, _floorY);
+		if (!noResidue[c])
+			synthesizeFloor(floor, _floorY, halfSize, _floorCurve[c].data());
+	}
+
+	bool floorUnused[MaxChannels] = { };
+	std::copy(noResidue, noResidue + _channels, floorUnused);
+
+	for (size_t i = 0; i < mapping.magnitude.size(); ++i)
+	{
+		size_t m = static_cast<size_t>(mapping.magnitude[i]);
+		size_t a = static_cast<size_t>(mapping.angle[i]);
+		if (!noResidue[m] || !noResidue[a])
+			noResidue[m] = noResidue[a] = false;
+	}
+
+	for (size_t submap = 0; submap < mapping.submapResidue.size(); ++submap)
+	{
+		float* vectors[MaxChannels] = { };
+		bool doNotDecode[MaxChannels] = { };
+		int channels = 0;
+		for (int c = 0; c < _channels; ++c)
+		{
+			if (mapping.mux[static_cast<size_t>(c)] != static_cast<int>(submap)) continue;
+
+			vectors[channels] = _blocks[c].data();
+			doNotDecode[channels] = noResidue[c];
+			++channels;
+		}
+
+		decodeResidue(bits, _residues[static_cast<size_t>(mapping.submapResidue[submap])], channels,
+			doNotDecode, vectors, n);
+	}
+
+	for (size_t i = mapping.magnitude.size(); i > 0; --i)
+	{
+		float* magnitude = _blocks[mapping.magnitude[i - 1]].data();
+		float* angle = _blocks[mapping.angle[i - 1]].data();
+		for (int j = 0; j < halfSize; ++j)
+		{
+			float m = magnitude[j];
+			float a = angle[j];
+			if (m > 0.0f)
+			{
+				magnitude[j] = (a > 0.0f) ? m : m + a;
+				angle[j] = (a > 0.0f) ? m - a : m;
+			}
+			else
+			{
+				magnitude[j] = (a > 0.0f) ? m : m - a;
+				angle[j] = (a > 0.0f) ? m + a : m;
+			}
+		}
+	}
+
+	std::vector<float> spectrum(static_cast<size_t>(halfSize));
+	for (int c = 0; c < _channels; ++c)
+	{
+		float* block = _blocks[c].data();
+		if (floorUnused[c])
+		{
+			std::fill(spectrum.begin(), spectrum.end(), 0.0f);
+		}
+		else
+		{
+			for (int j = 0; j < halfSize; ++j)
+				spectrum[static_cast<size_t>(j)] = block[j] * _floorCurve[c][static_cast<size_t>(j)];
+		}
+
+		_transform[mode.blockFlag].transform(spectrum.data(), block);
+		applyWindow(block, n, mode.blockFlag, previousFlag, nextFlag);
+	}
+
+	if (_previousBlocksize > 0)
+	{
+		int frames = _previousBlocksize / 4 + n / 4;
+		int start = n / 4 - _previousBlocksize / 4;
+		int previousHalf = _previousBlocksize / 2;
+
+		size_t offset = _pending.size();
+		_pending.resize(offset + static_cast<size_t>(frames * _channels));
+		for (int c = 0; c < _channels; ++c)
+		{
+			const float* block = _blocks[c].data();
+			const float* previous = _previousBlocks[c].data();
+			for (int k = 0; k < frames; ++k)
+			{
+				int current = start + k;
+				float value = ((current >= 0) ? block[current] : 0.0f) + ((k < previousHalf) ? previous[k] : 0.0f);
+				int sample = static_cast<int>(std::floor(value * 32767.0f + 0.5f));
+				_pending[offset + static_cast<size_t>(k * _channels + c)] = static_cast<int16_t>(clamp(sample, -32768, 32767));
+			}
+		}
+
+		_framesDecoded += frames;
+		if ((finalGranule >= 0) && (_framesDecoded > finalGranule))
+		{
+			int64_t extra = (std::min)(_framesDecoded - finalGranule, static_cast<int64_t>(frames));
+			_pending.resize(_pending.size() - static_cast<size_t>(extra * _channels));
+			_framesDecoded -= extra;
+		}
+	}
+
+	for (int c = 0; c < _channels; ++c)
+		std::copy(_blocks[c].begin() + halfSize, _blocks[c].begin() + n, _previousBlocks[c].begin());
+
+	_previousBlocksize = n;
+}
+
+size_t VorbisDecoder::read(char* buffer, size_t size)
+{
+	size_t frameSize = static_cast<size_t>(_channels) * sizeof(int16_t);
+	size_t requested = size / frameSize * static_cast<size_t>(_channels);
+	size_t written = 0;
+
+	int64_t finalGranule = -1;
+	while (written < requested)
+	{
+		if (_pendingOffset >= _pending.size())
+		{
+			_pending.clear();
+			_pendingOffset = 0;
+
+			if (_finished) break;
+
+			if (_reader.readPacket(_packet, finalGranule))
+				decodePacket(_packet, finalGranule);
+			else
+				_finished = true;
+
+			continue;
+		}
+
+		size_t count = (std::min)(requested - written, _pending.size() - _pendingOffset);
+		memcpy(buffer + written * sizeof(int16_t), _pending.data() + _pendingOffset, count * sizeof(int16_t));
+		_pendingOffset += count;
+		written += count;
+	}
+
+	return written * sizeof(int16_t);
+}
+
+void VorbisDecoder::rewind()
+{
+	_reader.seek(_audioOffset);
+	_pending.clear();
+	_pendingOffset = 0;
+	_previousBlocksize = 0;
+	_framesDecoded = 0;
+	_finished = false;
+}
+
+Decoder::Pointer et::audio::openOGGFile(const std::string& fileName)
+{
+	InputStream::Pointer file(new InputStream(fileName, StreamMode_Binary));
+	if (file->invalid())
+	{
+		std::cout << "Unable to open OGG file " << fileName << std::endl;
+		return Decoder::Pointer();
+	}
+
+	Description::Pointer desc(new Description);
+	desc->setOrigin(fileName);
+
+	VorbisDecoder* decoder = new VorbisDecoder(desc, file);
+	Decoder::Pointer result(decoder);
+
+	if (!decoder->open())
+	{
+		log::error("Unable to decode Vorbis stream from file %s", fileName.c_str());
+		return Decoder::Pointer();
+	}
+
+	return result;
+}
@@ -6,36 +6,142 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include <assert.h>
 #include <et/geometry/geometry.h>
 #include <et/core/tools.h>
 #include <et/core/containers.h>
+#include <et/threading/thread.h>
+#include <et/threading/criticalsection.h>
 #include <et/sound/openal.h>
-#include <et/sound/sound.h>
+#include <et/sound/voicemanager.h>
 
 namespace et
 {
     namespace audio
     {
+		enum
+		{
+			StreamBuffersCount = 4,
+			StreamBufferSize = 32768,
+			VoiceSourcesCount = 24
+		};
+
+		enum StreamState
+		{
+			StreamState_Stopped,
+			StreamState_Starting,
+			StreamState_Playing,
+			StreamState_Paused
+		};
+
         class TrackPrivate
         {
 		public:     
 			Description::Pointer desc;
 			TrackPrivate() : buffer(0) { }
 			ALuint buffer;
+			std::string streamFileName;
         };
+
+		/*
+		 * Queue of buffers of the streaming player. Buffers are refilled on the streaming thread,
+		 * all methods should be called under the lock of streaming thread.
+		 */
+		class AudioStream
+		{
+		public:
+			AudioStream(ALuint source, Decoder::Pointer decoder);
+			~AudioStream();
+
+			void play(bool looped);
+			void pause();
+			void stop();
+			void update();
+
+			bool playing() const
+				{ return (_state == StreamState_Starting) || (_state == StreamState_Playing); }
+
+			float position() const;
+
+		private:
+			ET_DENY_COPY(AudioStream)
+
+			void start();
+			bool fillBuffer(ALuint buffer);
+
+		private:
+			ALuint _source;
+			ALuint _buffers[StreamBuffersCount];
+			Decoder::Pointer _decoder;
+			Description::Pointer _desc;
+			BinaryDataStorage _decoded;
+			size_t _frameSize;
+			size_t _processedFrames;
+			StreamState _state;
+			bool _looped;
+		};
+
+		class StreamingThread : public Thread
+		{
+		public:
+			StreamingThread() :
+				Thread(false) { }
+
+			ThreadResult main();
+
+			CriticalSection& streamsLock()
+				{ return _csStreams; }
+
+			void addStream(AudioStream* stream);
+			void removeStream(AudioStream* stream);
+
+		private:
+			CriticalSection _csStreams;
+			std::vector<AudioStream*> _streams;
+		};
         
         class PlayerPrivate
         {
 		public:     
-			PlayerPrivate() : source(0) { }
+			PlayerPrivate() : source(0), stream(nullptr) { }
 			ALuint source;
+			AudioStream* stream;
+
+			/*
+			 * Stream is not available without audio device or after manager was released
+			 */
+			bool streamAvailable() const;
+			void releaseStream();
+		};
+
+		class OpenALVoiceBackend : public VoiceBackend
+		{
+		public:
+			OpenALVoiceBackend(size_t maxSources);
+			~OpenALVoiceBackend();
+
+			size_t sourcesCount() const
+				{ return _sources.size(); }
+
+			void start(size_t source, Track::Pointer track, float position, bool looped);
+			void stop(size_t source);
+			void apply(size_t source, float gain, const vec3& location);
+
+			bool playing(size_t source);
+			float position(size_t source);
+
+		private:
+			std::vector<ALuint> _sources;
 		};
 
 		class ManagerPrivate
 		{
 		public:
-			ManagerPrivate() { }
+			ManagerPrivate() :
+				voices(nullptr) { }
+
+			VoiceManager* voices;
 		};
     }
 }
@@ -49,6 +155,9 @@ using namespace et::audio;
 
 static ALCdevice* sharedDevice = nullptr;
 static ALCcontext* sharedContext = nullptr;
+static StreamingThread* sharedStreamingThread = nullptr;
+
+static const float streamUpdateInterval = 0.05f;
 
 ALCdevice* getSharedDevice();
 ALCcontext* getSharedContext();
@@ -68,7 +177,7 @@ Manager::Manager() : _private(new ManagerPrivate)
 	log::info("[Audio::Manager] Default OpenAL device is `%s`", defaultDeviceSpecifier);
 
 	sharedDevice = alcOpenDevice(defaultDeviceSpecifier);
-	if (alcOpenDevice == nullptr)
+	if (sharedDevice == nullptr)
 	{
 		log::error("Unable to initialize OpenAL device");
 		return;
@@ -99,11 +208,25 @@ Manager::Manager() : _private(new ManagerPrivate)
 	float orientation[] = { 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f };
 	alListenerfv(AL_ORIENTATION, orientation);
 	checkOpenALError("alListenerfv(AL_ORIENTATION, ...");
+
+	sharedStreamingThread = new StreamingThread;
+	sharedStreamingThread->run();
 }
 
 Manager::~Manager()
 {
+	delete _private->voices;
+	_private->voices = nullptr;
+
 	if (sharedDevice == nullptr) return;
+
+	if (sharedStreamingThread != nullptr)
+	{
+		sharedStreamingThread->stop();
+		sharedStreamingThread->waitForTermination();
+		delete sharedStreamingThread;
+		sharedStreamingThread = nullptr;
+	}
 	
 	nativeRelease();
 	alcMakeContextCurrent(0);
@@ -121,6 +244,11 @@ Track::Pointer Manager::loadTrack(const std::string& fileName)
 	return Track::Pointer(new Track(fileName));
 }
 
+Track::Pointer Manager::streamTrack(const std::string& fileName)
+{
+	return Track::Pointer(new Track(fileName, true));
+}
+
 Track::Pointer Manager::genTrack(Description::Pointer desc)
 {
 	return Track::Pointer(new Track(desc));
@@ -137,6 +265,22 @@ Player::Pointer Manager::genPlayer()
 	return Player::Pointer(new Player);
 }
 
+/*
+ * Without audio device voices are managed by the null backend and remain virtual
+ */
+VoiceManager& Manager::voices()
+{
+	if (_private->voices == nullptr)
+	{
+		VoiceBackend* backend = (sharedContext == nullptr) ? static_cast<VoiceBackend*>(new NullVoiceBackend(0)) :
+			static_cast<VoiceBackend*>(new OpenALVoiceBackend(VoiceSourcesCount));
+
+		_private->voices = new VoiceManager(backend);
+	}
+
+	return *_private->voices;
+}
+
 /*
  * Track implementation
  */ 
@@ -146,6 +290,23 @@ Track::Track(const std::string& fileName) : _private(new TrackPrivate)
 	init(loadFile(fileName));
 }
 
+Track::Track(const std::string& fileName, bool streaming) : _private(new TrackPrivate)
+{
+	if (!streaming)
+	{
+		init(loadFile(fileName));
+		return;
+	}
+
+	Decoder::Pointer decoder = openFile(fileName);
+	if (decoder.valid())
+		_private->desc = decoder->description();
+	else
+		log::error("Unable to open audio stream from file %s", fileName.c_str());
+
+	_private->streamFileName = fileName;
+}
+
 Track::Track(Description::Pointer desc) : _private(new TrackPrivate)
 {
 	init(desc);
@@ -159,22 +320,27 @@ Track::~Track()
 
 float Track::duration() const
 {
-	return _private->desc->duration;
+	return _private->desc.valid() ? _private->desc->duration : 0.0f;
 }
 
 size_t Track::channels() const
 {
-	return _private->desc->channels;
+	return _private->desc.valid() ? _private->desc->channels : 0;
 }
 
 size_t Track::sampleRate() const
 {
-	return _private->desc->sampleRate;
+	return _private->desc.valid() ? _private->desc->sampleRate : 0;
 }
 
 size_t Track::bitDepth() const
 {
-	return _private->desc->bitDepth;
+	return _private->desc.valid() ? _private->desc->bitDepth : 0;
+}
+
+bool Track::streaming() const
+{
+	return !_private->streamFileName.empty();
 }
 
 void Track::init(Description::Pointer data)
@@ -226,6 +392,7 @@ Player::Player(Track::Pointer track) :
 Player::~Player()
 {
 	stop();
+	_private->releaseStream();
 
 	alDeleteSources(1, &_private->source);
     checkOpenALError("alDeleteSources");
@@ -255,6 +422,14 @@ void Player::init()
 
 void Player::play(bool looped)
 {
+	if (_private->streamAvailable())
+	{
+		CriticalSectionScope lock(sharedStreamingThread->streamsLock());
+		_private->stream->play(looped);
+		sharedStreamingThread->resume();
+		return;
+	}
+
 	alSourcei(_private->source, AL_LOOPING, looped ? AL_TRUE : AL_FALSE);
     checkOpenALError("alSourcei(..., AL_LOOPING, ...)");
 	
@@ -270,18 +445,41 @@ void Player::play(Track::Pointer track, bool looped)
 
 void Player::pause()
 {
+	if (_private->streamAvailable())
+	{
+		CriticalSectionScope lock(sharedStreamingThread->streamsLock());
+		_private->stream->pause();
+		return;
+	}
+
 	alSourcePause(_private->source);
     checkOpenALError("alSourcePause");
 }
 
 void Player::stop()
 {
+	if (_private->streamAvailable())
+	{
+		CriticalSectionScope lock(sharedStreamingThread->streamsLock());
+		_private->stream->stop();
+		return;
+	}
+
 	alSourceStop(_private->source);
     checkOpenALError("alSourceStop");
 }
 
+/*
+ * Rewind stops the source (as alSourceRewind does), streaming player starts over on next play
+ */
 void Player::rewind()
 {
+	if (_private->stream != nullptr)
+	{
+		stop();
+		return;
+	}
+
     alSourceRewind(_private->source);
     checkOpenALError("alSourceRewind");
 }
@@ -291,10 +489,26 @@ void Player::linkTrack(Track::Pointer track)
 	if (_currentTrack == track) return;
 
     stop();
+	_private->releaseStream();
     
 	_currentTrack = track;
-	alSourcei(_private->source, AL_BUFFER, track->_private->buffer);
-    checkOpenALError("alSourcei(.., AL_BUFFER, ...)");
+	if (track->streaming())
+	{
+		alSourcei(_private->source, AL_BUFFER, 0);
+		checkOpenALError("alSourcei(.., AL_BUFFER, 0)");
+
+		Decoder::Pointer decoder = openFile(track->_private->streamFileName);
+		if (decoder.valid() && (sharedStreamingThread != nullptr))
+		{
+			_private->stream = new AudioStream(_private->source, decoder);
+			sharedStreamingThread->addStream(_private->stream);
+		}
+	}
+	else
+	{
+		alSourcei(_private->source, AL_BUFFER, track->_private->buffer);
+		checkOpenALError("alSourcei(.., AL_BUFFER, ...)");
+	}
 }
 
 void Player::setVolume(float value)
@@ -307,16 +521,29 @@ float Player::position() const
 {
 	if (_currentTrack.invalid()) return 0.0f;
 
+	if (_private->streamAvailable())
+	{
+		CriticalSectionScope lock(sharedStreamingThread->streamsLock());
+		return _private->stream->position();
+	}
+
 	float sampleOffset = 0.0f;
 	alGetSourcef(_private->source, AL_SAMPLE_OFFSET, &sampleOffset);
 	checkOpenALError("alGetSourcef(..., AL_SAMPLE_OFFSET, ");
 
-	return sampleOffset / static_cast<float>(_currentTrack->sampleRate());
+	size_t sampleRate = _currentTrack->sampleRate();
+	return (sampleRate > 0) ? sampleOffset / static_cast<float>(sampleRate) : 0.0f;
 }
 
 bool Player::playing() const
 {
 	if (_currentTrack.invalid()) return false;
+
+	if (_private->streamAvailable())
+	{
+		CriticalSectionScope lock(sharedStreamingThread->streamsLock());
+		return _private->stream->playing();
+	}
 	
 	ALint state = 0;
 	alGetSourcei(_private->source, AL_SOURCE_STATE, &state);
@@ -337,6 +564,293 @@ void Player::setPan(float pan)
 	checkOpenALError("alSource3f(..., AL_POSITION, ");
 }
 
+bool PlayerPrivate::streamAvailable() const
+{
+	return (stream != nullptr) && (sharedStreamingThread != nullptr);
+}
+
+void PlayerPrivate::releaseStream()
+{
+	if (stream == nullptr) return;
+
+	if (sharedStreamingThread != nullptr)
+		sharedStreamingThread->removeStream(stream);
+
+	delete stream;
+	stream = nullptr;
+}
+
+/*
+ * Streaming implementation
+ */
+
+ThreadResult StreamingThread::main()
+{
+	while (running())
+	{
+		{
+			CriticalSectionScope lock(_csStreams);
+			for (AudioStream* stream : _streams)
+				stream->update();
+		}
+		suspend(streamUpdateInterval);
+	}
+
+	return 0;
+}
+
+void StreamingThread::addStream(AudioStream* stream)
+{
+	CriticalSectionScope lock(_csStreams);
+	_streams.push_back(stream);
+}
+
+void StreamingThread::removeStream(AudioStream* stream)
+{
+	CriticalSectionScope lock(_csStreams);
+	_streams.erase(std::remove(_streams.begin(), _streams.end(), stream), _streams.end());
+}
+
+AudioStream::AudioStream(ALuint source, Decoder::Pointer decoder) :
+	_source(source), _decoder(decoder), _desc(decoder->description()), _processedFrames(0),
+	_state(StreamState_Stopped), _looped(false)
+{
+	_frameSize = etMax(size_t(1), _desc->channels * _desc->bitDepth / 8);
+	_decoded.resize(StreamBufferSize - StreamBufferSize % _frameSize);
+
+	alGenBuffers(StreamBuffersCount, _buffers);
+	checkOpenALError("alGenBuffers");
+}
+
+AudioStream::~AudioStream()
+{
+	stop();
+
+	alDeleteBuffers(StreamBuffersCount, _buffers);
+	checkOpenALError("alDeleteBuffers");
+}
+
+void AudioStream::play(bool looped)
+{
+	_looped = looped;
+
+	if (_state == StreamState_Paused)
+	{
+		alSourcePlay(_source);
+		checkOpenALError("alSourcePlay");
+		_state = StreamState_Playing;
+	}
+	else if (_state == StreamState_Stopped)
+	{
+		_state = StreamState_Starting;
+	}
+}
+
+void AudioStream::pause()
+{
+	if (_state == StreamState_Playing)
+	{
+		alSourcePause(_source);
+		checkOpenALError("alSourcePause");
+		_state = StreamState_Paused;
+	}
+	else if (_state == StreamState_Starting)
+	{
+		_state = StreamState_Stopped;
+	}
+}
+
+/*
+ * Buffers of the stopped source are processed, so detaching them unqueues all
+ */
+void AudioStream::stop()
+{
+	alSourceStop(_source);
+	alSourcei(_source, AL_BUFFER, 0);
+	checkOpenALError("alSourcei(.., AL_BUFFER, 0)");
+
+	_decoder->rewind();
+	_processedFrames = 0;
+	_state = StreamState_Stopped;
+}
+
+void AudioStream::start()
+{
+	stop();
+
+	ALsizei queued = 0;
+	while ((queued < StreamBuffersCount) && fillBuffer(_buffers[queued]))
+		++queued;
+
+	if (queued == 0) return;
+
+	alSourceQueueBuffers(_source, queued, _buffers);
+	checkOpenALError("alSourceQueueBuffers");
+
+	alSourcePlay(_source);
+	checkOpenALError("alSourcePlay");
+
+	_state = StreamState_Playing;
+}
+
+/*
+ * Processed buffers are refilled and queued again. Source, which was stopped by underrun, is restarted,
+ * stream is stopped when all buffers were played and decoder has no more data.
+ */
+void AudioStream::update()
+{
+	if (_state == StreamState_Starting)
+		start();
+
+	if (_state != StreamState_Playing) return;
+
+	ALint processed = 0;
+	alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+
+	for (ALint i = 0; i < processed; ++i)
+	{
+		ALuint buffer = 0;
+		alSourceUnqueueBuffers(_source, 1, &buffer);
+
+		ALint bufferSize = 0;
+		alGetBufferi(buffer, AL_SIZE, &bufferSize);
+		_processedFrames += static_cast<size_t>(bufferSize) / _frameSize;
+
+		if (fillBuffer(buffer))
+			alSourceQueueBuffers(_source, 1, &buffer);
+	}
+	checkOpenALError("AudioStream::update");
+
+	ALint sourceState = 0;
+	alGetSourcei(_source, AL_SOURCE_STATE, &sourceState);
+	if (sourceState == AL_PLAYING) return;
+
+	ALint queued = 0;
+	alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+	if (queued > 0)
+	{
+		alSourcePlay(_source);
+		checkOpenALError("alSourcePlay");
+	}
+	else
+	{
+		stop();
+	}
+}
+
+bool AudioStream::fillBuffer(ALuint buffer)
+{
+	size_t bytesDecoded = _decoder->read(_decoded.binary(), _decoded.dataSize());
+	while (_looped && (bytesDecoded < _decoded.dataSize()))
+	{
+		_decoder->rewind();
+		size_t bytesRead = _decoder->read(_decoded.binary() + bytesDecoded, _decoded.dataSize() - bytesDecoded);
+		if (bytesRead == 0) break;
+
+		bytesDecoded += bytesRead;
+	}
+
+	if (bytesDecoded == 0) return false;
+
+	alBufferData(buffer, static_cast<ALenum>(_desc->format), _decoded.data(),
+		static_cast<ALsizei>(bytesDecoded), static_cast<ALsizei>(_desc->sampleRate));
+	checkOpenALError("alBufferData");
+
+	return true;
+}
+
+float AudioStream::position() const
+{
+	ALint sampleOffset = 0;
+	if (_state != StreamState_Stopped)
+		alGetSourcei(_source, AL_SAMPLE_OFFSET, &sampleOffset);
+
+	float result = static_cast<float>(_processedFrames + static_cast<size_t>(sampleOffset)) /
+		static_cast<float>(_desc->sampleRate);
+
+	return (_looped && (_desc->duration > 0.0f)) ? std::fmod(result, _desc->duration) : result;
+}
+
+/*
+ * Voice backend implementation
+ */
+
+/*
+ * Sources are created until the limit of the device, distance attenuation is applied by the voice manager
+ */
+OpenALVoiceBackend::OpenALVoiceBackend(size_t maxSources)
+{
+	alGetError();
+
+	for (size_t i = 0; i < maxSources; ++i)
+	{
+		ALuint source = 0;
+		alGenSources(1, &source);
+		if (alGetError() != AL_NO_ERROR) break;
+
+		alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+		alSourcef(source, AL_ROLLOFF_FACTOR, 0.0f);
+		_sources.push_back(source);
+	}
+	checkOpenALError("OpenALVoiceBackend::OpenALVoiceBackend");
+
+	if (_sources.size() < maxSources)
+		log::warning("[Audio::Manager] Only %u sources are available for voices", static_cast<uint32_t>(_sources.size()));
+}
+
+OpenALVoiceBackend::~OpenALVoiceBackend()
+{
+	for (ALuint source : _sources)
+	{
+		alSourceStop(source);
+		alSourcei(source, AL_BUFFER, 0);
+	}
+
+	if (!_sources.empty())
+		alDeleteSources(static_cast<ALsizei>(_sources.size()), _sources.data());
+
+	checkOpenALError("OpenALVoiceBackend::~OpenALVoiceBackend");
+}
+
+void OpenALVoiceBackend::start(size_t source, Track::Pointer track, float position, bool looped)
+{
+	ALuint s = _sources[source];
+
+	alSourcei(s, AL_BUFFER, static_cast<ALint>(track->_private->buffer));
+	alSourcei(s, AL_LOOPING, looped ? AL_TRUE : AL_FALSE);
+	alSourcef(s, AL_SEC_OFFSET, position);
+	alSourcePlay(s);
+	checkOpenALError("OpenALVoiceBackend::start");
+}
+
+void OpenALVoiceBackend::stop(size_t source)
+{
+	alSourceStop(_sources[source]);
+	alSourcei(_sources[source], AL_BUFFER, 0);
+	checkOpenALError("OpenALVoiceBackend::stop");
+}
+
+void OpenALVoiceBackend::apply(size_t source, float gain, const vec3& location)
+{
+	alSourcef(_sources[source], AL_GAIN, gain);
+	alSourcefv(_sources[source], AL_POSITION, location.data());
+	checkOpenALError("OpenALVoiceBackend::apply");
+}
+
+bool OpenALVoiceBackend::playing(size_t source)
+{
+	ALint state = 0;
+	alGetSourcei(_sources[source], AL_SOURCE_STATE, &state);
+	return (state == AL_PLAYING);
+}
+
+float OpenALVoiceBackend::position(size_t source)
+{
+	float offset = 0.0f;
+	alGetSourcef(_sources[source], AL_SEC_OFFSET, &offset);
+	return offset;
+}
+
 /*
  * Service functions
  */
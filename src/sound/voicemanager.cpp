@@ -0,0 +1,311 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <algorithm>
+#include <et/sound/voicemanager.h>
+
+using namespace et;
+using namespace et::audio;
+
+namespace
+{
+	/*
+	 * Voice keeps its source until another one becomes noticeably louder,
+	 * so voices of similar volume do not swap sources every frame
+	 */
+	const float realVoiceBias = 1.25f;
+}
+
+/*
+ * Voice
+ */
+void Voice::stop()
+{
+	if (_owner != nullptr)
+		_owner->stop(Voice::Pointer(this));
+}
+
+/*
+ * Null backend
+ */
+void NullVoiceBackend::update(float deltaTime)
+{
+	for (Source& s : _sources)
+	{
+		if (!s.playing) continue;
+
+		float duration = s.track->duration();
+		s.position += deltaTime;
+
+		if (s.position < duration) continue;
+
+		if (s.looped && (duration > 0.0f))
+		{
+			s.position = std::fmod(s.position, duration);
+		}
+		else
+		{
+			s.position = duration;
+			s.playing = false;
+		}
+	}
+}
+
+void NullVoiceBackend::start(size_t source, Track::Pointer track, float position, bool looped)
+{
+	Source& s = _sources.at(source);
+	s.track = track;
+	s.position = position;
+	s.looped = looped;
+	s.playing = true;
+}
+
+void NullVoiceBackend::stop(size_t source)
+{
+	_sources.at(source) = Source();
+}
+
+void NullVoiceBackend::apply(size_t source, float gain, const vec3& location)
+{
+	Source& s = _sources.at(source);
+	s.gain = gain;
+	s.location = location;
+}
+
+/*
+ * Voice manager
+ */
+VoiceManager::VoiceManager(VoiceBackend* backend) :
+	_backend(backend), _audibilityThreshold(0.001f)
+{
+	assert(backend != nullptr);
+
+	_statistics.sources = _backend->sourcesCount();
+	for (size_t i = _statistics.sources; i > 0; --i)
+		_freeSources.push_back(i - 1);
+}
+
+VoiceManager::~VoiceManager()
+{
+	stopAll();
+	delete _backend;
+}
+
+Voice::Pointer VoiceManager::play(Track::Pointer track, const VoiceParameters& params)
+{
+	if (track.invalid() || track->streaming())
+	{
+		log::error("[VoiceManager] Voices could be played only from loaded tracks");
+		return Voice::Pointer();
+	}
+
+	Voice::Pointer voice(new Voice(this, track, params));
+	_voices.push_back(voice);
+	return voice;
+}
+
+void VoiceManager::stop(Voice::Pointer voice)
+{
+	if (voice.valid() && (voice->_owner == this))
+		remove(voice.ptr());
+}
+
+void VoiceManager::stopAll()
+{
+	for (Voice::Pointer& voice : _voices)
+		finish(voice.ptr());
+
+	_voices.clear();
+
+	_statistics.voices = 0;
+	_statistics.realVoices = 0;
+	_statistics.virtualVoices = 0;
+}
+
+void VoiceManager::setCategoryLimit(size_t index, size_t maxRealVoices)
+{
+	category(index).limit = maxRealVoices;
+}
+
+void VoiceManager::setCategoryVolume(size_t index, float volume)
+{
+	category(index).volume = volume;
+}
+
+VoiceManager::Category& VoiceManager::category(size_t index)
+{
+	if (index >= _categories.size())
+		_categories.resize(index + 1);
+
+	return _categories[index];
+}
+
+/*
+ * Voices are ranked by priority and audibility, the first ones which fit into
+ * the pool and category limits get sources. Others continue as virtual voices.
+ */
+void VoiceManager::update(float deltaTime)
+{
+	_backend->update(deltaTime);
+
+	for (Voice::Pointer& voice : _voices)
+		advance(voice.ptr(), deltaTime);
+
+	_voices.erase(std::remove_if(_voices.begin(), _voices.end(),
+		[](const Voice::Pointer& v) { return !v->_playing; }), _voices.end());
+
+	_order.clear();
+	for (Voice::Pointer& voice : _voices)
+	{
+		voice->_audibility = audibility(voice.ptr());
+
+		RankedVoice r = { voice.ptr(), voice->_audibility, voice->_parameters.priority, false, false };
+		r.audible = (r.score > 0.0f) && (r.score >= _audibilityThreshold);
+		if (voice->_source != Voice::InvalidSource)
+			r.score *= realVoiceBias;
+
+		_order.push_back(r);
+	}
+
+	std::stable_sort(_order.begin(), _order.end(), [](const RankedVoice& a, const RankedVoice& b)
+		{ return (a.priority > b.priority) || ((a.priority == b.priority) && (a.score > b.score)); });
+
+	for (Category& c : _categories)
+		c.realVoices = 0;
+
+	_statistics.inaudibleVoices = 0;
+	_statistics.limitedVoices = 0;
+
+	size_t availableSources = _statistics.sources;
+	for (RankedVoice& r : _order)
+	{
+		if (!r.audible)
+		{
+			++_statistics.inaudibleVoices;
+			continue;
+		}
+
+		Category& c = category(r.voice->_parameters.category);
+		if ((availableSources == 0) || (c.realVoices >= c.limit))
+		{
+			++_statistics.limitedVoices;
+			continue;
+		}
+
+		r.real = true;
+		++c.realVoices;
+		--availableSources;
+	}
+
+	for (RankedVoice& r : _order)
+	{
+		if (!r.real && (r.voice->_source != Voice::InvalidSource))
+			virtualize(r.voice);
+	}
+
+	for (RankedVoice& r : _order)
+	{
+		Voice* voice = r.voice;
+		if (!r.real) continue;
+
+		if (voice->_source == Voice::InvalidSource)
+		{
+			voice->_source = _freeSources.back();
+			_freeSources.pop_back();
+
+			_backend->start(voice->_source, voice->_track, voice->_position, voice->_parameters.looped);
+			++_statistics.startedVoices;
+		}
+
+		const VoiceParameters& params = voice->_parameters;
+		_backend->apply(voice->_source, voice->_audibility,
+			params.relative ? params.location : params.location - _listenerLocation);
+	}
+
+	_statistics.voices = _voices.size();
+	_statistics.realVoices = _statistics.sources - availableSources;
+	_statistics.virtualVoices = _statistics.voices - _statistics.realVoices;
+}
+
+float VoiceManager::audibility(const Voice* voice)
+{
+	const VoiceParameters& params = voice->_parameters;
+	float result = params.volume * category(params.category).volume;
+
+	if (!params.relative && (params.maxDistance > params.referenceDistance))
+	{
+		float distance = clamp(length(params.location - _listenerLocation), params.referenceDistance, params.maxDistance);
+		result *= 1.0f - (distance - params.referenceDistance) / (params.maxDistance - params.referenceDistance);
+	}
+
+	return result;
+}
+
+/*
+ * New voices start from the beginning, real voices take position from the backend
+ */
+void VoiceManager::advance(Voice* voice, float deltaTime)
+{
+	if (!voice->_started)
+	{
+		voice->_started = true;
+		return;
+	}
+
+	if (voice->_source != Voice::InvalidSource)
+	{
+		if (_backend->playing(voice->_source))
+			voice->_position = _backend->position(voice->_source);
+		else
+			finish(voice);
+
+		return;
+	}
+
+	float duration = voice->_track->duration();
+	voice->_position += deltaTime;
+
+	if (voice->_position < duration) return;
+
+	if (voice->_parameters.looped && (duration > 0.0f))
+		voice->_position = std::fmod(voice->_position, duration);
+	else
+		finish(voice);
+}
+
+void VoiceManager::virtualize(Voice* voice)
+{
+	voice->_position = _backend->position(voice->_source);
+	_backend->stop(voice->_source);
+
+	_freeSources.push_back(voice->_source);
+	voice->_source = Voice::InvalidSource;
+}
+
+void VoiceManager::finish(Voice* voice)
+{
+	if (voice->_source != Voice::InvalidSource)
+	{
+		_backend->stop(voice->_source);
+		_freeSources.push_back(voice->_source);
+		voice->_source = Voice::InvalidSource;
+	}
+
+	voice->_playing = false;
+	voice->_owner = nullptr;
+	++_statistics.finishedVoices;
+}
+
+void VoiceManager::remove(Voice* voice)
+{
+	finish(voice);
+
+	_voices.erase(std::remove_if(_voices.begin(), _voices.end(),
+		[voice](const Voice::Pointer& v) { return v.ptr() == voice; }), _voices.end());
+
+	_statistics.voices = _voices.size();
+}
@@ -0,0 +1,296 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <deque>
+#include <algorithm>
+#include <et/threading/thread.h>
+#include <et/threading/threading.h>
+#include <et/tasks/jobsystem.h>
+
+namespace et
+{
+	class JobWorker : public Thread
+	{
+	public:
+		JobWorker(JobSystemPrivate* owner) :
+			Thread(false), _owner(owner) { }
+
+		ThreadResult main();
+
+		void pushJob(const Job&);
+		bool popJob(Job&);
+		bool stealJob(Job&);
+
+		void cancelJobs(std::vector<Job>&);
+
+	private:
+		JobSystemPrivate* _owner;
+
+		CriticalSection _csModifying;
+		std::deque<Job> _jobs;
+	};
+
+	class JobSystemPrivate
+	{
+	public:
+		std::vector<JobWorker*> workers;
+		AtomicCounter nextWorker;
+
+	public:
+		JobSystemPrivate(size_t workersCount);
+		~JobSystemPrivate();
+
+		JobWorker* currentWorker();
+
+		void submit(const Job& job, JobCounter* dependency);
+		void enqueue(const Job& job);
+
+		bool takeJob(Job& job, JobWorker* worker);
+		void execute(const Job& job);
+		void finish(JobCounter* counter);
+	};
+}
+
+using namespace et;
+
+/**
+ *
+ * JobWorker
+ *
+ */
+ThreadResult JobWorker::main()
+{
+	while (running())
+	{
+		Job job;
+		if (_owner->takeJob(job, this))
+			_owner->execute(job);
+		else
+			suspend();
+	}
+
+	return 0;
+}
+
+void JobWorker::pushJob(const Job& job)
+{
+	CriticalSectionScope lock(_csModifying);
+	_jobs.push_back(job);
+}
+
+/*
+ * Owner takes most recent jobs (they are likely still in cache),
+ * other workers are stealing the oldest ones.
+ */
+bool JobWorker::popJob(Job& job)
+{
+	CriticalSectionScope lock(_csModifying);
+	if (_jobs.empty()) return false;
+
+	job = _jobs.back();
+	_jobs.pop_back();
+	return true;
+}
+
+bool JobWorker::stealJob(Job& job)
+{
+	CriticalSectionScope lock(_csModifying);
+	if (_jobs.empty()) return false;
+
+	job = _jobs.front();
+	_jobs.pop_front();
+	return true;
+}
+
+void JobWorker::cancelJobs(std::vector<Job>& jobs)
+{
+	CriticalSectionScope lock(_csModifying);
+	jobs.insert(jobs.end(), _jobs.begin(), _jobs.end());
+	_jobs.clear();
+}
+
+/**
+ *
+ * JobSystemPrivate
+ *
+ */
+JobSystemPrivate::JobSystemPrivate(size_t workersCount)
+{
+	workers.reserve(workersCount);
+
+	for (size_t i = 0; i < workersCount; ++i)
+		workers.push_back(new JobWorker(this));
+
+	for (auto w : workers)
+		w->run();
+}
+
+JobSystemPrivate::~JobSystemPrivate()
+{
+	for (auto w : workers)
+	{
+		w->stop();
+		w->waitForTermination();
+	}
+
+	std::vector<Job> cancelledJobs;
+	for (auto w : workers)
+	{
+		w->cancelJobs(cancelledJobs);
+		delete w;
+	}
+
+	for (auto& job : cancelledJobs)
+	{
+		delete job.task;
+		if (job.counter)
+			job.counter->_counter.release();
+	}
+}
+
+JobWorker* JobSystemPrivate::currentWorker()
+{
+	ThreadId current = Threading::currentThread();
+
+	for (auto w : workers)
+	{
+		if (w->id() == current)
+			return w;
+	}
+
+	return nullptr;
+}
+
+void JobSystemPrivate::submit(const Job& job, JobCounter* dependency)
+{
+	if (job.counter)
+		job.counter->_counter.retain();
+
+	if (dependency)
+	{
+		CriticalSectionScope lock(dependency->_csDependent);
+		if (!dependency->completed())
+		{
+			dependency->_dependent.push_back(job);
+			return;
+		}
+	}
+
+	enqueue(job);
+}
+
+void JobSystemPrivate::enqueue(const Job& job)
+{
+	JobWorker* target = currentWorker();
+
+	if (target == nullptr)
+	{
+		size_t index = static_cast<size_t>(nextWorker.retain()) % workers.size();
+		target = workers.at(index);
+	}
+
+	target->pushJob(job);
+
+	/*
+	 * Resume is not lost even if target is just about to suspend
+	 */
+	bool targetWasSuspended = target->suspended();
+	target->resume();
+
+	if (targetWasSuspended) return;
+
+	for (auto w : workers)
+	{
+		if ((w != target) && w->suspended())
+		{
+			w->resume();
+			break;
+		}
+	}
+}
+
+bool JobSystemPrivate::takeJob(Job& job, JobWorker* worker)
+{
+	if (worker && worker->popJob(job))
+		return true;
+
+	for (auto w : workers)
+	{
+		if ((w != worker) && w->stealJob(job))
+			return true;
+	}
+
+	return false;
+}
+
+void JobSystemPrivate::execute(const Job& job)
+{
+	job.task->execute();
+	delete job.task;
+
+	if (job.counter)
+		finish(job.counter);
+}
+
+void JobSystemPrivate::finish(JobCounter* counter)
+{
+	if (counter->_counter.release() > 0) return;
+
+	std::vector<Job> dependent;
+	{
+		CriticalSectionScope lock(counter->_csDependent);
+		dependent.swap(counter->_dependent);
+	}
+
+	for (auto& job : dependent)
+		enqueue(job);
+}
+
+/**
+ *
+ * JobSystem
+ *
+ */
+JobSystem::JobSystem() :
+	_private(new JobSystemPrivate(std::max(size_t(1), Threading::coresCount())))
+{
+}
+
+JobSystem::JobSystem(size_t workersCount) :
+	_private(new JobSystemPrivate(std::max(size_t(1), workersCount)))
+{
+}
+
+JobSystem::~JobSystem()
+{
+	delete _private;
+}
+
+size_t JobSystem::workersCount() const
+{
+	return _private->workers.size();
+}
+
+void JobSystem::submit(Task* task, JobCounter* counter, JobCounter* dependency)
+{
+	assert(task);
+	_private->submit(Job(task, counter), dependency);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+	JobWorker* worker = _private->currentWorker();
+
+	while (!counter.completed())
+	{
+		Job job;
+		if (_private->takeJob(job, worker))
+			_private->execute(job);
+		else
+			Thread::sleepMSec(0);
+	}
+}
@@ -7,10 +7,12 @@
 
 #include <algorithm>
 #include <et/tasks/taskpool.h>
+#include <et/tasks/jobsystem.h>
 
 using namespace et;
 
-TaskPool::TaskPool()
+TaskPool::TaskPool() :
+	_jobSystem(nullptr), _lastIndex(InvalidTaskHandle), _lastTime(0.0f)
 {
 }
 
@@ -18,57 +20,116 @@ TaskPool::~TaskPool()
 {
 	CriticalSectionScope lock(_csModifying);
 	
-	for (auto i : _tasks)
-		delete i;
+	joinPostedTasks();
+	
+	for (auto& entry : _pendingTasks)
+		delete entry.second;
 }
 
-void TaskPool::addTask(Task* t, float delay)
+TaskHandle TaskPool::addTask(Task* t, float delay)
 {
-	CriticalSectionScope lock(_csModifying);
+	if (t->_posted.retain() > 1) return InvalidTaskHandle;
 	
-	auto alreadyAdded = std::find(_tasksToAdd.begin(), _tasksToAdd.end(), t);
-	if (alreadyAdded == _tasksToAdd.end())
+	TaskHandle handle = ++_lastIndex;
+	t->_scheduleIndex = handle;
+	t->_delay = delay;
+	_inbox.push(t);
+	
+	return handle;
+}
+
+void TaskPool::joinPostedTasks()
+{
+	Task* t = _inbox.drain();
+	while (t != nullptr)
 	{
-		t->setExecutionTime(_lastTime + delay);
-		_tasksToAdd.push_back(t); 
+		Task* next = t->_nextPosted;
+		
+		_pendingTasks[t->_scheduleIndex] = t;
+		_schedule.push_back(ScheduledTask(t, _lastTime + t->_delay, t->_scheduleIndex));
+		std::push_heap(_schedule.begin(), _schedule.end());
+		
+		t = next;
 	}
 }
 
-void TaskPool::update(float t)
+bool TaskPool::cancelTask(TaskHandle handle)
 {
-	joinTasks();
+	CriticalSectionScope lock(_csModifying);
+	
+	joinPostedTasks();
+	
+	auto i = _pendingTasks.find(handle);
+	if (i == _pendingTasks.end()) return false;
 	
-	_lastTime = t;
+	delete i->second;
+	_pendingTasks.erase(i);
+	
+	return true;
+}
+
+void TaskPool::update(float t)
+{
+	{
+		CriticalSectionScope lock(_csModifying);
+		
+		_lastTime = t;
+		
+		joinPostedTasks();
+		
+		while (_schedule.size() && (t >= _schedule.front().executionTime))
+		{
+			ScheduledTask entry = _schedule.front();
+			std::pop_heap(_schedule.begin(), _schedule.end());
+			_schedule.pop_back();
+			
+			auto i = _pendingTasks.find(entry.index);
+			if (i != _pendingTasks.end())
+			{
+				_pendingTasks.erase(i);
+				_dueTasks.push_back(entry.task);
+			}
+		}
+	}
 	
-	auto i = _tasks.begin();
-	while (i != _tasks.end())
+	for (auto task : _dueTasks)
 	{
-		Task* task = (*i);
-		if (t >= task->executionTime())
+		if (_jobSystem == nullptr)
 		{
 			task->execute();
 			delete task;
-			i = _tasks.erase(i);
 		}
 		else
 		{
-			++i;
+			_jobSystem->submit(task);
 		}
 	}
+	
+	_dueTasks.clear();
 }
 
 bool TaskPool::hasTasks()
 {
+	if (!_inbox.empty()) return true;
+	
 	CriticalSectionScope lock(_csModifying);
-	return (_tasks.size() + _tasksToAdd.size()) > 0;
+	return !_pendingTasks.empty();
 }
 
-void TaskPool::joinTasks()
+bool TaskPool::nextTaskTime(float& t)
 {
 	CriticalSectionScope lock(_csModifying);
-	if (_tasksToAdd.size())
+	
+	joinPostedTasks();
+	
+	while (_schedule.size() && (_pendingTasks.count(_schedule.front().index) == 0))
 	{
-		_tasks.insert(_tasks.end(), _tasksToAdd.begin(), _tasksToAdd.end());
-		_tasksToAdd.clear();
+		std::pop_heap(_schedule.begin(), _schedule.end());
+		_schedule.pop_back();
 	}
-}
\ No newline at end of file
+	
+	if (_schedule.empty()) return false;
+	
+	t = _schedule.front().executionTime;
+	return true;
+}
@@ -9,13 +9,58 @@
 #include <et/core/tools.h>
 #include <et/app/application.h>
 #include <et/primitives/primitives.h>
+#include <et/tasks/jobsystem.h>
 #include <et/terrain/terrain.h>
-#include <et/timers/intervaltimer.h>
 
 using namespace et;
 
 #define ET_TERRAIN_CHUNK_SIZE		32
 
+namespace
+{
+	const size_t parallelSelectionDepth = 3;
+	const size_t parallelSelectionThreshold = 1024;
+	const float morphStart = 0.75f;
+
+	/*
+	 * Returns offset from the vertex to its position on the coarser level and the level,
+	 * on which vertex still exists. Coarser triangles are the same as in lod patterns.
+	 */
+	vec3 morphOffset(RawDataAcessor<vec3>& pos, const vec2i& dim, int x, int z, int& level)
+	{
+		level = 0;
+		while ((level < Terrain::LodLevel4) && (((x | z) & (1 << level)) == 0))
+			++level;
+
+		if (level == Terrain::LodLevel4)
+			return vec3(0.0f);
+
+		int s = 1 << level;
+		vec2i a;
+		vec2i b;
+		if (((x & s) != 0) && ((z & s) != 0))
+		{
+			a = vec2i(x + s, z - s);
+			b = vec2i(x - s, z + s);
+		}
+		else if ((x & s) != 0)
+		{
+			a = vec2i(x - s, z);
+			b = vec2i(x + s, z);
+		}
+		else
+		{
+			a = vec2i(x, z - s);
+			b = vec2i(x, z + s);
+		}
+
+		a = vec2i(etMin(a.x, dim.x - 1), etMin(a.y, dim.y - 1));
+		b = vec2i(etMin(b.x, dim.x - 1), etMin(b.y, dim.y - 1));
+
+		return 0.5f * (pos[a.x + a.y * dim.x] + pos[b.x + b.y * dim.x]) - pos[x + z * dim.x];
+	}
+}
+
 class et::TerrainLODLevels
 {
 public:
@@ -394,28 +439,43 @@ private:
 class et::TerrainChunk
 {
 public:
+	/*
+	 * Chunk includes the first row and column of the next ones, as lod patterns do.
+	 * Error of the level is accumulated from offsets of vertices, which disappear on it.
+	 */
 	TerrainChunk(int index, Terrain* t, int x0, int z0) : selectedLod(0), selectedVariation(0), 
 		visible(true), _x0(x0), _z0(z0), _index(index), _t(t)
 	{
 		VertexDataChunk pos = t->_tdata->vertexData()->chunk(Usage_Position);
 		RawDataAcessor<vec3> posData = pos.accessData<vec3>(0);
 
-		initialOffset = x0 + z0 * _t->terrainData()->dimension().x;
+		const vec2i& dim = _t->terrainData()->dimension();
+		initialOffset = x0 + z0 * dim.x;
 		vec3 _minVect = posData[initialOffset];
 		vec3 _maxVect = _minVect;
 
-		for (int z = z0, ze = z0 + ET_TERRAIN_CHUNK_SIZE; z < ze; ++z)
+		float levelOffsets[Terrain::LodLevel_max] = { };
+		for (int z = z0, ze = etMin(z0 + ET_TERRAIN_CHUNK_SIZE, dim.y - 1); z <= ze; ++z)
 		{
-			for (int x = x0, xe = x0 + ET_TERRAIN_CHUNK_SIZE; x < xe; ++x)
+			for (int x = x0, xe = etMin(x0 + ET_TERRAIN_CHUNK_SIZE, dim.x - 1); x <= xe; ++x)
 			{
-				int e = x + z * _t->terrainData()->dimension().x;
+				int e = x + z * dim.x;
 				_minVect = minv(posData[e], _minVect);
 				_maxVect = maxv(posData[e], _maxVect);
+
+				int level = 0;
+				vec3 offset = morphOffset(posData, dim, x, z, level);
+				if (level < Terrain::LodLevel4)
+					levelOffsets[level + 1] = etMax(levelOffsets[level + 1], offset.length());
 			}
 		}
 
+		lodError[Terrain::LodLevel0] = 0.0f;
+		for (int level = Terrain::LodLevel1; level < Terrain::LodLevel_max; ++level)
+			lodError[level] = lodError[level - 1] + levelOffsets[level];
+
 		vec3 center = (_minVect + _maxVect) / 2.0f;
-		vec3 dimension = _maxVect - _minVect;
+		vec3 dimension = (_maxVect - _minVect) / 2.0f;
 		_aabb = AABB(center, dimension);
 	}
 
@@ -425,6 +485,11 @@ public:
 	int initialOffset;
 	bool visible;
 
+	/*
+	 * Maximal deviation from the full resolution surface for each level
+	 */
+	float lodError[Terrain::LodLevel_max];
+
 	const int index() const
 		{ return _index; }
 
@@ -439,8 +504,28 @@ private:
 	AABB _aabb;
 };
 
+class Terrain::LodSelectionTask : public Task
+{
+public:
+	LodSelectionTask(Terrain* owner, uint32_t nodeIndex, uint32_t planeMask, const LodSelection& selection,
+		size_t depth) : _owner(owner), _nodeIndex(nodeIndex), _planeMask(planeMask), _selection(selection),
+		_depth(depth) { }
+
+private:
+	void execute()
+		{ _owner->selectLodLevels(_nodeIndex, _planeMask, _selection, _depth, nullptr, nullptr); }
+
+private:
+	Terrain* _owner;
+	uint32_t _nodeIndex;
+	uint32_t _planeMask;
+	const LodSelection& _selection;
+	size_t _depth;
+};
+
 Terrain::Terrain(RenderContext* rc, TerrainDelegate* tDelegate) : 
-	_rc(rc), _tdata(0), _delegate(tDelegate), _lods(0)
+	_rc(rc), _tdata(0), _delegate(tDelegate), _lods(0), _lodErrors(0), _morphRanges(0),
+	_maxScreenSpaceError(2.0f), _geomorphingEnabled(false)
 {
 
 }
@@ -456,6 +541,8 @@ void Terrain::releaseData()
 		delete *i;
 
 	_chunks.clear();
+	_visibleChunks.clear();
+	_nodes.clear();
 
 	delete _lods;
 	_lods = 0;
@@ -464,7 +551,7 @@ void Terrain::releaseData()
 void Terrain::render(RenderContext* rc)
 {
 	rc->renderState().bindVertexArray(_vao);
-	for (ChunkIterator i = _chunks.begin(), e = _chunks.end(); i != e; ++i)
+	for (ChunkIterator i = _visibleChunks.begin(), e = _visibleChunks.end(); i != e; ++i)
 	{
 		TerrainChunk* chunk = *i;
 		TerrainLODLevels::LOD& l = _lods->lods[chunk->selectedLod];
@@ -481,7 +568,10 @@ void Terrain::loadFromData(const TerrainDataRef& data)
 
 void Terrain::loadFromStream(std::istream& stream, const vec2i& dimension, TerrainData::Format format)
 {
-	loadFromData(TerrainDataRef(new TerrainData(_delegate, stream, dimension, format)));
+	TerrainDataRef data(new TerrainData(_delegate));
+	data->setMorphDataEnabled(_geomorphingEnabled);
+	data->loadFromStream(stream, dimension, format);
+	loadFromData(data);
 }
 
 void Terrain::loadFromRAWFile(const std::string& fileName, const vec2i& dimension, TerrainData::Format format)
@@ -495,9 +585,22 @@ void Terrain::loadFromRAWFile(const std::string& fileName, const vec2i& dimensio
 void Terrain::generateBuffer()
 {
 	releaseData();
+
+	if (!_tdata->vertexData().valid())
+	{
+		log::warning("Terrain data has no vertex data (streaming mode), terrain will not be rendered.");
+		return;
+	}
+
+	/*
+	 * Indices are relative to the first vertex of the chunk, but rows have width of the whole terrain
+	 */
+	bool shortIndices = ET_TERRAIN_CHUNK_SIZE * (_tdata->dimension().x + 1) <= 0xffff;
 	
-	IndexArray::Pointer indices(new IndexArray(IndexArrayFormat_16bit, 0, PrimitiveType_Triangles));
+	IndexArray::Pointer indices(new IndexArray(shortIndices ? IndexArrayFormat_16bit : IndexArrayFormat_32bit,
+		0, PrimitiveType_Triangles));
 	_lods = new TerrainLODLevels(indices, this);
+	generateMorphData();
 	generateChunks();
 	indices->compact();
 
@@ -507,11 +610,28 @@ void Terrain::generateBuffer()
 	_vao->setBuffers(_vertexBuffer, _indexBuffer);
 }
 
+void Terrain::generateMorphData()
+{
+	VertexArray::Pointer& vertexData = _tdata->vertexData();
+	if (!vertexData->decl().has(Usage_TexCoord1)) return;
+
+	const vec2i& dim = _tdata->dimension();
+	RawDataAcessor<vec3> pos = vertexData->chunk(Usage_Position).accessData<vec3>(0);
+	RawDataAcessor<vec4> morph = vertexData->chunk(Usage_TexCoord1).accessData<vec4>(0);
+
+	for (int z = 0; z < dim.y; ++z)
+	{
+		for (int x = 0; x < dim.x; ++x)
+		{
+			int level = 0;
+			vec3 offset = morphOffset(pos, dim, x, z, level);
+			morph[x + z * dim.x] = vec4(offset, static_cast<float>(level));
+		}
+	}
+}
+
 void Terrain::generateChunks()
 { 
-	std::cout << "Generating terrain chunks... ";
-	IntervalTimer timer(true);
-
 	int totalChunks = 0;
 	_chunkSizes = _tdata->dimension() / ET_TERRAIN_CHUNK_SIZE;
 	for (int z = 0; z < _chunkSizes.y; ++z)
@@ -523,7 +643,75 @@ void Terrain::generateChunks()
 		}
 	}
 
-	std::cout << "done (" << timer.lap() << " sec) " << std::endl;
+	_lodErrors.fill(0);
+	for (TerrainChunk* chunk : _chunks)
+	{
+		for (int level = LodLevel0; level < LodLevel_max; ++level)
+			_lodErrors[level] = etMax(_lodErrors[level], chunk->lodError[level]);
+	}
+
+	if (!_chunks.empty())
+	{
+		_nodes.push_back(QuadtreeNode());
+		buildQuadtree(0, vec2i(0), _chunkSizes - vec2i(1));
+	}
+
+	_visibleChunks = _chunks;
+}
+
+/*
+ * Children of the node are stored contiguously, chunk ranges are inclusive
+ */
+void Terrain::buildQuadtree(uint32_t nodeIndex, const vec2i& firstChunk, const vec2i& lastChunk)
+{
+	vec2i size = lastChunk - firstChunk + vec2i(1);
+	vec2i half((size.x + 1) / 2, (size.y + 1) / 2);
+
+	_nodes[nodeIndex].firstChunk = firstChunk;
+	_nodes[nodeIndex].lastChunk = lastChunk;
+	_nodes[nodeIndex].firstChild = 0;
+	_nodes[nodeIndex].childrenCount = 0;
+
+	if ((size.x == 1) && (size.y == 1))
+	{
+		const AABB& aabb = _chunks[firstChunk.x + firstChunk.y * _chunkSizes.x]->aabb();
+		_nodes[nodeIndex].minVertex = aabb.minVertex();
+		_nodes[nodeIndex].maxVertex = aabb.maxVertex();
+		return;
+	}
+
+	vec2i childFirst[4];
+	vec2i childLast[4];
+	uint32_t childrenCount = 0;
+	for (int z = 0; z < 2; ++z)
+	{
+		for (int x = 0; x < 2; ++x)
+		{
+			vec2i first(firstChunk.x + x * half.x, firstChunk.y + z * half.y);
+			vec2i last(x ? lastChunk.x : first.x + half.x - 1, z ? lastChunk.y : first.y + half.y - 1);
+			if ((first.x > last.x) || (first.y > last.y)) continue;
+
+			childFirst[childrenCount] = first;
+			childLast[childrenCount] = last;
+			++childrenCount;
+		}
+	}
+
+	uint32_t firstChild = static_cast<uint32_t>(_nodes.size());
+	_nodes.resize(_nodes.size() + childrenCount);
+	_nodes[nodeIndex].firstChild = firstChild;
+	_nodes[nodeIndex].childrenCount = childrenCount;
+
+	for (uint32_t i = 0; i < childrenCount; ++i)
+		buildQuadtree(firstChild + i, childFirst[i], childLast[i]);
+
+	_nodes[nodeIndex].minVertex = _nodes[firstChild].minVertex;
+	_nodes[nodeIndex].maxVertex = _nodes[firstChild].maxVertex;
+	for (uint32_t i = 1; i < childrenCount; ++i)
+	{
+		_nodes[nodeIndex].minVertex = minv(_nodes[nodeIndex].minVertex, _nodes[firstChild + i].minVertex);
+		_nodes[nodeIndex].maxVertex = maxv(_nodes[nodeIndex].maxVertex, _nodes[firstChild + i].maxVertex);
+	}
 }
 
 void Terrain::recomputeLodLevels()
@@ -539,11 +727,158 @@ void Terrain::recomputeLodLevels()
 	validateLODLevels();
 }
 
+/*
+ * Morph ranges are computed from the largest error of each level over the whole terrain,
+ * chunks with smaller error could switch to the coarser level before morphing completes.
+ */
+void Terrain::recomputeLodLevels(const Camera& camera, float viewportHeight, JobSystem* jobSystem)
+{
+	if (_nodes.empty()) return;
+
+	LodSelection selection;
+	selection.frustum = camera.frustum();
+	selection.cameraPosition = camera.position();
+	selection.distanceScale = 0.5f * viewportHeight * camera.projectionMatrix()[1][1] / _maxScreenSpaceError;
+
+	float rangeStart = 0.0f;
+	for (int level = LodLevel0; level < LodLevel4; ++level)
+	{
+		float rangeEnd = _lodErrors[level + 1] * selection.distanceScale;
+		rangeStart = etMax(rangeStart, morphStart * rangeEnd);
+		_morphRanges[level] = vec2(rangeStart, 1.0f / etMax(rangeEnd - rangeStart, std::numeric_limits<float>::epsilon()));
+		rangeStart = etMax(rangeStart, rangeEnd);
+	}
+	_morphRanges[LodLevel4] = vec2(0.0f);
+
+	uint32_t allPlanes = (1u << FrustumPlane_max) - 1;
+	if ((jobSystem == nullptr) || (_chunks.size() < parallelSelectionThreshold))
+	{
+		selectLodLevels(0, allPlanes, selection, 0, nullptr, nullptr);
+	}
+	else
+	{
+		JobCounter counter;
+		selectLodLevels(0, allPlanes, selection, 0, jobSystem, &counter);
+		jobSystem->wait(counter);
+	}
+
+	validateLODLevels();
+}
+
+/*
+ * Bit of the plane is cleared, when node is completely inside of it, so children are not tested again
+ */
+void Terrain::selectLodLevels(uint32_t nodeIndex, uint32_t planeMask, const LodSelection& selection,
+	size_t depth, JobSystem* jobSystem, JobCounter* counter)
+{
+	const QuadtreeNode& node = _nodes[nodeIndex];
+
+	if (planeMask != 0)
+	{
+		vec3 center = 0.5f * (node.minVertex + node.maxVertex);
+		vec3 extent = 0.5f * (node.maxVertex - node.minVertex);
+
+		for (int p = FrustumPlane_Right; p < FrustumPlane_max; ++p)
+		{
+			if ((planeMask & (1u << p)) == 0) continue;
+
+			const vec4& plane = selection.frustum.plane(static_cast<FrustumPlane>(p));
+			float distance = dot(plane.xyz(), center) + plane.w;
+			float radius = dot(absv(plane.xyz()), extent);
+
+			if (distance + radius <= 0.0f)
+			{
+				hideChunks(node);
+				return;
+			}
+
+			if (distance - radius > 0.0f)
+				planeMask &= ~(1u << p);
+		}
+	}
+
+	if (node.childrenCount == 0)
+	{
+		TerrainChunk* chunk = _chunks[node.firstChunk.x + node.firstChunk.y * _chunkSizes.x];
+
+		vec3 toBox = maxv(node.minVertex - selection.cameraPosition, selection.cameraPosition - node.maxVertex);
+		float distance = maxv(toBox, vec3(0.0f)).length();
+
+		int level = LodLevel4;
+		while ((level > LodLevel0) && (chunk->lodError[level] * selection.distanceScale > distance))
+			--level;
+
+		chunk->selectedLod = level;
+		chunk->visible = true;
+		return;
+	}
+
+	for (uint32_t i = node.firstChild, e = node.firstChild + node.childrenCount; i < e; ++i)
+	{
+		if ((jobSystem != nullptr) && (depth + 1 == parallelSelectionDepth))
+			jobSystem->submit(new LodSelectionTask(this, i, planeMask, selection, depth + 1), counter);
+		else
+			selectLodLevels(i, planeMask, selection, depth + 1, jobSystem, counter);
+	}
+}
+
+/*
+ * Hidden chunks get the coarsest level, so they do not force neighbours to be detailed
+ */
+void Terrain::hideChunks(const QuadtreeNode& node)
+{
+	for (int z = node.firstChunk.y; z <= node.lastChunk.y; ++z)
+	{
+		for (int x = node.firstChunk.x; x <= node.lastChunk.x; ++x)
+		{
+			TerrainChunk* chunk = _chunks[x + z * _chunkSizes.x];
+			chunk->selectedLod = LodLevel4;
+			chunk->visible = false;
+		}
+	}
+}
+
+/*
+ * Transition patterns only join neighbouring levels, so levels of adjacent chunks
+ * are limited to differ by one. Two passes give the exact result for 4-connected grid.
+ */
+void Terrain::limitLodDifference()
+{
+	for (int z = 0; z < _chunkSizes.y; ++z)
+	{
+		for (int x = 0; x < _chunkSizes.x; ++x)
+		{
+			int& lod = _chunks[x + z * _chunkSizes.x]->selectedLod;
+			if (x > 0)
+				lod = etMin(lod, _chunks[x - 1 + z * _chunkSizes.x]->selectedLod + 1);
+			if (z > 0)
+				lod = etMin(lod, _chunks[x + (z - 1) * _chunkSizes.x]->selectedLod + 1);
+		}
+	}
+
+	for (int z = _chunkSizes.y - 1; z >= 0; --z)
+	{
+		for (int x = _chunkSizes.x - 1; x >= 0; --x)
+		{
+			int& lod = _chunks[x + z * _chunkSizes.x]->selectedLod;
+			if (x + 1 < _chunkSizes.x)
+				lod = etMin(lod, _chunks[x + 1 + z * _chunkSizes.x]->selectedLod + 1);
+			if (z + 1 < _chunkSizes.y)
+				lod = etMin(lod, _chunks[x + (z + 1) * _chunkSizes.x]->selectedLod + 1);
+		}
+	}
+}
+
 void Terrain::validateLODLevels()
 {
+	limitLodDifference();
+
+	_visibleChunks.clear();
 	for (ChunkIterator i = _chunks.begin(), e = _chunks.end(); i != e; ++i)
 	{
 		TerrainChunk* chunk = *i;
+		if (chunk->visible)
+			_visibleChunks.push_back(chunk);
 
 		if (chunk->selectedLod == 0)
 		{
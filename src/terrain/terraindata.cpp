@@ -5,23 +5,90 @@
  *
  */
 
+#include <algorithm>
+#include <et/geometry/simd.h>
 #include <et/collision/collision.h>
+#include <et/tasks/jobsystem.h>
 #include <et/terrain/terrain.h>
 #include <et/timers/intervaltimer.h>
 
 using namespace et;
 
-TerrainData::TerrainData(TerrainDataDelegate* aDelegate) : _delegate(aDelegate)
+namespace
 {
+	const size_t pointsPerJob = 1024;
+	const size_t spheresPerJob = 64;
 }
 
-TerrainData::TerrainData(TerrainDataDelegate* aDelegate, std::istream& stream, const vec2i& dimension, Format format) : _delegate(aDelegate)
+struct TerrainData::Batch
+{
+	enum Query
+	{
+		Query_Heights,
+		Query_Normals,
+		Query_Contacts,
+		Query_GatherContacts
+	};
+
+	Query query;
+	size_t count;
+	size_t itemsPerJob;
+
+	const vec3* points;
+	const Sphere* spheres;
+
+	float* heights;
+	vec3* normals;
+	TerrainContact* contacts;
+	size_t* contactsCount;
+
+	/*
+	 * Gathered contacts of each job, jobs process consecutive ranges of spheres
+	 */
+	std::vector<std::vector<TerrainContact>> gathered;
+
+	Batch(Query q, size_t c, size_t perJob) : query(q), count(c), itemsPerJob(perJob), points(nullptr),
+		spheres(nullptr), heights(nullptr), normals(nullptr), contacts(nullptr), contactsCount(nullptr) { }
+};
+
+class TerrainData::BatchTask : public Task
+{
+public:
+	BatchTask(const TerrainData* owner, Batch& batch, size_t begin, size_t end) :
+		_owner(owner), _batch(batch), _begin(begin), _end(end) { }
+
+private:
+	void execute()
+		{ _owner->processBatch(_batch, _begin, _end); }
+
+private:
+	const TerrainData* _owner;
+	Batch& _batch;
+	size_t _begin;
+	size_t _end;
+};
+
+TerrainData::TerrainData(TerrainDataDelegate* aDelegate) : _delegate(aDelegate), _tiles(nullptr),
+	_residentMemory(0), _useCounter(0), _memoryBudget(0), _morphDataEnabled(false)
+{
+}
+
+TerrainData::TerrainData(TerrainDataDelegate* aDelegate, std::istream& stream, const vec2i& dimension, Format format) : 
+	_delegate(aDelegate), _tiles(nullptr), _residentMemory(0), _useCounter(0), _memoryBudget(0),
+	_morphDataEnabled(false)
 {
 	loadFromStream(stream, dimension, format);
 }
 
+TerrainData::~TerrainData()
+{
+	releaseTiles();
+}
+
 void TerrainData::loadFromStream(std::istream& stream, const vec2i& dimension, Format format)
 {
+	releaseTiles();
+
 	_dimension = dimension;
 	_dimensionf.x = static_cast<float>(dimension.x - 1);
 	_dimensionf.y = static_cast<float>(dimension.y - 1);
@@ -61,6 +128,9 @@ void TerrainData::generateVertexData(const FloatDataStorage& hm)
 	decl.push_back(Usage_TexCoord0, Type_Vec2);
 	decl.push_back(Usage_Tangent, Type_Vec3);
 
+	if (_morphDataEnabled)
+		decl.push_back(Usage_TexCoord1, Type_Vec4);
+
 	_vertexData.reset(new VertexArray(decl, _dimension.square()));
 
 	RawDataAcessor<vec3> pos = _vertexData->chunk(Usage_Position).accessData<vec3>(0);
@@ -123,6 +193,175 @@ void TerrainData::generateVertexData(const FloatDataStorage& hm)
 		_normals.push_back(nrm[i]);
 }
 
+void TerrainData::releaseTiles()
+{
+	CriticalSectionScope lock(_tilesLock);
+
+	delete _tiles;
+	_tiles = nullptr;
+
+	_streamedTiles.clear();
+	_residentTiles.clear();
+	_residentMemory = 0;
+}
+
+bool TerrainData::loadFromTiledFile(const std::string& fileName, size_t memoryBudget)
+{
+	releaseTiles();
+
+	TerrainTiles* tiles = new TerrainTiles(fileName);
+	if (!tiles->valid())
+	{
+		delete tiles;
+		return false;
+	}
+
+	CriticalSectionScope lock(_tilesLock);
+
+	_positions.resize(0);
+	_normals.resize(0);
+	_vertexData.reset(nullptr);
+
+	_tiles = tiles;
+	_memoryBudget = memoryBudget;
+	_streamedTiles.resize(static_cast<size_t>(tiles->tilesCount().square()));
+
+	_dimension = tiles->dimension();
+	_dimensionf.x = static_cast<float>(_dimension.x - 1);
+	_dimensionf.y = static_cast<float>(_dimension.y - 1);
+
+	_minVertex = processedPosition(vec2i(0), tiles->minHeight());
+	_maxVertex = _minVertex;
+	for (int i = 0; i < 8; ++i)
+	{
+		vec2i corner((i & 1) ? _dimension.x - 1 : 0, (i & 2) ? _dimension.y - 1 : 0);
+		vec3 p = processedPosition(corner, (i & 4) ? tiles->maxHeight() : tiles->minHeight());
+		_minVertex = minv(_minVertex, p);
+		_maxVertex = maxv(_maxVertex, p);
+	}
+	_bounds = AABB(0.5f * (_minVertex + _maxVertex), _maxVertex - _minVertex);
+
+	return true;
+}
+
+void TerrainData::updateStreaming(const vec3& center, float radius)
+{
+	if (!streaming()) return;
+
+	CriticalSectionScope lock(_tilesLock);
+
+	int ts = _tiles->tileSize();
+	vec3 radiusVector(radius, 0.0f, radius);
+	vec2 p0 = normalizePoint(center - radiusVector);
+	vec2 p1 = normalizePoint(center + radiusVector);
+	vec2 c = normalizePoint(center);
+
+	vec2i t0(static_cast<int>(p0.x) / ts, static_cast<int>(p0.y) / ts);
+	vec2i t1(static_cast<int>(p1.x) / ts, static_cast<int>(p1.y) / ts);
+
+	std::vector<std::pair<float, size_t>> candidates;
+	for (int z = t0.y; z <= t1.y; ++z)
+	{
+		for (int x = t0.x; x <= t1.x; ++x)
+		{
+			vec2 tileCenter((static_cast<float>(x) + 0.5f) * static_cast<float>(ts), (static_cast<float>(z) + 0.5f) * static_cast<float>(ts));
+			candidates.push_back(std::make_pair((tileCenter - c).dotSelf(), _tiles->tileIndex(x * ts, z * ts)));
+		}
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	/*
+	 * Nearest tiles are touched last, so they are evicted last
+	 */
+	size_t tileMemory = static_cast<size_t>(ts * ts) * 2 * sizeof(vec3);
+	size_t count = etMin(candidates.size(), etMax(size_t(1), _memoryBudget / tileMemory));
+	for (size_t i = count; i > 0; --i)
+		residentTile(candidates[i - 1].second);
+}
+
+vec3 TerrainData::processedPosition(const vec2i& xy, float height) const
+{
+	vec3 result(static_cast<float>(xy.x) / _dimensionf.x, height, static_cast<float>(xy.y) / _dimensionf.y);
+	return _delegate ? _delegate->processTerrainVertex(this, result, xy) : result;
+}
+
+const TerrainData::StreamedTile& TerrainData::residentTile(size_t index) const
+{
+	StreamedTile& tile = _streamedTiles[index];
+	if (tile.positions.empty())
+		loadTile(index);
+
+	tile.lastUse = ++_useCounter;
+	return tile;
+}
+
+/*
+ * Normals are computed with central differences, samples of neighbour tiles are read from the mapping,
+ * pages of all touched tiles are discarded afterwards.
+ */
+void TerrainData::loadTile(size_t index) const
+{
+	int ts = _tiles->tileSize();
+	size_t tileMemory = static_cast<size_t>(ts * ts) * 2 * sizeof(vec3);
+
+	while (!_residentTiles.empty() && (_residentMemory + tileMemory > _memoryBudget))
+	{
+		auto oldest = _residentTiles.begin();
+		for (auto i = _residentTiles.begin(), e = _residentTiles.end(); i != e; ++i)
+		{
+			if (_streamedTiles[*i].lastUse < _streamedTiles[*oldest].lastUse)
+				oldest = i;
+		}
+
+		StreamedTile& evicted = _streamedTiles[*oldest];
+		std::vector<vec3>().swap(evicted.positions);
+		std::vector<vec3>().swap(evicted.normals);
+
+		*oldest = _residentTiles.back();
+		_residentTiles.pop_back();
+		_residentMemory -= tileMemory;
+	}
+
+	const vec2i& tilesCount = _tiles->tilesCount();
+	vec2i tile(static_cast<int>(index) % tilesCount.x, static_cast<int>(index) / tilesCount.x);
+	vec2i origin = tile * ts;
+
+	int bs = ts + 2;
+	std::vector<vec3> bordered(static_cast<size_t>(bs * bs));
+	for (int z = 0; z < bs; ++z)
+	{
+		for (int x = 0; x < bs; ++x)
+		{
+			vec2i p(clamp(origin.x + x - 1, 0, _dimension.x - 1), clamp(origin.y + z - 1, 0, _dimension.y - 1));
+			bordered[static_cast<size_t>(x + z * bs)] = processedPosition(p, _tiles->heightAtXZ(p.x, p.y));
+		}
+	}
+
+	StreamedTile& result = _streamedTiles[index];
+	result.positions.resize(static_cast<size_t>(ts * ts));
+	result.normals.resize(static_cast<size_t>(ts * ts));
+	for (int z = 0; z < ts; ++z)
+	{
+		for (int x = 0; x < ts; ++x)
+		{
+			size_t i = static_cast<size_t>((x + 1) + (z + 1) * bs);
+			vec3 dx = bordered[i + 1] - bordered[i - 1];
+			vec3 dz = bordered[i + static_cast<size_t>(bs)] - bordered[i - static_cast<size_t>(bs)];
+			result.positions[static_cast<size_t>(x + z * ts)] = bordered[i];
+			result.normals[static_cast<size_t>(x + z * ts)] = normalize(cross(dz, dx));
+		}
+	}
+
+	_residentTiles.push_back(index);
+	_residentMemory += tileMemory;
+
+	for (int z = etMax(0, tile.y - 1), ze = etMin(tilesCount.y - 1, tile.y + 1); z <= ze; ++z)
+	{
+		for (int x = etMax(0, tile.x - 1), xe = etMin(tilesCount.x - 1, tile.x + 1); x <= xe; ++x)
+			_tiles->discardTile(static_cast<size_t>(x + z * tilesCount.x));
+	}
+}
+
 vec3 TerrainData::normalAtNormalizedPoint(const vec2& normalized) const
 {
 	vec2i p00(static_cast<int>(normalized.x), static_cast<int>(normalized.y));
@@ -131,7 +370,7 @@ vec3 TerrainData::normalAtNormalizedPoint(const vec2& normalized) const
 	vec2 dp(normalized.x - static_cast<float>(p00.x), normalized.y - static_cast<float>(p00.y));
 
 	vec3 n00 = normalAtXZ(p00);
-	vec3 n11 = normalAtXZ(p00);
+	vec3 n11 = normalAtXZ(p11);
 
 	if (dp.y > dp.x)
 	{
@@ -147,6 +386,7 @@ vec3 TerrainData::normalAtNormalizedPoint(const vec2& normalized) const
 
 vec3 TerrainData::normalAtPoint(const vec3& pt) const
 {
+	CriticalSectionScope lock(_tilesLock);
 	return normalAtNormalizedPoint(normalizePoint(pt));
 }
 
@@ -158,7 +398,7 @@ float TerrainData::heightAtNormalizedPoint(const vec2& normalized) const
 	vec2 dp(normalized.x - static_cast<float>(p00.x), normalized.y - static_cast<float>(p00.y));
 
 	float h00 = heightAtXZ(p00);
-	float h11 = heightAtXZ(p00);
+	float h11 = heightAtXZ(p11);
 
 	if (dp.y > dp.x)
 	{
@@ -174,37 +414,31 @@ float TerrainData::heightAtNormalizedPoint(const vec2& normalized) const
 
 float TerrainData::heightAtPoint(const vec3& pt) const
 {
+	CriticalSectionScope lock(_tilesLock);
 	return heightAtNormalizedPoint(normalizePoint(pt));
 }
 
-const vec3& TerrainData::normalAtIndex(int index) const
+vec3 TerrainData::normalAtXZ(const vec2i& xy) const
 {
-	return _normals[index];
-}
+	if (_tiles == nullptr)
+		return _normals[xy.x + _dimension.x * xy.y];
 
-const vec3& TerrainData::normalAtXZ(const vec2i& xy) const
-{
-	return _normals[xy.x + _dimension.x * xy.y];
-}
-
-float TerrainData::heightAtIndex(int index) const
-{
-	return _positions[index].y;
+	int ts = _tiles->tileSize();
+	return residentTile(_tiles->tileIndex(xy.x, xy.y)).normals[static_cast<size_t>((xy.x % ts) + (xy.y % ts) * ts)];
 }
 
 float TerrainData::heightAtXZ(const vec2i& xy) const
 {
-	return _positions[xy.x + _dimension.x * xy.y].y;
+	return positionAtXZ(xy).y;
 }
 
-const vec3& TerrainData::positionAtIndex(int index) const
+vec3 TerrainData::positionAtXZ(const vec2i& xy) const
 {
-	return _positions[index];
-}
+	if (_tiles == nullptr)
+		return _positions[xy.x + _dimension.x * xy.y];
 
-const vec3& TerrainData::positionAtXZ(const vec2i& xy) const
-{
-	return _positions[xy.x + _dimension.x * xy.y];
+	int ts = _tiles->tileSize();
+	return residentTile(_tiles->tileIndex(xy.x, xy.y)).positions[static_cast<size_t>((xy.x % ts) + (xy.y % ts) * ts)];
 }
 
 vec2 TerrainData::normalizePoint(const vec3& pt) const
@@ -247,47 +481,47 @@ triangle TerrainData::triangleForXZ(const vec2i& pt0, int side) const
 	return triangle(v1, v2, v3);
 }
 
-TerrainContact TerrainData::contactForSphere(const Sphere& s) const
+template <typename F>
+void TerrainData::enumerateSphereContacts(const Sphere& s, F callback) const
 {
 	vec3 radiusVector(s.radius(), 0.0f, s.radius());
 	vec2 leftTopProj = normalizePoint(s.center() - radiusVector);
 	vec2 rightBottomProj = normalizePoint(s.center() + radiusVector);
-
 	vec2i leftTopIndex(static_cast<int>(leftTopProj.x), static_cast<int>(leftTopProj.y));
 	vec2i rightBottomIndex(static_cast<int>(rightBottomProj.x), static_cast<int>(rightBottomProj.y));
 
-	TerrainContact t;
-
 	float squareRadius = sqr(s.radius());
-	int numPoints = 0;
 
 	for (int y = leftTopIndex.y; y <= rightBottomIndex.y; ++y)
 	{
 		for (int x = leftTopIndex.x; x <= rightBottomIndex.x; ++x)
 		{
 			triangle t1 = triangleForXZ(vec2i(x, y), 0);
-			triangle t2 = triangleForXZ(vec2i(x, y), 1);
 			vec3 projCtoP1 = plane(t1).projectionOfPoint(s.center());
-			vec3 projCtoP2 = plane(t2).projectionOfPoint(s.center());
 			float d1 = (projCtoP1 - s.center()).dotSelf();
-			float d2 = (projCtoP1 - s.center()).dotSelf();
-
 			if ((d1 <= squareRadius) && (pointInsideTriangle(projCtoP1, t1)))
-			{
-				++numPoints;
-				t.normal += t1.normalizedNormal();
-				t.point += projCtoP1;
-			}
+				callback(projCtoP1, t1.normalizedNormal());
 
+			triangle t2 = triangleForXZ(vec2i(x, y), 1);
+			vec3 projCtoP2 = plane(t2).projectionOfPoint(s.center());
+			float d2 = (projCtoP2 - s.center()).dotSelf();
 			if ((d2 <= squareRadius) && (pointInsideTriangle(projCtoP2, t2)))
-			{
-				++numPoints;
-				t.normal += t2.normalizedNormal();
-				t.point += projCtoP2;
-			}
-
+				callback(projCtoP2, t2.normalizedNormal());
 		}
 	}
+}
+
+TerrainContact TerrainData::averageContactForSphere(const Sphere& s) const
+{
+	TerrainContact t;
+	int numPoints = 0;
+
+	enumerateSphereContacts(s, [&t, &numPoints](const vec3& point, const vec3& normal)
+	{
+		++numPoints;
+		t.normal += normal;
+		t.point += point;
+	});
 
 	t.contacted = numPoints > 0;
 	if (t.contacted)
@@ -299,31 +533,305 @@ TerrainContact TerrainData::contactForSphere(const Sphere& s) const
 	return t;
 }
 
+TerrainContact TerrainData::contactForSphere(const Sphere& s) const
+{
+	CriticalSectionScope lock(_tilesLock);
+	return averageContactForSphere(s);
+}
+
 void TerrainData::gatherContactsForSphere(const Sphere& s, TerrainDataDelegate* contactDelegate) const
 {
-	vec3 radiusVector(s.radius(), 0.0f, s.radius());
-	vec2 leftTopProj = normalizePoint(s.center() - radiusVector);
-	vec2 rightBottomProj = normalizePoint(s.center() + radiusVector);
-	vec2i leftTopIndex(static_cast<int>(leftTopProj.x), static_cast<int>(leftTopProj.y));
-	vec2i rightBottomIndex(static_cast<int>(rightBottomProj.x), static_cast<int>(rightBottomProj.y));
+	CriticalSectionScope lock(_tilesLock);
 
-	float squareRadius = sqr(s.radius());
+	enumerateSphereContacts(s, [contactDelegate](const vec3& point, const vec3& normal)
+		{ contactDelegate->terrainDataDidFindContact(TerrainContact(point, normalize(normal), true)); });
+}
 
-	for (int y = leftTopIndex.y; y <= rightBottomIndex.y; ++y)
+void TerrainData::heightsAtPoints(const std::vector<vec3>& points, std::vector<float>& heights,
+	JobSystem* jobSystem) const
+{
+	heights.resize(points.size());
+
+	Batch batch(Batch::Query_Heights, points.size(), pointsPerJob);
+	batch.points = points.data();
+	batch.heights = heights.data();
+	processBatch(batch, jobSystem);
+}
+
+void TerrainData::normalsAtPoints(const std::vector<vec3>& points, std::vector<vec3>& normals,
+	JobSystem* jobSystem) const
+{
+	normals.resize(points.size());
+
+	Batch batch(Batch::Query_Normals, points.size(), pointsPerJob);
+	batch.points = points.data();
+	batch.normals = normals.data();
+	processBatch(batch, jobSystem);
+}
+
+void TerrainData::contactsForSpheres(const std::vector<Sphere>& spheres, std::vector<TerrainContact>& contacts,
+	JobSystem* jobSystem) const
+{
+	contacts.resize(spheres.size());
+
+	Batch batch(Batch::Query_Contacts, spheres.size(), spheresPerJob);
+	batch.spheres = spheres.data();
+	batch.contacts = contacts.data();
+	processBatch(batch, jobSystem);
+}
+
+/*
+ * Each job gathers contacts into its own list, lists are concatenated in the order of spheres
+ */
+void TerrainData::gatherContactsForSpheres(const std::vector<Sphere>& spheres, std::vector<TerrainContact>& contacts,
+	std::vector<size_t>& firstContact, JobSystem* jobSystem) const
+{
+	firstContact.resize(spheres.size() + 1);
+	firstContact[0] = 0;
+
+	Batch batch(Batch::Query_GatherContacts, spheres.size(), spheresPerJob);
+	batch.spheres = spheres.data();
+	batch.contactsCount = firstContact.data() + 1;
+	batch.gathered.resize(etMax(size_t(1), (spheres.size() + spheresPerJob - 1) / spheresPerJob));
+	processBatch(batch, jobSystem);
+
+	for (size_t i = 1, e = firstContact.size(); i < e; ++i)
+		firstContact[i] += firstContact[i - 1];
+
+	contacts.clear();
+	contacts.reserve(firstContact.back());
+	for (const auto& g : batch.gathered)
+		contacts.insert(contacts.end(), g.begin(), g.end());
+}
+
+/*
+ * Heightfield is not modified by queries without streaming, so jobs do not take the lock
+ */
+void TerrainData::processBatch(Batch& batch, JobSystem* jobSystem) const
+{
+	if (streaming())
 	{
-		for (int x = leftTopIndex.x; x <= rightBottomIndex.x; ++x)
+		CriticalSectionScope lock(_tilesLock);
+		processBatch(batch, 0, batch.count);
+		return;
+	}
+
+	if ((jobSystem == nullptr) || (batch.count <= batch.itemsPerJob))
+	{
+		processBatch(batch, 0, batch.count);
+		return;
+	}
+
+	JobCounter counter;
+	for (size_t begin = 0; begin < batch.count; begin += batch.itemsPerJob)
+		jobSystem->submit(new BatchTask(this, batch, begin, etMin(begin + batch.itemsPerJob, batch.count)), &counter);
+
+	jobSystem->wait(counter);
+}
+
+void TerrainData::processBatch(Batch& batch, size_t begin, size_t end) const
+{
+	switch (batch.query)
+	{
+		case Batch::Query_Heights:
 		{
-			triangle t1 = triangleForXZ(vec2i(x, y), 0);
-			vec3 projCtoP1 = plane(t1).projectionOfPoint(s.center());
-			float d1 = (projCtoP1 - s.center()).dotSelf();
-			if ((d1 <= squareRadius) && (pointInsideTriangle(projCtoP1, t1)))
-				contactDelegate->terrainDataDidFindContact(TerrainContact(projCtoP1, normalize(t1.normalizedNormal()), true));
+			for (size_t i = sampleHeights(batch.points, batch.heights, begin, end); i < end; ++i)
+				batch.heights[i] = heightAtNormalizedPoint(normalizePoint(batch.points[i]));
+			break;
+		}
 
-			triangle t2 = triangleForXZ(vec2i(x, y), 1);
-			vec3 projCtoP2 = plane(t2).projectionOfPoint(s.center());
-			float d2 = (projCtoP1 - s.center()).dotSelf();
-			if ((d2 <= squareRadius) && (pointInsideTriangle(projCtoP2, t2)))
-				contactDelegate->terrainDataDidFindContact(TerrainContact(projCtoP2, normalize(t2.normalizedNormal()), true));
+		case Batch::Query_Normals:
+		{
+			for (size_t i = sampleNormals(batch.points, batch.normals, begin, end); i < end; ++i)
+				batch.normals[i] = normalAtNormalizedPoint(normalizePoint(batch.points[i]));
+			break;
+		}
+
+		case Batch::Query_Contacts:
+		{
+			for (size_t i = begin; i < end; ++i)
+				batch.contacts[i] = averageContactForSphere(batch.spheres[i]);
+			break;
+		}
+
+		case Batch::Query_GatherContacts:
+		{
+			std::vector<TerrainContact>& gathered = batch.gathered[begin / batch.itemsPerJob];
+			for (size_t i = begin; i < end; ++i)
+			{
+				size_t gatheredBefore = gathered.size();
+				enumerateSphereContacts(batch.spheres[i], [&gathered](const vec3& point, const vec3& normal)
+					{ gathered.push_back(TerrainContact(point, normalize(normal), true)); });
+				batch.contactsCount[i] = gathered.size() - gatheredBefore;
+			}
+			break;
+		}
+	}
+}
+
+#if (ET_SIMD)
+
+/*
+ * Samples are interpolated over the same triangles as in heightAtNormalizedPoint:
+ * both halves of the cell are evaluated and selected by mask.
+ */
+size_t TerrainData::sampleHeights(const vec3* points, float* heights, size_t begin, size_t end) const
+{
+	if (streaming() || (_positions.size() == 0)) return begin;
+
+	simd::float4 zero = simd::splat(0.0f);
+	simd::float4 one = simd::splat(1.0f);
+	simd::float4 minX = simd::splat(_minVertex.x);
+	simd::float4 minZ = simd::splat(_minVertex.z);
+	simd::float4 scaleX = simd::splat(1.0f / _bounds.dimension.x);
+	simd::float4 scaleZ = simd::splat(1.0f / _bounds.dimension.z);
+	simd::float4 dimX = simd::splat(_dimensionf.x);
+	simd::float4 dimZ = simd::splat(_dimensionf.y);
+
+	const vec3* positions = _positions.data();
+	int lastX = _dimension.x - 1;
+	int lastZ = _dimension.y - 1;
+
+	int ix[4];
+	int iz[4];
+	float h00[4];
+	float h11[4];
+	float h10[4];
+	float h01[4];
+
+	for (; begin + 4 <= end; begin += 4)
+	{
+		const vec3* p = points + begin;
+		simd::float4 x = simd::set(p[0].x, p[1].x, p[2].x, p[3].x);
+		simd::float4 z = simd::set(p[0].z, p[1].z, p[2].z, p[3].z);
+		x = simd::mul(dimX, simd::min(one, simd::max(zero, simd::mul(simd::sub(x, minX), scaleX))));
+		z = simd::mul(dimZ, simd::min(one, simd::max(zero, simd::mul(simd::sub(z, minZ), scaleZ))));
+
+		simd::truncate(x, ix);
+		simd::truncate(z, iz);
+		simd::float4 dx = simd::sub(x, simd::truncate(x));
+		simd::float4 dz = simd::sub(z, simd::truncate(z));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			int row0 = iz[i] * _dimension.x;
+			int row1 = etMin(iz[i] + 1, lastZ) * _dimension.x;
+			int x1 = etMin(ix[i] + 1, lastX);
+			h00[i] = positions[ix[i] + row0].y;
+			h11[i] = positions[x1 + row1].y;
+			h10[i] = positions[ix[i] + row1].y;
+			h01[i] = positions[x1 + row0].y;
+		}
+
+		simd::float4 v00 = simd::load(h00);
+		simd::float4 v11 = simd::load(h11);
+		simd::float4 v10 = simd::load(h10);
+		simd::float4 v01 = simd::load(h01);
+
+		simd::float4 upper = simd::add(v10, simd::add(simd::mul(simd::sub(one, dz), simd::sub(v00, v10)),
+			simd::mul(dx, simd::sub(v11, v10))));
+		simd::float4 lower = simd::add(v01, simd::add(simd::mul(dz, simd::sub(v11, v01)),
+			simd::mul(simd::sub(one, dx), simd::sub(v00, v01))));
+
+		simd::store(heights + begin, simd::selectGreater(dz, dx, upper, lower));
+	}
+
+	return begin;
+}
+
+/*
+ * Components of the corner normals are gathered into separate vectors
+ */
+size_t TerrainData::sampleNormals(const vec3* points, vec3* normals, size_t begin, size_t end) const
+{
+	if (streaming() || (_normals.size() == 0)) return begin;
+
+	simd::float4 zero = simd::splat(0.0f);
+	simd::float4 one = simd::splat(1.0f);
+	simd::float4 minX = simd::splat(_minVertex.x);
+	simd::float4 minZ = simd::splat(_minVertex.z);
+	simd::float4 scaleX = simd::splat(1.0f / _bounds.dimension.x);
+	simd::float4 scaleZ = simd::splat(1.0f / _bounds.dimension.z);
+	simd::float4 dimX = simd::splat(_dimensionf.x);
+	simd::float4 dimZ = simd::splat(_dimensionf.y);
+
+	const vec3* source = _normals.data();
+	int lastX = _dimension.x - 1;
+	int lastZ = _dimension.y - 1;
+
+	int ix[4];
+	int iz[4];
+	float n00[3][4];
+	float n11[3][4];
+	float n10[3][4];
+	float n01[3][4];
+	float result[3][4];
+
+	for (; begin + 4 <= end; begin += 4)
+	{
+		const vec3* p = points + begin;
+		simd::float4 x = simd::set(p[0].x, p[1].x, p[2].x, p[3].x);
+		simd::float4 z = simd::set(p[0].z, p[1].z, p[2].z, p[3].z);
+		x = simd::mul(dimX, simd::min(one, simd::max(zero, simd::mul(simd::sub(x, minX), scaleX))));
+		z = simd::mul(dimZ, simd::min(one, simd::max(zero, simd::mul(simd::sub(z, minZ), scaleZ))));
+
+		simd::truncate(x, ix);
+		simd::truncate(z, iz);
+		simd::float4 dx = simd::sub(x, simd::truncate(x));
+		simd::float4 dz = simd::sub(z, simd::truncate(z));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			int row0 = iz[i] * _dimension.x;
+			int row1 = etMin(iz[i] + 1, lastZ) * _dimension.x;
+			int x1 = etMin(ix[i] + 1, lastX);
+			const vec3& a00 = source[ix[i] + row0];
+			const vec3& a11 = source[x1 + row1];
+			const vec3& a10 = source[ix[i] + row1];
+			const vec3& a01 = source[x1 + row0];
+			for (int c = 0; c < 3; ++c)
+			{
+				n00[c][i] = a00[c];
+				n11[c][i] = a11[c];
+				n10[c][i] = a10[c];
+				n01[c][i] = a01[c];
+			}
 		}
+
+		simd::float4 n[3];
+		for (int c = 0; c < 3; ++c)
+		{
+			simd::float4 v00 = simd::load(n00[c]);
+			simd::float4 v11 = simd::load(n11[c]);
+			simd::float4 v10 = simd::load(n10[c]);
+			simd::float4 v01 = simd::load(n01[c]);
+
+			simd::float4 upper = simd::add(v10, simd::add(simd::mul(simd::sub(one, dz), simd::sub(v00, v10)),
+				simd::mul(dx, simd::sub(v11, v10))));
+			simd::float4 lower = simd::add(v01, simd::add(simd::mul(dz, simd::sub(v11, v01)),
+				simd::mul(simd::sub(one, dx), simd::sub(v00, v01))));
+
+			n[c] = simd::selectGreater(dz, dx, upper, lower);
+		}
+
+		simd::float4 lengthSquared = simd::add(simd::mul(n[0], n[0]), simd::add(simd::mul(n[1], n[1]), simd::mul(n[2], n[2])));
+		simd::float4 scale = simd::inverseSqrt(lengthSquared);
+		for (int c = 0; c < 3; ++c)
+			simd::store(result[c], simd::mul(n[c], scale));
+
+		for (int i = 0; i < 4; ++i)
+			normals[begin + static_cast<size_t>(i)] = vec3(result[0][i], result[1][i], result[2][i]);
 	}
-}
\ No newline at end of file
+
+	return begin;
+}
+
+#else
+
+size_t TerrainData::sampleHeights(const vec3*, float*, size_t begin, size_t) const
+	{ return begin; }
+
+size_t TerrainData::sampleNormals(const vec3*, vec3*, size_t begin, size_t) const
+	{ return begin; }
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <fstream>
+#include <et/terrain/terraintiles.h>
+
+using namespace et;
+
+namespace
+{
+	const uint32_t terrainTilesMagic = ET_COMPOSE_UINT32('E', 'T', 'T', 'L');
+	const uint32_t terrainTilesVersion = 1;
+}
+
+bool TerrainTiles::convertRAW(std::istream& stream, const vec2i& dimension, bool sixteenBits,
+	const std::string& outputFile, int tileSize)
+{
+	if ((tileSize <= 0) || (dimension.x <= 0) || (dimension.y <= 0)) return false;
+
+	std::ofstream output(outputFile.c_str(), std::ios::out | std::ios::binary);
+	if (output.fail())
+	{
+		log::error("Unable to create file: %s", outputFile.c_str());
+		return false;
+	}
+
+	Header header = { };
+	header.magic = terrainTilesMagic;
+	header.version = terrainTilesVersion;
+	header.width = dimension.x;
+	header.height = dimension.y;
+	header.tileSize = tileSize;
+	header.tilesX = (dimension.x + tileSize - 1) / tileSize;
+	header.tilesY = (dimension.y + tileSize - 1) / tileSize;
+	header.minSample = std::numeric_limits<uint16_t>::max();
+	header.maxSample = 0;
+
+	/*
+	 * Header is written again when all samples are known
+	 */
+	std::vector<char> headerData(HeaderSize, 0);
+	output.write(headerData.data(), HeaderSize);
+
+	size_t sampleSize = sixteenBits ? sizeof(uint16_t) : sizeof(uint8_t);
+	std::vector<unsigned char> rawRow(static_cast<size_t>(dimension.x) * sampleSize);
+	std::vector<uint16_t> rows(static_cast<size_t>(tileSize * dimension.x));
+	std::vector<uint16_t> tile(static_cast<size_t>(tileSize * tileSize));
+
+	for (int tz = 0; tz < header.tilesY; ++tz)
+	{
+		int rowsCount = etMin(tileSize, dimension.y - tz * tileSize);
+		for (int r = 0; r < rowsCount; ++r)
+		{
+			stream.read(reinterpret_cast<char*>(rawRow.data()), static_cast<std::streamsize>(rawRow.size()));
+			if (stream.fail())
+			{
+				log::error("Unexpected end of heightmap data");
+				return false;
+			}
+
+			uint16_t* row = rows.data() + r * dimension.x;
+			for (int x = 0; x < dimension.x; ++x)
+			{
+				row[x] = sixteenBits ? reinterpret_cast<const uint16_t*>(rawRow.data())[x] :
+					static_cast<uint16_t>(rawRow[static_cast<size_t>(x)] * 257);
+
+				header.minSample = etMin(header.minSample, row[x]);
+				header.maxSample = etMax(header.maxSample, row[x]);
+			}
+		}
+
+		for (int tx = 0; tx < header.tilesX; ++tx)
+		{
+			for (int z = 0; z < tileSize; ++z)
+			{
+				const uint16_t* row = rows.data() + etMin(z, rowsCount - 1) * dimension.x;
+				for (int x = 0; x < tileSize; ++x)
+					tile[static_cast<size_t>(x + z * tileSize)] = row[etMin(tx * tileSize + x, dimension.x - 1)];
+			}
+			output.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size() * sizeof(uint16_t)));
+		}
+	}
+
+	etCopyMemory(headerData.data(), &header, sizeof(header));
+	output.seekp(0);
+	output.write(headerData.data(), HeaderSize);
+
+	return !output.fail();
+}
+
+TerrainTiles::TerrainTiles(const std::string& fileName) :
+	_file(fileName), _header(nullptr)
+{
+	if (!_file.valid() || (_file.size() < HeaderSize)) return;
+
+	const Header* header = reinterpret_cast<const Header*>(_file.data());
+	if ((header->magic != terrainTilesMagic) || (header->version != terrainTilesVersion) || (header->tileSize <= 0))
+	{
+		log::error("Invalid terrain tiles file: %s", fileName.c_str());
+		return;
+	}
+
+	size_t tileSize = static_cast<size_t>(header->tileSize * header->tileSize) * sizeof(uint16_t);
+	if (_file.size() < HeaderSize + static_cast<size_t>(header->tilesX * header->tilesY) * tileSize)
+	{
+		log::error("Terrain tiles file is truncated: %s", fileName.c_str());
+		return;
+	}
+
+	_header = header;
+	_dimension = vec2i(header->width, header->height);
+	_tilesCount = vec2i(header->tilesX, header->tilesY);
+}
+
+void TerrainTiles::prefetchTile(size_t index)
+{
+	_file.prefetch(tileOffset(index), tileDataSize());
+}
+
+void TerrainTiles::discardTile(size_t index)
+{
+	_file.discard(tileOffset(index), tileDataSize());
+}
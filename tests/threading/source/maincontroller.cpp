@@ -1,8 +1,314 @@
+#include <et/threading/criticalsection.h>
+#include <et/tasks/taskpool.h>
+#include <et/geometry/rectplacer.h>
+#include <et/collision/broadphase.h>
 #include "maincontroller.h"
 
 using namespace et;
 using namespace demo;
 
+/*
+ * Benchmarks are run when application is loaded, if defined to 1
+ */
+#if !defined(ET_THREADING_TESTS_BENCHMARKS)
+#	define ET_THREADING_TESTS_BENCHMARKS	0
+#endif
+
+#if (ET_THREADING_TESTS_BENCHMARKS)
+
+/*
+ * Post / drain throughput benchmark:
+ * run loop inbox (TaskPool) against tasks list guarded by critical section
+ */
+namespace
+{
+	const size_t benchmarkProducers = 4;
+	const size_t benchmarkTasksPerProducer = 100000;
+	
+	class BenchmarkTask : public Task
+	{
+	public:
+		BenchmarkTask(AtomicCounter& c) :
+			_counter(c) { }
+		
+		void execute()
+			{ _counter.retain(); }
+		
+	private:
+		BenchmarkTask& operator = (const BenchmarkTask&)
+			{ return *this; }
+		
+	private:
+		AtomicCounter& _counter;
+	};
+	
+	class LockedTaskList
+	{
+	public:
+		void addTask(BenchmarkTask* t, float)
+		{
+			CriticalSectionScope lock(_csModifying);
+			_tasks.push_back(t);
+		}
+		
+		void update(float)
+		{
+			std::list<BenchmarkTask*> tasks;
+			{
+				CriticalSectionScope lock(_csModifying);
+				tasks.swap(_tasks);
+			}
+			
+			for (auto t : tasks)
+			{
+				t->execute();
+				delete t;
+			}
+		}
+		
+	private:
+		CriticalSection _csModifying;
+		std::list<BenchmarkTask*> _tasks;
+	};
+	
+	template <typename Q>
+	class BenchmarkProducer : public Thread
+	{
+	public:
+		BenchmarkProducer(Q& q, AtomicCounter& c) :
+			Thread(false), _queue(q), _counter(c) { }
+		
+		ThreadResult main()
+		{
+			for (size_t i = 0; i < benchmarkTasksPerProducer; ++i)
+				_queue.addTask(new BenchmarkTask(_counter), 0.0f);
+			
+			return 0;
+		}
+		
+	private:
+		BenchmarkProducer& operator = (const BenchmarkProducer&)
+			{ return *this; }
+		
+	private:
+		Q& _queue;
+		AtomicCounter& _counter;
+	};
+	
+	template <typename Q>
+	uint64_t benchmarkPostAndDrain()
+	{
+		Q queue;
+		AtomicCounter executed;
+		AtomicCounterType totalTasks = static_cast<AtomicCounterType>(benchmarkProducers * benchmarkTasksPerProducer);
+		
+		std::vector<BenchmarkProducer<Q>*> producers;
+		for (size_t i = 0; i < benchmarkProducers; ++i)
+			producers.push_back(new BenchmarkProducer<Q>(queue, executed));
+		
+		uint64_t startTime = queryContiniousTimeInMilliSeconds();
+		
+		for (auto p : producers)
+			p->run();
+		
+		while (executed.atomicCounterValue() < totalTasks)
+			queue.update(0.0f);
+		
+		uint64_t elapsedTime = queryContiniousTimeInMilliSeconds() - startTime;
+		
+		for (auto p : producers)
+		{
+			p->waitForTermination();
+			delete p;
+		}
+		
+		return elapsedTime;
+	}
+	
+	void benchmarkRunLoopInbox()
+	{
+		uint64_t lockedTime = benchmarkPostAndDrain<LockedTaskList>();
+		uint64_t inboxTime = benchmarkPostAndDrain<TaskPool>();
+		
+		log::info("Posted and drained %lu tasks from %lu threads: critical section - %lu ms, lock-free inbox - %lu ms",
+			static_cast<unsigned long>(benchmarkProducers * benchmarkTasksPerProducer),
+			static_cast<unsigned long>(benchmarkProducers), static_cast<unsigned long>(lockedTime),
+			static_cast<unsigned long>(inboxTime));
+	}
+	
+	/*
+	 * Packing of glyph-sized rects into the atlas, should fit into a millisecond
+	 */
+	const size_t benchmarkRectsCount = 10000;
+	const uint64_t benchmarkPackingBudget = 1000;
+	
+	void benchmarkRectPlacer()
+	{
+		const char* sortModeNames[RectPlacer::SortMode_max] = { "none", "height", "area", "longest side" };
+		
+		RectPlacer::SizeList sizes;
+		for (size_t i = 0; i < benchmarkRectsCount; ++i)
+			sizes.push_back(vec2i(6 + rand() % 19, 8 + rand() % 17));
+		
+		for (size_t mode = 0; mode < RectPlacer::SortMode_max; ++mode)
+		{
+			RectPlacer placer(vec2i(2048), true);
+			RectPlacer::RectList positions;
+			
+			uint64_t startTime = queryCurrentTimeInMicroSeconds();
+			size_t placed = placer.place(sizes, positions, static_cast<RectPlacer::SortMode>(mode));
+			uint64_t elapsedTime = queryCurrentTimeInMicroSeconds() - startTime;
+			
+			log::info("Packed %lu of %lu rects (sort by %s) in %lu us, occupancy %.1f%%%s",
+				static_cast<unsigned long>(placed), static_cast<unsigned long>(sizes.size()), sortModeNames[mode],
+				static_cast<unsigned long>(elapsedTime), 100.0f * placer.occupancy(),
+				(elapsedTime > benchmarkPackingBudget) ? ", over budget" : "");
+		}
+	}
+	
+	/*
+	 * SIMD specializations of math types against the same operations written with scalar code
+	 */
+	const size_t benchmarkMathIterations = 1000000;
+	
+	mat4 scalarMultiply(const mat4& a, const mat4& b)
+	{
+		mat4 r;
+		for (int i = 0; i < 4; ++i)
+			r[i] = b[0] * a[i].x + b[1] * a[i].y + b[2] * a[i].z + b[3] * a[i].w;
+		return r;
+	}
+	
+	vec4 scalarTransform(const mat4& m, const vec4& v)
+		{ return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w; }
+	
+	mat4 scalarInverse(const mat4& m)
+		{ return m.adjugateMatrix() / m.determinant(); }
+	
+	quaternion scalarMultiply(const quaternion& a, const quaternion& b)
+	{
+		quaternion r;
+		r.scalar = a.scalar * b.scalar - dot(a.vector, b.vector);
+		r.vector = a.vector.cross(b.vector) + a.scalar * b.vector + b.scalar * a.vector;
+		return r;
+	}
+	
+	template <typename F>
+	uint64_t measureMath(F func)
+	{
+		uint64_t startTime = queryCurrentTimeInMicroSeconds();
+		for (size_t i = 0; i < benchmarkMathIterations; ++i)
+			func();
+		return queryCurrentTimeInMicroSeconds() - startTime;
+	}
+	
+	void benchmarkMath()
+	{
+		mat4 a = quaternion(0.5f, normalize(vec3(1.0f, 2.0f, 3.0f))).toMatrix();
+		a[3] = vec4(1.0f, 2.0f, 3.0f, 1.0f);
+		
+		mat4 b = a.inverse();
+		vec4 v(1.0f, 0.5f, 0.25f, 1.0f);
+		quaternion q(0.1f, unitY);
+		quaternion qr;
+		
+		mat4 m = identityMatrix;
+		uint64_t simdMultiply = measureMath([&]() { m = m * a; m = m * b; });
+		uint64_t scalarMultiplyTime = measureMath([&]() { m = scalarMultiply(m, a); m = scalarMultiply(m, b); });
+		
+		uint64_t simdTransform = measureMath([&]() { v = a * v; v = b * v; });
+		uint64_t scalarTransformTime = measureMath([&]() { v = scalarTransform(a, v); v = scalarTransform(b, v); });
+		
+		uint64_t simdInverse = measureMath([&]() { m = m.inverse(); });
+		uint64_t scalarInverseTime = measureMath([&]() { m = scalarInverse(m); });
+		
+		uint64_t simdQuaternion = measureMath([&]() { qr = qr * q; });
+		uint64_t scalarQuaternion = measureMath([&]() { qr = scalarMultiply(qr, q); });
+		
+		uint64_t simdNormalize = measureMath([&]() { v = normalize(v + a[0]); });
+		uint64_t scalarNormalize = measureMath([&]() { v += a[0]; v /= std::sqrt(v.x*v.x + v.y*v.y + v.z*v.z + v.w*v.w); });
+		
+		log::info("%lu iterations, SIMD %s / scalar (us): mat4 x mat4 %lu / %lu, mat4 x vec4 %lu / %lu, "
+			"inverse %lu / %lu, quaternion %lu / %lu, normalize %lu / %lu (%f)",
+			static_cast<unsigned long>(benchmarkMathIterations), ET_SIMD ? "enabled" : "disabled",
+			static_cast<unsigned long>(simdMultiply), static_cast<unsigned long>(scalarMultiplyTime),
+			static_cast<unsigned long>(simdTransform), static_cast<unsigned long>(scalarTransformTime),
+			static_cast<unsigned long>(simdInverse), static_cast<unsigned long>(scalarInverseTime),
+			static_cast<unsigned long>(simdQuaternion), static_cast<unsigned long>(scalarQuaternion),
+			static_cast<unsigned long>(simdNormalize), static_cast<unsigned long>(scalarNormalize),
+			m[0].x + v.x + qr.scalar);
+	}
+	
+	/*
+	 * Moving spheres in the box, proxies are moved and overlapping pairs are found each frame
+	 */
+	const size_t benchmarkProxiesCount = 10000;
+	const size_t benchmarkBroadphaseFrames = 30;
+	const float benchmarkWorldSize = 100.0f;
+	
+	void benchmarkBroadphase(Broadphase& broadphase, const char* name)
+	{
+		std::vector<Sphere> spheres;
+		std::vector<vec3> velocities;
+		std::vector<BroadphaseProxy> proxies;
+		
+		for (size_t i = 0; i < benchmarkProxiesCount; ++i)
+		{
+			spheres.push_back(Sphere(benchmarkWorldSize * vec3(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f),
+				randomFloat(-1.0f, 1.0f)), randomFloat(0.5f, 1.5f)));
+			velocities.push_back(vec3(randomFloat(-0.5f, 0.5f), randomFloat(-0.5f, 0.5f), randomFloat(-0.5f, 0.5f)));
+			proxies.push_back(broadphase.addProxy(spheres.back()));
+		}
+		
+		uint64_t updateTime = 0;
+		uint64_t pairsTime = 0;
+		size_t pairsCount = 0;
+		
+		BroadphasePairList pairs;
+		for (size_t frame = 0; frame < benchmarkBroadphaseFrames; ++frame)
+		{
+			for (size_t i = 0; i < benchmarkProxiesCount; ++i)
+			{
+				vec3 c = spheres[i].center() + velocities[i];
+				for (int k = 0; k < 3; ++k)
+				{
+					if (std::abs(c[k]) > benchmarkWorldSize)
+						velocities[i][k] = -velocities[i][k];
+				}
+				spheres[i].setCenter(c);
+			}
+			
+			uint64_t startTime = queryCurrentTimeInMicroSeconds();
+			for (size_t i = 0; i < benchmarkProxiesCount; ++i)
+				broadphase.moveProxy(proxies[i], spheres[i]);
+			updateTime += queryCurrentTimeInMicroSeconds() - startTime;
+			
+			pairs.clear();
+			startTime = queryCurrentTimeInMicroSeconds();
+			broadphase.findOverlappingPairs(pairs);
+			pairsTime += queryCurrentTimeInMicroSeconds() - startTime;
+			pairsCount += pairs.size();
+		}
+		
+		log::info("%s, %lu proxies: update %lu us, pairs %lu us per frame, %lu pairs per frame", name,
+			static_cast<unsigned long>(benchmarkProxiesCount),
+			static_cast<unsigned long>(updateTime / benchmarkBroadphaseFrames),
+			static_cast<unsigned long>(pairsTime / benchmarkBroadphaseFrames),
+			static_cast<unsigned long>(pairsCount / benchmarkBroadphaseFrames));
+	}
+	
+	void benchmarkBroadphase()
+	{
+		SweepAndPrune sweepAndPrune;
+		benchmarkBroadphase(sweepAndPrune, "Sweep and prune");
+		
+		UniformGrid grid(3.0f);
+		benchmarkBroadphase(grid, "Uniform grid");
+	}
+}
+
+#endif
+
 void MainController::setRenderContextParameters(et::RenderContextParameters& p)
 {
 	p.supportedInterfaceOrientations =
@@ -24,6 +330,13 @@ void MainController::applicationDidLoad(et::RenderContext* rc)
 	_mainMenu = MainMenuLayout::Pointer(new MainMenuLayout(rc, _resourceManager));
 	_gui->pushLayout(_mainMenu);
 
+#if (ET_THREADING_TESTS_BENCHMARKS)
+	benchmarkRunLoopInbox();
+	benchmarkRectPlacer();
+	benchmarkMath();
+	benchmarkBroadphase();
+#endif
+	
 	for (size_t i = 0; i < _threads.size(); ++i)
 		_threads[i] = new EventThread;
 }
@@ -0,0 +1,100 @@
+#include <et/core/tools.h>
+#include <et/core/filesystem.h>
+#include <et/core/assetpack.h>
+
+using namespace et;
+
+void printHelp()
+{
+	std::cout << "Using: " << std::endl <<
+		"assetpack -root <ROOT FOLDER> -out <OUTPUT FILE>" << std::endl <<
+		"\tOPTIONAL: -align <ALIGNMENT>, default: 16 - alignment of the files in pack, power of two" << std::endl <<
+		"\tOPTIONAL: -mask <MASK>, default: *.* - mask of the files to add" << std::endl;
+}
+
+void collectFiles(const std::string& rootFolder, const std::string& mask, StringList& files)
+{
+	StringList folders;
+	folders.push_back(rootFolder);
+	findSubfolders(rootFolder, true, folders);
+
+	for (auto& folder : folders)
+	{
+		StringList folderFiles;
+		findFiles(folder, mask, false, folderFiles);
+
+		for (auto& file : folderFiles)
+		{
+			if (!folderExists(file))
+				files.push_back(file);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bool hasRoot = false;
+	bool hasOutput = false;
+
+	std::string rootFolder;
+	std::string outFile;
+	std::string mask = "*.*";
+	int alignment = AssetPack::DefaultAlignment;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if ((strcmp(argv[i], "-root") == 0) && (i + 1 < argc))
+		{
+			rootFolder = addTrailingSlash(std::string(argv[i+1]));
+			if (folderExists(rootFolder))
+			{
+				hasRoot = true;
+				++i;
+			}
+			else
+			{
+				std::cout << "ERROR: root folder not found" << std::endl;
+				return 1;
+			}
+		}
+		else if ((strcmp(argv[i], "-out") == 0) && (i + 1 < argc))
+		{
+			outFile = std::string(argv[i+1]);
+			hasOutput = true;
+			++i;
+		}
+		else if ((strcmp(argv[i], "-mask") == 0) && (i + 1 < argc))
+		{
+			mask = std::string(argv[i+1]);
+			++i;
+		}
+		else if ((strcmp(argv[i], "-align") == 0) && (i + 1 < argc))
+		{
+			alignment = strToInt(std::string(argv[i+1]));
+			++i;
+		}
+	}
+
+	if (!hasRoot || !hasOutput || (alignment <= 0))
+	{
+		printHelp();
+		return 1;
+	}
+
+	StringList files;
+	collectFiles(rootFolder, mask, files);
+
+	if (!AssetPack::build(outFile, rootFolder, files, static_cast<size_t>(alignment)))
+		return 1;
+
+	AssetPack::Pointer pack(new AssetPack(outFile));
+	if (!pack->valid())
+		return 1;
+
+	for (size_t i = 0; i < pack->entriesCount(); ++i)
+		std::cout << pack->entryName(i) << "\t|\t" << pack->entry(i).size << std::endl;
+
+	std::cout << "Files: " << pack->entriesCount() << std::endl;
+
+	return 0;
+}
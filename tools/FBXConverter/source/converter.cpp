@@ -118,7 +118,7 @@ void Converter::applicationDidLoad(RenderContext* rc)
 	const std::string& lp = application().launchParameter(1);
 	if (fileExists(lp))
 	{
-		Invocation1 i;
+		Invocation i;
 		i.setTarget(this, &Converter::performLoading, lp);
 		i.invokeInMainRunLoop();
 	}
@@ -213,7 +213,7 @@ void Converter::onBtnOpenClick(et::gui::Button*)
 	types.push_back("etm");
 	std::string fileName = selectFile(types, SelectFileMode_Open);
 	
-	Invocation1 i;
+	Invocation i;
 	i.setTarget(this, &Converter::performLoading, fileName);
 	i.invokeInMainRunLoop();
 	
@@ -225,7 +225,7 @@ void Converter::onBtnSaveClick(et::gui::Button* b)
 {
 	std::string fileName = selectFile(StringList(), SelectFileMode_Save);
 	
-	Invocation1 i;
+	Invocation i;
 
 	i.setTarget(this, (b->tag == 1 ? &Converter::performBinarySaving :
 		&Converter::performBinaryWithReadableMaterialsSaving), fileName);